@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Замеры производительности отдельных частей приложения
+#
+# Собираются отдельно от приложения:
+#   qmake benchmarks.pro && make
+# и запускаются из папки сборки, например:
+#   ./patchxml-benchmark
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    patchxml \
+    compaction \
+    database \
+    export
@@ -0,0 +1,284 @@
+#include <DataLayer/Database/DatabaseHelper.h>
+#include <DataLayer/Database/ScenarioChangesCompactor.h>
+
+#include <3rd_party/Helpers/DiffMatchPatchHelper.h>
+
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QtTest>
+
+using DatabaseLayer::DatabaseHelper;
+using DatabaseLayer::ScenarioChangesCompactor;
+
+namespace {
+	/**
+	 * @brief Количество изменений сценария в проекте, который редактировали около года
+	 */
+	const int CHANGES_COUNT = 20000;
+
+	/**
+	 * @brief Количество последних изменений, остающихся после сжатия, как в приложении
+	 */
+	const int TAIL_SIZE = 1000;
+
+	/**
+	 * @brief Количество сцен в сценарии
+	 */
+	const int SCENES_COUNT = 300;
+
+	/**
+	 * @brief Текст сценария по умолчанию, к которому применяется первое изменение
+	 */
+	const QString INITIAL_XML =
+			"<?xml version=\"1.0\"?>\n<scenario version=\"1.0\">\n"
+			"<scene_heading>\n<v><![CDATA[]]></v>\n</scene_heading>\n"
+			"</scenario>\n";
+
+	/**
+	 * @brief Сформировать xml сценария, в котором заданная сцена изменена заданное число раз
+	 */
+	static QString scenarioXml(int _changedScene, int _revision) {
+		const QString blockXml = "<%1>\n<v><![CDATA[%2]]></v>\n</%1>\n";
+		QString xml = "<?xml version=\"1.0\"?>\n<scenario version=\"1.0\">\n";
+		for (int scene = 0; scene < SCENES_COUNT; ++scene) {
+			xml.append(blockXml.arg("scene_heading", QString("INT. ROOM %1 - DAY").arg(scene)));
+			xml.append(blockXml.arg("action", scene == _changedScene
+											  ? QString("Somebody walks into the room, take %1.").arg(_revision)
+											  : QString("Somebody walks into the room.")));
+			xml.append(blockXml.arg("character", "SOMEBODY"));
+			xml.append(blockXml.arg("dialog", "I have been waiting for you since the very morning."));
+		}
+		xml.append("</scenario>\n");
+		return xml;
+	}
+
+	/**
+	 * @brief Создать таблицы изменений сценария так же, как это делает Database
+	 */
+	static void createTables(QSqlDatabase& _database) {
+		QSqlQuery q_creator(_database);
+		q_creator.exec("CREATE TABLE scenario_changes "
+					   "("
+					   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+					   "uuid TEXT NOT NULL, "
+					   "datetime TEXT NOT NULL, "
+					   "username TEXT NOT NULL, "
+					   "undo_patch TEXT NOT NULL, "
+					   "redo_patch TEXT NOT NULL, "
+					   "is_draft INTEGER NOT NULL DEFAULT(0) "
+					   ")"
+					   );
+		q_creator.exec("CREATE TABLE scenario_changes_compacted "
+					   "("
+					   "uuid TEXT PRIMARY KEY "
+					   ") WITHOUT ROWID"
+					   );
+		q_creator.exec("CREATE INDEX scenario_changes_uuid_index ON scenario_changes (uuid)");
+	}
+
+	/**
+	 * @brief Загрузить все изменения, как это делается при открытии проекта и полной синхронизации
+	 * @return Количество загруженных изменений
+	 */
+	static int loadChanges(QSqlDatabase& _database) {
+		QSqlQuery q_loader(_database);
+		q_loader.exec("SELECT id, uuid, datetime, username, undo_patch, redo_patch, is_draft FROM scenario_changes");
+		int count = 0;
+		while (q_loader.next()) {
+			++count;
+		}
+		return count;
+	}
+}
+
+
+/**
+ * @brief Размер файла и время загрузки истории изменений проекта до и после сжатия
+ */
+class CompactionBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сформировать проект с большой историей изменений
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief Сжатие истории
+	 */
+	void compact();
+
+	/**
+	 * @brief Загрузка истории изменений до и после сжатия
+	 */
+	void loadChanges_data();
+	void loadChanges();
+
+	/**
+	 * @brief Закрыть соединения
+	 */
+	void cleanupTestCase();
+
+private:
+	/**
+	 * @brief Открыть соединение с файлом
+	 */
+	QSqlDatabase openDatabase(const QString& _connectionName, const QString& _fileName);
+
+	/**
+	 * @brief Восстановить текст сценария по истории изменений
+	 */
+	QString restoreText(QSqlDatabase& _database);
+
+private:
+	/**
+	 * @brief Папка для файлов проектов
+	 */
+	QTemporaryDir m_dir;
+
+	/**
+	 * @brief Проект с полной историей
+	 */
+	QString m_originalFileName;
+
+	/**
+	 * @brief Проект со сжатой историей
+	 */
+	QString m_compactedFileName;
+
+	/**
+	 * @brief Итоговый текст сценария
+	 */
+	QString m_lastXml;
+};
+
+void CompactionBenchmark::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_originalFileName = m_dir.filePath("original.kitsp");
+	m_compactedFileName = m_dir.filePath("compacted.kitsp");
+
+	{
+		QSqlDatabase database = openDatabase("original", m_originalFileName);
+		::createTables(database);
+
+		QSqlQuery q_saver(database);
+		q_saver.prepare("INSERT INTO scenario_changes (uuid, datetime, username, undo_patch, redo_patch, is_draft) "
+						"VALUES(?, ?, ?, ?, ?, 0)");
+		database.transaction();
+		QString previousXml = INITIAL_XML;
+		for (int change = 0; change < CHANGES_COUNT; ++change) {
+			const QString xml = ::scenarioXml(change % SCENES_COUNT, change);
+			q_saver.addBindValue(QUuid::createUuid().toString());
+			q_saver.addBindValue(QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss"));
+			q_saver.addBindValue("user");
+			//
+			// Патчи хранятся сжатыми, как их сохраняет приложение
+			//
+			q_saver.addBindValue(DatabaseHelper::compress(DiffMatchPatchHelper::makePatchXml(xml, previousXml)));
+			q_saver.addBindValue(DatabaseHelper::compress(DiffMatchPatchHelper::makePatchXml(previousXml, xml)));
+			QVERIFY(q_saver.exec());
+			previousXml = xml;
+		}
+		QVERIFY(database.commit());
+		m_lastXml = previousXml;
+	}
+	QSqlDatabase::removeDatabase("original");
+
+	QVERIFY(QFile::copy(m_originalFileName, m_compactedFileName));
+}
+
+void CompactionBenchmark::compact()
+{
+	const QString fileName = m_dir.filePath("compact.kitsp");
+	QVERIFY(QFile::copy(m_originalFileName, fileName));
+
+	{
+		QSqlDatabase database = openDatabase("compact", fileName);
+		bool isCompacted = false;
+		QBENCHMARK_ONCE {
+			isCompacted = ScenarioChangesCompactor::compact(database, TAIL_SIZE, INITIAL_XML);
+			QSqlQuery(database).exec("VACUUM");
+		}
+		QVERIFY(isCompacted);
+
+		//
+		// Снимок вместе с хвостом должны давать тот же текст, а все uuid'ы остаются известны проекту
+		//
+		QCOMPARE(restoreText(database), m_lastXml);
+		QSqlQuery q_checker(database);
+		QVERIFY(q_checker.exec("SELECT (SELECT COUNT(*) FROM scenario_changes), "
+							   "(SELECT COUNT(*) FROM scenario_changes_compacted)"));
+		QVERIFY(q_checker.next());
+		QCOMPARE(q_checker.value(0).toInt(), TAIL_SIZE + 1);
+		QCOMPARE(q_checker.value(1).toInt(), CHANGES_COUNT - TAIL_SIZE);
+
+		//
+		// Повторное сжатие без новых изменений ничего не делает
+		//
+		QVERIFY(!ScenarioChangesCompactor::compact(database, TAIL_SIZE, INITIAL_XML));
+	}
+	QSqlDatabase::removeDatabase("compact");
+
+	QFile::remove(m_compactedFileName);
+	QVERIFY(QFile::copy(fileName, m_compactedFileName));
+
+	qDebug() << "file size before compaction:" << QFileInfo(m_originalFileName).size() / 1024 << "KiB"
+			 << "after:" << QFileInfo(m_compactedFileName).size() / 1024 << "KiB";
+}
+
+void CompactionBenchmark::loadChanges_data()
+{
+	QTest::addColumn<QString>("fileName");
+	QTest::newRow("original") << m_originalFileName;
+	QTest::newRow("compacted") << m_compactedFileName;
+}
+
+void CompactionBenchmark::loadChanges()
+{
+	QFETCH(QString, fileName);
+
+	int count = 0;
+	QBENCHMARK {
+		{
+			QSqlDatabase database = openDatabase("load", fileName);
+			count = ::loadChanges(database);
+		}
+		QSqlDatabase::removeDatabase("load");
+	}
+	QVERIFY(count > 0);
+}
+
+void CompactionBenchmark::cleanupTestCase()
+{
+	foreach (const QString& connectionName, QSqlDatabase::connectionNames()) {
+		QSqlDatabase::removeDatabase(connectionName);
+	}
+}
+
+QSqlDatabase CompactionBenchmark::openDatabase(const QString& _connectionName, const QString& _fileName)
+{
+	QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", _connectionName);
+	database.setDatabaseName(_fileName);
+	database.open();
+	return database;
+}
+
+QString CompactionBenchmark::restoreText(QSqlDatabase& _database)
+{
+	QString text = INITIAL_XML;
+	QSqlQuery q_loader(_database);
+	q_loader.exec("SELECT redo_patch FROM scenario_changes WHERE is_draft = 0 ORDER BY id");
+	while (q_loader.next()) {
+		text = DiffMatchPatchHelper::applyPatchXml(text, DatabaseHelper::uncompress(q_loader.value(0).toString()));
+	}
+	return text;
+}
+
+QTEST_GUILESS_MAIN(CompactionBenchmark)
+
+#include "CompactionBenchmark.moc"
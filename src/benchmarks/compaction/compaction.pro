@@ -0,0 +1,36 @@
+#-------------------------------------------------
+#
+# Замер размера файла проекта и времени загрузки истории изменений до и после её сжатия
+#
+#-------------------------------------------------
+
+QT       += core gui sql testlib
+QT       -= widgets
+
+TARGET = compaction-benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/benchmarks/compaction
+} else {
+    DESTDIR = $$PWD/../../../build/Release/benchmarks/compaction
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+INCLUDEPATH += $$PWD/../../bin/scenarist-core
+
+SOURCES += \
+    CompactionBenchmark.cpp \
+    ../../bin/scenarist-core/DataLayer/Database/ScenarioChangesCompactor.cpp \
+    ../../bin/scenarist-core/3rd_party/Helpers/DiffMatchPatch.cpp
@@ -0,0 +1,420 @@
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Размеры синтетического проекта
+	 */
+	/** @{ */
+	const int SCENARIO_CHANGES_COUNT = 50000;
+	const int HISTORY_RECORDS_COUNT = 50000;
+	const int CHARACTERS_COUNT = 2000;
+	const int PHOTOS_PER_CHARACTER = 3;
+	const int PHOTO_SIZE = 4096;
+	/** @} */
+
+	/**
+	 * @brief Количество изменений, которые проверяются при сравнении с сервером
+	 */
+	const int SYNC_LOOKUPS_COUNT = 1000;
+
+	/**
+	 * @brief Количество сохранений проекта
+	 */
+	const int SAVES_COUNT = 200;
+
+	/**
+	 * @brief Время, с которого выбирается история для отправки на сервер
+	 */
+	const QString HISTORY_FROM_DATETIME = "2016-12-31 00:00:00";
+
+	/**
+	 * @brief Время изменения с заданным номером, последние изменения попадают в выборку истории
+	 */
+	static QString changeDatetime(int _index, int _count) {
+		return QDateTime(QDate(2016, 1, 1)).addSecs(qint64(_index) * 365 * 24 * 60 * 60 / _count)
+				.toString("yyyy-MM-dd hh:mm:ss");
+	}
+
+	/**
+	 * @brief Создать таблицы, по которым выполняются замеры, так же, как это делает Database
+	 */
+	static void createTables(QSqlDatabase& _database) {
+		QSqlQuery q_creator(_database);
+		q_creator.exec("CREATE TABLE _database_history "
+					   "( "
+					   "id TEXT PRIMARY KEY, "
+					   "query TEXT NOT NULL, "
+					   "query_values TEXT NOT NULL, "
+					   "query_id INTEGER DEFAULT(NULL), "
+					   "query_values_data BLOB DEFAULT(NULL), "
+					   "datetime TEXT NOT NULL "
+					   ")"
+					   );
+		q_creator.exec("CREATE TABLE characters_photo "
+					   "( "
+					   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+					   "fk_character_id INTEGER NOT NULL, "
+					   "photo BLOB NOT NULL, "
+					   "sort_order INTEGER NOT NULL DEFAULT(0) "
+					   ")"
+					   );
+		q_creator.exec("CREATE TABLE scenario_changes "
+					   "("
+					   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+					   "uuid TEXT NOT NULL, "
+					   "datetime TEXT NOT NULL, "
+					   "username TEXT NOT NULL, "
+					   "undo_patch TEXT NOT NULL, "
+					   "redo_patch TEXT NOT NULL, "
+					   "is_draft INTEGER NOT NULL DEFAULT(0) "
+					   ")"
+					   );
+	}
+
+	/**
+	 * @brief Создать индексы так же, как это делает Database::createIndexes
+	 */
+	static void createIndexes(QSqlDatabase& _database) {
+		QSqlQuery q_creator(_database);
+		q_creator.exec("CREATE INDEX IF NOT EXISTS scenario_changes_uuid_index ON scenario_changes (uuid)");
+		q_creator.exec("CREATE INDEX IF NOT EXISTS database_history_datetime_index ON _database_history (datetime)");
+		q_creator.exec("CREATE INDEX IF NOT EXISTS characters_photo_character_index "
+					   "ON characters_photo (fk_character_id, sort_order)");
+	}
+
+	/**
+	 * @brief Применить параметры SQLite так же, как это делает Database при открытии файла
+	 */
+	static void applyProfile(QSqlDatabase& _database, const QString& _journalMode, const QString& _synchronous) {
+		QSqlQuery q_tuner(_database);
+		q_tuner.exec(QString("PRAGMA journal_mode = %1").arg(_journalMode));
+		q_tuner.exec(QString("PRAGMA synchronous = %1").arg(_synchronous));
+		q_tuner.exec("PRAGMA cache_size = -16384");
+		q_tuner.exec(QString("PRAGMA mmap_size = %1").arg(64 * 1024 * 1024));
+	}
+
+	/**
+	 * @brief Добавить в проект одно изменение сценария и несколько записей истории, как при сохранении
+	 */
+	static bool saveChanges(QSqlDatabase& _database, int _index) {
+		const QString datetime = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
+		QSqlQuery q_saver(_database);
+		_database.transaction();
+		q_saver.prepare("INSERT INTO scenario_changes (uuid, datetime, username, undo_patch, redo_patch) "
+						"VALUES(?, ?, 'user', ?, ?)");
+		q_saver.addBindValue(QUuid::createUuid().toString());
+		q_saver.addBindValue(datetime);
+		q_saver.addBindValue(QString("@@ -1,4 +1,4 @@ undo %1").arg(_index));
+		q_saver.addBindValue(QString("@@ -1,4 +1,4 @@ redo %1").arg(_index));
+		bool isOk = q_saver.exec();
+		q_saver.prepare("INSERT INTO _database_history (id, query, query_values, query_id, query_values_data, datetime) "
+						"VALUES(?, '', '', 1, ?, ?)");
+		for (int record = 0; record < 5; ++record) {
+			q_saver.addBindValue(QUuid::createUuid().toString());
+			q_saver.addBindValue(QByteArray(64, char(record)));
+			q_saver.addBindValue(datetime);
+			isOk = isOk && q_saver.exec();
+		}
+		return _database.commit() && isOk;
+	}
+}
+
+
+/**
+ * @brief Открытие, сохранение и сравнение изменений с сервером на больших проектах
+ */
+class DatabaseBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сформировать проекты с индексами и без
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief Открытие проекта и загрузка списка изменений сценария
+	 */
+	void open_data();
+	void open();
+
+	/**
+	 * @brief Поиск изменений по uuid и выборка истории для отправки на сервер
+	 */
+	void syncDiff_data();
+	void syncDiff();
+
+	/**
+	 * @brief Загрузка фотографий персонажей
+	 */
+	void photos_data();
+	void photos();
+
+	/**
+	 * @brief Последовательные сохранения проекта
+	 */
+	void save_data();
+	void save();
+
+private:
+	/**
+	 * @brief Добавить в таблицу данных проекты с индексами и без
+	 */
+	void addProjects();
+
+	/**
+	 * @brief Добавить в таблицу данных параметры SQLite
+	 */
+	void addProfiles();
+
+	/**
+	 * @brief Открыть соединение с файлом
+	 */
+	QSqlDatabase openDatabase(const QString& _fileName);
+
+private:
+	/**
+	 * @brief Папка для файлов проектов
+	 */
+	QTemporaryDir m_dir;
+
+	/**
+	 * @brief Проект без индексов
+	 */
+	QString m_plainFileName;
+
+	/**
+	 * @brief Проект с индексами
+	 */
+	QString m_indexedFileName;
+
+	/**
+	 * @brief Uuid'ы изменений, которые ищутся при сравнении с сервером
+	 */
+	QStringList m_lookupUuids;
+};
+
+void DatabaseBenchmark::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_plainFileName = m_dir.filePath("plain.kitsp");
+	m_indexedFileName = m_dir.filePath("indexed.kitsp");
+
+	{
+		QSqlDatabase database = openDatabase(m_plainFileName);
+		::createTables(database);
+
+		QSqlQuery q_saver(database);
+		database.transaction();
+		q_saver.prepare("INSERT INTO scenario_changes (uuid, datetime, username, undo_patch, redo_patch) "
+						"VALUES(?, ?, 'user', ?, ?)");
+		for (int change = 0; change < SCENARIO_CHANGES_COUNT; ++change) {
+			const QString uuid = QUuid::createUuid().toString();
+			if (change % (SCENARIO_CHANGES_COUNT / SYNC_LOOKUPS_COUNT) == 0) {
+				m_lookupUuids.append(uuid);
+			}
+			q_saver.addBindValue(uuid);
+			q_saver.addBindValue(::changeDatetime(change, SCENARIO_CHANGES_COUNT));
+			q_saver.addBindValue(QString("@@ -%1,7 +%1,12 @@ undo patch of the change").arg(change));
+			q_saver.addBindValue(QString("@@ -%1,12 +%1,7 @@ redo patch of the change").arg(change));
+			QVERIFY(q_saver.exec());
+		}
+
+		q_saver.prepare("INSERT INTO _database_history (id, query, query_values, query_id, query_values_data, datetime) "
+						"VALUES(?, '', '', ?, ?, ?)");
+		for (int record = 0; record < HISTORY_RECORDS_COUNT; ++record) {
+			q_saver.addBindValue(QUuid::createUuid().toString());
+			q_saver.addBindValue(record % 20 + 1);
+			q_saver.addBindValue(QByteArray(64, char(record)));
+			q_saver.addBindValue(::changeDatetime(record, HISTORY_RECORDS_COUNT));
+			QVERIFY(q_saver.exec());
+		}
+
+		q_saver.prepare("INSERT INTO characters_photo (fk_character_id, photo, sort_order) VALUES(?, ?, ?)");
+		for (int photo = 0; photo < CHARACTERS_COUNT * PHOTOS_PER_CHARACTER; ++photo) {
+			q_saver.addBindValue(photo % CHARACTERS_COUNT + 1);
+			q_saver.addBindValue(QByteArray(PHOTO_SIZE, char(photo)));
+			q_saver.addBindValue(photo / CHARACTERS_COUNT);
+			QVERIFY(q_saver.exec());
+		}
+		QVERIFY(database.commit());
+	}
+	QSqlDatabase::removeDatabase(m_plainFileName);
+
+	QVERIFY(QFile::copy(m_plainFileName, m_indexedFileName));
+	{
+		QSqlDatabase database = openDatabase(m_indexedFileName);
+		::createIndexes(database);
+	}
+	QSqlDatabase::removeDatabase(m_indexedFileName);
+
+	qDebug() << "project size without indexes:" << QFileInfo(m_plainFileName).size() / 1024 << "KiB"
+			 << "with indexes:" << QFileInfo(m_indexedFileName).size() / 1024 << "KiB";
+}
+
+void DatabaseBenchmark::open_data()
+{
+	addProfiles();
+}
+
+void DatabaseBenchmark::open()
+{
+	QFETCH(QString, journalMode);
+	QFETCH(QString, synchronous);
+
+	int count = 0;
+	QBENCHMARK {
+		{
+			QSqlDatabase database = openDatabase(m_indexedFileName);
+			::applyProfile(database, journalMode, synchronous);
+			QSqlQuery q_loader(database);
+			q_loader.exec("SELECT uuid FROM scenario_changes");
+			count = 0;
+			while (q_loader.next()) {
+				++count;
+			}
+		}
+		QSqlDatabase::removeDatabase(m_indexedFileName);
+	}
+	QCOMPARE(count, SCENARIO_CHANGES_COUNT);
+
+	//
+	// Возвращаем файлу обычный журнал, чтобы следующие замеры начинались в одинаковых условиях
+	//
+	{
+		QSqlDatabase database = openDatabase(m_indexedFileName);
+		::applyProfile(database, "DELETE", "FULL");
+	}
+	QSqlDatabase::removeDatabase(m_indexedFileName);
+}
+
+void DatabaseBenchmark::syncDiff_data()
+{
+	addProjects();
+}
+
+void DatabaseBenchmark::syncDiff()
+{
+	QFETCH(QString, fileName);
+
+	int found = 0;
+	int historyCount = 0;
+	{
+		QSqlDatabase database = openDatabase(fileName);
+		QSqlQuery q_checker(database);
+		QBENCHMARK {
+			found = 0;
+			q_checker.prepare("SELECT COUNT(id) FROM scenario_changes WHERE uuid = ?");
+			foreach (const QString& uuid, m_lookupUuids) {
+				q_checker.addBindValue(uuid);
+				q_checker.exec();
+				q_checker.next();
+				found += q_checker.value(0).toInt();
+			}
+
+			historyCount = 0;
+			q_checker.prepare("SELECT id FROM _database_history WHERE datetime >= ?");
+			q_checker.addBindValue(HISTORY_FROM_DATETIME);
+			q_checker.exec();
+			while (q_checker.next()) {
+				++historyCount;
+			}
+		}
+	}
+	QSqlDatabase::removeDatabase(fileName);
+
+	QCOMPARE(found, m_lookupUuids.size());
+	QVERIFY(historyCount > 0);
+}
+
+void DatabaseBenchmark::photos_data()
+{
+	addProjects();
+}
+
+void DatabaseBenchmark::photos()
+{
+	QFETCH(QString, fileName);
+
+	int count = 0;
+	{
+		QSqlDatabase database = openDatabase(fileName);
+		QSqlQuery q_loader(database);
+		QBENCHMARK {
+			count = 0;
+			q_loader.prepare("SELECT photo FROM characters_photo WHERE fk_character_id = ? ORDER BY sort_order");
+			for (int character = 1; character <= CHARACTERS_COUNT; character += 10) {
+				q_loader.addBindValue(character);
+				q_loader.exec();
+				while (q_loader.next()) {
+					++count;
+				}
+			}
+		}
+	}
+	QSqlDatabase::removeDatabase(fileName);
+
+	QCOMPARE(count, CHARACTERS_COUNT / 10 * PHOTOS_PER_CHARACTER);
+}
+
+void DatabaseBenchmark::save_data()
+{
+	addProfiles();
+}
+
+void DatabaseBenchmark::save()
+{
+	QFETCH(QString, journalMode);
+	QFETCH(QString, synchronous);
+
+	const QString fileName = m_dir.filePath(QString("save-%1-%2.kitsp").arg(journalMode, synchronous));
+	QVERIFY(QFile::copy(m_indexedFileName, fileName));
+
+	bool isSaved = true;
+	{
+		QSqlDatabase database = openDatabase(fileName);
+		::applyProfile(database, journalMode, synchronous);
+		int index = 0;
+		QBENCHMARK_ONCE {
+			for (int save = 0; save < SAVES_COUNT; ++save) {
+				isSaved = ::saveChanges(database, index++) && isSaved;
+			}
+		}
+	}
+	QSqlDatabase::removeDatabase(fileName);
+
+	QVERIFY(isSaved);
+}
+
+void DatabaseBenchmark::addProjects()
+{
+	QTest::addColumn<QString>("fileName");
+	QTest::newRow("without indexes") << m_plainFileName;
+	QTest::newRow("with indexes") << m_indexedFileName;
+}
+
+void DatabaseBenchmark::addProfiles()
+{
+	QTest::addColumn<QString>("journalMode");
+	QTest::addColumn<QString>("synchronous");
+	QTest::newRow("DELETE, FULL") << "DELETE" << "FULL";
+	QTest::newRow("WAL, FULL") << "WAL" << "FULL";
+	QTest::newRow("WAL, NORMAL") << "WAL" << "NORMAL";
+}
+
+QSqlDatabase DatabaseBenchmark::openDatabase(const QString& _fileName)
+{
+	QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", _fileName);
+	database.setDatabaseName(_fileName);
+	database.open();
+	return database;
+}
+
+QTEST_GUILESS_MAIN(DatabaseBenchmark)
+
+#include "DatabaseBenchmark.moc"
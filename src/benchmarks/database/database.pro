@@ -0,0 +1,33 @@
+#-------------------------------------------------
+#
+# Замер открытия, сохранения и сравнения изменений при синхронизации на больших проектах
+# с индексами и без, при разных параметрах SQLite
+#
+#-------------------------------------------------
+
+QT       += core sql testlib
+QT       -= gui
+
+TARGET = database-benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/benchmarks/database
+} else {
+    DESTDIR = $$PWD/../../../build/Release/benchmarks/database
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+SOURCES += \
+    DatabaseBenchmark.cpp
@@ -0,0 +1,176 @@
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QUuid>
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Количество сцен в сценарии полнометражного сериала
+	 */
+	const int SCENES_COUNT = 3000;
+
+	/**
+	 * @brief Время ожидания завершения экспорта (мс)
+	 */
+	const int EXPORT_TIMEOUT = 10 * 60 * 1000;
+
+	/**
+	 * @brief Имя файла проекта, по нему же называются экспортированные файлы
+	 */
+	const QString PROJECT_NAME = "large";
+
+	/**
+	 * @brief Сформировать xml большого сценария
+	 */
+	static QString scenarioXml() {
+		const QString blockXml = "<%1>\n<v><![CDATA[%2]]></v>\n</%1>\n";
+		QString xml = "<?xml version=\"1.0\"?>\n<scenario version=\"1.0\">\n";
+		for (int scene = 0; scene < SCENES_COUNT; ++scene) {
+			xml.append(QString("<scene_heading uuid=\"%1\">\n<v><![CDATA[INT. ROOM %2 - DAY]]></v>\n</scene_heading>\n")
+					   .arg(QUuid::createUuid().toString()).arg(scene));
+			xml.append(blockXml.arg("action", "Somebody walks into the room and looks around for a long time."));
+			xml.append(blockXml.arg("character", "SOMEBODY"));
+			xml.append(blockXml.arg("parenthetical", "quietly"));
+			xml.append(blockXml.arg("dialog", "I have been waiting for you since the very morning."));
+			xml.append(blockXml.arg("character", "NOBODY"));
+			xml.append(blockXml.arg("dialog", "And I have been walking here since the very evening."));
+			xml.append(blockXml.arg("transition", "CUT TO:"));
+		}
+		xml.append("</scenario>\n");
+		return xml;
+	}
+}
+
+
+/**
+ * @brief Время и пиковый объём памяти пакетного экспорта большого сценария
+ */
+class ExportBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сформировать проект с большим сценарием
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief Экспорт в заданный формат
+	 */
+	void exportScenario_data();
+	void exportScenario();
+
+private:
+	/**
+	 * @brief Запустить приложение в режиме пакетного экспорта
+	 * @return Вывод приложения, если оно завершилось успешно, иначе пустая строка
+	 */
+	QString runExport(const QString& _format);
+
+private:
+	/**
+	 * @brief Папка для проекта и экспортированных файлов
+	 */
+	QTemporaryDir m_dir;
+
+	/**
+	 * @brief Файл проекта
+	 */
+	QString m_projectFileName;
+};
+
+void ExportBenchmark::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_projectFileName = m_dir.filePath(PROJECT_NAME + ".kitsp");
+
+	//
+	// Схему создаёт само приложение при экспорте пустого файла, чтобы она совпадала с текущей версией
+	//
+	{
+		QFile projectFile(m_projectFileName);
+		QVERIFY(projectFile.open(QIODevice::WriteOnly));
+	}
+	QVERIFY2(!runExport("fdx").isNull(), "Can't run Scenarist, set SCENARIST_BINARY to its path");
+
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase("QSQLITE", "project");
+		database.setDatabaseName(m_projectFileName);
+		QVERIFY(database.open());
+
+		QSqlQuery q_saver(database);
+		QVERIFY(q_saver.exec("DELETE FROM scenario"));
+		q_saver.prepare("INSERT INTO scenario (scheme, text, is_draft) VALUES('', ?, ?)");
+		q_saver.addBindValue(::scenarioXml());
+		q_saver.addBindValue(0);
+		QVERIFY(q_saver.exec());
+		q_saver.addBindValue(QString());
+		q_saver.addBindValue(1);
+		QVERIFY(q_saver.exec());
+	}
+	QSqlDatabase::removeDatabase("project");
+}
+
+void ExportBenchmark::exportScenario_data()
+{
+	QTest::addColumn<QString>("format");
+	QTest::newRow("docx") << "docx";
+	QTest::newRow("fdx") << "fdx";
+}
+
+void ExportBenchmark::exportScenario()
+{
+	QFETCH(QString, format);
+
+	const QString exportedFileName = m_dir.filePath(PROJECT_NAME + "." + format);
+	QFile::remove(exportedFileName);
+
+	QString report;
+	QBENCHMARK_ONCE {
+		report = runExport(format);
+	}
+	QVERIFY(!report.isNull());
+	QVERIFY(QFileInfo(exportedFileName).size() > 0);
+
+	//
+	// Пиковый объём памяти печатает само приложение, поскольку его нельзя узнать снаружи после завершения
+	//
+	const QRegularExpressionMatch peakMemory = QRegularExpression("peak memory: (\\d+) KiB").match(report);
+	if (peakMemory.hasMatch()) {
+		qDebug() << format << "peak memory:" << peakMemory.captured(1).toLongLong() / 1024 << "MiB";
+	}
+}
+
+QString ExportBenchmark::runExport(const QString& _format)
+{
+	QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+	QString binary = environment.value("SCENARIST_BINARY");
+	if (binary.isEmpty()) {
+		binary = QDir(QCoreApplication::applicationDirPath()).filePath("../../bin/scenarist-desktop/Scenarist");
+	}
+	if (!environment.contains("QT_QPA_PLATFORM")) {
+		environment.insert("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QProcess scenarist;
+	scenarist.setProcessEnvironment(environment);
+	scenarist.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+	scenarist.start(binary, QStringList() << "--export" << _format << "--output-dir" << m_dir.path() << m_projectFileName);
+	if (!scenarist.waitForFinished(EXPORT_TIMEOUT)
+		|| scenarist.exitStatus() != QProcess::NormalExit
+		|| scenarist.exitCode() != 0) {
+		scenarist.kill();
+		return QString();
+	}
+
+	return QString::fromUtf8(scenarist.readAllStandardOutput());
+}
+
+QTEST_GUILESS_MAIN(ExportBenchmark)
+
+#include "ExportBenchmark.moc"
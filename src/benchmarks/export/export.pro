@@ -0,0 +1,34 @@
+#-------------------------------------------------
+#
+# Замер времени и пикового объёма памяти пакетного экспорта большого сценария в DOCX и FDX
+#
+# Запускает собранное приложение, путь к нему можно задать переменной окружения SCENARIST_BINARY
+#
+#-------------------------------------------------
+
+QT       += core sql testlib
+QT       -= gui
+
+TARGET = export-benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/benchmarks/export
+} else {
+    DESTDIR = $$PWD/../../../build/Release/benchmarks/export
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+SOURCES += \
+    ExportBenchmark.cpp
@@ -0,0 +1,195 @@
+#include <3rd_party/Helpers/DiffMatchPatchHelper.h>
+
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Количество сцен в сценарии для замеров
+	 */
+	const int SCENES_COUNT = 3000;
+
+	/**
+	 * @brief Код первого спецсимвола, которым помощник заменяет тэги
+	 */
+	const int FIRST_TAG_CHAR = 44032;
+
+	/**
+	 * @brief Сформировать xml сценария заданного размера в том же виде, что и ScenarioXml
+	 */
+	static QString scenarioXml(int _scenesCount) {
+		const QString blockXml = "<%1>\n<v><![CDATA[%2]]></v>\n</%1>\n";
+		QString xml = "<?xml version=\"1.0\"?>\n<scenario version=\"1.0\">\n";
+		for (int scene = 0; scene < _scenesCount; ++scene) {
+			xml.append(QString("<scene_heading uuid=\"{%1}\">\n<v><![CDATA[INT. ROOM %1 - DAY]]></v>\n</scene_heading>\n")
+					   .arg(scene));
+			xml.append(blockXml.arg("action", "Somebody walks into the room & looks <around> for a while."));
+			for (int replica = 0; replica < 3; ++replica) {
+				xml.append(blockXml.arg("character", "SOMEBODY"));
+				xml.append(blockXml.arg("parenthetical", "(quietly)"));
+				xml.append(blockXml.arg("dialog", "I have been waiting for you since the very morning, where were you?"));
+			}
+			xml.append(blockXml.arg("transition", "CUT TO:"));
+		}
+		xml.append("</scenario>\n");
+		return xml;
+	}
+
+	/**
+	 * @brief Соответствия тэгов и спецсимволов, восстановленные через открытый интерфейс помощника
+	 */
+	static const QList<QPair<QString, QString> >& tagsChars() {
+		static QList<QPair<QString, QString> > s_tagsChars;
+		if (s_tagsChars.isEmpty()) {
+			for (int code = FIRST_TAG_CHAR; ; ++code) {
+				const QString plain = QChar(code);
+				const QString tag = DiffMatchPatchHelper::plainToXml(plain);
+				if (tag == plain) {
+					break;
+				}
+				s_tagsChars.append(qMakePair(tag, plain));
+			}
+		}
+		return s_tagsChars;
+	}
+
+	/**
+	 * @brief Прежняя реализация преобразования в плоский текст, полная замена для каждого тэга
+	 */
+	static QString xmlToPlainByReplace(const QString& _xml) {
+		QString plain = _xml;
+		for (int index = 0; index < tagsChars().size(); ++index) {
+			plain.replace(tagsChars().at(index).first, tagsChars().at(index).second);
+		}
+		plain.remove("<?xml version=\"1.0\"?>\n");
+		plain.remove("<scenario version=\"1.0\">\n");
+		plain.remove("</scenario>\n");
+		return plain;
+	}
+
+	/**
+	 * @brief Прежняя реализация преобразования в xml, полная замена для каждого спецсимвола
+	 */
+	static QString plainToXmlByReplace(const QString& _plain) {
+		QString xml = _plain;
+		for (int index = 0; index < tagsChars().size(); ++index) {
+			xml.replace(tagsChars().at(index).second, tagsChars().at(index).first);
+		}
+		return xml;
+	}
+}
+
+
+/**
+ * @brief Сравнение однопроходных преобразований DiffMatchPatchHelper с прежними
+ *		  на большом сценарии
+ */
+class PatchXmlBenchmark : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сформировать сценарий и убедиться, что обе реализации дают одинаковый результат
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief Преобразование xml в плоский текст
+	 */
+	void xmlToPlain_data();
+	void xmlToPlain();
+
+	/**
+	 * @brief Преобразование плоского текста в xml
+	 */
+	void plainToXml_data();
+	void plainToXml();
+
+	/**
+	 * @brief Формирование патча по изменению в середине сценария
+	 */
+	void makePatchXml();
+
+private:
+	/**
+	 * @brief Добавить в таблицу данных обе реализации
+	 */
+	void addImplementations();
+
+private:
+	/**
+	 * @brief Сценарий для замеров
+	 */
+	QString m_xml;
+
+	/**
+	 * @brief Сценарий в плоском виде
+	 */
+	QString m_plain;
+};
+
+void PatchXmlBenchmark::initTestCase()
+{
+	m_xml = ::scenarioXml(SCENES_COUNT);
+	m_plain = DiffMatchPatchHelper::xmlToPlain(m_xml);
+	qDebug() << "scenario xml size:" << m_xml.size() << "chars";
+
+	QVERIFY(!::tagsChars().isEmpty());
+	QCOMPARE(m_plain, ::xmlToPlainByReplace(m_xml));
+	QCOMPARE(DiffMatchPatchHelper::plainToXml(m_plain), ::plainToXmlByReplace(m_plain));
+}
+
+void PatchXmlBenchmark::xmlToPlain_data()
+{
+	addImplementations();
+}
+
+void PatchXmlBenchmark::xmlToPlain()
+{
+	QFETCH(bool, isSinglePass);
+
+	QString plain;
+	QBENCHMARK {
+		plain = isSinglePass ? DiffMatchPatchHelper::xmlToPlain(m_xml) : ::xmlToPlainByReplace(m_xml);
+	}
+	QCOMPARE(plain.size(), m_plain.size());
+}
+
+void PatchXmlBenchmark::plainToXml_data()
+{
+	addImplementations();
+}
+
+void PatchXmlBenchmark::plainToXml()
+{
+	QFETCH(bool, isSinglePass);
+
+	QString xml;
+	QBENCHMARK {
+		xml = isSinglePass ? DiffMatchPatchHelper::plainToXml(m_plain) : ::plainToXmlByReplace(m_plain);
+	}
+	QVERIFY(!xml.isEmpty());
+}
+
+void PatchXmlBenchmark::makePatchXml()
+{
+	QString changedXml = m_xml;
+	changedXml.insert(m_xml.size() / 2, "<action>\n<v><![CDATA[New action in the middle]]></v>\n</action>\n");
+
+	QString patch;
+	QBENCHMARK {
+		patch = DiffMatchPatchHelper::makePatchXml(m_xml, changedXml);
+	}
+	QVERIFY(!patch.isEmpty());
+}
+
+void PatchXmlBenchmark::addImplementations()
+{
+	QTest::addColumn<bool>("isSinglePass");
+	QTest::newRow("replace per tag") << false;
+	QTest::newRow("single pass") << true;
+}
+
+QTEST_GUILESS_MAIN(PatchXmlBenchmark)
+
+#include "PatchXmlBenchmark.moc"
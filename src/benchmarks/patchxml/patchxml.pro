@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Замер преобразований xml сценария в плоский текст патчей и обратно
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+QT       -= widgets
+
+TARGET = patchxml-benchmark
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/benchmarks/patchxml
+} else {
+    DESTDIR = $$PWD/../../../build/Release/benchmarks/patchxml
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+INCLUDEPATH += $$PWD/../../bin/scenarist-core
+
+SOURCES += \
+    PatchXmlBenchmark.cpp \
+    ../../bin/scenarist-core/3rd_party/Helpers/DiffMatchPatch.cpp
@@ -1,15 +1,29 @@
 #include "BackupHelper.h"
 
+#include "DiffMatchPatchHelper.h"
+
 #include <DataLayer/DataStorageLayer/StorageFacade.h>
 #include <DataLayer/DataStorageLayer/ScenarioStorage.h>
 
 #include <Domain/Scenario.h>
 
-#include <QDateTime>
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
 #include <QFileInfo>
+#include <QMutexLocker>
+#include <QSaveFile>
 #include <QSqlDatabase>
 #include <QSqlQuery>
+#include <QVariant>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
 
 namespace {
 	/**
@@ -17,10 +31,161 @@ namespace {
 	 */
 	const QString BACKUP_VERSIONS_EXTENSION = "kitsrc";
 
+	/**
+	 * @brief Расширение файла с хэшами страниц полной резервной копии
+	 */
+	const QString BACKUP_PAGES_EXTENSION = "pages";
+
+	/**
+	 * @brief Расширение временного файла, в котором полная резервная копия создаётся с нуля
+	 */
+	const QString BACKUP_TEMP_EXTENSION = "tmp";
+
+	/**
+	 * @brief Расширение журнала отката, с прежним содержимым перезаписываемых страниц копии
+	 */
+	const QString BACKUP_JOURNAL_EXTENSION = "journal";
+
+	/**
+	 * @brief Метка конца журнала отката
+	 * @note Журнал без неё записан не полностью, а значит копию ещё не начинали менять
+	 */
+	const quint32 JOURNAL_END_MARKER = 0x4b49544a;
+
 	/**
 	 * @brief Название соединения для БД резервных копий версий сценария
 	 */
 	const QString BACKUPDB_CONNECTION_NAME = "backup_versions";
+
+	/**
+	 * @brief Размер страницы, с точностью до которой сравнивается файл и его копия
+	 * @note Совпадает с размером страницы базы данных, чтобы изменение одной записи
+	 *		 затрагивало как можно меньше страниц копии
+	 */
+	const int PAGE_SIZE = 4096;
+
+	/**
+	 * @brief Количество страниц, считываемых из файла за раз
+	 */
+	const int PAGES_PER_READ = 256;
+
+	/**
+	 * @brief Алгоритм хэширования страниц
+	 */
+	const QCryptographicHash::Algorithm PAGE_HASH_ALGORITHM = QCryptographicHash::Md5;
+
+	/**
+	 * @brief Количество хранимых версий текста сценария
+	 */
+	const int VERSIONS_COUNT = 100;
+
+	/**
+	 * @brief Записать данные файла на диск
+	 */
+	static bool syncToDisk(QFile& _file) {
+		if (!_file.flush()) {
+			return false;
+		}
+#ifdef Q_OS_WIN
+		return ::_commit(_file.handle()) == 0;
+#else
+		return ::fsync(_file.handle()) == 0;
+#endif
+	}
+
+	/**
+	 * @brief Участок копии, который будет перезаписан, с его прежним содержимым
+	 */
+	struct JournalEntry {
+		qint64 position;
+		QByteArray data;
+	};
+
+	/**
+	 * @brief Сохранить прежнее содержимое перезаписываемых участков копии в журнал отката
+	 * @return Объём записанных данных, или -1, если журнал записать не удалось
+	 */
+	static qint64 writeJournal(const QString& _journalFilePath, qint64 _backupSize,
+		const QByteArray& _backupPagesHashes, const QList<JournalEntry>& _entries) {
+		QFile journal(_journalFilePath);
+		if (!journal.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+			return -1;
+		}
+
+		QDataStream stream(&journal);
+		stream << _backupSize << _backupPagesHashes << (qint32)_entries.size();
+		foreach (const JournalEntry& entry, _entries) {
+			stream << entry.position << entry.data;
+		}
+		stream << JOURNAL_END_MARKER;
+		if (stream.status() != QDataStream::Ok
+			|| !::syncToDisk(journal)) {
+			journal.remove();
+			return -1;
+		}
+
+		return journal.size();
+	}
+
+	/**
+	 * @brief Вернуть копию и хэши её страниц к состоянию, сохранённому в журнале отката, и удалить журнал
+	 * @return Удалось ли вернуть копию, если нет, то журнал остаётся для следующей попытки
+	 */
+	static bool replayJournal(const QString& _journalFilePath, const QString& _backupFilePath,
+		const QString& _pagesFilePath) {
+		QFile journal(_journalFilePath);
+		if (!journal.exists()) {
+			return true;
+		}
+		if (!journal.open(QIODevice::ReadOnly)) {
+			return false;
+		}
+
+		qint64 backupSize = 0;
+		QByteArray backupPagesHashes;
+		qint32 entriesCount = 0;
+		QList<JournalEntry> entries;
+		QDataStream stream(&journal);
+		stream >> backupSize >> backupPagesHashes >> entriesCount;
+		for (int entryIndex = 0; entryIndex < entriesCount && stream.status() == QDataStream::Ok; ++entryIndex) {
+			JournalEntry entry;
+			stream >> entry.position >> entry.data;
+			entries.append(entry);
+		}
+		quint32 endMarker = 0;
+		stream >> endMarker;
+		journal.close();
+
+		//
+		// Недописанный журнал означает, что копию ещё не меняли, откатывать нечего
+		//
+		if (stream.status() == QDataStream::Ok
+			&& endMarker == JOURNAL_END_MARKER) {
+			QFile backupFile(_backupFilePath);
+			if (!backupFile.open(QIODevice::ReadWrite)) {
+				return false;
+			}
+			foreach (const JournalEntry& entry, entries) {
+				if (!backupFile.seek(entry.position)
+					|| backupFile.write(entry.data) != entry.data.size()) {
+					return false;
+				}
+			}
+			if (!backupFile.resize(backupSize)
+				|| !::syncToDisk(backupFile)) {
+				return false;
+			}
+			backupFile.close();
+
+			QSaveFile pagesFile(_pagesFilePath);
+			if (pagesFile.open(QIODevice::WriteOnly)) {
+				pagesFile.write(backupPagesHashes);
+				pagesFile.commit();
+			}
+		}
+
+		return QFile::remove(_journalFilePath);
+	}
 }
 
 
@@ -48,6 +213,9 @@ void BackupHelper::saveBackup(const QString& _filePath)
 		&& !m_isInProgress) {
 		m_isInProgress = true;
 
+		QElapsedTimer timer;
+		timer.start();
+
 		//
 		// Создаём папку для хранения резервных копий, если такой ещё нет
 		//
@@ -62,52 +230,339 @@ void BackupHelper::saveBackup(const QString& _filePath)
 		}
 
 		QFileInfo fileInfo(_filePath);
-		const QString tmpBackupFileName =
-				QString("%1%2.backup.tmp.%3").arg(backupPath, fileInfo.completeBaseName(), fileInfo.completeSuffix());
 		const QString backupFileName =
 				QString("%1%2.full.backup.%3").arg(backupPath, fileInfo.completeBaseName(), fileInfo.completeSuffix());
 		const QString backupVersionsFileName =
 				QString("%1%2.versions.backup.%3").arg(backupPath, fileInfo.completeBaseName(), BACKUP_VERSIONS_EXTENSION);
 
+		Statistics statistics;
+		statistics.datetime = QDateTime::currentDateTime();
+		statistics.fileSize = fileInfo.size();
+
 		//
-		// Копируем файл во временную резервную копию
+		// Обновляем полную копию файла
 		//
-		if (QFile::copy(_filePath, tmpBackupFileName)) {
-			//
-			// Если скопировать удалось, переименовываем временную копию
-			//
-			QFile::remove(backupFileName);
-			QFile::rename(tmpBackupFileName, backupFileName);
-		}
+		statistics.bytesWritten += updateFullBackup(_filePath, backupFileName);
 
 		//
 		// Добавляем версию сценария в файл с резервными копиями версий текста сценария
 		//
+		statistics.bytesWritten += saveScenarioVersion(backupVersionsFileName);
+
+		statistics.msecs = timer.elapsed();
 		{
-			//
-			// NOTE: Как быть с быстродействием?
-			//
-			{
-				QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", BACKUPDB_CONNECTION_NAME);
-				db.setDatabaseName(backupVersionsFileName);
-				db.open();
-				//
-				// Храним всего 100 копий, удаляя более старые
-				//
-				QSqlQuery backuper(db);
-				backuper.exec("CREATE TABLE IF NOT EXISTS versions (id INTEGER, version TEXT NOT NULL, datetime TEXT NOT NULL)");
-				backuper.exec("UPDATE versions SET id = (id + 1)");
-				backuper.exec("DELETE FROM versions WHERE id = 101");
-
-				backuper.prepare("INSERT INTO versions VALUES(1, ?, ?)");
-				backuper.addBindValue(DataStorageLayer::StorageFacade::scenarioStorage()->current()->text());
-				backuper.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+			QMutexLocker locker(&s_statisticsMutex);
+			s_lastStatistics = statistics;
+		}
+
+		m_isInProgress = false;
+	}
+}
+
+BackupHelper::Statistics BackupHelper::lastStatistics()
+{
+	QMutexLocker locker(&s_statisticsMutex);
+	return s_lastStatistics;
+}
+
+qint64 BackupHelper::backupsSize(const QString& _dir)
+{
+	qint64 size = 0;
+	foreach (const QFileInfo& fileInfo, QDir(_dir).entryInfoList(QDir::Files)) {
+		size += fileInfo.size();
+	}
+	return size;
+}
+
+
+//********
+// Скрытая часть
+
+
+BackupHelper::Statistics BackupHelper::s_lastStatistics;
+QMutex BackupHelper::s_statisticsMutex;
+
+qint64 BackupHelper::updateFullBackup(const QString& _filePath, const QString& _backupFilePath)
+{
+	QFile file(_filePath);
+	if (!file.open(QIODevice::ReadOnly)) {
+		return 0;
+	}
+
+	//
+	// Если прошлое обновление копии прервалось, возвращаем копию к состоянию до него
+	//
+	const QString pagesFilePath = _backupFilePath + "." + BACKUP_PAGES_EXTENSION;
+	const QString journalFilePath = _backupFilePath + "." + BACKUP_JOURNAL_EXTENSION;
+	if (!::replayJournal(journalFilePath, _backupFilePath, pagesFilePath)) {
+		return 0;
+	}
+
+	//
+	// Загружаем хэши страниц копии, сохранённые при её прошлом обновлении.
+	// Если их нет, или они не соответствуют копии, то копия будет записана полностью
+	//
+	const qint64 backupSize = QFileInfo(_backupFilePath).size();
+	const int hashSize = QCryptographicHash::hash(QByteArray(), PAGE_HASH_ALGORITHM).size();
+	QByteArray backupPagesHashes;
+	{
+		QFile pagesFile(pagesFilePath);
+		if (pagesFile.open(QIODevice::ReadOnly)) {
+			backupPagesHashes = pagesFile.readAll();
+			const qint64 backupPagesCount = (backupSize + PAGE_SIZE - 1) / PAGE_SIZE;
+			if (backupPagesHashes.isEmpty()
+				|| backupPagesHashes.size() != backupPagesCount * hashSize) {
+				backupPagesHashes.clear();
+			}
+		}
+	}
+
+	//
+	// Определяем, какие страницы изменились с прошлого обновления копии
+	//
+	QByteArray pagesHashes;
+	QList<int> changedPages;
+	qint64 fileSize = 0;
+	int pageIndex = 0;
+	while (!file.atEnd()) {
+		const QByteArray pages = file.read(PAGE_SIZE * PAGES_PER_READ);
+		if (pages.isEmpty()) {
+			break;
+		}
+		fileSize += pages.size();
+
+		for (int pageStart = 0; pageStart < pages.size(); pageStart += PAGE_SIZE, ++pageIndex) {
+			const QByteArray pageHash = QCryptographicHash::hash(pages.mid(pageStart, PAGE_SIZE), PAGE_HASH_ALGORITHM);
+			pagesHashes.append(pageHash);
+			if (backupPagesHashes.mid(pageIndex * hashSize, hashSize) != pageHash) {
+				changedPages.append(pageIndex);
+			}
+		}
+	}
+
+	//
+	// Если ничего не изменилось, то копия уже актуальна
+	//
+	if (!backupPagesHashes.isEmpty()
+		&& changedPages.isEmpty()
+		&& backupSize == fileSize) {
+		return 0;
+	}
+
+	//
+	// Если прежней копии нет, или её хэши не сохранились, то копия записывается с нуля
+	// во временный файл, который заменяет прежнюю копию только после записи на диск
+	//
+	if (backupPagesHashes.isEmpty()) {
+		const QString tempBackupFilePath = _backupFilePath + "." + BACKUP_TEMP_EXTENSION;
+		QFile::remove(tempBackupFilePath);
+		QFile backupFile(tempBackupFilePath);
+		if (!backupFile.open(QIODevice::WriteOnly)) {
+			return 0;
+		}
+
+		//
+		// Файл проекта мог измениться после подсчёта хэшей, поэтому считаем их заново по тому, что записано
+		//
+		qint64 bytesWritten = 0;
+		pagesHashes.clear();
+		file.seek(0);
+		while (!file.atEnd()) {
+			const QByteArray pages = file.read(PAGE_SIZE * PAGES_PER_READ);
+			if (pages.isEmpty()) {
+				break;
+			}
+			if (backupFile.write(pages) != pages.size()) {
+				backupFile.remove();
+				return 0;
+			}
+			bytesWritten += pages.size();
+
+			for (int pageStart = 0; pageStart < pages.size(); pageStart += PAGE_SIZE) {
+				pagesHashes.append(QCryptographicHash::hash(pages.mid(pageStart, PAGE_SIZE), PAGE_HASH_ALGORITHM));
+			}
+		}
+
+		if (!::syncToDisk(backupFile)) {
+			backupFile.remove();
+			return 0;
+		}
+		backupFile.close();
+
+		QFile::remove(pagesFilePath);
+		QFile::remove(_backupFilePath);
+		if (!QFile::rename(tempBackupFilePath, _backupFilePath)) {
+			return bytesWritten;
+		}
+
+		QSaveFile pagesFile(pagesFilePath);
+		if (pagesFile.open(QIODevice::WriteOnly)) {
+			pagesFile.write(pagesHashes);
+			pagesFile.commit();
+		}
+
+		return bytesWritten;
+	}
+
+	//
+	// Иначе страницы перезаписываются прямо в копии. Их прежнее содержимое, а также отрезаемый хвост
+	// копии, если файл уменьшился, сначала сохраняется в журнал отката. При сбое журнал возвращает
+	// копию к прежнему состоянию - сразу, или при следующем обновлении, если прервалось приложение
+	//
+	QFile backupFile(_backupFilePath);
+	if (!backupFile.open(QIODevice::ReadWrite)) {
+		return 0;
+	}
+
+	QList<JournalEntry> journalEntries;
+	foreach (int changedPage, changedPages) {
+		const qint64 pagePosition = (qint64)changedPage * PAGE_SIZE;
+		if (pagePosition >= backupSize) {
+			break;
+		}
+		backupFile.seek(pagePosition);
+		JournalEntry entry;
+		entry.position = pagePosition;
+		entry.data = backupFile.read(PAGE_SIZE);
+		journalEntries.append(entry);
+	}
+	if (fileSize < backupSize) {
+		backupFile.seek(fileSize);
+		JournalEntry entry;
+		entry.position = fileSize;
+		entry.data = backupFile.readAll();
+		journalEntries.append(entry);
+	}
+
+	const qint64 journalSize = ::writeJournal(journalFilePath, backupSize, backupPagesHashes, journalEntries);
+	if (journalSize < 0) {
+		return 0;
+	}
+	qint64 bytesWritten = journalSize;
+
+	//
+	// Хэши прежней копии больше ей не соответствуют, пока изменения не записаны полностью.
+	// При откате они восстанавливаются из журнала
+	//
+	QFile::remove(pagesFilePath);
+
+	bool isWritten = true;
+	foreach (int changedPage, changedPages) {
+		const qint64 pagePosition = (qint64)changedPage * PAGE_SIZE;
+		file.seek(pagePosition);
+		const QByteArray page = file.read(PAGE_SIZE);
+		if (!backupFile.seek(pagePosition)
+			|| backupFile.write(page) != page.size()) {
+			isWritten = false;
+			break;
+		}
+		bytesWritten += page.size();
+
+		//
+		// Файл проекта мог измениться после подсчёта хэшей, сохраняем хэш того, что записано
+		//
+		pagesHashes.replace(changedPage * hashSize, hashSize, QCryptographicHash::hash(page, PAGE_HASH_ALGORITHM));
+	}
+
+	//
+	// Если файл уменьшился, отрезаем лишнее
+	//
+	isWritten = isWritten
+				&& backupFile.resize(fileSize)
+				&& ::syncToDisk(backupFile);
+	backupFile.close();
+
+	if (!isWritten) {
+		::replayJournal(journalFilePath, _backupFilePath, pagesFilePath);
+		return bytesWritten;
+	}
+
+	//
+	// Копия обновлена, журнал больше не нужен. Хэши новой копии сохраняются только после его удаления,
+	// чтобы откат по журналу никогда не оставил их рядом с прежней копией
+	//
+	if (!QFile::remove(journalFilePath)) {
+		return bytesWritten;
+	}
+
+	QSaveFile pagesFile(pagesFilePath);
+	if (pagesFile.open(QIODevice::WriteOnly)) {
+		pagesFile.write(pagesHashes);
+		pagesFile.commit();
+	}
+
+	return bytesWritten;
+}
+
+qint64 BackupHelper::saveScenarioVersion(const QString& _versionsFilePath)
+{
+	qint64 bytesWritten = 0;
+
+	{
+		QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", BACKUPDB_CONNECTION_NAME);
+		db.setDatabaseName(_versionsFilePath);
+		db.open();
+
+		//
+		// Целиком храним только последнюю версию, а каждая предыдущая хранится как патч,
+		// восстанавливающий её из следующей за ней. Чем больше идентификатор, тем новее версия
+		//
+		QSqlQuery backuper(db);
+		backuper.exec("CREATE TABLE IF NOT EXISTS versions (id INTEGER, version TEXT NOT NULL, datetime TEXT NOT NULL, "
+					  "is_patch INTEGER NOT NULL DEFAULT(0))");
+
+		//
+		// В файлах прошлых версий все версии хранились целиком, а более новые имели меньшие идентификаторы
+		//
+		if (backuper.exec("ALTER TABLE versions ADD COLUMN is_patch INTEGER NOT NULL DEFAULT(0)")) {
+			backuper.exec("UPDATE versions SET id = (SELECT MAX(id) FROM versions) + 1 - id");
+		}
+
+		const QString scenarioText = DataStorageLayer::StorageFacade::scenarioStorage()->current()->text();
+
+		db.transaction();
+
+		//
+		// Последнюю сохранённую версию заменяем патчем от новой версии
+		//
+		int lastVersionId = 0;
+		bool needSaveVersion = true;
+		backuper.exec("SELECT id, version FROM versions WHERE id = (SELECT MAX(id) FROM versions)");
+		if (backuper.next()) {
+			lastVersionId = backuper.value("id").toInt();
+			const QString lastVersionText = backuper.value("version").toString();
+			if (lastVersionText == scenarioText) {
+				needSaveVersion = false;
+			} else {
+				const QString patch = DiffMatchPatchHelper::makePatch(scenarioText, lastVersionText);
+				backuper.prepare("UPDATE versions SET version = ?, is_patch = 1 WHERE id = ?");
+				backuper.addBindValue(patch);
+				backuper.addBindValue(lastVersionId);
 				backuper.exec();
+				bytesWritten += patch.toUtf8().size();
 			}
+		}
+
+		if (needSaveVersion) {
+			backuper.prepare("INSERT INTO versions (id, version, datetime, is_patch) VALUES(?, ?, ?, 0)");
+			backuper.addBindValue(lastVersionId + 1);
+			backuper.addBindValue(scenarioText);
+			backuper.addBindValue(QDateTime::currentDateTime().toString(Qt::ISODate));
+			backuper.exec();
+			bytesWritten += scenarioText.toUtf8().size();
 
-			QSqlDatabase::removeDatabase(BACKUPDB_CONNECTION_NAME);
+			//
+			// Храним всего VERSIONS_COUNT копий, удаляя более старые
+			//
+			backuper.prepare("DELETE FROM versions WHERE id <= ?");
+			backuper.addBindValue(lastVersionId + 1 - VERSIONS_COUNT);
+			backuper.exec();
 		}
 
-		m_isInProgress = false;
+		db.commit();
 	}
+
+	QSqlDatabase::removeDatabase(BACKUPDB_CONNECTION_NAME);
+
+	return bytesWritten;
 }
@@ -1,6 +1,8 @@
 #ifndef BACKUPHELPER_H
 #define BACKUPHELPER_H
 
+#include <QDateTime>
+#include <QMutex>
 #include <QString>
 
 
@@ -27,6 +29,56 @@ public:
 	 */
 	void saveBackup(const QString& _filePath);
 
+	/**
+	 * @brief Статистика создания резервной копии
+	 */
+	struct Statistics {
+		/**
+		 * @brief Время создания
+		 */
+		QDateTime datetime;
+
+		/**
+		 * @brief Размер файла проекта
+		 */
+		qint64 fileSize = 0;
+
+		/**
+		 * @brief Объём записанных в резервную копию данных
+		 */
+		qint64 bytesWritten = 0;
+
+		/**
+		 * @brief Длительность создания копии (мс)
+		 */
+		qint64 msecs = 0;
+	};
+
+	/**
+	 * @brief Статистика последнего создания резервной копии
+	 */
+	static Statistics lastStatistics();
+
+	/**
+	 * @brief Объём, занимаемый резервными копиями в заданной папке
+	 */
+	static qint64 backupsSize(const QString& _dir);
+
+private:
+	/**
+	 * @brief Обновить полную копию файла, перезаписав в ней только изменившиеся страницы
+	 * @note Страницы перезаписываются прямо в копии, а их прежнее содержимое сохраняется в журнал отката,
+	 *		 по которому копия восстанавливается, если обновление не удалось или прервалось
+	 * @return Объём записанных данных, включая журнал отката
+	 */
+	static qint64 updateFullBackup(const QString& _filePath, const QString& _backupFilePath);
+
+	/**
+	 * @brief Добавить текущую версию текста сценария в файл версий
+	 * @return Объём записанных данных
+	 */
+	static qint64 saveScenarioVersion(const QString& _versionsFilePath);
+
 private:
 	/**
 	 * @brief Включён/выключен
@@ -42,6 +94,16 @@ private:
 	 * @brief Папка, в которую сохранять резервные копии
 	 */
 	QString m_backupDir;
+
+	/**
+	 * @brief Статистика последнего создания резервной копии
+	 */
+	static Statistics s_lastStatistics;
+
+	/**
+	 * @brief Мьютекс для доступа к статистике
+	 */
+	static QMutex s_statisticsMutex;
 };
 
 #endif // BACKUPHELPER_H
@@ -9,6 +9,7 @@
 #include <QSet>
 #include <QString>
 #include <QRegularExpression>
+#include <QVector>
 
 namespace {
 	/**
@@ -113,6 +114,110 @@ public:
 					);
 	}
 
+	/**
+	 * @brief Сформировать патч между двумя фрагментами xml-текстов
+	 * @param _plainOffset Позиция начала фрагментов в плоском тексте документа
+	 * @note Фрагменты должны отличаться только той частью документа, которая была изменена,
+	 *		 тогда полученный патч применим ко всему документу
+	 */
+	static QString makePatchXml(const QString& _xml1, const QString& _xml2, int _plainOffset) {
+		diff_match_patch dmp;
+		QList<Patch> patches = dmp.patch_make(xmlToPlain(_xml1), xmlToPlain(_xml2));
+		for (int index = 0; index < patches.size(); ++index) {
+			patches[index].start1 += _plainOffset;
+			patches[index].start2 += _plainOffset;
+		}
+		return plainToXml(dmp.patch_toText(patches));
+	}
+
+	/**
+	 * @brief Длина xml-текста в плоском представлении
+	 */
+	static int plainLength(const QString& _xml) {
+		return xmlToPlain(_xml).length();
+	}
+
+	/**
+	 * @brief Преобразовать xml в плоский текст, заменяя тэги спецсимволами
+	 * @note Текст обрабатывается за один проход, тэги ищутся в карте целиком
+	 */
+	static QString xmlToPlain(const QString& _xml) {
+		//
+		// TODO: искать тэги и добавлять их в карту, чтобы ещё более корректной была замена
+		//		 Может быть не самой лучшей идеей, если работают одновременно несколько авторов их
+		//		 карты замен будут разными и тогда сценарии не сойдутся
+		//
+		const QString CDATA_START = "<v><![CDATA[";
+		const QString CDATA_END = "]]></v>";
+		const QHash<QString,QString>& tags = tagsMap();
+
+		QString plain;
+		plain.reserve(_xml.length());
+		const int xmlLength = _xml.length();
+		int position = 0;
+		while (position < xmlLength) {
+			const QChar currentChar = _xml.at(position);
+			if (currentChar == '<') {
+				//
+				// Значения блоков
+				//
+				if (_xml.midRef(position, CDATA_START.length()) == CDATA_START) {
+					plain.append(tags.value(CDATA_START));
+					position += CDATA_START.length();
+					continue;
+				}
+
+				const int tagEnd = _xml.indexOf('>', position);
+				if (tagEnd != -1) {
+					const QString tag = _xml.mid(position, tagEnd - position + 1);
+					//
+					// Тэги из карты заменяем спецсимволами
+					//
+					if (tags.contains(tag)) {
+						plain.append(tags.value(tag));
+						position = tagEnd + 1;
+						continue;
+					}
+					//
+					// Общие тэги сценария удаляем вместе с переносом строки
+					//
+					if (tagEnd + 1 < xmlLength
+						&& _xml.at(tagEnd + 1) == '\n'
+						&& isCommonScenarioTag(tag)) {
+						position = tagEnd + 2;
+						continue;
+					}
+				}
+			} else if (currentChar == ']'
+					   && _xml.midRef(position, CDATA_END.length()) == CDATA_END) {
+				plain.append(tags.value(CDATA_END));
+				position += CDATA_END.length();
+				continue;
+			}
+
+			plain.append(currentChar);
+			++position;
+		}
+		return plain;
+	}
+
+	/**
+	 * @brief Преобразовать плоский текст в xml, заменяя спецсимволы на тэги
+	 */
+	static QString plainToXml(const QString& _plain) {
+		QString xml;
+		xml.reserve(_plain.length() * 2);
+		foreach (const QChar& plainChar, _plain) {
+			const QString tag = tagForChar(plainChar);
+			if (tag.isEmpty()) {
+				xml.append(plainChar);
+			} else {
+				xml.append(tag);
+			}
+		}
+		return xml;
+	}
+
 	/**
 	 * @brief Применить патч для простого текста
 	 */
@@ -259,7 +364,7 @@ public:
 				//
 				// Идём до открывающего тега
 				//
-				if (isOpenTag(tagsMap().key(oldXml.at(oldStartPosForXml)))) {
+				if (isOpenTag(tagForChar(oldXml.at(oldStartPosForXml)))) {
 					break;
 				}
 			}
@@ -268,7 +373,7 @@ public:
 				//
 				// Идём до закрывающего тэга, он находится в конце строки
 				//
-				if (isCloseTag(tagsMap().key(oldXml.at(oldEndPosForXml)))) {
+				if (isCloseTag(tagForChar(oldXml.at(oldEndPosForXml)))) {
 					++oldEndPosForXml;
 					break;
 				}
@@ -284,7 +389,7 @@ public:
 				//
 				// Идём до открывающего тега
 				//
-				if (isOpenTag(tagsMap().key(newXml.at(newStartPosForXml)))) {
+				if (isOpenTag(tagForChar(newXml.at(newStartPosForXml)))) {
 					break;
 				}
 			}
@@ -293,7 +398,7 @@ public:
 				//
 				// Идём до закрывающего тэга, он находится в конце строки
 				//
-				if (isCloseTag(tagsMap().key(newXml.at(newEndPosForXml)))) {
+				if (isCloseTag(tagForChar(newXml.at(newEndPosForXml)))) {
 					++newEndPosForXml;
 					break;
 				}
@@ -331,30 +436,42 @@ public:
 
 private:
 	/**
-	 * @brief Преобразовать xml в плоский текст, заменяя тэги спецсимволами
+	 * @brief Код первого спецсимвола, используемого для замены тэгов
 	 */
-	static QString xmlToPlain(const QString& _xml) {
-		//
-		// TODO: искать тэги и добавлять их в карту, чтобы ещё более корректной была замена
-		//		 Может быть не самой лучшей идеей, если работают одновременно несколько авторов их
-		//		 карты замен будут разными и тогда сценарии не сойдутся
-		//
-		QString plain = _xml;
-		foreach (const QString& key, tagsMap().keys()) {
-			plain.replace(key, tagsMap().value(key));
-		}
-		return ::removeCommonXmlTagsForScenario(plain);
+	static const int FIRST_TAG_CHAR = 44032;
+
+	/**
+	 * @brief Является ли тэг общим тэгом сценария, не попадающим в плоский текст
+	 */
+	static bool isCommonScenarioTag(const QString& _tag) {
+		return _tag == "<?xml version=\"1.0\"?>"
+				|| _tag == "<scenario version=\"1.0\">"
+				|| _tag == "</scenario>";
 	}
 
 	/**
-	 * @brief Преобразовать плоский текст в xml, заменяя спецсимволы на тэги
+	 * @brief Получить тэг, которому соответствует спецсимвол
+	 * @return Пустую строку, если символ не является заменой тэга
 	 */
-	static QString plainToXml(const QString& _plain) {
-		QString xml = _plain;
-		foreach (const QString& value, tagsMap().values()) {
-			xml.replace(value, tagsMap().key(value));
+	static QString tagForChar(const QChar& _char) {
+		const QVector<QString>& tags = charsTags();
+		const int index = _char.unicode() - FIRST_TAG_CHAR;
+		return (index >= 0 && index < tags.size()) ? tags.at(index) : QString();
+	}
+
+	/**
+	 * @brief Тэги, индексированные по спецсимволам, которыми они заменяются
+	 */
+	static const QVector<QString>& charsTags() {
+		static QVector<QString> s_charsTags;
+		if (s_charsTags.isEmpty()) {
+			const QHash<QString,QString>& tags = tagsMap();
+			s_charsTags.resize(tags.size());
+			foreach (const QString& tag, tags.keys()) {
+				s_charsTags[tags.value(tag).at(0).unicode() - FIRST_TAG_CHAR] = tag;
+			}
 		}
-		return xml;
+		return s_charsTags;
 	}
 
 	/**
@@ -373,7 +490,7 @@ private:
 	 */
 	static const QHash<QString,QString>& tagsMap() {
 		static QHash<QString,QString> s_tagsMap;
-		static int s_charIndex = 44032;
+		static int s_charIndex = FIRST_TAG_CHAR;
 		if (s_tagsMap.isEmpty()) {
 			//
 			// WARNING: Добавлять новые теги, только в конец карты, ни в коем случае не в начало,
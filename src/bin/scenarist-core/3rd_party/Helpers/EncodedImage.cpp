@@ -0,0 +1,193 @@
+#include "EncodedImage.h"
+
+#include "ImageHelper.h"
+
+#include <QCache>
+#include <QCryptographicHash>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QPair>
+
+#include <QtConcurrentMap>
+
+namespace {
+	/**
+	 * @brief Максимальный объём кэша распакованных изображений (КиБ)
+	 */
+	const int IMAGES_CACHE_SIZE = 64 * 1024;
+
+	/**
+	 * @brief Кэш распакованных изображений по хэшу сжатых данных
+	 */
+	static QCache<QByteArray, QPixmap>& imagesCache() {
+		static QCache<QByteArray, QPixmap> s_imagesCache(IMAGES_CACHE_SIZE);
+		return s_imagesCache;
+	}
+
+	/**
+	 * @brief Изображения, распаковываемые в фоне, по хэшу сжатых данных
+	 * @note Для каждого хранится распаковка и индекс изображения в ней
+	 */
+	static QHash<QByteArray, QPair<QFuture<QImage>, int> >& pendingImages() {
+		static QHash<QByteArray, QPair<QFuture<QImage>, int> > s_pendingImages;
+		return s_pendingImages;
+	}
+
+	/**
+	 * @brief Поместить изображение в кэш
+	 */
+	static void cacheImage(const QByteArray& _hash, const QPixmap& _image) {
+		const int cost = qMax(1, _image.width() * _image.height() * _image.depth() / 8 / 1024);
+		imagesCache().insert(_hash, new QPixmap(_image), cost);
+	}
+
+	/**
+	 * @brief Получить хэш данных
+	 */
+	static QByteArray hashForBytes(const QByteArray& _bytes) {
+		return QCryptographicHash::hash(_bytes, QCryptographicHash::Md5);
+	}
+
+	/**
+	 * @brief Распаковать изображение, может выполняться в любом потоке
+	 */
+	static QImage decodeImage(const QByteArray& _bytes) {
+		return QImage::fromData(_bytes);
+	}
+}
+
+
+EncodedImage::EncodedImage()
+{
+}
+
+EncodedImage::EncodedImage(const QByteArray& _bytes) :
+	m_bytes(_bytes),
+	m_hash(::hashForBytes(_bytes))
+{
+}
+
+EncodedImage::EncodedImage(const QPixmap& _image) :
+	m_bytes(ImageHelper::bytesFromImage(_image)),
+	m_hash(::hashForBytes(m_bytes))
+{
+	//
+	// Запоминаем исходное изображение, чтобы не распаковывать его из сжатых данных
+	//
+	if (!m_bytes.isEmpty()) {
+		::cacheImage(m_hash, _image);
+	}
+}
+
+bool EncodedImage::isNull() const
+{
+	return m_bytes.isEmpty();
+}
+
+QByteArray EncodedImage::bytes() const
+{
+	return m_bytes;
+}
+
+QByteArray EncodedImage::hash() const
+{
+	return m_hash;
+}
+
+QPixmap EncodedImage::image() const
+{
+	if (isNull()) {
+		return QPixmap();
+	}
+
+	if (QPixmap* cachedImage = imagesCache().object(m_hash)) {
+		return *cachedImage;
+	}
+
+	//
+	// Если изображение распаковывается в фоне, то ждём только его, а не всю пачку
+	//
+	QPixmap image;
+	if (pendingImages().contains(m_hash)) {
+		const QPair<QFuture<QImage>, int> pendingImage = pendingImages().take(m_hash);
+		image = QPixmap::fromImage(pendingImage.first.resultAt(pendingImage.second));
+	} else {
+		image = ImageHelper::imageFromBytes(m_bytes);
+	}
+	::cacheImage(m_hash, image);
+	return image;
+}
+
+bool EncodedImage::isSourceOf(const QPixmap& _image) const
+{
+	if (isNull()) {
+		return _image.isNull();
+	}
+
+	QPixmap* cachedImage = imagesCache().object(m_hash);
+	return cachedImage != 0 && cachedImage->cacheKey() == _image.cacheKey();
+}
+
+bool EncodedImage::operator==(const EncodedImage& _other) const
+{
+	return m_hash == _other.m_hash;
+}
+
+bool EncodedImage::operator!=(const EncodedImage& _other) const
+{
+	return !(*this == _other);
+}
+
+void EncodedImage::prepare(const QList<EncodedImage>& _images)
+{
+	//
+	// Отбираем изображения, которых нет в кэше и которые ещё не распаковываются
+	//
+	QList<QByteArray> hashes;
+	QList<QByteArray> bytes;
+	foreach (const EncodedImage& image, _images) {
+		if (!image.isNull()
+			&& !hashes.contains(image.m_hash)
+			&& !imagesCache().contains(image.m_hash)
+			&& !pendingImages().contains(image.m_hash)) {
+			hashes.append(image.m_hash);
+			bytes.append(image.m_bytes);
+		}
+	}
+	if (bytes.isEmpty()) {
+		return;
+	}
+
+	//
+	// Распаковываем их параллельно, не блокируя интерфейс, а в QPixmap преобразуем и кладём в кэш
+	// уже в потоке интерфейса, по мере готовности каждого изображения
+	//
+	const QFuture<QImage> decoding = QtConcurrent::mapped(bytes, &::decodeImage);
+	for (int index = 0; index < hashes.size(); ++index) {
+		pendingImages().insert(hashes.at(index), qMakePair(decoding, index));
+	}
+
+	QFutureWatcher<QImage>* decodingWatcher = new QFutureWatcher<QImage>;
+	QObject::connect(decodingWatcher, &QFutureWatcher<QImage>::resultReadyAt, [decodingWatcher, hashes] (int _index) {
+		//
+		// Изображение могли уже забрать, обратившись к нему раньше
+		//
+		const QByteArray& hash = hashes.at(_index);
+		if (pendingImages().contains(hash)
+			&& pendingImages().value(hash) == qMakePair(decodingWatcher->future(), _index)) {
+			pendingImages().remove(hash);
+			::cacheImage(hash, QPixmap::fromImage(decodingWatcher->resultAt(_index)));
+		}
+	});
+	QObject::connect(decodingWatcher, &QFutureWatcher<QImage>::finished, [decodingWatcher, hashes] {
+		foreach (const QByteArray& hash, hashes) {
+			if (pendingImages().contains(hash)
+				&& pendingImages().value(hash).first == decodingWatcher->future()) {
+				pendingImages().remove(hash);
+			}
+		}
+		decodingWatcher->deleteLater();
+	});
+	decodingWatcher->setFuture(decoding);
+}
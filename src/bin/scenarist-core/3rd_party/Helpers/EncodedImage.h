@@ -0,0 +1,83 @@
+#ifndef ENCODEDIMAGE_H
+#define ENCODEDIMAGE_H
+
+#include <QByteArray>
+#include <QList>
+#include <QPixmap>
+
+
+/**
+ * @brief Изображение, хранящееся в сжатом виде
+ *
+ * Изображение хранится так, как оно сохраняется в базе данных, и распаковывается только при
+ * обращении к нему. Распакованные изображения хранятся в общем кэше, вытесняющем давно
+ * неиспользовавшиеся. Изображения сравниваются по хэшу сжатых данных
+ */
+class EncodedImage
+{
+public:
+	EncodedImage();
+
+	/**
+	 * @brief Изображение из сжатых данных
+	 */
+	explicit EncodedImage(const QByteArray& _bytes);
+
+	/**
+	 * @brief Изображение из распакованного, сжимается сразу
+	 */
+	explicit EncodedImage(const QPixmap& _image);
+
+	/**
+	 * @brief Пустое ли изображение
+	 */
+	bool isNull() const;
+
+	/**
+	 * @brief Сжатые данные
+	 */
+	QByteArray bytes() const;
+
+	/**
+	 * @brief Хэш сжатых данных
+	 */
+	QByteArray hash() const;
+
+	/**
+	 * @brief Распакованное изображение
+	 * @note Должно вызываться в потоке интерфейса
+	 */
+	QPixmap image() const;
+
+	/**
+	 * @brief Является ли заданное изображение распакованным из данного
+	 * @note Позволяет проверить изображение на изменение без повторного сжатия
+	 */
+	bool isSourceOf(const QPixmap& _image) const;
+
+	bool operator==(const EncodedImage& _other) const;
+	bool operator!=(const EncodedImage& _other) const;
+
+	/**
+	 * @brief Начать распаковку ещё не распакованных изображений параллельно в фоновых потоках
+	 *
+	 * Не дожидается распаковки: готовые изображения попадают в кэш по мере готовности, а обращение
+	 * к ещё не готовому изображению ждёт только его
+	 *
+	 * @note Должно вызываться в потоке интерфейса перед последовательным обращением к изображениям
+	 */
+	static void prepare(const QList<EncodedImage>& _images);
+
+private:
+	/**
+	 * @brief Сжатые данные
+	 */
+	QByteArray m_bytes;
+
+	/**
+	 * @brief Хэш сжатых данных
+	 */
+	QByteArray m_hash;
+};
+
+#endif // ENCODEDIMAGE_H
@@ -3,6 +3,7 @@
 
 #include <QByteArray>
 #include <QBuffer>
+#include <QCache>
 #include <QIcon>
 #include <QPainter>
 #include <QPixmap>
@@ -25,6 +26,16 @@ namespace {
 	 * @brief Используем низкое качество изображения (всё-таки у нас приложение не для фотографов)
 	 */
 	const int IMAGE_FILE_QUALITY = 30;
+
+	/**
+	 * @brief Шаг, с которым округляются размеры миниатюр
+	 */
+	const int THUMBNAIL_SIZE_STEP = 64;
+
+	/**
+	 * @brief Максимальный объём кэша миниатюр (КиБ)
+	 */
+	const int THUMBNAILS_CACHE_SIZE = 16 * 1024;
 }
 
 
@@ -66,6 +77,53 @@ public:
 		return image;
 	}
 
+	/**
+	 * @brief Получить миниатюру изображения, вписанную в заданный размер
+	 *
+	 * Готовые миниатюры кэшируются, поэтому повторный показ того же изображения в том же размере
+	 * не требует масштабирования. Новый размер строится из промежуточной миниатюры, округлённой вверх
+	 * до THUMBNAIL_SIZE_STEP, чтобы при изменении размера не масштабировать каждый раз исходник
+	 * @note Должно вызываться в потоке интерфейса
+	 */
+	static QPixmap thumbnail(const QPixmap& _image, const QSize& _size) {
+		if (_image.isNull() || _size.isEmpty()) {
+			return QPixmap();
+		}
+
+		static QCache<QString, QPixmap> s_thumbnails(THUMBNAILS_CACHE_SIZE);
+		const QString key = QString("%1:%2x%3").arg(_image.cacheKey()).arg(_size.width()).arg(_size.height());
+		if (QPixmap* thumbnail = s_thumbnails.object(key)) {
+			return *thumbnail;
+		}
+
+		const QSize bucketSize(
+			(_size.width() + THUMBNAIL_SIZE_STEP - 1) / THUMBNAIL_SIZE_STEP * THUMBNAIL_SIZE_STEP,
+			(_size.height() + THUMBNAIL_SIZE_STEP - 1) / THUMBNAIL_SIZE_STEP * THUMBNAIL_SIZE_STEP);
+		const QString bucketKey =
+				QString("%1:%2x%3:bucket").arg(_image.cacheKey()).arg(bucketSize.width()).arg(bucketSize.height());
+		QPixmap bucketThumbnail;
+		if (QPixmap* cachedBucketThumbnail = s_thumbnails.object(bucketKey)) {
+			bucketThumbnail = *cachedBucketThumbnail;
+		} else {
+			bucketThumbnail =
+				_image.width() > bucketSize.width() || _image.height() > bucketSize.height()
+				? _image.scaled(bucketSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)
+				: _image;
+			s_thumbnails.insert(bucketKey, new QPixmap(bucketThumbnail), thumbnailCost(bucketThumbnail));
+		}
+
+		const QPixmap thumbnail = bucketThumbnail.scaled(_size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		s_thumbnails.insert(key, new QPixmap(thumbnail), thumbnailCost(thumbnail));
+		return thumbnail;
+	}
+
+	/**
+	 * @brief Объём, занимаемый миниатюрой в кэше (КиБ)
+	 */
+	static int thumbnailCost(const QPixmap& _thumbnail) {
+		return qMax(1, _thumbnail.width() * _thumbnail.height() * _thumbnail.depth() / 8 / 1024);
+	}
+
 	/**
 	 * @brief Установить цвет иконки
 	 */
@@ -85,23 +143,26 @@ public:
 
 	/**
 	 * @brief Сравнить два изображения
+	 * @note Одно и то же изображение сравнивается без сжатия
 	 */
 	static bool isImagesEqual(const QPixmap& _lhs, const QPixmap& _rhs) {
-		return bytesFromImage(_lhs) == bytesFromImage(_rhs);
+		return _lhs.cacheKey() == _rhs.cacheKey()
+				|| bytesFromImage(_lhs) == bytesFromImage(_rhs);
 	}
 
 	/**
 	 * @brief Сравнить два списка изображений
 	 */
 	static bool isImageListsEqual(const QList<QPixmap>& _lhs, const QList<QPixmap>& _rhs) {
-		QList<QByteArray> lhs, rhs;
-		foreach (const QPixmap& pixmap, _lhs) {
-			lhs.append(bytesFromImage(pixmap));
+		if (_lhs.size() != _rhs.size()) {
+			return false;
 		}
-		foreach (const QPixmap& pixmap, _rhs) {
-			rhs.append(bytesFromImage(pixmap));
+		for (int index = 0; index < _lhs.size(); ++index) {
+			if (!isImagesEqual(_lhs.at(index), _rhs.at(index))) {
+				return false;
+			}
 		}
-		return lhs == rhs;
+		return true;
 	}
 };
 
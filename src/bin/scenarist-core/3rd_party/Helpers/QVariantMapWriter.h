@@ -12,26 +12,39 @@ class QVariantMapWriter
 {
 public:
 	/**
-	 * @brief Преобразовать карту в строку с данными
+	 * @brief Преобразовать карту в массив байт
 	 */
-	static QString mapToDataString(const QVariantMap& _map) {
+	static QByteArray mapToData(const QVariantMap& _map) {
 		const QVariant mapValue = _map;
 		QByteArray bytes;
 		QDataStream bytesWriter(&bytes, QIODevice::WriteOnly);
 		bytesWriter << mapValue;
-		return QString(bytes.toBase64());
+		return bytes;
 	}
 
 	/**
-	 * @brief Преобразовать строку с данными в карту
+	 * @brief Преобразовать массив байт в карту
 	 */
-	static QVariantMap dataStringToMap(const QString& _dataString) {
-		QByteArray bytes = QByteArray::fromBase64(_dataString.toLatin1());
-		QDataStream bytesReader(&bytes, QIODevice::ReadOnly);
+	static QVariantMap dataToMap(const QByteArray& _data) {
+		QDataStream bytesReader(_data);
 		QVariant mapValue;
 		bytesReader >> mapValue;
 		return mapValue.toMap();
 	}
+
+	/**
+	 * @brief Преобразовать карту в строку с данными
+	 */
+	static QString mapToDataString(const QVariantMap& _map) {
+		return QString(mapToData(_map).toBase64());
+	}
+
+	/**
+	 * @brief Преобразовать строку с данными в карту
+	 */
+	static QVariantMap dataStringToMap(const QString& _dataString) {
+		return dataToMap(QByteArray::fromBase64(_dataString.toLatin1()));
+	}
 };
 
 #endif // QVARIANTMAPWRITER
@@ -187,17 +187,12 @@ void ActivityEdit::updateCard(const QString& _uuid, int _type, const QString& _t
 	const QString& _description, const QString& _colors)
 {
 	if (CustomGraphicsScene* scene = dynamic_cast<CustomGraphicsScene*>(m_view->scene())) {
-		for (auto shape : scene->shapes()) {
-			if (CardShape* currentCard = dynamic_cast<CardShape*>(shape)) {
-				if (currentCard->uuid() == _uuid) {
-					currentCard->setCardType((CardShape::CardType)_type);
-					currentCard->setTitle(_title);
-					currentCard->setDescription(_description);
-					currentCard->setColors(_colors);
-					scene->notifyStateChangeByUser();
-					break;
-				}
-			}
+		if (CardShape* currentCard = scene->card(_uuid)) {
+			currentCard->setCardType((CardShape::CardType)_type);
+			currentCard->setTitle(_title);
+			currentCard->setDescription(_description);
+			currentCard->setColors(_colors);
+			scene->notifyStateChangeByUser();
 		}
 	}
 }
@@ -270,13 +265,8 @@ void ActivityEdit::selectCard(const QString& _uuid)
 	if (CustomGraphicsScene* scene = dynamic_cast<CustomGraphicsScene*>(m_view->scene())) {
 		scene->clearSelection();
 
-		for (auto shape : scene->shapes()) {
-			if (CardShape* currentCard = dynamic_cast<CardShape*>(shape)) {
-				if (currentCard->uuid() == _uuid) {
-					currentCard->setSelected(true);
-					break;
-				}
-			}
+		if (CardShape* currentCard = scene->card(_uuid)) {
+			currentCard->setSelected(true);
 		}
 	}
 }
@@ -349,6 +349,11 @@ QList<Shape*> CustomGraphicsScene::shapes() const
 	return m_shapes;
 }
 
+CardShape* CustomGraphicsScene::card(const QString& _uuid) const
+{
+	return m_cards.value(_uuid, nullptr);
+}
+
 void CustomGraphicsScene::focusShape(Shape* _shape)
 {
 	clearSelection();
@@ -371,7 +376,8 @@ void CustomGraphicsScene::appendShape(Shape* _shape)
 	//
 	connect(_shape, SIGNAL(stateIsAboutToBeChangedByUser()), this, SIGNAL(stateChangedByUser()));
 	m_shapes.append(_shape);
-	if (!items().contains(_shape)) {
+	registerShape(_shape);
+	if (_shape->scene() != this) {
 		addItem(_shape);
 	}
 
@@ -390,7 +396,8 @@ void CustomGraphicsScene::insertShape(Shape* _shape, Shape* _after)
 	//
 	connect(_shape, SIGNAL(stateIsAboutToBeChangedByUser()), this, SIGNAL(stateChangedByUser()));
 	m_shapes.insert(m_shapes.indexOf(_after) + 1, _shape);
-	if (!items().contains(_shape)) {
+	registerShape(_shape);
+	if (_shape->scene() != this) {
 		addItem(_shape);
 	}
 
@@ -409,7 +416,7 @@ void CustomGraphicsScene::insertShape(Shape* _shape, Shape* _after)
 
 Shape* CustomGraphicsScene::takeShape(Shape* _shape)
 {
-	if (m_shapes.contains(_shape)) {
+	if (m_shapesIndex.contains(_shape)) {
 		//
 		// При необходимости соединяем между собой окружающие карточку элементы
 		// если это карточка, конечно
@@ -451,6 +458,7 @@ Shape* CustomGraphicsScene::takeShape(Shape* _shape)
 		//
 		disconnect(_shape, SIGNAL(stateIsAboutToBeChangedByUser()), this, SIGNAL(stateChangedByUser()));
 		m_shapes.removeAll(_shape);
+		unregisterShape(_shape);
 
 		//
 		// Скрываем фигуру
@@ -465,7 +473,7 @@ Shape* CustomGraphicsScene::takeShape(Shape* _shape)
 
 void CustomGraphicsScene::removeShape(Shape* _shape)
 {
-	if (m_shapes.contains(_shape)) {
+	if (m_shapesIndex.contains(_shape)) {
 		//
 		// Определяем внешние элементы
 		//
@@ -501,6 +509,7 @@ void CustomGraphicsScene::removeShape(Shape* _shape)
 			removeItem(items[i]);
 			disconnect(_shape, SIGNAL(stateIsAboutToBeChangedByUser()), this, SIGNAL(stateChangedByUser()));
 			m_shapes.removeAll(items[i]);
+			unregisterShape(items[i]);
 			delete items[i];
 			items[i] = nullptr;
 		}
@@ -529,7 +538,7 @@ QList<Shape *> CustomGraphicsScene::selectedShapes()
 	QList<Shape *> result;
 	QList<QGraphicsItem *> items = selectedItems();
 	for(int i=0; i<items.count(); ++i)
-		if (m_shapes.contains(dynamic_cast<Shape *>(items[i])))
+		if (m_shapesIndex.contains(dynamic_cast<Shape *>(items[i])))
 			result << dynamic_cast<Shape *>(items[i]);
 	return result;
 }
@@ -549,6 +558,9 @@ void CustomGraphicsScene::removeSelectedShapes()
 		//
 		takeShape(shapes[i]);
 		m_shapesAboutToDelete << shapes[i];
+		if (CardShape* card = dynamic_cast<CardShape*>(shapes[i])) {
+			m_cardsAboutToDelete.insert(card->uuid(), card);
+		}
 	}
 }
 
@@ -581,9 +593,13 @@ void CustomGraphicsScene::removeAllShapes()
 		//
 		qDeleteAll(m_shapesAboutToDelete);
 		m_shapesAboutToDelete.clear();
+		m_cardsAboutToDelete.clear();
 	}
 
 	clear();
+	m_shapes.clear();
+	m_shapesIndex.clear();
+	m_cards.clear();
 	QGraphicsRectItem *item;
 	addItem(item = new QGraphicsRectItem(QRectF(0,0,10000,10000)));
 	item->setVisible(false);
@@ -1037,18 +1053,12 @@ Shape* CustomGraphicsScene::createCard(const QString& _uuid, int _cardType, cons
 	const QString& _description, const QString& _colors, const QPointF& _scenePos, Shape* _parent,
 	bool& _needCorrectPosition)
 {
-	Shape* newCard = nullptr;
 	//
 	// Сперва пробуем восстановить из корзины
 	//
-	for (Shape* shape : m_shapesAboutToDelete) {
-		if (CardShape* card = dynamic_cast<CardShape*>(shape)) {
-			if (card->uuid() == _uuid) {
-				newCard = card;
-				m_shapesAboutToDelete.removeAll(card);
-				break;
-			}
-		}
+	Shape* newCard = m_cardsAboutToDelete.take(_uuid);
+	if (newCard != nullptr) {
+		m_shapesAboutToDelete.removeAll(newCard);
 	}
 
 	//
@@ -1098,7 +1108,7 @@ bool CustomGraphicsScene::hasCards(QGraphicsItem* parentItem) const
 	for (QGraphicsItem* item : checkList) {
 		if (CardShape* card = dynamic_cast<CardShape*>(item)) {
 			if (card->isVisible()
-				&& m_shapes.contains(card)) {
+				&& m_shapesIndex.contains(card)) {
 				return true;
 			}
 		}
@@ -1175,3 +1185,21 @@ Flow* CustomGraphicsScene::cardFlow(Shape* _card, bool _cardIsStartOfFlow) const
 
 	return flow;
 }
+
+void CustomGraphicsScene::registerShape(Shape* _shape)
+{
+	m_shapesIndex.insert(_shape);
+	if (CardShape* card = dynamic_cast<CardShape*>(_shape)) {
+		m_cards.insert(card->uuid(), card);
+	}
+}
+
+void CustomGraphicsScene::unregisterShape(Shape* _shape)
+{
+	m_shapesIndex.remove(_shape);
+	if (CardShape* card = dynamic_cast<CardShape*>(_shape)) {
+		if (m_cards.value(card->uuid()) == card) {
+			m_cards.remove(card->uuid());
+		}
+	}
+}
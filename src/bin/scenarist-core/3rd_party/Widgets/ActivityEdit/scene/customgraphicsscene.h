@@ -4,7 +4,10 @@
 #include <QGraphicsScene>
 #include <QGraphicsLineItem>
 #include <QGraphicsRectItem>
+#include <QHash>
+#include <QSet>
 
+class CardShape;
 class Flow;
 class Shape;
 
@@ -54,6 +57,11 @@ public:
 	 */
 	QList<Shape*> shapes() const;
 
+	/**
+	 * @brief Получить карточку сцены по её uuid, если такой нет, возвращается nullptr
+	 */
+	CardShape* card(const QString& _uuid) const;
+
 	/**
 	 * @brief Сфокусировать представление на заданной фигуре
 	 */
@@ -164,6 +172,16 @@ private:
 	 */
 	Flow* cardFlow(Shape* _card, bool _cardIsStartOfFlow) const;
 
+	/**
+	 * @brief Добавить фигуру в индекс фигур сцены
+	 */
+	void registerShape(Shape* _shape);
+
+	/**
+	 * @brief Убрать фигуру из индекса фигур сцены
+	 */
+	void unregisterShape(Shape* _shape);
+
 private:
 	/**
 	 * @brief Фигуры сцены
@@ -171,11 +189,26 @@ private:
 	 */
 	QList<Shape*> m_shapes;
 
+	/**
+	 * @brief Индекс фигур сцены для быстрой проверки принадлежности фигуры сцене
+	 */
+	QSet<Shape*> m_shapesIndex;
+
+	/**
+	 * @brief Индекс карточек сцены по их uuid
+	 */
+	QHash<QString, CardShape*> m_cards;
+
 	/**
 	 * @brief Корзина с удалёнными фигурами
 	 */
 	QList<Shape*> m_shapesAboutToDelete;
 
+	/**
+	 * @brief Индекс карточек из корзины по их uuid
+	 */
+	QHash<QString, CardShape*> m_cardsAboutToDelete;
+
 	/**
 	 * @brief Действие происходит после перемещения курсора
 	 */
@@ -53,8 +53,9 @@ bool SceneUndoStack::needSyncRedo()
 QString SceneUndoStack::undo()
 {
 	if (canUndo()) {
+		applyChange(m_history[m_historyIndex], true);
 		--m_historyIndex;
-		return currentState();
+		return m_currentState;
 	}
 
 	return QString::null;
@@ -64,7 +65,8 @@ QString SceneUndoStack::redo()
 {
 	if (canRedo()) {
 		++m_historyIndex;
-		return currentState();
+		applyChange(m_history[m_historyIndex], false);
+		return m_currentState;
 	}
 
 	return QString::null;
@@ -74,6 +76,7 @@ void SceneUndoStack::clear()
 {
 	m_history.clear();
 	m_historyNeedSync.clear();
+	m_currentState.clear();
 	m_historyIndex = START_HISTORY_INDEX;
 }
 
@@ -83,34 +86,56 @@ void SceneUndoStack::addState(const QString& _data, bool _needSync)
 	// +1 т.к. нужно сохранить текущее состояние
 	//
 	const int indexToRemove = m_historyIndex + 1;
-	while (m_history.count() > indexToRemove) {
-		m_history.removeAt(indexToRemove);
-		m_historyNeedSync.removeAt(indexToRemove);
-	}
+	m_history.resize(indexToRemove);
+	m_historyNeedSync.resize(indexToRemove);
 
-	m_history << qCompress(_data.toUtf8());
+	//
+	// Для первого состояния изменение не сохраняем, т.к. отменять его некуда
+	//
+	m_history << (m_history.isEmpty() ? Change() : makeChange(m_currentState, _data));
 	m_historyNeedSync << _needSync;
+	m_currentState = _data;
 
 	++m_historyIndex;
 }
 
 bool SceneUndoStack::hasChanges(const QString& _data)
 {
-	//
-	// Сравниваем сжатые массивы, так быстрее
-	//
 	if (!m_history.isEmpty()) {
-		return m_history[m_historyIndex] != qCompress(_data.toUtf8());
+		return m_currentState != _data;
 	}
 
 	return true;
 }
 
-QString SceneUndoStack::currentState()
+SceneUndoStack::Change SceneUndoStack::makeChange(const QString& _from, const QString& _to)
 {
-	if (!m_history.isEmpty()) {
-		return qUncompress(m_history[m_historyIndex]);
+	//
+	// Отбрасываем совпадающие начало и конец строк, при перемещении или правке
+	// одной фигуры меняется лишь небольшой фрагмент XML
+	//
+	const int minLength = qMin(_from.length(), _to.length());
+	int prefixLength = 0;
+	while (prefixLength < minLength
+		   && _from.at(prefixLength) == _to.at(prefixLength)) {
+		++prefixLength;
+	}
+	int suffixLength = 0;
+	while (suffixLength < minLength - prefixLength
+		   && _from.at(_from.length() - suffixLength - 1) == _to.at(_to.length() - suffixLength - 1)) {
+		++suffixLength;
 	}
 
-	return QString::null;
+	Change change;
+	change.position = prefixLength;
+	change.removed = qCompress(_from.mid(prefixLength, _from.length() - prefixLength - suffixLength).toUtf8());
+	change.inserted = qCompress(_to.mid(prefixLength, _to.length() - prefixLength - suffixLength).toUtf8());
+	return change;
+}
+
+void SceneUndoStack::applyChange(const SceneUndoStack::Change& _change, bool _isUndo)
+{
+	const QString removed = QString::fromUtf8(qUncompress(_isUndo ? _change.inserted : _change.removed));
+	const QString inserted = QString::fromUtf8(qUncompress(_isUndo ? _change.removed : _change.inserted));
+	m_currentState.replace(_change.position, removed.length(), inserted);
 }
@@ -1,6 +1,7 @@
 #ifndef SCENEUNDOSTACK_H
 #define SCENEUNDOSTACK_H
 
+#include <QByteArray>
 #include <QString>
 #include <QVector>
 
@@ -8,8 +9,9 @@
 /**
  * @class SceneUndoStack
  * Хранит состояния сцены, представленные в виде XML-строк.
- * Грубо, зато быстро
- * При добавлении в стэк строка архивируется, а при извлечении разархивируется
+ * Целиком хранится только текущее состояние, а для каждого перехода между соседними состояниями
+ * хранится лишь изменившийся фрагмент строки - до и после изменения, в сжатом виде.
+ * При отмене и повторе фрагменты подставляются в текущее состояние
  *
  * @see CustomGraphicsScene
  * @see CustomGraphicsScene::stateChangedByUser()
@@ -67,15 +69,46 @@ public:
 
 private:
 	/**
-	 * @brief Вернуть текущее состояние
+	 * @brief Изменение состояния
 	 */
-	QString currentState();
+	struct Change {
+		/**
+		 * @brief Позиция изменившегося фрагмента
+		 */
+		int position = 0;
+
+		/**
+		 * @brief Фрагмент до изменения (сжатый)
+		 */
+		QByteArray removed;
+
+		/**
+		 * @brief Фрагмент после изменения (сжатый)
+		 */
+		QByteArray inserted;
+	};
+
+	/**
+	 * @brief Определить изменение, переводящее одно состояние в другое
+	 */
+	static Change makeChange(const QString& _from, const QString& _to);
+
+	/**
+	 * @brief Применить изменение к текущему состоянию, или откатить его
+	 */
+	void applyChange(const Change& _change, bool _isUndo);
 
 private:
 	/**
 	 * @brief История изменений
+	 * @note Изменение с индексом i переводит состояние i - 1 в состояние i, у первого состояния изменения нет
+	 */
+	QVector<Change> m_history;
+
+	/**
+	 * @brief Текущее состояние
 	 */
-	QVector<QByteArray> m_history;
+	QString m_currentState;
 
 	/**
 	 * @brief Нужно ли синхронизировать изменения с текстом сценария
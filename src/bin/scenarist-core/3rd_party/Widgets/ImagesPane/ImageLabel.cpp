@@ -1,5 +1,7 @@
 #include "ImageLabel.h"
 
+#include <3rd_party/Helpers/ImageHelper.h>
+
 #include <QApplication>
 #include <QFileDialog>
 #include <QPainter>
@@ -49,7 +51,7 @@ void ImageLabel::setImage(const QPixmap& _image)
 		painter.begin(&photoToShow);
 		painter.fillRect(0, 0, width(), height(), qApp->palette().button());
 
-		QPixmap scaledPhoto = m_image.scaled(photoSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		QPixmap scaledPhoto = ImageHelper::thumbnail(m_image, photoSize);
 		painter.drawPixmap((width() - scaledPhoto.width()) / 2,
 						   (height() - scaledPhoto.height()) / 2,
 						   scaledPhoto);
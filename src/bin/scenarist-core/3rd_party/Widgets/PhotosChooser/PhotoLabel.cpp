@@ -1,5 +1,7 @@
 #include "PhotoLabel.h"
 
+#include <3rd_party/Helpers/ImageHelper.h>
+
 #include <QApplication>
 #include <QFileDialog>
 #include <QPainter>
@@ -47,7 +49,7 @@ void PhotoLabel::setPhoto(const QPixmap& _photo)
 		painter.begin(&photoToShow);
 		painter.fillRect(0, 0, width(), height(), qApp->palette().button());
 
-		QPixmap scaledPhoto = m_photo.scaled(photoSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+		QPixmap scaledPhoto = ImageHelper::thumbnail(m_photo, photoSize);
 		painter.drawPixmap((width() - scaledPhoto.width()) / 2,
 						   (height() - scaledPhoto.height()) / 2,
 						   scaledPhoto);
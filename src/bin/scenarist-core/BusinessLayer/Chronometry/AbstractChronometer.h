@@ -21,6 +21,12 @@ namespace BusinessLogic
 		 */
 		virtual QString name() const = 0;
 
+		/**
+		 * @brief Загрузить параметры хронометража из настроек
+		 * @note Параметры считываются один раз при изменении настроек, а не при каждом расчёте
+		 */
+		virtual void loadSettings() = 0;
+
 		/**
 		 * @brief Подсчитать длительность заданного текста определённого типа
 		 */
@@ -7,7 +7,9 @@ using namespace DataStorageLayer;
 using namespace BusinessLogic;
 
 
-CharactersChronometer::CharactersChronometer()
+CharactersChronometer::CharactersChronometer() :
+	m_characterChron(0),
+	m_considerSpaces(false)
 {
 }
 
@@ -16,52 +18,48 @@ QString CharactersChronometer::name() const
 	return "characters-chronometer";
 }
 
-float CharactersChronometer::calculateFrom(BusinessLogic::ScenarioBlockStyle::Type _type, const QString& _text) const
+void CharactersChronometer::loadSettings()
 {
-	//
-	// Не включаем в хронометраж непечатный текст, заголовок и окончание папки, а также описание сцены
-	//
-	if (_type == ScenarioBlockStyle::NoprintableText
-		|| _type == ScenarioBlockStyle::FolderHeader
-		|| _type == ScenarioBlockStyle::FolderFooter
-		|| _type == ScenarioBlockStyle::SceneDescription) {
-		return 0;
-	}
-
-	static const QString CHARACTERS_KEY = "chronometry/characters/characters";
-	static const QString SECONDS_KEY = "chronometry/characters/seconds";
-	static const QString CONSIDER_SPACES_KEY = "chronometry/characters/consider-spaces";
-
 	//
 	// Рассчитаем длительность одного символа
 	//
 	int characters =
 			StorageFacade::settingsStorage()->value(
-				CHARACTERS_KEY,
+				"chronometry/characters/characters",
 				SettingsStorage::ApplicationSettings)
 			.toInt();
 	int seconds =
 			StorageFacade::settingsStorage()->value(
-				SECONDS_KEY,
+				"chronometry/characters/seconds",
 				SettingsStorage::ApplicationSettings)
 			.toInt();
-	bool considerSpaces =
+	m_considerSpaces =
 			StorageFacade::settingsStorage()->value(
-				CONSIDER_SPACES_KEY,
+				"chronometry/characters/consider-spaces",
 				SettingsStorage::ApplicationSettings)
 			.toInt();
 
-	const float CHARACTER_CHRON = (float)seconds / (float)characters;
+	m_characterChron = (float)seconds / (float)characters;
+}
+
+float CharactersChronometer::calculateFrom(BusinessLogic::ScenarioBlockStyle::Type _type, const QString& _text) const
+{
+	//
+	// Не включаем в хронометраж непечатный текст, заголовок и окончание папки, а также описание сцены
+	//
+	if (!ScenarioBlockStyle::isChronometrable(_type)) {
+		return 0;
+	}
 
 	//
 	// Рассчитаем длительность текста
 	//
 	QString textForChron = _text;
 	textForChron = textForChron.remove("\n").simplified();
-	if (!considerSpaces) {
+	if (!m_considerSpaces) {
 		textForChron = textForChron.remove(" ");
 	}
-	float textChron = textForChron.length() * CHARACTER_CHRON;
+	float textChron = textForChron.length() * m_characterChron;
 
 	return textChron;
 }
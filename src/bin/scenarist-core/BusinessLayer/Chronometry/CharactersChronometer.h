@@ -19,11 +19,27 @@ namespace BusinessLogic
 		 */
 		QString name() const;
 
+		/**
+		 * @brief Загрузить параметры хронометража из настроек
+		 */
+		void loadSettings();
+
 		/**
 		 * @brief Подсчитать длительность заданного текста определённого типа
 		 */
 		float calculateFrom(
 				BusinessLogic::ScenarioBlockStyle::Type _type, const QString &_text) const;
+
+	private:
+		/**
+		 * @brief Длительность одного символа
+		 */
+		float m_characterChron;
+
+		/**
+		 * @brief Учитывать ли пробелы
+		 */
+		bool m_considerSpaces;
 	};
 }
 
@@ -9,7 +9,6 @@
 #include <DataLayer/DataStorageLayer/SettingsStorage.h>
 
 #include <QTextDocument>
-#include <QTextCursor>
 #include <QTextBlock>
 #include <QTime>
 
@@ -19,9 +18,77 @@ using namespace BusinessLogic;
 
 bool ChronometerFacade::chronometryUsed()
 {
-	return StorageFacade::settingsStorage()->value(
+	if (s_chronometer == 0) {
+		updateChronometer();
+	}
+
+	return s_chronometryUsed;
+}
+
+void ChronometerFacade::updateChronometer()
+{
+	static QString CHRONOMETRY_TYPE_KEY = "chronometry/current-chronometer-type";
+	static QString CHRONOMETRY_PAGES = PagesChronometer().name();
+	static QString CHRONOMETRY_CHARACTERS = CharactersChronometer().name();
+	static QString CHRONOMETRY_CONFIGURABLE = ConfigurableChronometer().name();
+
+	s_chronometryUsed =
+			StorageFacade::settingsStorage()->value(
 				"chronometry/used",
 				SettingsStorage::ApplicationSettings).toInt();
+
+	//
+	// Определить какой хронометр нужно использовать
+	// Если не задан, настроить на хронометр для страниц
+	//
+	QString chronometryType =
+			StorageFacade::settingsStorage()->value(
+				CHRONOMETRY_TYPE_KEY,
+				SettingsStorage::ApplicationSettings);
+	if (chronometryType.isEmpty()) {
+		chronometryType = CHRONOMETRY_PAGES;
+		StorageFacade::settingsStorage()->setValue(
+					CHRONOMETRY_TYPE_KEY,
+					chronometryType,
+					SettingsStorage::ApplicationSettings);
+	}
+
+	//
+	// Хронометр заменяется, пока им не пользуется ни один поток
+	//
+	QMutexLocker locker(&s_blocksChronometryMutex);
+
+	//
+	// Проверить какой используется
+	// Если нужно создать необходимый
+	//
+	if (chronometryType == CHRONOMETRY_PAGES) {
+		if (s_chronometer == 0
+			|| s_chronometer->name() != CHRONOMETRY_PAGES) {
+			delete s_chronometer;
+			s_chronometer = new PagesChronometer;
+		}
+	} else if (chronometryType == CHRONOMETRY_CHARACTERS) {
+		if (s_chronometer == 0
+			|| s_chronometer->name() != CHRONOMETRY_CHARACTERS) {
+			delete s_chronometer;
+			s_chronometer = new CharactersChronometer;
+		}
+	} else {
+		if (s_chronometer == 0
+			|| s_chronometer->name() != CHRONOMETRY_CONFIGURABLE) {
+			delete s_chronometer;
+			s_chronometer = new ConfigurableChronometer;
+		}
+	}
+	s_chronometer->loadSettings();
+
+	//
+	// Запомненные длительности блоков рассчитаны со старыми параметрами
+	//
+	for (auto iter = s_blocksChronometry.begin(); iter != s_blocksChronometry.end(); ++iter) {
+		iter.value().clear();
+	}
 }
 
 qreal ChronometerFacade::calculate(const QTextBlock& _block)
@@ -45,40 +112,34 @@ qreal ChronometerFacade::calculate(QTextDocument* _document, int _fromCursorPosi
 		chronometry = 0;
 
 		if (!_document->isEmpty()) {
-			QTextCursor cursor(_document);
-			cursor.setPosition(_fromCursorPosition);
+			QTextBlock block = _document->findBlock(_fromCursorPosition);
 			bool isFirstStep = true;
-			do {
-				//
-				// Перейти к следующему, если это не первый шаг цикла
-				//
-				if (!isFirstStep) {
-					cursor.movePosition(QTextCursor::NextBlock);
-				} else {
-					isFirstStep = false;
-				}
-				cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
-				if (cursor.position() > _toCursorPosition) {
-					cursor.setPosition(_toCursorPosition, QTextCursor::KeepAnchor);
-				}
+			while (block.isValid()
+				   && (isFirstStep || block.position() <= _toCursorPosition)) {
+				isFirstStep = false;
 
 				//
-				// Поссчитать хронометраж текущего блока, если он видим
+				// Блоки, попадающие в диапазон целиком, считаем с использованием кэша,
+				// а у крайних блоков берём только попадающую в диапазон часть текста
 				//
-				if (cursor.atBlockEnd()
-					|| cursor.position() == _toCursorPosition) {
-					//
-					// Посчитать его хронометраж, добавив к результату
-					//
+				const int blockStart = block.position();
+				const int blockEnd = blockStart + block.length() - 1;
+				if (_fromCursorPosition <= blockStart
+					&& _toCursorPosition >= blockEnd) {
+					chronometry += blockChronometry(block);
+				} else {
+					const int startInBlock = qMax(_fromCursorPosition - blockStart, 0);
+					const int endInBlock = qMin(_toCursorPosition, blockEnd) - blockStart;
+					QMutexLocker locker(&s_blocksChronometryMutex);
 					chronometry +=
-							chronometer()->calculateFrom(
-								ScenarioBlockStyle::forBlock(cursor.block()),
-								cursor.selectedText()
+							s_chronometer->calculateFrom(
+								ScenarioBlockStyle::forBlock(block),
+								block.text().mid(startInBlock, qMax(endInBlock - startInBlock, 0))
 								);
-					cursor.clearSelection();
 				}
-			} while (!cursor.atEnd()
-					 && cursor.position() < _toCursorPosition);
+
+				block = block.next();
+			}
 		}
 	}
 
@@ -111,52 +172,54 @@ QString ChronometerFacade::secondsToTime(qreal _seconds)
 
 AbstractChronometer* ChronometerFacade::chronometer()
 {
-	static QString CHRONOMETRY_TYPE_KEY = "chronometry/current-chronometer-type";
-	static QString CHRONOMETRY_PAGES = PagesChronometer().name();
-	static QString CHRONOMETRY_CHARACTERS = CharactersChronometer().name();
-	static QString CHRONOMETRY_CONFIGURABLE = ConfigurableChronometer().name();
+	if (s_chronometer == 0) {
+		updateChronometer();
+	}
+
+	return s_chronometer;
+}
+
+qreal ChronometerFacade::blockChronometry(const QTextBlock& _block)
+{
+	const QTextDocument* document = _block.document();
+	const int type = ScenarioBlockStyle::forBlock(_block);
+	const QString text = _block.text();
+	const uint textHash = qHash(text);
 
 	//
-	// Определить какой хронометр нужно использовать
-	// Если не задан, настроить на хронометр для страниц
+	// Хронометр создаётся до блокировки, поскольку при создании он захватывает ту же блокировку
 	//
-	QString chronometryType =
-			StorageFacade::settingsStorage()->value(
-				CHRONOMETRY_TYPE_KEY,
-				SettingsStorage::ApplicationSettings);
-	if (chronometryType.isEmpty()) {
-		chronometryType = CHRONOMETRY_PAGES;
-		StorageFacade::settingsStorage()->setValue(
-					CHRONOMETRY_TYPE_KEY,
-					chronometryType,
-					SettingsStorage::ApplicationSettings);
-	}
+	chronometer();
+	QMutexLocker locker(&s_blocksChronometryMutex);
 
 	//
-	// Проверить какой используется
-	// Если нужно создать необходимый
+	// Кэш документа удаляем вместе с самим документом
 	//
-	if (chronometryType == CHRONOMETRY_PAGES) {
-		if (s_chronometer == 0
-			|| s_chronometer->name() != CHRONOMETRY_PAGES) {
-			delete s_chronometer;
-			s_chronometer = new PagesChronometer;
-		}
-	} else if (chronometryType == CHRONOMETRY_CHARACTERS) {
-		if (s_chronometer == 0
-			|| s_chronometer->name() != CHRONOMETRY_CHARACTERS) {
-			delete s_chronometer;
-			s_chronometer = new CharactersChronometer;
-		}
-	} else {
-		if (s_chronometer == 0
-			|| s_chronometer->name() != CHRONOMETRY_CONFIGURABLE) {
-			delete s_chronometer;
-			s_chronometer = new ConfigurableChronometer;
-		}
+	if (!s_blocksChronometry.contains(document)) {
+		QObject::connect(document, &QObject::destroyed, [document] {
+			QMutexLocker locker(&s_blocksChronometryMutex);
+			s_blocksChronometry.remove(document);
+		});
 	}
 
-	return s_chronometer;
+	BlockChronometry cached = s_blocksChronometry[document].value(_block.fragmentIndex());
+	if (cached.revision != _block.revision()
+		|| cached.type != type
+		|| cached.textHash != textHash) {
+		//
+		// Рассчитываем под блокировкой, чтобы хронометр не был заменён во время расчёта
+		//
+		cached.revision = _block.revision();
+		cached.type = type;
+		cached.textHash = textHash;
+		cached.duration = s_chronometer->calculateFrom((ScenarioBlockStyle::Type)type, text);
+		s_blocksChronometry[document].insert(_block.fragmentIndex(), cached);
+	}
+
+	return cached.duration;
 }
 
 AbstractChronometer* ChronometerFacade::s_chronometer = 0;
+bool ChronometerFacade::s_chronometryUsed = false;
+QHash<const QTextDocument*, QHash<int, ChronometerFacade::BlockChronometry> > ChronometerFacade::s_blocksChronometry;
+QMutex ChronometerFacade::s_blocksChronometryMutex;
@@ -1,6 +1,8 @@
 #ifndef CHRONOMETERFACADE_H
 #define CHRONOMETERFACADE_H
 
+#include <QHash>
+#include <QMutex>
 #include <QString>
 
 class QTextBlock;
@@ -13,6 +15,8 @@ namespace BusinessLogic
 
 	/**
 	 * @brief Фасад для доступа к рассчёту хронометража
+	 * @note Рассчитывать хронометраж можно из любого потока, а обновлять хронометр только
+	 *		 из главного, т.к. при этом читаются настройки
 	 */
 	class ChronometerFacade
 	{
@@ -22,6 +26,12 @@ namespace BusinessLogic
 		 */
 		static bool chronometryUsed();
 
+		/**
+		 * @brief Обновить хронометр и его параметры после изменения настроек хронометража
+		 * @note Сбрасывает также кэш длительностей блоков. Вызывается только из главного потока
+		 */
+		static void updateChronometer();
+
 		/**
 		 * @brief Вычислить хронометраж последовательности ограниченной заданным блоком
 		 */
@@ -56,11 +66,56 @@ namespace BusinessLogic
 		 */
 		static AbstractChronometer* chronometer();
 
+		/**
+		 * @brief Длительность блока целиком, берётся из кэша, если блок не изменился
+		 */
+		static qreal blockChronometry(const QTextBlock& _block);
+
 	private:
+		/**
+		 * @brief Запомненная длительность блока
+		 */
+		struct BlockChronometry {
+			BlockChronometry() : revision(-1), type(0), textHash(0), duration(0) {}
+
+			/**
+			 * @brief Ключ, по которому определяется, что блок не изменился
+			 * @note Помимо ревизии учитывается хэш текста, т.к. после очистки документа
+			 *		 ревизии блоков начинаются заново
+			 */
+			/** @{ */
+			int revision;
+			int type;
+			uint textHash;
+			/** @} */
+
+			/**
+			 * @brief Длительность блока
+			 */
+			qreal duration;
+		};
+
 		/**
 		 * @brief Текущий хронометр
 		 */
 		static AbstractChronometer* s_chronometer;
+
+		/**
+		 * @brief Используется ли хронометраж
+		 */
+		static bool s_chronometryUsed;
+
+		/**
+		 * @brief Кэш длительностей блоков документов, блоки идентифицируются своим индексом
+		 *		  во внутренней структуре документа, который не меняется при правке текста
+		 */
+		static QHash<const QTextDocument*, QHash<int, BlockChronometry> > s_blocksChronometry;
+
+		/**
+		 * @brief Защита кэша длительностей блоков и текущего хронометра, к ним обращаются
+		 *		  и фоновые потоки экспорта
+		 */
+		static QMutex s_blocksChronometryMutex;
 	};
 }
 
@@ -7,7 +7,27 @@ using namespace DataStorageLayer;
 using namespace BusinessLogic;
 
 
-ConfigurableChronometer::ConfigurableChronometer()
+namespace {
+	/**
+	 * @brief Получить значение параметра хронометража
+	 */
+	float secondsValue(const QString& _key) {
+		return
+				StorageFacade::settingsStorage()->value(
+					_key,
+					SettingsStorage::ApplicationSettings)
+				.toFloat();
+	}
+}
+
+
+ConfigurableChronometer::ConfigurableChronometer() :
+	m_sceneHeadingSecondsForParagraph(0),
+	m_sceneHeadingSecondsForEvery50(0),
+	m_actionSecondsForParagraph(0),
+	m_actionSecondsForEvery50(0),
+	m_dialogSecondsForParagraph(0),
+	m_dialogSecondsForEvery50(0)
 {
 }
 
@@ -16,6 +36,22 @@ QString ConfigurableChronometer::name() const
 	return "configurable-chronometer";
 }
 
+void ConfigurableChronometer::loadSettings()
+{
+	m_sceneHeadingSecondsForParagraph =
+			secondsValue("chronometry/configurable/seconds-for-paragraph/scene_heading");
+	m_sceneHeadingSecondsForEvery50 =
+			secondsValue("chronometry/configurable/seconds-for-every-50/scene_heading");
+	m_actionSecondsForParagraph =
+			secondsValue("chronometry/configurable/seconds-for-paragraph/action");
+	m_actionSecondsForEvery50 =
+			secondsValue("chronometry/configurable/seconds-for-every-50/action");
+	m_dialogSecondsForParagraph =
+			secondsValue("chronometry/configurable/seconds-for-paragraph/dialog");
+	m_dialogSecondsForEvery50 =
+			secondsValue("chronometry/configurable/seconds-for-every-50/dialog");
+}
+
 float ConfigurableChronometer::calculateFrom(
 		BusinessLogic::ScenarioBlockStyle::Type _type, const QString& _text) const
 {
@@ -30,35 +66,17 @@ float ConfigurableChronometer::calculateFrom(
 	//
 	float secondsForParagraph = 0;
 	float secondsForEvery50 = 0;
-	QString secondsForParagraphKey;
-	QString secondsForEvery50Key;
-
 	if (_type == ScenarioBlockStyle::Action) {
-		secondsForParagraphKey = "chronometry/configurable/seconds-for-paragraph/action";
-		secondsForEvery50Key = "chronometry/configurable/seconds-for-every-50/action";
+		secondsForParagraph = m_actionSecondsForParagraph;
+		secondsForEvery50 = m_actionSecondsForEvery50;
 	} else if (_type == ScenarioBlockStyle::Dialogue) {
-		secondsForParagraphKey = "chronometry/configurable/seconds-for-paragraph/dialog";
-		secondsForEvery50Key = "chronometry/configurable/seconds-for-every-50/dialog";
+		secondsForParagraph = m_dialogSecondsForParagraph;
+		secondsForEvery50 = m_dialogSecondsForEvery50;
 	} else {
-		secondsForParagraphKey = "chronometry/configurable/seconds-for-paragraph/scene_heading";
-		secondsForEvery50Key = "chronometry/configurable/seconds-for-every-50/scene_heading";
+		secondsForParagraph = m_sceneHeadingSecondsForParagraph;
+		secondsForEvery50 = m_sceneHeadingSecondsForEvery50;
 	}
 
-	//
-	// Получим значения длительности
-	//
-	secondsForParagraph =
-			StorageFacade::settingsStorage()->value(
-				secondsForParagraphKey,
-				SettingsStorage::ApplicationSettings)
-			.toFloat();
-
-	secondsForEvery50 =
-			StorageFacade::settingsStorage()->value(
-				secondsForEvery50Key,
-				SettingsStorage::ApplicationSettings)
-			.toFloat();
-
 	const int EVERY_50 = 50;
 	const float SECONDS_FOR_CHARACTER = secondsForEvery50 / EVERY_50;
 
@@ -19,11 +19,29 @@ namespace BusinessLogic
 		 */
 		QString name() const;
 
+		/**
+		 * @brief Загрузить параметры хронометража из настроек
+		 */
+		void loadSettings();
+
 		/**
 		 * @brief Подсчитать длительность заданного текста определённого типа
 		 */
 		float calculateFrom(
 				BusinessLogic::ScenarioBlockStyle::Type _type, const QString &_text) const;
+
+	private:
+		/**
+		 * @brief Длительность абзаца и каждых 50 символов для поддерживаемых блоков
+		 */
+		/** @{ */
+		float m_sceneHeadingSecondsForParagraph;
+		float m_sceneHeadingSecondsForEvery50;
+		float m_actionSecondsForParagraph;
+		float m_actionSecondsForEvery50;
+		float m_dialogSecondsForParagraph;
+		float m_dialogSecondsForEvery50;
+		/** @} */
 	};
 }
 
@@ -7,7 +7,8 @@ using namespace DataStorageLayer;
 using namespace BusinessLogic;
 
 
-PagesChronometer::PagesChronometer()
+PagesChronometer::PagesChronometer() :
+	m_seconds(0)
 {
 }
 
@@ -16,34 +17,33 @@ QString PagesChronometer::name() const
 	return "pages-chronometer";
 }
 
+void PagesChronometer::loadSettings()
+{
+	//
+	// Получим значение длительности одной страницы текста
+	//
+	m_seconds =
+			StorageFacade::settingsStorage()->value(
+				"chronometry/pages/seconds",
+				SettingsStorage::ApplicationSettings)
+			.toInt();
+}
+
 float PagesChronometer::calculateFrom(
 		BusinessLogic::ScenarioBlockStyle::Type _type, const QString& _text) const
 {
 	//
 	// Не включаем в хронометраж непечатный текст, заголовок и окончание папки, а также описание сцены
 	//
-	if (_type == ScenarioBlockStyle::NoprintableText
-		|| _type == ScenarioBlockStyle::FolderHeader
-		|| _type == ScenarioBlockStyle::FolderFooter
-		|| _type == ScenarioBlockStyle::SceneDescription) {
+	if (!ScenarioBlockStyle::isChronometrable(_type)) {
 		return 0;
 	}
 
-	//
-	// Получим значение длительности одной страницы текста
-	//
-	static const QString SECONDS_KEY = "chronometry/pages/seconds";
-	int seconds =
-			StorageFacade::settingsStorage()->value(
-				SECONDS_KEY,
-				SettingsStorage::ApplicationSettings)
-			.toInt();
-
 	//
 	// Высчитываем длительность строки на странице, из знания о том, сколько строк на странице
 	//
 	const float LINES_IN_PAGE = 54;
-	const float LINE_CHRON = seconds / LINES_IN_PAGE;
+	const float LINE_CHRON = m_seconds / LINES_IN_PAGE;
 
 	//
 	// Длина строки в зависимости от типа
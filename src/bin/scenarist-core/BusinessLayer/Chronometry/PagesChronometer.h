@@ -19,6 +19,11 @@ namespace BusinessLogic
 		 */
 		QString name() const;
 
+		/**
+		 * @brief Загрузить параметры хронометража из настроек
+		 */
+		void loadSettings();
+
 		/**
 		 * @brief Подсчитать длительность заданного текста определённого типа
 		 */
@@ -27,6 +32,12 @@ namespace BusinessLogic
 
 	private:
 		int linesInText(const QString& _text, int _lineLength) const;
+
+	private:
+		/**
+		 * @brief Длительность одной страницы текста
+		 */
+		int m_seconds;
 	};
 }
 
@@ -42,14 +42,11 @@ Counter CountersFacade::calculate(QTextDocument* _document, int _fromCursorPosit
 			cursor.movePosition(QTextCursor::EndOfBlock, QTextCursor::KeepAnchor);
 
 			if (cursor.block().isVisible()) {
-				QString text = cursor.selectedText();
-				if (calculateWords) {
-					counter.addWords(wordsCount(text));
-				}
-				if (calculateCharacters) {
-					counter.addCharactersWithSpaces(charactersWithSpacesCount(text));
-					counter.addCharactersWithoutSpaces(charactersWithoutSpacesCount(text));
-				}
+				const Counter blockCounter =
+						calculate(cursor.selectedText(), calculateWords, calculateCharacters);
+				counter.addWords(blockCounter.words());
+				counter.addCharactersWithSpaces(blockCounter.charactersWithSpaces());
+				counter.addCharactersWithoutSpaces(blockCounter.charactersWithoutSpaces());
 			}
 
 			cursor.movePosition(QTextCursor::NextCharacter);
@@ -60,6 +57,20 @@ Counter CountersFacade::calculate(QTextDocument* _document, int _fromCursorPosit
 	return counter;
 }
 
+BusinessLogic::Counter CountersFacade::calculate(const QString& _text, bool _calculateWords, bool _calculateCharacters)
+{
+	Counter counter;
+	if (_calculateWords) {
+		counter.setWords(wordsCount(_text));
+	}
+	if (_calculateCharacters) {
+		counter.setCharactersWithSpaces(charactersWithSpacesCount(_text));
+		counter.setCharactersWithoutSpaces(charactersWithoutSpacesCount(_text));
+	}
+
+	return counter;
+}
+
 BusinessLogic::Counter CountersFacade::calculateFull(QTextDocument* _document)
 {
 	Counter counter;
@@ -21,6 +21,12 @@ namespace BusinessLogic
 		 */
 		static Counter calculate(QTextDocument* _document, int _fromCursorPosition, int _toCursorPosition);
 
+		/**
+		 * @brief Рассчитать значения для заданного текста
+		 * @note Не обращается к настройкам и документу, поэтому может использоваться в фоновых потоках
+		 */
+		static Counter calculate(const QString& _text, bool _calculateWords, bool _calculateCharacters);
+
 		/**
 		 * @brief Рассчитать все значения для документа
 		 */
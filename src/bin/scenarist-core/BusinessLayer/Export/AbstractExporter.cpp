@@ -13,6 +13,7 @@
 #include <3rd_party/Helpers/TextEditHelper.h>
 #include <3rd_party/Widgets/PagesTextEdit/PageMetrics.h>
 
+#include <QAbstractTextDocumentLayout>
 #include <QApplication>
 #include <QTextBlock>
 #include <QTextCursor>
@@ -140,84 +141,74 @@ namespace {
 	}
 
 	/**
-	 * @brief Определить тип следующей строки документа
+	 * @brief Перевести размер в единицы компоновщика документа
+	 * @note Компоновщик QTextDocument хранит координаты с точностью до 1/64 пикселя,
+	 *		 поэтому и здесь считаем в них, чтобы совпадать с ним в пограничных случаях
 	 */
-	static LineType currentLine(QTextDocument* _inDocument, const QTextBlockFormat& _blockFormat,
-		const QTextCharFormat& _charFormat) {
-		LineType type = UndefinedLine;
-
-		if (_inDocument->isEmpty()) {
-			type = FirstDocumentLine;
-		} else {
-			//
-			// Определяем конец страницы или середина при помощи проверки
-			// на количество страниц, после вставки новой строки
-			//
-			const int documentPagesCount = _inDocument->pageCount();
-			QTextCursor cursor(_inDocument);
-			cursor.movePosition(QTextCursor::End);
-			insertLine(cursor, _blockFormat, _charFormat);
-			const int documentPagesCountWithNextLine = _inDocument->pageCount();
-			cursor.deletePreviousChar();
-			if (documentPagesCount == documentPagesCountWithNextLine) {
-				type = MiddlePageLine;
-			} else {
-				type = LastPageLine;
-			}
-		}
-
-		return type;
+	static qint64 toLayoutUnits(qreal _value) {
+		return qRound64(_value * 64);
 	}
 
 	/**
-	 * @brief Оптимизированная версия подсчёта кол-ва строк до конца страницы
+	 * @brief Посчитать кол-во строк заданного формата, которое поместится до конца текущей страницы
+	 *
+	 * Считается по метрикам стиля блока (фиксированная высота строки, отступы сверху и снизу)
+	 * и высоте уже скомпонованного документа, без вставки в документ пробных строк.
+	 * Правила те же, что и у компоновщика документа: отступы соседних абзацев не суммируются,
+	 * а берётся наибольший из них, строка не влезающая целиком переносится на следующую страницу
 	 */
 	static int linesToEndOfPage(QTextDocument* _inDocument, const QTextBlockFormat& _blockFormat,
-		const QTextCharFormat& _charFormat, const int _blockLines) {
+		const QTextCharFormat& _charFormat) {
+		const qint64 pageHeight = toLayoutUnits(_inDocument->pageSize().height());
+
 		//
-		// Минимальное количество строк для проверки
+		// Определяем где заканчивается последняя строка документа
 		//
-		const int MINIMUM_LINES_FOR_CHECK = 3;
+		const QTextBlockFormat lastBlockFormat = _inDocument->lastBlock().blockFormat();
+		const qint64 documentBottom =
+				toLayoutUnits(_inDocument->documentLayout()->documentSize().height())
+				- toLayoutUnits(lastBlockFormat.bottomMargin());
+		// ... и где заканчивается страница, на которой она находится
+		const qint64 pageIndex = documentBottom > 0 ? (documentBottom - 1) / pageHeight : 0;
+		const qint64 pageBottom = (pageIndex + 1) * pageHeight;
 
-		int result = 0;
+		//
+		// Высота строки и отступы перед первой и последующими строками
+		//
+		const qint64 lineHeight =
+				toLayoutUnits(
+					_blockFormat.lineHeightType() == QTextBlockFormat::FixedHeight
+					? _blockFormat.lineHeight()
+					: TextEditHelper::fontLineHeight(_charFormat.font()));
+		const qint64 firstLineSpacing = toLayoutUnits(qMax(lastBlockFormat.bottomMargin(), _blockFormat.topMargin()));
+		const qint64 lineSpacing = toLayoutUnits(qMax(_blockFormat.bottomMargin(), _blockFormat.topMargin()));
 
 		//
 		// Считаем количество строк
 		//
-		QTextCursor cursor(_inDocument);
-		cursor.movePosition(QTextCursor::End);
-		// ... количество страниц в исходном документе
-		const int documentPagesCount = _inDocument->pageCount();
-		// ... верхняя граница количества строк для проверки
-		const int checkLimit =
-				(_blockLines < MINIMUM_LINES_FOR_CHECK) ? MINIMUM_LINES_FOR_CHECK : _blockLines;
-		// ... тип текущей линии
-		LineType type = UndefinedLine;
-
-		while (type != LastPageLine
-			   && result <= checkLimit) {
-
-			insertLine(cursor, _blockFormat, _charFormat);
-			++result;
-
-			if (documentPagesCount == _inDocument->pageCount()) {
-				type = MiddlePageLine;
-			} else {
-				type = LastPageLine;
-				cursor.deletePreviousChar();
-				--result;
-			}
+		const qint64 firstLineBottom = documentBottom + firstLineSpacing + lineHeight;
+		if (firstLineBottom > pageBottom) {
+			return 0;
 		}
+		return 1 + static_cast<int>((pageBottom - firstLineBottom) / (lineSpacing + lineHeight));
+	}
 
-		//
-		// Возвращаем документ в исходное состояние
-		//
-		int deleteLines = result;
-		while (deleteLines-- > 0)  {
-			cursor.deletePreviousChar();
+	/**
+	 * @brief Определить тип следующей строки документа
+	 */
+	static LineType currentLine(QTextDocument* _inDocument, const QTextBlockFormat& _blockFormat,
+		const QTextCharFormat& _charFormat) {
+		LineType type = UndefinedLine;
+
+		if (_inDocument->isEmpty()) {
+			type = FirstDocumentLine;
+		} else if (linesToEndOfPage(_inDocument, _blockFormat, _charFormat) > 0) {
+			type = MiddlePageLine;
+		} else {
+			type = LastPageLine;
 		}
 
-		return result;
+		return type;
 	}
 
 	/**
@@ -854,7 +845,7 @@ namespace {
 		// Посчитаем сколько строк до конца страницы и сколько строк в блоке
 		//
 		const int blockLines = linesOfText(preparedDocument, blockFormat, charFormat, _sourceDocumentCursor.block().text());
-		const int linesToEndOfPageCount = linesToEndOfPage(preparedDocument, blockFormat, charFormat, blockLines);
+		const int linesToEndOfPageCount = linesToEndOfPage(preparedDocument, blockFormat, charFormat);
 
 		//
 		// Для блоков "Время и место" и "Группа сцен"
@@ -918,13 +909,16 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 	//
 	// Данные считываются из исходного документа, если необходимо преобразовываются,
 	// и записываются в новый документ
-	// NOTE: делаем копию документа, т.к. данные могут быть изменены, удаляем, при выходе
-	//
-	QTextDocument* scenarioDocument = _scenario->document()->clone();
+	// NOTE: при проверке переносов блоки исходного документа могут разрываться, поэтому в таком
+	//		 случае делаем копию документа, удаляем её при выходе. В остальных случаях исходный
+	//		 документ только читается
 	//
-	// ... копируем пользовательские данные из блоков
-	//
-	{
+	QTextDocument* scenarioDocument = _scenario->document();
+	if (_exportParameters.checkPageBreaks) {
+		scenarioDocument = _scenario->document()->clone();
+		//
+		// ... копируем пользовательские данные из блоков
+		//
 		QTextBlock sourceDocumentBlock = _scenario->document()->begin();
 		QTextBlock copyDocumentBlock = scenarioDocument->begin();
 		while (sourceDocumentBlock.isValid()) {
@@ -1012,11 +1006,10 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 		//
 		// Год печатается на последней строке документа
 		//
-		LineType currentLineType = ::currentLine(preparedDocument, centerFormat, titleFormat);
-		while (currentLineType != LastPageLine) {
+		int emptyLines = ::linesToEndOfPage(preparedDocument, centerFormat, titleFormat);
+		while (emptyLines-- > 0) {
 			++currentLineNumber;
 			::insertLine(destDocumentCursor, centerFormat, titleFormat);
-			currentLineType = ::currentLine(preparedDocument, centerFormat, titleFormat);
 		}
 		destDocumentCursor.insertText(_exportParameters.scenarioYear);
 	}
@@ -1045,7 +1038,7 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 		//
 		// Если блок содержит текст, который необходимо вывести на печать
 		//
-		if (::needPrintBlock(currentBlockType, _exportParameters.outline)) {
+		if (needExportBlock(sourceDocumentCursor.block(), _exportParameters)) {
 
 			//
 			// Определим стили и настроим курсор
@@ -1072,16 +1065,11 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 					}
 
 					//
-					// ... выполняется до тех пор, пока не будут вставлены все строки,
-					//	   или не будет достигнут конец страницы
+					// ... вставляем все строки, но не дальше конца страницы
 					//
-					while (emptyLines-- > 0
-						   && currentLineType == MiddlePageLine) {
-						//
-						// ... вставим линию и настроим её стиль
-						//
+					emptyLines = qMin(emptyLines, ::linesToEndOfPage(preparedDocument, blockFormat, charFormat));
+					while (emptyLines-- > 0) {
 						::insertLine(destDocumentCursor, blockFormat, charFormat);
-						currentLineType = ::currentLine(preparedDocument, blockFormat, charFormat);
 					}
 				}
 			}
@@ -1100,8 +1088,7 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 				//
 				// ... если вставляется не первый блок текста
 				//
-				LineType currentLineType = ::currentLine(preparedDocument, blockFormat, charFormat);
-				if (currentLineType != FirstDocumentLine) {
+				if (!preparedDocument->isEmpty()) {
 					//
 					// ... вставим новый абзац для наполнения текстом
 					//
@@ -1115,45 +1102,19 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 				destDocumentCursor.setCharFormat(charFormat);
 
 				//
-				// Для блока "Время и место" добавочная информация
+				// Для блока "Время и место" сохраняем данные сцены
 				//
 				if (currentBlockType == ScenarioBlockStyle::SceneHeading) {
-					//
-					// Данные сцены
-					//
 					QTextBlockUserData* textBlockData = sourceDocumentCursor.block().userData();
-					ScenarioTextBlockInfo* sceneInfo = dynamic_cast<ScenarioTextBlockInfo*>(textBlockData);
-					if (sceneInfo != 0) {
+					if (ScenarioTextBlockInfo* sceneInfo = dynamic_cast<ScenarioTextBlockInfo*>(textBlockData)) {
 						destDocumentCursor.block().setUserData(sceneInfo->clone());
 					}
-
-					//
-					// Префикс экспорта
-					//
-					destDocumentCursor.insertText(_exportParameters.scenesPrefix);
-					//
-					// Номер сцены, если необходимо
-					//
-					if (_exportParameters.printScenesNumbers) {
-						if (sceneInfo != 0) {
-							QString sceneNumber = QString("%1. ").arg(sceneInfo->sceneNumber());
-							destDocumentCursor.insertText(sceneNumber);
-						}
-					}
 				}
 
 				//
 				// Вставить текст
 				//
-				// Приходится вручную устанавливать верхний регистр для текста,
-				// т.к. при выводе в диалог предварительного просмотра эта
-				// настройка не учитывается...
-				//
-				if (charFormatForType(currentBlockType).fontCapitalization() == QFont::AllUppercase) {
-					destDocumentCursor.insertText(sourceDocumentCursor.block().text().toUpper());
-				} else {
-					destDocumentCursor.insertText(sourceDocumentCursor.block().text());
-				}
+				destDocumentCursor.insertText(exportBlockText(sourceDocumentCursor.block(), _exportParameters));
 
 				//
 				// Добавляем редакторские пометки, если необходимо
@@ -1188,16 +1149,11 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 					//
 					lastEmptyLines = emptyLines;
 					//
-					// ... выполняется до тех пор, пока не будут вставлены все строки,
-					//	   или не будет достигнут конец страницы
+					// ... вставляем все строки, но не дальше конца страницы
 					//
-					while (emptyLines-- > 0
-						   && currentLineType == MiddlePageLine) {
-						//
-						// ... вставим линию и настроим её стиль
-						//
+					emptyLines = qMin(emptyLines, ::linesToEndOfPage(preparedDocument, blockFormat, charFormat));
+					while (emptyLines-- > 0) {
 						::insertLine(destDocumentCursor, blockFormat, charFormat);
-						currentLineType = ::currentLine(preparedDocument, blockFormat, charFormat);
 					}
 				}
 			}
@@ -1213,8 +1169,52 @@ QTextDocument* AbstractExporter::prepareDocument(const BusinessLogic::ScenarioDo
 	//
 	// Удаляем копию документа с текстом сценария
 	//
-	delete scenarioDocument;
-	scenarioDocument = 0;
+	if (scenarioDocument != _scenario->document()) {
+		delete scenarioDocument;
+		scenarioDocument = 0;
+	}
 
 	return preparedDocument;
 }
+
+bool AbstractExporter::needExportBlock(const QTextBlock& _block, const ExportParameters& _exportParameters)
+{
+	return ::needPrintBlock(ScenarioBlockStyle::forBlock(_block), _exportParameters.outline);
+}
+
+QString AbstractExporter::exportBlockText(const QTextBlock& _block, const ExportParameters& _exportParameters)
+{
+	const ScenarioBlockStyle::Type blockType = ScenarioBlockStyle::forBlock(_block);
+	QString text;
+
+	//
+	// Для блока "Время и место" добавочная информация
+	//
+	if (blockType == ScenarioBlockStyle::SceneHeading) {
+		//
+		// Префикс экспорта
+		//
+		text.append(_exportParameters.scenesPrefix);
+		//
+		// Номер сцены, если необходимо
+		//
+		if (_exportParameters.printScenesNumbers) {
+			if (ScenarioTextBlockInfo* sceneInfo = dynamic_cast<ScenarioTextBlockInfo*>(_block.userData())) {
+				text.append(QString("%1. ").arg(sceneInfo->sceneNumber()));
+			}
+		}
+	}
+
+	//
+	// Приходится вручную устанавливать верхний регистр для текста,
+	// т.к. при выводе в диалог предварительного просмотра эта
+	// настройка не учитывается...
+	//
+	if (charFormatForType(blockType).fontCapitalization() == QFont::AllUppercase) {
+		text.append(_block.text().toUpper());
+	} else {
+		text.append(_block.text());
+	}
+
+	return text;
+}
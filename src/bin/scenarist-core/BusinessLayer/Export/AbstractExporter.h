@@ -3,6 +3,7 @@
 
 #include <QString>
 
+class QTextBlock;
 class QTextDocument;
 
 namespace BusinessLogic
@@ -97,6 +98,18 @@ namespace BusinessLogic
 		static QTextDocument* prepareDocument(const ScenarioDocument* _scenario,
 			const ExportParameters& _exportParameters);
 
+	protected:
+		/**
+		 * @brief Нужно ли выводить заданный блок сценария
+		 */
+		static bool needExportBlock(const QTextBlock& _block, const ExportParameters& _exportParameters);
+
+		/**
+		 * @brief Текст блока сценария в том виде, в котором он выводится
+		 * @note Для блоков "Время и место" добавляется приставка и номер сцены, если нужно
+		 */
+		static QString exportBlockText(const QTextBlock& _block, const ExportParameters& _exportParameters);
+
 	public:
 		virtual ~AbstractExporter() {}
 
@@ -104,6 +117,19 @@ namespace BusinessLogic
 		 * @brief Экспорт заданного документа в файл
 		 */
 		virtual void exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const = 0;
+
+		/**
+		 * @brief Экспорт в файл документа, заранее сформированного методом prepareDocument
+		 * @note Позволяет формировать документ один раз для экспорта в несколько форматов.
+		 *		 Экспортер может изменять сформированный документ, владение им остаётся у вызывающего
+		 */
+		virtual void exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+			const ExportParameters& _exportParameters) const = 0;
+
+		/**
+		 * @brief Нужен ли экспортеру сформированный документ
+		 */
+		virtual bool needPreparedDocument() const { return true; }
 	};
 }
 
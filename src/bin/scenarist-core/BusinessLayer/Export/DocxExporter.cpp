@@ -13,13 +13,12 @@
 
 #include <Domain/Scenario.h>
 
-#include <3rd_party/Helpers/TextEditHelper.h>
-
 #include <QTextDocument>
 #include <QTextCursor>
 #include <QTextBlock>
 #include <QFile>
 #include <QChar>
+#include <QXmlStreamWriter>
 
 using namespace BusinessLogic;
 
@@ -302,40 +301,52 @@ namespace {
 	}
 
 	/**
-	 * @brief Сформировать текст блока документа в зависимости от его стиля и оформления
+	 * @brief Записать фрагмент текста абзаца без дополнительного оформления
 	 */
-	static QString docxText(QMap<int, QStringList>& _comments, const QTextCursor& _cursor) {
-		QString documentXml;
+	static void writeDocxRun(QXmlStreamWriter& _writer, const QString& _text, bool _preserveSpaces = true) {
+		_writer.writeStartElement("w:r");
+		_writer.writeEmptyElement("w:rPr");
+		_writer.writeStartElement("w:t");
+		if (_preserveSpaces) {
+			_writer.writeAttribute("xml:space", "preserve");
+		}
+		_writer.writeCharacters(_text);
+		_writer.writeEndElement(); // w:t
+		_writer.writeEndElement(); // w:r
+	}
 
+	/**
+	 * @brief Записать текст блока документа в зависимости от его стиля и оформления
+	 */
+	static void writeDocxText(QXmlStreamWriter& _writer, QMap<int, QStringList>& _comments, const QTextBlock& _block) {
 		//
 		// Получим стиль параграфа
 		//
 		ScenarioBlockStyle::Type currentBlockType =
-				(ScenarioBlockStyle::Type)_cursor.blockFormat().property(ScenarioBlockStyle::PropertyType).toInt();
+				(ScenarioBlockStyle::Type)_block.blockFormat().property(ScenarioBlockStyle::PropertyType).toInt();
+
+		_writer.writeStartElement("w:p");
+		_writer.writeStartElement("w:pPr");
 
 		//
 		// Запишем параграф в документ
 		//
 		if (currentBlockType != ScenarioBlockStyle::Undefined) {
-			documentXml =
-				QString("<w:p><w:pPr><w:pStyle w:val=\"%1\"/>")
-				.arg(ScenarioBlockStyle::typeName(currentBlockType).toUpper().replace("_", ""));
+			_writer.writeEmptyElement("w:pStyle");
+			_writer.writeAttribute("w:val", ScenarioBlockStyle::typeName(currentBlockType).toUpper().replace("_", ""));
+			_writer.writeEmptyElement("w:rPr");
+			_writer.writeEndElement(); // w:pPr
 
 			//
 			//  ... текст абзаца
 			//
-			const QTextBlock block = _cursor.block();
-			const QString blockText = block.text();
-			documentXml.append("<w:rPr/></w:pPr>");
-			foreach (const QTextLayout::FormatRange& range, block.textFormats()) {
+			const QString blockText = _block.text();
+			foreach (const QTextLayout::FormatRange& range, _block.textFormats()) {
 				//
 				// ... стандартный для абзаца
 				//
 				if (range.format.boolProperty(ScenarioBlockStyle::PropertyIsReviewMark) == false) {
-					documentXml.append(
-						QString("<w:r><w:rPr/><w:t xml:space=\"preserve\">%2</w:t></w:r>")
-						.arg(TextEditHelper::toHtmlEscaped(blockText.mid(range.start, range.length)))
-						);
+					writeDocxRun(_writer, blockText.mid(range.start, range.length));
 				}
 				//
 				// ... нестандартный
@@ -348,7 +359,7 @@ namespace {
 					// Комментарий
 					//
 					if (hasComments
-						&& isCommentsRangeStart(block, range)) {
+						&& isCommentsRangeStart(_block, range)) {
 						const QStringList authors = range.format.property(ScenarioBlockStyle::PropertyCommentsAuthors).toStringList();
 						const QStringList dates = range.format.property(ScenarioBlockStyle::PropertyCommentsDates).toStringList();
 
@@ -361,27 +372,25 @@ namespace {
 											  << authors.at(commentIndex)
 											  << dates.at(commentIndex));
 
-							documentXml.append(
-								QString("<w:commentRangeStart w:id=\"%1\"/>").arg(lastCommentIndex));
+							_writer.writeEmptyElement("w:commentRangeStart");
+							_writer.writeAttribute("w:id", QString::number(lastCommentIndex));
 						}
 					}
-					documentXml.append("<w:r>");
-					documentXml.append("<w:rPr>");
+					_writer.writeStartElement("w:r");
+					_writer.writeStartElement("w:rPr");
 					//
 					// Заливка
 					//
 					if (!hasComments
 						&& range.format.hasProperty(QTextFormat::BackgroundBrush)) {
 						if (range.format.boolProperty(ScenarioBlockStyle::PropertyIsHighlight)) {
-							documentXml.append(
-										QString("<w:highlight w:val=\"%1\"/>")
-										// код цвета без решётки
-										.arg(Docx::highlightColorName(range.format.background().color())));
+							_writer.writeEmptyElement("w:highlight");
+							_writer.writeAttribute("w:val", Docx::highlightColorName(range.format.background().color()));
 						} else {
-							documentXml.append(
-										QString("<w:shd w:fill=\"%1\" w:val=\"clear\"/>")
-										// код цвета без решётки
-										.arg(range.format.background().color().name().mid(1)));
+							_writer.writeEmptyElement("w:shd");
+							// код цвета без решётки
+							_writer.writeAttribute("w:fill", range.format.background().color().name().mid(1));
+							_writer.writeAttribute("w:val", "clear");
 						}
 					}
 					//
@@ -389,60 +398,60 @@ namespace {
 					//
 					if (!hasComments
 						&& range.format.hasProperty(QTextFormat::ForegroundBrush)) {
-						documentXml.append(
-							QString("<w:color w:val=\"%1\"/>")
-									// код цвета без решётки
-									.arg(range.format.foreground().color().name().mid(1)));
+						_writer.writeEmptyElement("w:color");
+						// код цвета без решётки
+						_writer.writeAttribute("w:val", range.format.foreground().color().name().mid(1));
 					}
-					documentXml.append("</w:rPr>");
+					_writer.writeEndElement(); // w:rPr
 					//
 					// Сам текст
 					//
-					documentXml.append(
-						QString("<w:t xml:space=\"preserve\">%2</w:t>")
-						.arg(TextEditHelper::toHtmlEscaped(blockText.mid(range.start, range.length)))
-						);
-					documentXml.append("</w:r>");
+					_writer.writeStartElement("w:t");
+					_writer.writeAttribute("xml:space", "preserve");
+					_writer.writeCharacters(blockText.mid(range.start, range.length));
+					_writer.writeEndElement(); // w:t
+					_writer.writeEndElement(); // w:r
 					//
 					// Текст комментария
 					//
 					if (hasComments
-						&& isCommentsRangeEnd(block, range)) {
+						&& isCommentsRangeEnd(_block, range)) {
 						for (int commentIndex = lastCommentIndex - comments.size() + 1;
 							 commentIndex <= lastCommentIndex; ++commentIndex) {
-							documentXml.append(
-										QString("<w:commentRangeEnd w:id=\"%1\"/>"
-												"<w:r><w:rPr/><w:commentReference w:id=\"%1\"/></w:r>")
-										.arg(commentIndex));
+							_writer.writeEmptyElement("w:commentRangeEnd");
+							_writer.writeAttribute("w:id", QString::number(commentIndex));
+							_writer.writeStartElement("w:r");
+							_writer.writeEmptyElement("w:rPr");
+							_writer.writeEmptyElement("w:commentReference");
+							_writer.writeAttribute("w:id", QString::number(commentIndex));
+							_writer.writeEndElement(); // w:r
 						}
 					}
 				}
 			}
-			//
-			// ... закрываем абзац
-			//
-			documentXml.append("</w:p>");
-
-
 		} else {
 			//
 			// ... настройки абзаца
 			//
-			documentXml = "<w:p><w:pPr><w:pStyle w:val=\"Normal\"/>";
-			switch (_cursor.blockFormat().alignment()) {
+			_writer.writeEmptyElement("w:pStyle");
+			_writer.writeAttribute("w:val", "Normal");
+			switch (_block.blockFormat().alignment()) {
 				case Qt::AlignCenter:
 				case Qt::AlignHCenter: {
-					documentXml.append("<w:jc w:val=\"center\"/>");
+					_writer.writeEmptyElement("w:jc");
+					_writer.writeAttribute("w:val", "center");
 					break;
 				}
 
 				case Qt::AlignRight: {
-					documentXml.append("<w:jc w:val=\"right\"/>");
+					_writer.writeEmptyElement("w:jc");
+					_writer.writeAttribute("w:val", "right");
 					break;
 				}
 
 				case Qt::AlignJustify: {
-					documentXml.append("<w:jc w:val=\"both\"/>");
+					_writer.writeEmptyElement("w:jc");
+					_writer.writeAttribute("w:val", "both");
 					break;
 				}
 
@@ -450,13 +459,16 @@ namespace {
 					break;
 				}
 			}
-			documentXml.append(
-				QString("<w:rPr/></w:pPr><w:r><w:rPr/><w:t>%1</w:t></w:r></w:p>")
-				.arg(TextEditHelper::toHtmlEscaped(_cursor.block().text()))
-				);
+			_writer.writeEmptyElement("w:rPr");
+			_writer.writeEndElement(); // w:pPr
+
+			writeDocxRun(_writer, _block.text(), false);
 		}
 
-		return documentXml;
+		//
+		// ... закрываем абзац
+		//
+		_writer.writeEndElement(); // w:p
 	}
 }
 
@@ -467,6 +479,28 @@ DocxExporter::DocxExporter() :
 
 void DocxExporter::exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const
 {
+	//
+	// Сформируем документ
+	//
+	QTextDocument* preparedDocument = prepareDocument(_scenario, _exportParameters);
+
+	//
+	// Записываем его
+	//
+	exportTo(_scenario, preparedDocument, _exportParameters);
+
+	//
+	// Освобождаем память
+	//
+	delete preparedDocument;
+	preparedDocument = 0;
+}
+
+void DocxExporter::exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+	const ExportParameters& _exportParameters) const
+{
+	Q_UNUSED(_scenario);
+
 	//
 	// Открываем документ на запись
 	//
@@ -502,7 +536,7 @@ void DocxExporter::exportTo(ScenarioDocument* _scenario, const ExportParameters&
 			// ... документ
 			//
 			QMap<int, QStringList> comments;
-			writeDocument(&zip, _scenario, comments, _exportParameters);
+			writeDocument(&zip, _preparedDocument, comments, _exportParameters);
 			//
 			// ... комментарии
 			//
@@ -744,26 +778,34 @@ void DocxExporter::writeFooter(QtZipWriter* _zip, const ExportParameters& _expor
 	}
 }
 
-void DocxExporter::writeDocument(QtZipWriter* _zip, ScenarioDocument* _scenario,
+void DocxExporter::writeDocument(QtZipWriter* _zip, QTextDocument* _preparedDocument,
 	QMap<int, QStringList>& _comments, const ExportParameters& _exportParameters) const
 {
-	QString documentXml =
-			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"yes\"?>"
-			"<w:document xmlns:o=\"urn:schemas-microsoft-com:office:office\" xmlns:r=\"http://schemas.openxmlformats.org/officeDocument/2006/relationships\" xmlns:v=\"urn:schemas-microsoft-com:vml\" xmlns:w=\"http://schemas.openxmlformats.org/wordprocessingml/2006/main\" xmlns:w10=\"urn:schemas-microsoft-com:office:word\" xmlns:wp=\"http://schemas.openxmlformats.org/drawingml/2006/wordprocessingDrawing\">"
-			"<w:body>";
-
-	//
-	// Сформируем документ
 	//
-	QTextDocument* preparedDocument = prepareDocument(_scenario, _exportParameters);
-
+	// Документ пишется сразу в архив, сжимаясь по мере записи, без промежуточной копии всего его текста
 	//
-	// Данные считываются из исходного документа, определяется тип блока
+	QIODevice* documentDevice = _zip->openFile(QString::fromLatin1("word/document.xml"));
+	if (documentDevice == 0) {
+		return;
+	}
+	QXmlStreamWriter writer(documentDevice);
+	writer.writeStartDocument("1.0", true);
+	writer.writeStartElement("w:document");
+	writer.writeAttribute("xmlns:o", "urn:schemas-microsoft-com:office:office");
+	writer.writeAttribute("xmlns:r", "http://schemas.openxmlformats.org/officeDocument/2006/relationships");
+	writer.writeAttribute("xmlns:v", "urn:schemas-microsoft-com:vml");
+	writer.writeAttribute("xmlns:w", "http://schemas.openxmlformats.org/wordprocessingml/2006/main");
+	writer.writeAttribute("xmlns:w10", "urn:schemas-microsoft-com:office:word");
+	writer.writeAttribute("xmlns:wp", "http://schemas.openxmlformats.org/drawingml/2006/wordprocessingDrawing");
+	writer.writeStartElement("w:body");
+
+	//
+	// Данные считываются из сформированного документа, определяется тип блока
 	// и записываются прямо в файл
 	//
-	QTextCursor documentCursor(preparedDocument);
+	QTextCursor documentCursor(_preparedDocument);
 	while (!documentCursor.atEnd()) {
-		documentXml.append(::docxText(_comments, documentCursor));
+		::writeDocxText(writer, _comments, documentCursor.block());
 
 		//
 		// Переходим к следующему параграфу
@@ -776,64 +818,62 @@ void DocxExporter::writeDocument(QtZipWriter* _zip, ScenarioDocument* _scenario,
 	// В конце идёт блок настроек страницы
 	//
 	ScenarioTemplate style = ::exportStyle();
-	documentXml.append("<w:sectPr>");
+	writer.writeStartElement("w:sectPr");
 	//
 	// ... колонтитулы
 	//
 	if (_exportParameters.printPagesNumbers) {
 		if (style.numberingAlignment().testFlag(Qt::AlignTop)) {
-			documentXml.append("<w:headerReference w:type=\"default\" r:id=\"docRId2\"/>");
+			writer.writeEmptyElement("w:headerReference");
+			writer.writeAttribute("w:type", "default");
+			writer.writeAttribute("r:id", "docRId2");
 		} else {
-			documentXml.append("<w:footerReference w:type=\"default\" r:id=\"docRId3\"/>");
+			writer.writeEmptyElement("w:footerReference");
+			writer.writeAttribute("w:type", "default");
+			writer.writeAttribute("r:id", "docRId3");
 		}
 	}
 	//
 	// ... размер страницы
 	//
 	QSizeF paperSize = QPageSize(style.pageSizeId()).size(QPageSize::Millimeter);
-	documentXml.append(
-		QString("<w:pgSz w:w=\"%1\" w:h=\"%2\"/>")
-		.arg(::mmToTwips(paperSize.width()))
-		.arg(::mmToTwips(paperSize.height()))
-		);
+	writer.writeEmptyElement("w:pgSz");
+	writer.writeAttribute("w:w", QString::number(::mmToTwips(paperSize.width())));
+	writer.writeAttribute("w:h", QString::number(::mmToTwips(paperSize.height())));
 	//
 	// ... поля документа
 	//
-	documentXml.append(
-		QString("<w:pgMar w:left=\"%1\" w:right=\"%2\" w:top=\"%3\" w:bottom=\"%4\" w:header=\"%5\" w:footer=\"%6\" w:gutter=\"0\"/>")
-		.arg(::mmToTwips(style.pageMargins().left()))
-		.arg(::mmToTwips(style.pageMargins().right()))
-		.arg(::mmToTwips(style.pageMargins().top()))
-		.arg(::mmToTwips(style.pageMargins().bottom()))
-		.arg(::mmToTwips(style.pageMargins().top() / 2))
-		.arg(::mmToTwips(style.pageMargins().bottom() / 2))
-		);
+	writer.writeEmptyElement("w:pgMar");
+	writer.writeAttribute("w:left", QString::number(::mmToTwips(style.pageMargins().left())));
+	writer.writeAttribute("w:right", QString::number(::mmToTwips(style.pageMargins().right())));
+	writer.writeAttribute("w:top", QString::number(::mmToTwips(style.pageMargins().top())));
+	writer.writeAttribute("w:bottom", QString::number(::mmToTwips(style.pageMargins().bottom())));
+	writer.writeAttribute("w:header", QString::number(::mmToTwips(style.pageMargins().top() / 2)));
+	writer.writeAttribute("w:footer", QString::number(::mmToTwips(style.pageMargins().bottom() / 2)));
+	writer.writeAttribute("w:gutter", "0");
 	//
 	// ... нужна ли титульная страница
 	//
 	if (_exportParameters.printTilte) {
-		documentXml.append("<w:titlePg/>");
+		writer.writeEmptyElement("w:titlePg");
 	}
 	//
 	// ... нумерация страниц
 	//
 	int pageNumbersStartFrom = _exportParameters.printTilte ? 0 : 1;
-	documentXml.append(
-		QString("<w:pgNumType w:fmt=\"decimal\" w:start=\"%1\"/>").arg(pageNumbersStartFrom));
+	writer.writeEmptyElement("w:pgNumType");
+	writer.writeAttribute("w:fmt", "decimal");
+	writer.writeAttribute("w:start", QString::number(pageNumbersStartFrom));
 	//
 	// ... конец блока настроек страницы
 	//
-	documentXml.append(
-			"<w:textDirection w:val=\"lrTb\"/>"
-		"</w:sectPr>"
-		);
-
-	documentXml.append("</w:body></w:document>");
+	writer.writeEmptyElement("w:textDirection");
+	writer.writeAttribute("w:val", "lrTb");
+	writer.writeEndElement(); // w:sectPr
 
-	//
-	// Запишем документ в архив
-	//
-	_zip->addFile(QString::fromLatin1("word/document.xml"), documentXml.toUtf8());
+	writer.writeEndElement(); // w:body
+	writer.writeEndDocument(); // w:document
+	documentDevice->close();
 }
 
 void DocxExporter::writeComments(QtZipWriter* _zip, const QMap<int, QStringList>& _comments) const
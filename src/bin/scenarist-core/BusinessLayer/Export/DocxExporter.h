@@ -7,6 +7,7 @@
 
 #include <QString>
 
+class QTextDocument;
 class QtZipWriter;
 
 
@@ -25,6 +26,12 @@ namespace BusinessLogic
 		 */
 		void exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const;
 
+		/**
+		 * @brief Экспорт заранее сформированного документа в указанный файл
+		 */
+		void exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+			const ExportParameters& _exportParameters) const;
+
 	private:
 		/**
 		 * @brief Записать все статичные данные в файл
@@ -54,7 +61,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Записать документ
 		 */
-		void writeDocument(QtZipWriter* _zip, ScenarioDocument* _scenario,
+		void writeDocument(QtZipWriter* _zip, QTextDocument* _preparedDocument,
 			QMap<int, QStringList>& _comments, const ExportParameters& _exportParameters) const;
 
 		/**
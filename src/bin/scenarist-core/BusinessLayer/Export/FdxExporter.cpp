@@ -10,7 +10,6 @@
 
 #include <QFile>
 #include <QTextBlock>
-#include <QTextCursor>
 #include <QXmlStreamWriter>
 
 using namespace BusinessLogic;
@@ -68,6 +67,19 @@ void FdxExporter::exportTo(ScenarioDocument* _scenario, const ExportParameters&
 	}
 }
 
+void FdxExporter::exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+	const ExportParameters& _exportParameters) const
+{
+	Q_UNUSED(_preparedDocument);
+
+	exportTo(_scenario, _exportParameters);
+}
+
+bool FdxExporter::needPreparedDocument() const
+{
+	return false;
+}
+
 void FdxExporter::writeContent(QXmlStreamWriter& _writer, ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const
 {
 	_writer.writeStartElement("Content");
@@ -77,21 +89,18 @@ void FdxExporter::writeContent(QXmlStreamWriter& _writer, ScenarioDocument* _sce
 	//
 	ExportParameters fakeParameters;
 
-	//
-	// Сформируем документ
-	//
-	QTextDocument* preparedDocument = prepareDocument(_scenario, fakeParameters);
-
 	//
 	// Данные считываются из исходного документа, определяется тип блока
-	// и записываются прямо в файл
+	// и записываются прямо в файл. Разбивка на страницы в FDX не нужна, поэтому
+	// промежуточный документ для экспорта не формируется
 	//
-	QTextCursor documentCursor(preparedDocument);
-	while (!documentCursor.atEnd()) {
-		if (!documentCursor.block().text().isEmpty()) {
+	QTextBlock block = _scenario->document()->begin();
+	while (block.isValid()) {
+		if (needExportBlock(block, fakeParameters)
+			&& !block.text().isEmpty()) {
 			QString paragraphType;
 			QString sceneNumber;
-			switch (ScenarioBlockStyle::forBlock(documentCursor.block())) {
+			switch (ScenarioBlockStyle::forBlock(block)) {
 				case ScenarioBlockStyle::SceneHeading: {
 					paragraphType = "Scene Heading";
 
@@ -99,7 +108,7 @@ void FdxExporter::writeContent(QXmlStreamWriter& _writer, ScenarioDocument* _sce
 					// ... если надо, то выводим номера сцен
 					//
 					if (_exportParameters.printScenesNumbers) {
-						if (ScenarioTextBlockInfo* sceneInfo = dynamic_cast<ScenarioTextBlockInfo*>(documentCursor.block().userData())) {
+						if (ScenarioTextBlockInfo* sceneInfo = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
 							sceneNumber = QString::number(sceneInfo->sceneNumber());
 						}
 					}
@@ -158,15 +167,14 @@ void FdxExporter::writeContent(QXmlStreamWriter& _writer, ScenarioDocument* _sce
 				_writer.writeAttribute("Number", sceneNumber);
 			}
 			_writer.writeAttribute("Type", paragraphType);
-			_writer.writeTextElement("Text", documentCursor.block().text());
+			_writer.writeTextElement("Text", exportBlockText(block, fakeParameters));
 			_writer.writeEndElement(); // Paragraph
 		}
 
 		//
 		// Переходим к следующему параграфу
 		//
-		documentCursor.movePosition(QTextCursor::EndOfBlock);
-		documentCursor.movePosition(QTextCursor::NextBlock);
+		block = block.next();
 	}
 
 	_writer.writeEndElement(); // Content
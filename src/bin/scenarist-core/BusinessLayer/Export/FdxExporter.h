@@ -23,6 +23,17 @@ namespace BusinessLogic
 		 */
 		void exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const;
 
+		/**
+		 * @brief Экспорт в указанный файл, текст берётся из самого сценария
+		 */
+		void exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+			const ExportParameters& _exportParameters) const;
+
+		/**
+		 * @brief Сформированный документ не нужен, т.к. страницы в FDX не размечаются
+		 */
+		bool needPreparedDocument() const;
+
 	private:
 		/**
 		 * @brief Записать текст сценария
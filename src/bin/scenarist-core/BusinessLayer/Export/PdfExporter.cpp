@@ -262,30 +262,49 @@ PdfExporter::PdfExporter(QObject* _parent) :
 
 void PdfExporter::exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const
 {
+	//
+	// Сформируем документ
+	//
+	QTextDocument* preparedDocument = prepareDocument(_scenario, _exportParameters);
+
+	//
+	// Печатаем его
+	//
+	exportTo(_scenario, preparedDocument, _exportParameters);
+
+	//
+	// Освобождаем память
+	//
+	delete preparedDocument;
+	preparedDocument = 0;
+}
+
+void PdfExporter::exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+	const ExportParameters& _exportParameters) const
+{
+	Q_UNUSED(_scenario);
+
 	//
 	// Настроим принтер
 	//
 	QPrinter* printer = preparePrinter(_exportParameters.filePath);
 
 	//
-	// Сформируем документ
+	// Настроим документ
 	//
-	QTextDocument* preparedDocument = prepareDocument(_scenario, _exportParameters);
-	preparedDocument->setProperty(PRINT_TITLE_KEY, _exportParameters.printTilte);
-	preparedDocument->setProperty(PRINT_PAGE_NUMBERS_KEY, _exportParameters.printPagesNumbers);
+	_preparedDocument->setProperty(PRINT_TITLE_KEY, _exportParameters.printTilte);
+	_preparedDocument->setProperty(PRINT_PAGE_NUMBERS_KEY, _exportParameters.printPagesNumbers);
 
 	//
 	// Печатаем документ
 	//
-	::printDocument(preparedDocument, printer);
+	::printDocument(_preparedDocument, printer);
 
 	//
 	// Освобождаем память
 	//
 	delete printer;
 	printer = 0;
-	delete preparedDocument;
-	preparedDocument = 0;
 }
 
 void PdfExporter::printPreview(ScenarioDocument* _scenario, const ExportParameters& _exportParameters)
@@ -30,6 +30,12 @@ namespace BusinessLogic
 		 */
 		void exportTo(ScenarioDocument* _scenario, const ExportParameters& _exportParameters) const;
 
+		/**
+		 * @brief Экспорт заранее сформированного документа в указанный файл
+		 */
+		void exportTo(ScenarioDocument* _scenario, QTextDocument* _preparedDocument,
+			const ExportParameters& _exportParameters) const;
+
 		/**
 		 * @brief Предварительный просмотр и печать
 		 */
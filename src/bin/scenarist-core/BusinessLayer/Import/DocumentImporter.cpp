@@ -9,6 +9,7 @@
 
 #include <3rd_party/Widgets/PagesTextEdit/PageMetrics.h>
 
+#include <QDebug>
 #include <QRegularExpression>
 #include <QTextBlock>
 #include <QTextCursor>
@@ -261,6 +262,18 @@ QString DocumentImporter::importScenario(const ImportParameters& _importParamete
 	FormatReader* reader = FormatManager::createReader(&documentFile);
 	reader->read(&documentFile, &documentForImport);
 
+	//
+	// Повреждённый документ не импортируем, чтобы не подменить сценарий его обрывком
+	//
+	const bool hasError = reader->hasError();
+	if (hasError) {
+		qWarning() << "Can't import" << _importParameters.filePath << ":" << reader->errorString();
+	}
+	delete reader;
+	if (hasError) {
+		return QString();
+	}
+
 	//
 	// Найти минимальный отступ слева для всех блоков
 	// ЗАЧЕМ: во многих программах (Final Draft, Screeviner) сделано так, что поля
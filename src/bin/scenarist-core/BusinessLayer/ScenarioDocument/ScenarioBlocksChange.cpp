@@ -0,0 +1,49 @@
+#include "ScenarioBlocksChange.h"
+
+using BusinessLogic::ScenarioBlocksChange;
+
+
+ScenarioBlocksChange::ScenarioBlocksChange() :
+	position(-1)
+{
+}
+
+bool ScenarioBlocksChange::isEmpty() const
+{
+	return removedBlocks == insertedBlocks;
+}
+
+ScenarioBlocksChange ScenarioBlocksChange::reversed() const
+{
+	ScenarioBlocksChange change;
+	change.position = position;
+	change.removedBlocks = insertedBlocks;
+	change.insertedBlocks = removedBlocks;
+	return change;
+}
+
+void ScenarioBlocksChange::trim()
+{
+	//
+	// Совпадающие блоки в начале
+	//
+	int prefixSize = 0;
+	while (prefixSize < removedBlocks.size() - 1
+		   && prefixSize < insertedBlocks.size() - 1
+		   && removedBlocks.at(prefixSize) == insertedBlocks.at(prefixSize)) {
+		++prefixSize;
+	}
+	removedBlocks.remove(0, prefixSize);
+	insertedBlocks.remove(0, prefixSize);
+	position += prefixSize;
+
+	//
+	// Совпадающие блоки в конце
+	//
+	while (removedBlocks.size() > 1
+		   && insertedBlocks.size() > 1
+		   && removedBlocks.last() == insertedBlocks.last()) {
+		removedBlocks.removeLast();
+		insertedBlocks.removeLast();
+	}
+}
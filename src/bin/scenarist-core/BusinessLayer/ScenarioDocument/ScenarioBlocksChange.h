@@ -0,0 +1,56 @@
+#ifndef SCENARIOBLOCKSCHANGE_H
+#define SCENARIOBLOCKSCHANGE_H
+
+#include <QString>
+#include <QVector>
+
+
+namespace BusinessLogic
+{
+	/**
+	 * @brief Изменение текста сценария с точностью до блоков
+	 *
+	 * Блоки [position, position + removedBlocks.size()) заменяются на блоки insertedBlocks.
+	 * Блоки не имеют собственных идентификаторов, поэтому адресуются по номеру в документе
+	 */
+	class ScenarioBlocksChange
+	{
+	public:
+		ScenarioBlocksChange();
+
+		/**
+		 * @brief Изменение ничего не меняет
+		 */
+		bool isEmpty() const;
+
+		/**
+		 * @brief Получить обратное изменение
+		 */
+		ScenarioBlocksChange reversed() const;
+
+		/**
+		 * @brief Убрать совпадающие блоки в начале и в конце изменения
+		 * @note С каждой стороны остаётся хотя бы по одному блоку, чтобы изменение можно было
+		 *		 применить заменой существующих блоков
+		 */
+		void trim();
+
+	public:
+		/**
+		 * @brief Номер первого изменяемого блока
+		 */
+		int position;
+
+		/**
+		 * @brief Xml удаляемых блоков
+		 */
+		QVector<QString> removedBlocks;
+
+		/**
+		 * @brief Xml вставляемых блоков
+		 */
+		QVector<QString> insertedBlocks;
+	};
+}
+
+#endif // SCENARIOBLOCKSCHANGE_H
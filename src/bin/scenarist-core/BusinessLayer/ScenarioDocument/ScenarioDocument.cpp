@@ -4,6 +4,7 @@
 #include "ScenarioTextDocument.h"
 #include "ScenarioModel.h"
 #include "ScenarioModelItem.h"
+#include "ScenarioStructureBuilder.h"
 #include "ScenarioTemplate.h"
 #include "ScenarioTextBlockInfo.h"
 #include "ScenarioTextBlockParsers.h"
@@ -13,7 +14,6 @@
 
 #include <Domain/Scenario.h>
 
-#include <QCryptographicHash>
 #include <QRegularExpression>
 #include <QTextDocument>
 #include <QTextCursor>
@@ -22,6 +22,13 @@
 
 using namespace BusinessLogic;
 
+namespace {
+	/**
+	 * @brief Количество вставленных блоков, начиная с которого структура перестраивается в фоне
+	 */
+	const int BACKGROUND_REBUILD_BLOCKS_COUNT = 500;
+}
+
 
 QString ScenarioDocument::MIME_TYPE = "application/x-scenarist/scenario";
 
@@ -31,10 +38,17 @@ ScenarioDocument::ScenarioDocument(QObject* _parent) :
 	m_xmlHandler(new ScenarioXml(this)),
 	m_document(new ScenarioTextDocument(this, m_xmlHandler)),
 	m_model(new ScenarioModel(this, m_xmlHandler)),
+	m_structureBuilder(new ScenarioStructureBuilder(this)),
+	m_canRebuildStructureInBackground(true),
+	m_isStructureRebuilding(false),
+	m_isStructureRebuildOutdated(false),
 	m_inSceneDescriptionUpdate(false),
 	m_lastChangeStartPosition(0)
 {
 	initConnections();
+
+	connect(m_structureBuilder, &ScenarioStructureBuilder::progressChanged, this, &ScenarioDocument::structureRebuildProgress);
+	connect(m_structureBuilder, &ScenarioStructureBuilder::finished, this, &ScenarioDocument::aboutStructureRebuilt);
 }
 
 ScenarioTextDocument* ScenarioDocument::document() const
@@ -60,30 +74,20 @@ qreal ScenarioDocument::durationAtPosition(int _position) const
 		//
 		// Определим сцену, в которой находится курсор
 		//
-		QMap<int, ScenarioModelItem*>::const_iterator iter = m_modelItems.lowerBound(_position);
-		if (iter == m_modelItems.end()
-			|| (iter.key() > _position
-				&& iter != m_modelItems.begin())) {
-			--iter;
+		ScenarioModelItem* item = m_modelItems.floor(_position);
+		if (item == 0) {
+			item = m_modelItems.first();
 		}
 
 		//
 		// Запомним позицию начала сцены
 		//
-		int startPositionInLastScene = iter.key();
+		int startPositionInLastScene = item->position();
 
 		//
 		// Посчитаем хронометраж всех предыдущих сцен
 		//
-		if (iter.value()->type() == ScenarioModelItem::Scene) {
-			iter.value()->duration();
-		}
-		while (iter != m_modelItems.begin()) {
-			--iter;
-			if (iter.value()->type() == ScenarioModelItem::Scene) {
-				duration += iter.value()->duration();
-			}
-		}
+		duration += m_modelItems.durationBefore(item);
 
 		//
 		// Добавим к суммарному хрономертажу хронометраж от начала сцены
@@ -292,7 +296,7 @@ void ScenarioDocument::setItemDescriptionAtPosition(int _position, const QString
 			// Обновить описание внутри текста
 			//
 			cursor.beginEditBlock();
-			ScenarioBlockStyle descriptionBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::SceneDescription);
+			const ScenarioBlockStyle& descriptionBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::SceneDescription);
 			cursor.movePosition(QTextCursor::NextBlock);
 			if (ScenarioBlockStyle::forBlock(cursor.block()) == ScenarioBlockStyle::SceneCharacters) {
 				cursor.movePosition(QTextCursor::NextBlock);
@@ -433,7 +437,7 @@ int ScenarioDocument::positionToInsertMime(ScenarioModelItem* _insertParent, Sce
 	// Если необходимо вставить перед заданным элементом
 	//
 	if (_insertBefore != 0) {
-		int insertBeforeItemStartPos = m_modelItems.key(_insertBefore);
+		int insertBeforeItemStartPos = _insertBefore->position();
 
 		//
 		// Шаг назад
@@ -485,17 +489,17 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 	//
 	// Сохраняем изменённый xml и его хэш
 	//
-	m_document->updateScenarioXml();
+	m_document->updateScenarioXml(_position, _charsRemoved, _charsAdded);
 
 	//
 	// Прерываем ситуацию с ложным срабатыванием изменения документа
 	//
-	const QByteArray currentTextMd5Hash = m_document->scenarioXmlHash();
+	const QByteArray currentTextHash = m_document->scenarioXmlHash();
 	if (_charsRemoved == _charsAdded) {
 		//
 		// ... на самом ли деле текст изменился?
 		//
-		if (currentTextMd5Hash == m_lastTextMd5Hash) {
+		if (currentTextHash == m_lastTextHash) {
 			return;
 		}
 	}
@@ -503,13 +507,38 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 	//
 	// Сохранить md5 хэш текста документа
 	//
-	m_lastTextMd5Hash = currentTextMd5Hash;
+	m_lastTextHash = currentTextHash;
 
 	//
 	// Сохраняем позицию начала правок для последующей корректировки
 	//
 	m_lastChangeStartPosition = _position;
 
+	if (m_canRebuildStructureInBackground) {
+		//
+		// Если структура перестраивается в фоне, то изменение будет учтено после завершения,
+		// а до тех пор только смещаем позиции элементов, чтобы навигатор не расходился с текстом
+		//
+		if (m_isStructureRebuilding) {
+			m_isStructureRebuildOutdated = true;
+			shiftItemsWhileRebuilding(_position, _charsRemoved, _charsAdded);
+			return;
+		}
+
+		//
+		// Большие вставки (вставка большого фрагмента, применение патчей) разбираем в фоне,
+		// чтобы не блокировать интерфейс на время построения структуры
+		//
+		const int blocksAdded =
+				m_document->findBlock(_position + _charsAdded).blockNumber()
+				- m_document->findBlock(_position).blockNumber();
+		if (blocksAdded >= BACKGROUND_REBUILD_BLOCKS_COUNT) {
+			shiftItemsWhileRebuilding(_position, _charsRemoved, _charsAdded);
+			rebuildStructureInBackground();
+			return;
+		}
+	}
+
 	//
 	// Если были удалены данные
 	//
@@ -530,42 +559,35 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 		// Удаляем элементы начиная с того, который находится под курсором, если курсор в начале
 		// строки, или со следующего за курсором, если курсор не в начале строки
 		//
-		QMap<int, ScenarioModelItem*>::iterator iter = m_modelItems.lowerBound(position);
+		ScenarioModelItem* itemToDelete = m_modelItems.lowerBound(position);
 		const int charsAddedDelta = _charsAdded - _charsRemoved;
 		const int charsRemovedDelta = _charsRemoved - _charsAdded;
-		while (iter != m_modelItems.end()
-			   && iter.key() >= position
-			   && iter.key() < (position + _charsRemoved)) {
+		while (itemToDelete != 0
+			   && itemToDelete->position() < (position + _charsRemoved)) {
 			//
-			// Элемент для удаления
+			// Расширяем диапозон последующего построения дерева, для включения в него всех
+			// кто был удалён тут по причине не самого оптимального алгоритма
 			//
-			ScenarioModelItem* itemToDelete = iter.value();
-
-			if (itemToDelete != 0) {
-				//
-				// Расширяем диапозон последующего построения дерева, для включения в него всех
-				// кто был удалён тут по причине не самого оптимального алгоритма
-				//
-				if (itemToDelete->hasChildren()) {
-					const int charsModified = itemToDelete->endPosition() - position;
-					if (_charsAdded < charsModified + charsAddedDelta) {
-						_charsAdded = charsModified + charsAddedDelta;
-					}
-					if (_charsRemoved < charsModified - charsRemovedDelta) {
-						_charsRemoved = charsModified - charsRemovedDelta;
-					}
+			if (itemToDelete->hasChildren()) {
+				const int charsModified = itemToDelete->endPosition() - position;
+				if (_charsAdded < charsModified + charsAddedDelta) {
+					_charsAdded = charsModified + charsAddedDelta;
+				}
+				if (_charsRemoved < charsModified - charsRemovedDelta) {
+					_charsRemoved = charsModified - charsRemovedDelta;
 				}
-
-				//
-				// Удалим элемент из модели
-				//
-				m_model->removeItem(iter.value());
 			}
 
+			//
+			// Удалим элемент из модели
+			//
+			m_model->removeItem(itemToDelete);
+
 			//
 			// Удалим элемент из кэша
 			//
-			iter = m_modelItems.erase(iter);
+			m_modelItems.remove(itemToDelete);
+			itemToDelete = m_modelItems.lowerBound(position);
 		}
 	}
 
@@ -597,28 +619,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 			}
 		}
 
-		QMutableMapIterator<int, ScenarioModelItem*> removeIter(m_modelItems);
-		QMap<int, ScenarioModelItem*> updatedItems;
-		//
-		// Изымаем элементы из хэша и формируем обновлённый список
-		//
-		while (removeIter.hasNext()) {
-			removeIter.next();
-			if (removeIter.key() >= position) {
-				ScenarioModelItem* item = removeIter.value();
-				item->setPosition(removeIter.key() - _charsRemoved + _charsAdded);
-				updatedItems.insert(item->position(), item);
-				removeIter.remove();
-			}
-		}
-		//
-		// Переносим элементы из обновлённого списка в хэш
-		//
-		QMapIterator<int, ScenarioModelItem*> updateIter(updatedItems);
-		while (updateIter.hasNext()) {
-			updateIter.next();
-			m_modelItems.insert(updateIter.key(), updateIter.value());
-		}
+		m_modelItems.shift(position, _charsAdded - _charsRemoved);
 	}
 
 	//
@@ -629,10 +630,9 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 		// получить первый блок и обновить/создать его
 		// идти по документу, до конца вставленных символов и добавлять блоки
 		//
-		QMap<int, ScenarioModelItem*>::iterator iter = m_modelItems.lowerBound(_position);
-		if (iter != m_modelItems.begin()
-			&& iter.key() > _position) {
-			--iter;
+		ScenarioModelItem* item = m_modelItems.floor(_position);
+		if (item == 0) {
+			item = m_modelItems.first();
 		}
 
 		//
@@ -645,7 +645,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 		//
 		// Если в документе нет ни одного элемента, создадим первый
 		//
-		if (iter == m_modelItems.end()) {
+		if (item == 0) {
 			currentItem = itemForPosition(0);
 			m_model->addItem(currentItem);
 			m_modelItems.insert(0, currentItem);
@@ -653,7 +653,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 		//
 		// Или если вставляется новый элемент в начале текста
 		//
-		else if (_position == 0 && iter == m_modelItems.begin() && iter.key() > 0) {
+		else if (_position == 0 && item == m_modelItems.first() && item->position() > 0) {
 			currentItem = itemForPosition(0);
 			m_model->prependItem(currentItem);
 			m_modelItems.insert(0, currentItem);
@@ -662,8 +662,8 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 		// В противном случае получим необходимый к обновлению элемент
 		//
 		else {
-			currentItem = iter.value();
-			currentItemStartPos = iter.key();
+			currentItem = item;
+			currentItemStartPos = item->position();
 		}
 
 		//
@@ -688,10 +688,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 				currentType = ScenarioBlockStyle::forBlock(cursor.block());
 			} while (!cursor.atEnd()
 					 && currentType != ScenarioBlockStyle::SceneHeading
-					 && currentType != ScenarioBlockStyle::SceneGroupHeader
-					 && currentType != ScenarioBlockStyle::SceneGroupFooter
-					 && currentType != ScenarioBlockStyle::FolderHeader
-					 && currentType != ScenarioBlockStyle::FolderFooter);
+					 && !ScenarioBlockStyle::isEmbeddable(currentType));
 
 			//
 			// Тип следующего за элементом блока
@@ -703,10 +700,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 			//
 			if (!cursor.atEnd()
 				|| currentType == ScenarioBlockStyle::SceneHeading
-				|| currentType == ScenarioBlockStyle::SceneGroupHeader
-				|| currentType == ScenarioBlockStyle::SceneGroupFooter
-				|| currentType == ScenarioBlockStyle::FolderHeader
-				|| currentType == ScenarioBlockStyle::FolderFooter) {
+				|| ScenarioBlockStyle::isEmbeddable(currentType)) {
 				nextBlockType = currentType;
 				cursor.movePosition(QTextCursor::PreviousBlock);
 				cursor.movePosition(QTextCursor::EndOfBlock);
@@ -727,8 +721,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 			// ... если текущий элемент является группирующим, то нужно включить
 			//     и все входящие в него группирующие элементы
 			//
-			if (currentType == ScenarioBlockStyle::SceneGroupHeader
-				|| currentType == ScenarioBlockStyle::FolderHeader) {
+			if (ScenarioBlockStyle::isEmbeddableHeader(currentType)) {
 				int openedScenesGroups = currentType == ScenarioBlockStyle::SceneGroupHeader ? 1 : 0;
 				int openedFolders = currentType == ScenarioBlockStyle::FolderHeader ? 1 : 0;
 				QTextCursor endCursor = cursor;
@@ -767,8 +760,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 			//
 			// ... или как минимум его закрывающий блок
 			//
-			else if (currentType == ScenarioBlockStyle::SceneGroupFooter
-					   || currentType == ScenarioBlockStyle::FolderFooter) {
+			else if (ScenarioBlockStyle::isEmbeddableFooter(currentType)) {
 				QTextCursor endCursor = cursor;
 				endCursor.movePosition(QTextCursor::NextBlock);
 				endCursor.movePosition(QTextCursor::EndOfBlock);
@@ -782,8 +774,7 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 				QTextCursor cursorForCheck(m_document);
 				cursorForCheck.setPosition(currentItemStartPos);
 				ScenarioBlockStyle::Type checkType = ScenarioBlockStyle::forBlock(cursorForCheck.block());
-				if (checkType != ScenarioBlockStyle::SceneGroupFooter
-					&& checkType != ScenarioBlockStyle::FolderFooter) {
+				if (!ScenarioBlockStyle::isEmbeddableFooter(checkType)) {
 					updateItem(currentItem, currentItemStartPos, currentItemEndPos);
 					m_model->updateItem(currentItem);
 				}
@@ -904,6 +895,81 @@ void ScenarioDocument::aboutContentsChange(int _position, int _charsRemoved, int
 	updateDocumentScenesNumbers();
 }
 
+void ScenarioDocument::aboutStructureRebuilt()
+{
+	//
+	// Если за время построения документ изменился, то перестраиваем заново
+	//
+	if (m_isStructureRebuildOutdated) {
+		rebuildStructureInBackground();
+		return;
+	}
+
+	m_isStructureRebuilding = false;
+
+	//
+	// Создаём элементы, родители в результате всегда идут раньше своих детей
+	//
+	const QList<ScenarioStructureBuilder::ItemInfo> itemsInfo = m_structureBuilder->result();
+	QVector<ScenarioModelItem*> items(itemsInfo.size(), 0);
+	m_modelItems.clear();
+	for (int itemIndex = 0; itemIndex < itemsInfo.size(); ++itemIndex) {
+		const ScenarioStructureBuilder::ItemInfo& itemInfo = itemsInfo.at(itemIndex);
+		ScenarioModelItem* item = itemForPosition(itemInfo.position);
+		item->setType(itemInfo.type);
+		item->setHeader(itemInfo.header);
+		item->setColors(itemInfo.colors);
+		item->setTitle(itemInfo.title);
+		item->setText(itemInfo.text);
+		item->setDescription(itemInfo.description);
+		item->setDuration(itemInfo.duration);
+		item->setHasNote(itemInfo.hasNote);
+		item->setCounter(itemInfo.counter);
+		item->setFooter(itemInfo.footer);
+
+		//
+		// Описание, набранное прямо в тексте, сохраняем в блоке заголовка, как при пошаговом обновлении
+		//
+		if (!m_inSceneDescriptionUpdate
+			&& !itemInfo.description.isEmpty()) {
+			QTextBlock headerBlock = m_document->findBlock(itemInfo.position);
+			ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(headerBlock.userData());
+			if (info == 0) {
+				info = new ScenarioTextBlockInfo;
+			}
+			QTextDocument doc;
+			doc.setPlainText(itemInfo.description);
+			info->setDescription(doc.toHtml());
+			headerBlock.setUserData(info);
+		}
+
+		items[itemIndex] = item;
+		m_modelItems.insert(itemInfo.position, item);
+	}
+
+	//
+	// Собираем дерево с конца, чтобы к моменту обработки группы все её дети были уже вложены
+	// и посчитаны
+	//
+	QList<ScenarioModelItem*> topLevelItems;
+	for (int itemIndex = items.size() - 1; itemIndex >= 0; --itemIndex) {
+		ScenarioModelItem* item = items.at(itemIndex);
+		if (item->hasChildren()) {
+			item->updateFromChildren();
+		}
+
+		const int parentIndex = itemsInfo.at(itemIndex).parentIndex;
+		if (parentIndex != -1) {
+			items.at(parentIndex)->prependItem(item);
+		} else {
+			topLevelItems.prepend(item);
+		}
+	}
+	m_model->resetItems(topLevelItems);
+
+	updateDocumentScenesNumbers();
+}
+
 void ScenarioDocument::initConnections()
 {
 	connect(m_document, &ScenarioTextDocument::contentsChange, this, &ScenarioDocument::aboutContentsChange);
@@ -914,6 +980,34 @@ void ScenarioDocument::removeConnections()
 	disconnect(m_document, &ScenarioTextDocument::contentsChange, this, &ScenarioDocument::aboutContentsChange);
 }
 
+void ScenarioDocument::rebuildStructureInBackground()
+{
+	m_isStructureRebuilding = true;
+	m_isStructureRebuildOutdated = false;
+	m_structureBuilder->start(m_document);
+}
+
+void ScenarioDocument::shiftItemsWhileRebuilding(int _position, int _charsRemoved, int _charsAdded)
+{
+	//
+	// Элементы, начинавшиеся в удалённом тексте, убираем из индекса, чтобы смещение
+	// последующих не нарушило порядок позиций
+	//
+	if (_charsRemoved > 0) {
+		ScenarioModelItem* itemToRemove = m_modelItems.lowerBound(_position);
+		while (itemToRemove != 0
+			   && itemToRemove->position() < _position + _charsRemoved) {
+			m_modelItems.remove(itemToRemove);
+			itemToRemove = m_modelItems.lowerBound(_position);
+		}
+	}
+
+	//
+	// Остальные элементы после правки смещаем на разницу вставленных и удалённых символов
+	//
+	m_modelItems.shift(_position + _charsRemoved, _charsAdded - _charsRemoved);
+}
+
 void ScenarioDocument::updateItem(ScenarioModelItem* _item, int _itemStartPos, int _itemEndPos)
 {
 	//
@@ -1039,7 +1133,7 @@ void ScenarioDocument::updateItem(ScenarioModelItem* _item, int _itemStartPos, i
 						itemText = "";
 						isFirstTextBlock = false;
 					}
-					ScenarioBlockStyle blockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(blockType);
+					const ScenarioBlockStyle& blockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(blockType);
 					itemText +=
 							blockStyle.charFormat().fontCapitalization() == QFont::AllUppercase
 							? cursor.block().text().toUpper()
@@ -1116,23 +1210,19 @@ void ScenarioDocument::updateItem(ScenarioModelItem* _item, int _itemStartPos, i
 
 ScenarioModelItem* ScenarioDocument::itemForPosition(int _position, bool _findNear) const
 {
-	ScenarioModelItem* item = m_modelItems.value(_position, 0);
+	ScenarioModelItem* item = m_modelItems.item(_position);
 	if (item == 0) {
 		//
 		// Если необходимо ищем ближайшего
 		//
 		if (_findNear) {
-			QMap<int, ScenarioModelItem*>::const_iterator i = m_modelItems.lowerBound(_position);
-			if (i != m_modelItems.begin()
-				|| i != m_modelItems.end()) {
-				if (i != m_modelItems.begin()) {
-					--i;
-				}
-				item = i.value();
-			} else {
-				//
-				// не найден, т.к. в модели нет элементов
-				//
+			item = m_modelItems.floor(_position);
+			//
+			// ... если позиция раньше всех элементов, то берём первый, а если элементов нет,
+			//     то элемент не будет найден
+			//
+			if (item == 0) {
+				item = m_modelItems.first();
 			}
 		}
 		//
@@ -1185,6 +1275,14 @@ void ScenarioDocument::load(const QString& _scenario)
 	//
 	removeConnections();
 
+	//
+	// Отменяем фоновое построение структуры, т.к. она будет построена заново при загрузке
+	//
+	m_structureBuilder->cancel();
+	m_isStructureRebuilding = false;
+	m_isStructureRebuildOutdated = false;
+	m_canRebuildStructureInBackground = false;
+
 	//
 	// Очищаем модель и документ
 	//
@@ -1201,6 +1299,8 @@ void ScenarioDocument::load(const QString& _scenario)
 		aboutContentsChange(0, 0, m_document->characterCount());
 	}
 
+	m_canRebuildStructureInBackground = true;
+
 	//
 	// Подключаем необходимые сигналы
 	//
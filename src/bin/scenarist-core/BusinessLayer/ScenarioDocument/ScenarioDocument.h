@@ -1,6 +1,8 @@
 #ifndef SCENARIODOCUMENT_H
 #define SCENARIODOCUMENT_H
 
+#include "ScenarioModelItemsIndex.h"
+
 #include <QObject>
 #include <QMap>
 #include <QUuid>
@@ -18,6 +20,7 @@ namespace BusinessLogic
 	class ScenarioTextDocument;
 	class ScenarioModel;
 	class ScenarioModelItem;
+	class ScenarioStructureBuilder;
 
 
 	/**
@@ -185,12 +188,23 @@ namespace BusinessLogic
 		int positionToInsertMime(ScenarioModelItem* _insertParent, ScenarioModelItem* _insertBefore) const;
 		/** @} */
 
+	signals:
+		/**
+		 * @brief Изменился прогресс фонового построения структуры, в процентах
+		 */
+		void structureRebuildProgress(int _progress);
+
 	private slots:
 		/**
 		 * @brief Изменилось содержимое документа
 		 */
 		void aboutContentsChange(int _position, int _charsRemoved, int _charsAdded);
 
+		/**
+		 * @brief Завершилось фоновое построение структуры
+		 */
+		void aboutStructureRebuilt();
+
 	private:
 		/**
 		 * @brief Настроить необходимые соединения
@@ -207,6 +221,18 @@ namespace BusinessLogic
 		 */
 		void updateItem(ScenarioModelItem* _item, int _itemStartPos, int _itemEndPos);
 
+		/**
+		 * @brief Запустить построение структуры всего документа в фоне
+		 */
+		void rebuildStructureInBackground();
+
+		/**
+		 * @brief Сместить позиции элементов при правке, пока структура перестраивается в фоне
+		 * @note Элементы удалённого текста убираются из индекса, структура будет восстановлена
+		 *		 по завершении построения
+		 */
+		void shiftItemsWhileRebuilding(int _position, int _charsRemoved, int _charsAdded);
+
 		/**
 		 * @brief Создать или получить существующий элемент для позиции в документе
 		 *		  или ближайший к позиции
@@ -245,14 +271,36 @@ namespace BusinessLogic
 		ScenarioModel* m_model;
 
 		/**
-		 * @brief Карта элементов дерева сценария
+		 * @brief Индекс позиций элементов дерева сценария
+		 */
+		ScenarioModelItemsIndex m_modelItems;
+
+		/**
+		 * @brief Построитель структуры в фоне
+		 */
+		ScenarioStructureBuilder* m_structureBuilder;
+
+		/**
+		 * @brief Можно ли перестраивать структуру в фоне
+		 * @note При загрузке документа структура строится сразу
+		 */
+		bool m_canRebuildStructureInBackground;
+
+		/**
+		 * @brief Выполняется ли фоновое построение структуры
+		 * @note Пока флаг установлен, пошаговое обновление структуры не производится
+		 */
+		bool m_isStructureRebuilding;
+
+		/**
+		 * @brief Изменялся ли документ во время фонового построения структуры
 		 */
-		QMap<int, ScenarioModelItem*> m_modelItems;
+		bool m_isStructureRebuildOutdated;
 
 		/**
-		 * @brief MD5-хэш текста сценария, используется для отслеживания изменённости текста
+		 * @brief Хэш xml сценария, используется для отслеживания изменённости текста
 		 */
-		QByteArray m_lastTextMd5Hash;
+		QByteArray m_lastTextHash;
 
 		/**
 		 * @brief Флаг операции обновления описания сцены, для предотвращения рекурсии
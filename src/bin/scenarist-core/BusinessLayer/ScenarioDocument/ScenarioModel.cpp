@@ -138,6 +138,30 @@ void ScenarioModel::updateItem(ScenarioModelItem* _item)
 	}
 }
 
+void ScenarioModel::resetItems(const QList<ScenarioModelItem*>& _items)
+{
+	beginResetModel();
+
+	//
+	// Удаляем старое дерево целиком, вместе с корнем, чтобы не пересчитывать его при удалении
+	// каждого из элементов
+	//
+	delete m_rootItem;
+	m_rootItem = new ScenarioModelItem(0);
+	m_rootItem->setHeader(QObject::tr("Scenario"));
+	m_rootItem->setType(ScenarioModelItem::Scenario);
+
+	//
+	// Добавляем новые элементы и пересчитываем значения сценария
+	//
+	foreach (ScenarioModelItem* item, _items) {
+		m_rootItem->appendItem(item);
+	}
+	m_rootItem->updateFromChildren();
+
+	endResetModel();
+}
+
 QModelIndex ScenarioModel::index(int _row, int _column, const QModelIndex& _parent) const
 {
 	QModelIndex resultIndex;
@@ -71,6 +71,12 @@ namespace BusinessLogic
 		 */
 		void updateItem(ScenarioModelItem* _item);
 
+		/**
+		 * @brief Заменить все элементы сценария заданными
+		 * @note Элементы должны быть уже сформированы вместе с детьми, модель сбрасывается целиком
+		 */
+		void resetItems(const QList<ScenarioModelItem*>& _items);
+
 		/**
 		 * @brief Реализация древовидной модели
 		 */
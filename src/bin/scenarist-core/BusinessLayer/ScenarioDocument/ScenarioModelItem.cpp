@@ -1,5 +1,7 @@
 #include "ScenarioModelItem.h"
 
+#include "ScenarioModelItemsIndex.h"
+
 #include <QPainter>
 
 using namespace BusinessLogic;
@@ -11,6 +13,7 @@ namespace {
 
 ScenarioModelItem::ScenarioModelItem(int _position) :
 	m_position(_position),
+	m_positionIndex(0),
 	m_sceneNumber(0),
 	m_textLength(0),
 	m_duration(0),
@@ -22,6 +25,10 @@ ScenarioModelItem::ScenarioModelItem(int _position) :
 
 ScenarioModelItem::~ScenarioModelItem()
 {
+	if (m_positionIndex != 0) {
+		m_positionIndex->remove(this);
+	}
+
 	qDeleteAll(m_children);
 }
 
@@ -39,7 +46,7 @@ void ScenarioModelItem::setUuid(const QString& _uuid)
 
 int ScenarioModelItem::position() const
 {
-	return m_position;
+	return m_positionIndex != 0 ? m_positionIndex->position(this) : m_position;
 }
 
 void ScenarioModelItem::setPosition(int _position)
@@ -187,6 +194,7 @@ void ScenarioModelItem::setDuration(qreal _duration)
 {
 	if (m_duration != _duration) {
 		m_duration = _duration;
+		updateIndexDuration();
 		updateParentDuration();
 	}
 }
@@ -200,6 +208,7 @@ void ScenarioModelItem::setType(ScenarioModelItem::Type _type)
 {
 	if (m_type != _type) {
 		m_type = _type;
+		updateIndexDuration();
 	}
 }
 
@@ -329,9 +338,17 @@ void ScenarioModelItem::clear()
 	m_footer.clear();
 
 	m_duration = 0;
+	updateIndexDuration();
 	updateParentDuration();
 }
 
+void ScenarioModelItem::updateIndexDuration()
+{
+	if (m_positionIndex != 0) {
+		m_positionIndex->updateDuration(this);
+	}
+}
+
 //! Вспомогательные методы для организации работы модели
 
 void ScenarioModelItem::prependItem(ScenarioModelItem* _item)
@@ -377,6 +394,12 @@ void ScenarioModelItem::removeItem(ScenarioModelItem* _item)
 	_item = 0;
 }
 
+void ScenarioModelItem::updateFromChildren()
+{
+	updateParentDuration();
+	updateParentCounter();
+}
+
 bool ScenarioModelItem::hasParent() const
 {
 	return m_parent != 0;
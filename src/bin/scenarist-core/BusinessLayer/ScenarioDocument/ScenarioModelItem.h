@@ -9,6 +9,9 @@
 
 namespace BusinessLogic
 {
+	class ScenarioModelItemsIndex;
+
+
 	/**
 	 * @brief Класс элемента модели сценария
 	 */
@@ -38,6 +41,7 @@ namespace BusinessLogic
 
 		/**
 		 * @brief Позиция элемента
+		 * @note Для элемента, находящегося в индексе позиций, позиция определяется индексом
 		 */
 		int position() const;
 		void setPosition(int _position);
@@ -143,6 +147,11 @@ namespace BusinessLogic
 		 */
 		void clear();
 
+		/**
+		 * @brief Обновить длительность элемента в индексе позиций
+		 */
+		void updateIndexDuration();
+
 	private:
 		/**
 		 * @brief Идентификатор сцены
@@ -154,6 +163,12 @@ namespace BusinessLogic
 		 */
 		int m_position;
 
+		/**
+		 * @brief Индекс позиций, в котором находится элемент
+		 */
+		ScenarioModelItemsIndex* m_positionIndex;
+		friend class ScenarioModelItemsIndex;
+
 		/**
 		 * @brief Номер сцены
 		 */
@@ -239,6 +254,12 @@ namespace BusinessLogic
 		 */
 		void removeItem(ScenarioModelItem* _item);
 
+		/**
+		 * @brief Пересчитать длительность и счётчики по дочерним элементам
+		 * @note Используется при построении дерева целиком, когда элементы добавляются без пересчёта
+		 */
+		void updateFromChildren();
+
 		/**
 		 * @brief Имеет ли элемент родительский элемент
 		 */
@@ -0,0 +1,402 @@
+#include "ScenarioModelItemsIndex.h"
+
+#include "ScenarioModelItem.h"
+
+#include <QStack>
+
+using BusinessLogic::ScenarioModelItemsIndex;
+using BusinessLogic::ScenarioModelItem;
+
+
+namespace {
+	/**
+	 * @brief Длительность элемента, учитываемая в хронометраже
+	 */
+	qreal itemDuration(const ScenarioModelItem* _item) {
+		return _item->type() == ScenarioModelItem::Scene ? _item->duration() : 0;
+	}
+}
+
+
+/**
+ * @brief Узел дерева
+ *
+ * Позиция узла становится действительной после применения отложенных смещений всех его предков
+ */
+struct ScenarioModelItemsIndex::Node
+{
+	Node(int _position, ScenarioModelItem* _item) :
+		position(_position), delta(0), priority(qrand()), duration(itemDuration(_item)),
+		subtreeDuration(duration), item(_item), left(0), right(0), parent(0) {}
+
+	int position;
+	int delta;
+	int priority;
+	qreal duration;
+	qreal subtreeDuration;
+	ScenarioModelItem* item;
+	Node* left;
+	Node* right;
+	Node* parent;
+};
+
+
+ScenarioModelItemsIndex::ScenarioModelItemsIndex() :
+	m_root(0)
+{
+}
+
+ScenarioModelItemsIndex::~ScenarioModelItemsIndex()
+{
+	clear();
+}
+
+bool ScenarioModelItemsIndex::isEmpty() const
+{
+	return m_root == 0;
+}
+
+int ScenarioModelItemsIndex::size() const
+{
+	return m_nodes.size();
+}
+
+void ScenarioModelItemsIndex::clear()
+{
+	//
+	// Возвращаем элементам их позиции и удаляем узлы
+	//
+	foreach (Node* node, m_nodes) {
+		node->item->m_position = position(node->item);
+	}
+	foreach (Node* node, m_nodes) {
+		node->item->m_positionIndex = 0;
+		delete node;
+	}
+	m_nodes.clear();
+	m_root = 0;
+}
+
+void ScenarioModelItemsIndex::insert(int _position, ScenarioModelItem* _item)
+{
+	if (contains(_item)) {
+		remove(_item);
+	}
+	if (ScenarioModelItem* oldItem = item(_position)) {
+		remove(oldItem);
+	}
+
+	Node* node = new Node(_position, _item);
+	m_nodes.insert(_item, node);
+	_item->m_positionIndex = this;
+
+	Node* left = 0;
+	Node* right = 0;
+	split(m_root, _position, left, right);
+	m_root = merge(merge(left, node), right);
+	m_root->parent = 0;
+}
+
+void ScenarioModelItemsIndex::remove(ScenarioModelItem* _item)
+{
+	if (Node* node = m_nodes.value(_item, 0)) {
+		_item->m_position = position(_item);
+		_item->m_positionIndex = 0;
+		m_nodes.remove(_item);
+		removeNode(node);
+	}
+}
+
+bool ScenarioModelItemsIndex::contains(const ScenarioModelItem* _item) const
+{
+	return m_nodes.contains(_item);
+}
+
+int ScenarioModelItemsIndex::position(const ScenarioModelItem* _item) const
+{
+	int position = -1;
+	if (Node* node = m_nodes.value(_item, 0)) {
+		position = node->position;
+		for (Node* parent = node->parent; parent != 0; parent = parent->parent) {
+			position += parent->delta;
+		}
+	}
+	return position;
+}
+
+void ScenarioModelItemsIndex::shift(int _fromPosition, int _delta)
+{
+	if (_delta == 0) {
+		return;
+	}
+
+	Node* left = 0;
+	Node* right = 0;
+	split(m_root, _fromPosition, left, right);
+	if (right != 0) {
+		right->position += _delta;
+		right->delta += _delta;
+	}
+	m_root = merge(left, right);
+	if (m_root != 0) {
+		m_root->parent = 0;
+	}
+}
+
+void ScenarioModelItemsIndex::updateDuration(const ScenarioModelItem* _item)
+{
+	if (Node* node = m_nodes.value(_item, 0)) {
+		node->duration = itemDuration(_item);
+		for (; node != 0; node = node->parent) {
+			update(node);
+		}
+	}
+}
+
+qreal ScenarioModelItemsIndex::durationBefore(const ScenarioModelItem* _item) const
+{
+	qreal duration = 0;
+	if (Node* node = m_nodes.value(_item, 0)) {
+		if (node->left != 0) {
+			duration += node->left->subtreeDuration;
+		}
+		//
+		// Поднимаясь к корню, добавляем все узлы, от которых мы находимся справа
+		//
+		for (; node->parent != 0; node = node->parent) {
+			if (node->parent->right == node) {
+				duration += node->parent->duration;
+				if (node->parent->left != 0) {
+					duration += node->parent->left->subtreeDuration;
+				}
+			}
+		}
+	}
+	return duration;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::item(int _position) const
+{
+	ScenarioModelItem* result = lowerBound(_position);
+	if (result != 0
+		&& position(result) != _position) {
+		result = 0;
+	}
+	return result;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::lowerBound(int _position) const
+{
+	ScenarioModelItem* result = 0;
+	int delta = 0;
+	Node* node = m_root;
+	while (node != 0) {
+		if (node->position + delta >= _position) {
+			result = node->item;
+			delta += node->delta;
+			node = node->left;
+		} else {
+			delta += node->delta;
+			node = node->right;
+		}
+	}
+	return result;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::floor(int _position) const
+{
+	ScenarioModelItem* result = 0;
+	int delta = 0;
+	Node* node = m_root;
+	while (node != 0) {
+		if (node->position + delta <= _position) {
+			result = node->item;
+			delta += node->delta;
+			node = node->right;
+		} else {
+			delta += node->delta;
+			node = node->left;
+		}
+	}
+	return result;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::first() const
+{
+	Node* node = m_root;
+	while (node != 0
+		   && node->left != 0) {
+		node = node->left;
+	}
+	return node != 0 ? node->item : 0;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::next(const ScenarioModelItem* _item) const
+{
+	Node* node = m_nodes.value(_item, 0);
+	if (node == 0) {
+		return 0;
+	}
+
+	if (node->right != 0) {
+		node = node->right;
+		while (node->left != 0) {
+			node = node->left;
+		}
+		return node->item;
+	}
+
+	while (node->parent != 0
+		   && node->parent->right == node) {
+		node = node->parent;
+	}
+	return node->parent != 0 ? node->parent->item : 0;
+}
+
+ScenarioModelItem* ScenarioModelItemsIndex::previous(const ScenarioModelItem* _item) const
+{
+	Node* node = m_nodes.value(_item, 0);
+	if (node == 0) {
+		return 0;
+	}
+
+	if (node->left != 0) {
+		node = node->left;
+		while (node->right != 0) {
+			node = node->right;
+		}
+		return node->item;
+	}
+
+	while (node->parent != 0
+		   && node->parent->left == node) {
+		node = node->parent;
+	}
+	return node->parent != 0 ? node->parent->item : 0;
+}
+
+QList<ScenarioModelItem*> ScenarioModelItemsIndex::items() const
+{
+	QList<ScenarioModelItem*> result;
+	QStack<Node*> nodes;
+	Node* node = m_root;
+	while (node != 0
+		   || !nodes.isEmpty()) {
+		while (node != 0) {
+			nodes.push(node);
+			node = node->left;
+		}
+		node = nodes.pop();
+		result.append(node->item);
+		node = node->right;
+	}
+	return result;
+}
+
+void ScenarioModelItemsIndex::push(Node* _node)
+{
+	if (_node->delta != 0) {
+		if (_node->left != 0) {
+			_node->left->position += _node->delta;
+			_node->left->delta += _node->delta;
+		}
+		if (_node->right != 0) {
+			_node->right->position += _node->delta;
+			_node->right->delta += _node->delta;
+		}
+		_node->delta = 0;
+	}
+}
+
+void ScenarioModelItemsIndex::update(Node* _node)
+{
+	_node->subtreeDuration = _node->duration;
+	if (_node->left != 0) {
+		_node->subtreeDuration += _node->left->subtreeDuration;
+	}
+	if (_node->right != 0) {
+		_node->subtreeDuration += _node->right->subtreeDuration;
+	}
+}
+
+void ScenarioModelItemsIndex::split(Node* _node, int _position, Node*& _left, Node*& _right)
+{
+	if (_node == 0) {
+		_left = _right = 0;
+		return;
+	}
+
+	push(_node);
+	if (_node->position < _position) {
+		split(_node->right, _position, _node->right, _right);
+		if (_node->right != 0) {
+			_node->right->parent = _node;
+		}
+		_left = _node;
+	} else {
+		split(_node->left, _position, _left, _node->left);
+		if (_node->left != 0) {
+			_node->left->parent = _node;
+		}
+		_right = _node;
+	}
+	_node->parent = 0;
+	update(_node);
+}
+
+ScenarioModelItemsIndex::Node* ScenarioModelItemsIndex::merge(Node* _left, Node* _right)
+{
+	if (_left == 0) {
+		return _right;
+	}
+	if (_right == 0) {
+		return _left;
+	}
+
+	if (_left->priority > _right->priority) {
+		push(_left);
+		_left->right = merge(_left->right, _right);
+		_left->right->parent = _left;
+		update(_left);
+		return _left;
+	} else {
+		push(_right);
+		_right->left = merge(_left, _right->left);
+		_right->left->parent = _right;
+		update(_right);
+		return _right;
+	}
+}
+
+void ScenarioModelItemsIndex::removeNode(Node* _node)
+{
+	//
+	// Применяем отложенные смещения на пути от корня к узлу, чтобы позиции детей стали действительными
+	//
+	QStack<Node*> path;
+	for (Node* node = _node; node != 0; node = node->parent) {
+		path.push(node);
+	}
+	while (!path.isEmpty()) {
+		push(path.pop());
+	}
+
+	//
+	// Замещаем узел объединением его поддеревьев
+	//
+	Node* child = merge(_node->left, _node->right);
+	if (child != 0) {
+		child->parent = _node->parent;
+	}
+	if (_node->parent == 0) {
+		m_root = child;
+	} else if (_node->parent->left == _node) {
+		_node->parent->left = child;
+	} else {
+		_node->parent->right = child;
+	}
+	for (Node* node = _node->parent; node != 0; node = node->parent) {
+		update(node);
+	}
+	delete _node;
+}
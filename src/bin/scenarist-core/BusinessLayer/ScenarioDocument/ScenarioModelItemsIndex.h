@@ -0,0 +1,160 @@
+#ifndef SCENARIOMODELITEMSINDEX_H
+#define SCENARIOMODELITEMSINDEX_H
+
+#include <QHash>
+#include <QList>
+
+
+namespace BusinessLogic
+{
+	class ScenarioModelItem;
+
+
+	/**
+	 * @brief Индекс позиций элементов модели сценария в тексте
+	 *
+	 * Декартово дерево, упорядоченное по позициям элементов, с отложенным смещением поддеревьев.
+	 * Смещение всех элементов после точки правки, поиск, вставка и удаление выполняются
+	 * за логарифмическое время. Элементы, находящиеся в индексе, получают свою позицию из него.
+	 * Дополнительно в узлах хранятся суммы длительностей сцен поддеревьев, что позволяет
+	 * за логарифмическое время получать хронометраж всех сцен до заданного элемента
+	 */
+	class ScenarioModelItemsIndex
+	{
+	public:
+		ScenarioModelItemsIndex();
+		~ScenarioModelItemsIndex();
+
+		/**
+		 * @brief Пуст ли индекс
+		 */
+		bool isEmpty() const;
+
+		/**
+		 * @brief Количество элементов в индексе
+		 */
+		int size() const;
+
+		/**
+		 * @brief Очистить индекс
+		 */
+		void clear();
+
+		/**
+		 * @brief Добавить элемент в заданную позицию
+		 * @note Элемент, уже находящийся в этой позиции, вытесняется из индекса
+		 */
+		void insert(int _position, ScenarioModelItem* _item);
+
+		/**
+		 * @brief Удалить элемент из индекса
+		 */
+		void remove(ScenarioModelItem* _item);
+
+		/**
+		 * @brief Находится ли элемент в индексе
+		 */
+		bool contains(const ScenarioModelItem* _item) const;
+
+		/**
+		 * @brief Позиция элемента, -1 если элемента нет в индексе
+		 */
+		int position(const ScenarioModelItem* _item) const;
+
+		/**
+		 * @brief Сместить все элементы, начиная с заданной позиции, на заданную величину
+		 * @note Смещение не должно нарушать порядок элементов
+		 */
+		void shift(int _fromPosition, int _delta);
+
+		/**
+		 * @brief Обновить длительность элемента в индексе
+		 * @note Вызывается элементом при изменении его длительности или типа
+		 */
+		void updateDuration(const ScenarioModelItem* _item);
+
+		/**
+		 * @brief Суммарная длительность сцен, предшествующих элементу
+		 */
+		qreal durationBefore(const ScenarioModelItem* _item) const;
+
+		/**
+		 * @brief Элемент в заданной позиции, 0 если такого нет
+		 */
+		ScenarioModelItem* item(int _position) const;
+
+		/**
+		 * @brief Первый элемент находящийся в заданной позиции или после неё
+		 */
+		ScenarioModelItem* lowerBound(int _position) const;
+
+		/**
+		 * @brief Последний элемент находящийся в заданной позиции или до неё
+		 */
+		ScenarioModelItem* floor(int _position) const;
+
+		/**
+		 * @brief Первый элемент индекса
+		 */
+		ScenarioModelItem* first() const;
+
+		/**
+		 * @brief Следующий и предыдущий элементы, 0 если таких нет
+		 */
+		/** @{ */
+		ScenarioModelItem* next(const ScenarioModelItem* _item) const;
+		ScenarioModelItem* previous(const ScenarioModelItem* _item) const;
+		/** @} */
+
+		/**
+		 * @brief Все элементы в порядке следования в тексте
+		 */
+		QList<ScenarioModelItem*> items() const;
+
+	private:
+		/**
+		 * @brief Узел дерева
+		 */
+		struct Node;
+
+		/**
+		 * @brief Передать отложенное смещение узла его детям
+		 */
+		static void push(Node* _node);
+
+		/**
+		 * @brief Пересчитать суммарную длительность поддерева узла по его детям
+		 */
+		static void update(Node* _node);
+
+		/**
+		 * @brief Разделить дерево на узлы с позицией меньше заданной и все остальные
+		 */
+		static void split(Node* _node, int _position, Node*& _left, Node*& _right);
+
+		/**
+		 * @brief Объединить деревья, все узлы левого дерева должны предшествовать узлам правого
+		 */
+		static Node* merge(Node* _left, Node* _right);
+
+		/**
+		 * @brief Удалить узел из дерева
+		 */
+		void removeNode(Node* _node);
+
+	private:
+		/**
+		 * @brief Корень дерева
+		 */
+		Node* m_root;
+
+		/**
+		 * @brief Узлы элементов
+		 */
+		QHash<const ScenarioModelItem*, Node*> m_nodes;
+
+		Q_DISABLE_COPY(ScenarioModelItemsIndex)
+	};
+}
+
+#endif // SCENARIOMODELITEMSINDEX_H
@@ -0,0 +1,140 @@
+#include "ScenarioStructureBuilder.h"
+
+#include "ScenarioTextBlockInfo.h"
+
+#include <BusinessLayer/Chronometry/ChronometerFacade.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/SettingsStorage.h>
+
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QtConcurrentRun>
+
+using BusinessLogic::ScenarioStructureBuilder;
+using BusinessLogic::ScenarioBlockStyle;
+
+
+namespace {
+	/**
+	 * @brief Интервал опроса прогресса построения (мс)
+	 */
+	const int PROGRESS_INTERVAL = 100;
+}
+
+
+ScenarioStructureBuilder::ScenarioStructureBuilder(QObject* _parent) :
+	QObject(_parent),
+	m_isCanceled(0),
+	m_progress(0),
+	m_lastProgress(0)
+{
+	m_progressTimer.setInterval(PROGRESS_INTERVAL);
+	connect(&m_progressTimer, &QTimer::timeout, this, &ScenarioStructureBuilder::aboutCheckProgress);
+	connect(&m_watcher, &QFutureWatcherBase::finished, this, &ScenarioStructureBuilder::aboutBuildFinished);
+}
+
+bool ScenarioStructureBuilder::isRunning() const
+{
+	return m_watcher.isRunning();
+}
+
+void ScenarioStructureBuilder::start(QTextDocument* _document)
+{
+	//
+	// Настройки и хронометр не потокобезопасны, поэтому всё необходимое определяем здесь
+	//
+	const bool chronometryUsed = ChronometerFacade::chronometryUsed();
+	const bool calculateWords =
+			DataStorageLayer::StorageFacade::settingsStorage()->value(
+				"counters/words/used",
+				DataStorageLayer::SettingsStorage::ApplicationSettings).toInt();
+	const bool calculateCharacters =
+			DataStorageLayer::StorageFacade::settingsStorage()->value(
+				"counters/simbols/used",
+				DataStorageLayer::SettingsStorage::ApplicationSettings).toInt();
+	QSet<ScenarioBlockStyle::Type> uppercaseTypes;
+	{
+		const ScenarioTemplate& scenarioTemplate = ScenarioTemplateFacade::getTemplate();
+		for (int type = ScenarioBlockStyle::Undefined; type <= ScenarioBlockStyle::SceneDescription; ++type) {
+			const ScenarioBlockStyle::Type blockType = (ScenarioBlockStyle::Type)type;
+			if (scenarioTemplate.blockStyle(blockType).charFormat().fontCapitalization() == QFont::AllUppercase) {
+				uppercaseTypes.insert(blockType);
+			}
+		}
+	}
+
+	//
+	// Снимаем копию документа
+	//
+	QVector<BlockInfo> blocks;
+	blocks.reserve(_document->blockCount());
+	QTextBlock block = _document->begin();
+	while (block.isValid()) {
+		BlockInfo blockInfo;
+		blockInfo.type = ScenarioBlockStyle::forBlock(block);
+		blockInfo.text = block.text();
+		blockInfo.position = block.position();
+		blockInfo.isVisible = block.isVisible();
+		if (chronometryUsed) {
+			blockInfo.duration = ChronometerFacade::calculate(block);
+		}
+		if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
+			blockInfo.colors = info->colors();
+			blockInfo.title = info->title();
+		}
+		blocks.append(blockInfo);
+
+		block = block.next();
+	}
+
+	//
+	// Запускаем построение
+	//
+	m_isCanceled.storeRelease(0);
+	m_progress.storeRelease(0);
+	m_lastProgress = 0;
+	emit progressChanged(m_lastProgress);
+	m_progressTimer.start();
+	m_watcher.setFuture(
+		QtConcurrent::run(this, &ScenarioStructureBuilder::build, blocks, uppercaseTypes,
+			chronometryUsed, calculateWords, calculateCharacters));
+}
+
+void ScenarioStructureBuilder::cancel()
+{
+	m_isCanceled.storeRelease(1);
+}
+
+QList<ScenarioStructureBuilder::ItemInfo> ScenarioStructureBuilder::result() const
+{
+	return m_watcher.result();
+}
+
+void ScenarioStructureBuilder::aboutCheckProgress()
+{
+	const int progress = m_progress.loadAcquire();
+	if (progress != m_lastProgress) {
+		m_lastProgress = progress;
+		emit progressChanged(m_lastProgress);
+	}
+}
+
+void ScenarioStructureBuilder::aboutBuildFinished()
+{
+	m_progressTimer.stop();
+	m_lastProgress = 100;
+	emit progressChanged(m_lastProgress);
+
+	if (m_isCanceled.loadAcquire() == 0) {
+		emit finished();
+	}
+}
+
+QList<ScenarioStructureBuilder::ItemInfo> ScenarioStructureBuilder::build(const QVector<BlockInfo>& _blocks,
+	const QSet<ScenarioBlockStyle::Type>& _uppercaseTypes, bool _chronometryUsed, bool _calculateWords,
+	bool _calculateCharacters)
+{
+	return ScenarioStructureParser::parse(_blocks, _uppercaseTypes, _chronometryUsed, _calculateWords,
+		_calculateCharacters, &m_isCanceled, &m_progress);
+}
@@ -0,0 +1,116 @@
+#ifndef SCENARIOSTRUCTUREBUILDER_H
+#define SCENARIOSTRUCTUREBUILDER_H
+
+#include "ScenarioStructureParser.h"
+
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QObject>
+#include <QTimer>
+
+class QTextDocument;
+
+
+namespace BusinessLogic
+{
+	/**
+	 * @brief Построитель дерева структуры сценария в фоновом потоке
+	 *
+	 * Используется после больших изменений текста (вставка большого фрагмента, применение патчей),
+	 * когда пошаговое обновление структуры слишком долго блокирует интерфейс. Всё, что требует
+	 * обращения к документу и настройкам, снимается в потоке интерфейса, а разбор текста
+	 * на элементы выполняется в фоне над независимой копией данных
+	 */
+	class ScenarioStructureBuilder : public QObject
+	{
+		Q_OBJECT
+
+	public:
+		typedef ScenarioStructureParser::BlockInfo BlockInfo;
+		typedef ScenarioStructureParser::ItemInfo ItemInfo;
+
+	public:
+		explicit ScenarioStructureBuilder(QObject* _parent = 0);
+
+		/**
+		 * @brief Выполняется ли построение в данный момент
+		 */
+		bool isRunning() const;
+
+		/**
+		 * @brief Запустить построение структуры для заданного документа
+		 * @note Снимок документа делается сразу, сам документ в фоне не используется
+		 */
+		void start(QTextDocument* _document);
+
+		/**
+		 * @brief Отменить построение, результат текущего запуска будет отброшен
+		 */
+		void cancel();
+
+		/**
+		 * @brief Результат последнего построения
+		 */
+		QList<ItemInfo> result() const;
+
+	signals:
+		/**
+		 * @brief Изменился прогресс построения, в процентах
+		 * @note Испускается не чаще раза в 100 мс, по окончании построения всегда 100
+		 */
+		void progressChanged(int _progress);
+
+		/**
+		 * @brief Построение завершено
+		 */
+		void finished();
+
+	private slots:
+		/**
+		 * @brief Проверить прогресс фонового построения
+		 */
+		void aboutCheckProgress();
+
+		/**
+		 * @brief Фоновое построение завершилось
+		 */
+		void aboutBuildFinished();
+
+	private:
+		/**
+		 * @brief Построить структуру по снимку документа
+		 * @note Выполняется в фоновом потоке
+		 */
+		QList<ItemInfo> build(const QVector<BlockInfo>& _blocks,
+			const QSet<ScenarioBlockStyle::Type>& _uppercaseTypes, bool _chronometryUsed,
+			bool _calculateWords, bool _calculateCharacters);
+
+	private:
+		/**
+		 * @brief Наблюдатель за фоновым построением
+		 */
+		QFutureWatcher<QList<ItemInfo> > m_watcher;
+
+		/**
+		 * @brief Флаг отмены построения
+		 */
+		QAtomicInt m_isCanceled;
+
+		/**
+		 * @brief Прогресс построения, записываемый фоновым потоком
+		 */
+		QAtomicInt m_progress;
+
+		/**
+		 * @brief Последний сообщённый прогресс
+		 */
+		int m_lastProgress;
+
+		/**
+		 * @brief Таймер опроса прогресса, чтобы не засыпать интерфейс сигналами из фонового потока
+		 */
+		QTimer m_progressTimer;
+	};
+}
+
+#endif // SCENARIOSTRUCTUREBUILDER_H
@@ -0,0 +1,149 @@
+#include "ScenarioStructureParser.h"
+
+#include <BusinessLayer/Counters/CountersFacade.h>
+
+#include <QStack>
+
+using BusinessLogic::ScenarioStructureParser;
+using BusinessLogic::ScenarioBlockStyle;
+using BusinessLogic::ScenarioModelItem;
+using BusinessLogic::Counter;
+
+
+namespace {
+	/**
+	 * @brief Определить тип элемента структуры по типу его заголовочного блока
+	 */
+	ScenarioModelItem::Type itemTypeForBlock(ScenarioBlockStyle::Type _blockType) {
+		ScenarioModelItem::Type itemType = ScenarioModelItem::Undefined;
+		if (_blockType == ScenarioBlockStyle::SceneHeading) {
+			itemType = ScenarioModelItem::Scene;
+		} else if (_blockType == ScenarioBlockStyle::SceneGroupHeader
+				   || _blockType == ScenarioBlockStyle::SceneGroupFooter) {
+			itemType = ScenarioModelItem::SceneGroup;
+		} else if (_blockType == ScenarioBlockStyle::FolderHeader
+				   || _blockType == ScenarioBlockStyle::FolderFooter) {
+			itemType = ScenarioModelItem::Folder;
+		}
+		return itemType;
+	}
+
+	/**
+	 * @brief Добавить к счётчику значения другого счётчика
+	 */
+	void addCounter(Counter& _counter, const Counter& _other) {
+		_counter.addWords(_other.words());
+		_counter.addCharactersWithSpaces(_other.charactersWithSpaces());
+		_counter.addCharactersWithoutSpaces(_other.charactersWithoutSpaces());
+	}
+}
+
+
+QList<ScenarioStructureParser::ItemInfo> ScenarioStructureParser::parse(const QVector<BlockInfo>& _blocks,
+	const QSet<ScenarioBlockStyle::Type>& _uppercaseTypes, bool _chronometryUsed, bool _calculateWords,
+	bool _calculateCharacters, const QAtomicInt* _isCanceled, QAtomicInt* _progress)
+{
+	QList<ItemInfo> items;
+
+	//
+	// Индексы открытых групп и папок, в которые вкладываются последующие элементы
+	//
+	QStack<int> openedGroups;
+	//
+	// Индекс элемента, которому принадлежит текущий блок
+	//
+	int currentItemIndex = -1;
+	for (int blockIndex = 0; blockIndex < _blocks.size(); ++blockIndex) {
+		if (_isCanceled != 0
+			&& _isCanceled->loadAcquire() != 0) {
+			return QList<ItemInfo>();
+		}
+		if (_progress != 0) {
+			_progress->storeRelease((blockIndex + 1) * 100 / _blocks.size());
+		}
+
+		const BlockInfo& block = _blocks.at(blockIndex);
+		const Counter blockCounter =
+				block.isVisible
+				? CountersFacade::calculate(block.text, _calculateWords, _calculateCharacters)
+				: Counter();
+
+		//
+		// Окончание группы закрывает её, последующий текст начнёт новый элемент внутри охватывающей группы
+		//
+		if (blockIndex > 0
+			&& (block.type == ScenarioBlockStyle::SceneGroupFooter
+				|| block.type == ScenarioBlockStyle::FolderFooter)) {
+			if (!openedGroups.isEmpty()) {
+				ItemInfo& group = items[openedGroups.pop()];
+				group.footer = block.text;
+				addCounter(group.counter, blockCounter);
+			}
+			currentItemIndex = -1;
+		}
+		//
+		// Заголовки начинают новый элемент, первый блок текста начинает элемент всегда,
+		// как и текст, идущий сразу после окончания группы
+		//
+		else if (blockIndex == 0
+				 || currentItemIndex == -1
+				 || block.type == ScenarioBlockStyle::SceneHeading
+				 || block.type == ScenarioBlockStyle::SceneGroupHeader
+				 || block.type == ScenarioBlockStyle::FolderHeader) {
+			ItemInfo item;
+			item.parentIndex = openedGroups.isEmpty() ? -1 : openedGroups.top();
+			item.position = block.position;
+			item.type = itemTypeForBlock(block.type);
+			item.header = block.text;
+			item.colors = block.colors;
+			item.title = block.title;
+			if (item.type == ScenarioModelItem::Scene) {
+				item.duration = _chronometryUsed ? block.duration : -1;
+			}
+			item.counter = blockCounter;
+			items.append(item);
+			currentItemIndex = items.size() - 1;
+
+			if (block.type == ScenarioBlockStyle::SceneGroupHeader
+				|| block.type == ScenarioBlockStyle::FolderHeader) {
+				openedGroups.push(currentItemIndex);
+			}
+		}
+		//
+		// Остальные блоки наполняют текущий элемент
+		//
+		else {
+			ItemInfo& item = items[currentItemIndex];
+			if (block.type == ScenarioBlockStyle::SceneDescription) {
+				if (item.description.isNull()) {
+					item.description = "";
+				} else {
+					item.description.append("\n");
+				}
+				item.description.append(block.text);
+			} else {
+				if (item.text.isNull()) {
+					item.text = "";
+				} else {
+					item.text.append(" ");
+				}
+				item.text.append(_uppercaseTypes.contains(block.type) ? block.text.toUpper() : block.text);
+			}
+
+			if (block.type == ScenarioBlockStyle::NoprintableText) {
+				item.hasNote = true;
+				foreach (int groupIndex, openedGroups) {
+					items[groupIndex].hasNote = true;
+				}
+			}
+
+			if (item.type == ScenarioModelItem::Scene
+				&& _chronometryUsed) {
+				item.duration += block.duration;
+			}
+			addCounter(item.counter, blockCounter);
+		}
+	}
+
+	return items;
+}
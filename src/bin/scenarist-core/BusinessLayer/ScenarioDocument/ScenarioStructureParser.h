@@ -0,0 +1,76 @@
+#ifndef SCENARIOSTRUCTUREPARSER_H
+#define SCENARIOSTRUCTUREPARSER_H
+
+#include "ScenarioModelItem.h"
+#include "ScenarioTemplate.h"
+
+#include <BusinessLayer/Counters/Counter.h>
+
+#include <QAtomicInt>
+#include <QList>
+#include <QSet>
+#include <QVector>
+
+
+namespace BusinessLogic
+{
+	/**
+	 * @brief Разбор снимка текста сценария на элементы структуры
+	 *
+	 * Не обращается ни к документу, ни к настройкам, поэтому может выполняться в фоновом потоке
+	 */
+	class ScenarioStructureParser
+	{
+	public:
+		/**
+		 * @brief Снимок блока текста
+		 */
+		struct BlockInfo {
+			BlockInfo() : type(ScenarioBlockStyle::Undefined), position(0), isVisible(true), duration(0) {}
+
+			ScenarioBlockStyle::Type type;
+			QString text;
+			int position;
+			bool isVisible;
+			qreal duration;
+			QString colors;
+			QString title;
+		};
+
+		/**
+		 * @brief Описание элемента структуры
+		 * @note Элементы идут в порядке следования в тексте, родитель всегда раньше своих детей
+		 */
+		struct ItemInfo {
+			ItemInfo() :
+				parentIndex(-1), position(0), type(ScenarioModelItem::Undefined), duration(0),
+				hasNote(false) {}
+
+			int parentIndex;
+			int position;
+			ScenarioModelItem::Type type;
+			QString header;
+			QString footer;
+			QString colors;
+			QString title;
+			QString text;
+			QString description;
+			qreal duration;
+			bool hasNote;
+			Counter counter;
+		};
+
+	public:
+		/**
+		 * @brief Построить структуру по снимку документа
+		 * @param _isCanceled - флаг отмены, при его установке возвращается пустой список
+		 * @param _progress - сюда записывается прогресс разбора в процентах
+		 */
+		static QList<ItemInfo> parse(const QVector<BlockInfo>& _blocks,
+			const QSet<ScenarioBlockStyle::Type>& _uppercaseTypes, bool _chronometryUsed,
+			bool _calculateWords, bool _calculateCharacters, const QAtomicInt* _isCanceled = 0,
+			QAtomicInt* _progress = 0);
+	};
+}
+
+#endif // SCENARIOSTRUCTUREPARSER_H
@@ -11,6 +11,8 @@
 #include <QFile>
 #include <QFontInfo>
 #include <QFontMetrics>
+#include <QHash>
+#include <QMutexLocker>
 #include <QStandardItem>
 #include <QStandardItemModel>
 #include <QStandardPaths>
@@ -18,6 +20,7 @@
 #include <QTextBlock>
 #include <QTextBlockFormat>
 #include <QTextCharFormat>
+#include <QVector>
 #include <QXmlStreamReader>
 
 using BusinessLogic::ScenarioBlockStyle;
@@ -32,102 +35,209 @@ using BusinessLogic::ScenarioBlockStyle;
 
 namespace {
 	/**
-	 * @brief Получить карту типов и их текстовых отображений
+	 * @brief Описание типа блока
 	 */
-	static QMap<ScenarioBlockStyle::Type, QString> typeNames() {
-		static QMap<ScenarioBlockStyle::Type, QString> s_typeNames;
-		if (s_typeNames.isEmpty()) {
-			s_typeNames.insert(ScenarioBlockStyle::Undefined, "undefined");
-			s_typeNames.insert(ScenarioBlockStyle::SceneHeading, "scene_heading");
-			s_typeNames.insert(ScenarioBlockStyle::SceneCharacters, "scene_characters");
-			s_typeNames.insert(ScenarioBlockStyle::Action, "action");
-			s_typeNames.insert(ScenarioBlockStyle::Character, "character");
-			s_typeNames.insert(ScenarioBlockStyle::Parenthetical, "parenthetical");
-			s_typeNames.insert(ScenarioBlockStyle::Dialogue, "dialog");
-			s_typeNames.insert(ScenarioBlockStyle::Transition, "transition");
-			s_typeNames.insert(ScenarioBlockStyle::Note, "note");
-			s_typeNames.insert(ScenarioBlockStyle::TitleHeader, "title_header");
-			s_typeNames.insert(ScenarioBlockStyle::Title, "title");
-			s_typeNames.insert(ScenarioBlockStyle::NoprintableText, "noprintable_text");
-			s_typeNames.insert(ScenarioBlockStyle::SceneGroupHeader, "scene_group_header");
-			s_typeNames.insert(ScenarioBlockStyle::SceneGroupFooter, "scene_group_footer");
-			s_typeNames.insert(ScenarioBlockStyle::FolderHeader, "folder_header");
-			s_typeNames.insert(ScenarioBlockStyle::FolderFooter, "folder_footer");
-			s_typeNames.insert(ScenarioBlockStyle::SceneDescription, "scene_description");
-		}
+	struct BlockTypeInfo {
+		/**
+		 * @brief Название типа, его красивое и краткое отображения (переводятся при использовании)
+		 */
+		/** @{ */
+		const char* name;
+		const char* beautifyName;
+		const char* shortName;
+		/** @} */
+
+		/**
+		 * @brief Является ли блок заголовком или окончанием группы
+		 */
+		/** @{ */
+		bool isEmbeddableHeader;
+		bool isEmbeddableFooter;
+		/** @} */
+
+		/**
+		 * @brief Парный блок группы: окончание для заголовка и заголовок для окончания
+		 */
+		ScenarioBlockStyle::Type embeddablePair;
+
+		/**
+		 * @brief Учитывается ли блок в хронометраже
+		 */
+		bool isChronometrable;
+
+		/**
+		 * @brief Виден ли блок в режиме сценария и в режиме поэпизодника
+		 */
+		/** @{ */
+		bool isVisibleInScenario;
+		bool isVisibleInOutline;
+		/** @} */
+	};
+
+	/**
+	 * @brief Таблица описаний типов блоков, индексированная по типу
+	 */
+	Q_DECL_CONSTEXPR const BlockTypeInfo BLOCK_TYPES[] = {
+		{ "undefined",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Undefined"),
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Undefined"),
+		  false, false, ScenarioBlockStyle::Undefined, true, false, false },
+		{ "scene_heading",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Scene Heading"),
+		  //: Reduction of Scene Heading
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "SH"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, true },
+		{ "scene_characters",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Scene Characters"),
+		  //: Reduction of Scene Characters
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "SC"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, true },
+		{ "action",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Action"),
+		  //: Reduction of Action
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "A"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "character",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Character"),
+		  //: Reduction of Character
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "C"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "parenthetical",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Parenthetical"),
+		  //: Reduction of Parenthetical
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "P"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "dialog",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Dialog"),
+		  //: Reduction of Dialog
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "D"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "transition",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Transition"),
+		  //: Reduction of Transition
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Tr"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "note",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Shot"),
+		  //: Reduction of Shot
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "S"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "title_header",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Title Header"),
+		  //: Reduction of Title Header
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "TH"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "title",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Title"),
+		  //: Reduction of Title
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Ti"),
+		  false, false, ScenarioBlockStyle::Undefined, true, true, false },
+		{ "noprintable_text",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Noprintable Text"),
+		  //: Reduction of Noprintable Text
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "NT"),
+		  false, false, ScenarioBlockStyle::Undefined, false, true, false },
+		{ "scene_group_header",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Scene Group"),
+		  //: Reduction of Scene Group
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "SG"),
+		  true, false, ScenarioBlockStyle::SceneGroupFooter, true, true, true },
+		{ "scene_group_footer",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Scene Group Footer"),
+		  //: Reduction of Scene Group Footer
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "SGF"),
+		  false, true, ScenarioBlockStyle::SceneGroupHeader, true, true, true },
+		{ "folder_header",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Folder"),
+		  //: Reduction of Folder
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "F"),
+		  true, false, ScenarioBlockStyle::FolderFooter, false, true, true },
+		{ "folder_footer",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Folder Footer"),
+		  //: Reduction of Folder Footer
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "FF"),
+		  false, true, ScenarioBlockStyle::FolderHeader, false, true, true },
+		{ "scene_description",
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "Scene Description"),
+		  //: Reduction of Scene Description
+		  QT_TRANSLATE_NOOP("BusinessLogic::ScenarioBlockStyle", "SD"),
+		  false, false, ScenarioBlockStyle::Undefined, false, false, true }
+	};
+
+	/**
+	 * @brief Количество типов блоков
+	 */
+	const int BLOCK_TYPES_COUNT = sizeof(BLOCK_TYPES) / sizeof(BLOCK_TYPES[0]);
+	Q_STATIC_ASSERT_X(sizeof(BLOCK_TYPES) / sizeof(BLOCK_TYPES[0]) == ScenarioBlockStyle::SceneDescription + 1,
+		"Block types table must describe every ScenarioBlockStyle::Type");
+
+	/**
+	 * @brief Получить описание типа блока, для некорректного типа возвращается описание неопределённого
+	 */
+	static const BlockTypeInfo& blockTypeInfo(ScenarioBlockStyle::Type _type) {
+		return BLOCK_TYPES[_type >= 0 && _type < BLOCK_TYPES_COUNT ? _type : ScenarioBlockStyle::Undefined];
+	}
+
+	/**
+	 * @brief Получить список текстовых отображений типов, индексированный по типу
+	 * @note Списки заполняются при инициализации статических переменных, которая потокобезопасна,
+	 *		 поэтому ими можно пользоваться и из фоновых потоков
+	 */
+	static const QVector<QString>& typeNames() {
+		static const QVector<QString> s_typeNames = [] {
+			QVector<QString> typeNames;
+			for (int type = 0; type < BLOCK_TYPES_COUNT; ++type) {
+				typeNames.append(QString::fromLatin1(BLOCK_TYPES[type].name));
+			}
+			return typeNames;
+		}();
 		return s_typeNames;
 	}
 
 	/**
-	 * @brief Получить карту типов и их текстовых отображений в красивом виде
+	 * @brief Получить список текстовых отображений типов в красивом виде, индексированный по типу
 	 */
-	static QMap<ScenarioBlockStyle::Type, QString> beautifyTypeNames() {
-		static QMap<ScenarioBlockStyle::Type, QString> s_beautifyTypeNames;
-		if (s_beautifyTypeNames.isEmpty()) {
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Undefined, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Undefined"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::SceneHeading, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Scene Heading"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::SceneCharacters, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Scene Characters"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Action, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Action"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Character, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Character"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Parenthetical, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Parenthetical"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Dialogue, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Dialog"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Transition, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Transition"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Note, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Shot"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::TitleHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Title Header"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::Title, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Title"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::NoprintableText, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Noprintable Text"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::SceneGroupHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Scene Group"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::SceneGroupFooter, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Scene Group Footer"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::FolderHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Folder"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::FolderFooter, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Folder Footer"));
-			s_beautifyTypeNames.insert(ScenarioBlockStyle::SceneDescription, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Scene Description"));
-		}
+	static const QVector<QString>& beautifyTypeNames() {
+		static const QVector<QString> s_beautifyTypeNames = [] {
+			QVector<QString> beautifyTypeNames;
+			for (int type = 0; type < BLOCK_TYPES_COUNT; ++type) {
+				beautifyTypeNames.append(
+					QApplication::translate("BusinessLogic::ScenarioBlockStyle", BLOCK_TYPES[type].beautifyName));
+			}
+			return beautifyTypeNames;
+		}();
 		return s_beautifyTypeNames;
 	}
 
 	/**
-	 * @brief Получить карту типов и их кратких текстовых отображений
+	 * @brief Получить список кратких текстовых отображений типов, индексированный по типу
 	 */
-	static QMap<ScenarioBlockStyle::Type, QString> shortTypeNames() {
-		static QMap<ScenarioBlockStyle::Type, QString> s_shortTypeNames;
-		if (s_shortTypeNames.isEmpty()) {
-			s_shortTypeNames.insert(ScenarioBlockStyle::Undefined, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Undefined"));
-			//: Reduction of Scene Heading
-			s_shortTypeNames.insert(ScenarioBlockStyle::SceneHeading, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "SH"));
-			//: Reduction of Scene Characters
-			s_shortTypeNames.insert(ScenarioBlockStyle::SceneCharacters, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "SC"));
-			//: Reduction of Action
-			s_shortTypeNames.insert(ScenarioBlockStyle::Action, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "A"));
-			//: Reduction of Character
-			s_shortTypeNames.insert(ScenarioBlockStyle::Character, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "C"));
-			//: Reduction of Parenthetical
-			s_shortTypeNames.insert(ScenarioBlockStyle::Parenthetical, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "P"));
-			//: Reduction of Dialog
-			s_shortTypeNames.insert(ScenarioBlockStyle::Dialogue, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "D"));
-			//: Reduction of Transition
-			s_shortTypeNames.insert(ScenarioBlockStyle::Transition, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Tr"));
-			//: Reduction of Shot
-			s_shortTypeNames.insert(ScenarioBlockStyle::Note, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "S"));
-			//: Reduction of Title Header
-			s_shortTypeNames.insert(ScenarioBlockStyle::TitleHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "TH"));
-			//: Reduction of Title
-			s_shortTypeNames.insert(ScenarioBlockStyle::Title, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "Ti"));
-			//: Reduction of Noprintable Text
-			s_shortTypeNames.insert(ScenarioBlockStyle::NoprintableText, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "NT"));
-			//: Reduction of Scene Group
-			s_shortTypeNames.insert(ScenarioBlockStyle::SceneGroupHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "SG"));
-			//: Reduction of Scene Group Footer
-			s_shortTypeNames.insert(ScenarioBlockStyle::SceneGroupFooter, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "SGF"));
-			//: Reduction of Folder
-			s_shortTypeNames.insert(ScenarioBlockStyle::FolderHeader, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "F"));
-			//: Reduction of Folder Footer
-			s_shortTypeNames.insert(ScenarioBlockStyle::FolderFooter, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "FF"));
-			//: Reduction of Scene Description
-			s_shortTypeNames.insert(ScenarioBlockStyle::SceneDescription, QApplication::translate("BusinessLogic::ScenarioBlockStyle", "SD"));
-		}
+	static const QVector<QString>& shortTypeNames() {
+		static const QVector<QString> s_shortTypeNames = [] {
+			QVector<QString> shortTypeNames;
+			for (int type = 0; type < BLOCK_TYPES_COUNT; ++type) {
+				shortTypeNames.append(
+					QApplication::translate("BusinessLogic::ScenarioBlockStyle", BLOCK_TYPES[type].shortName));
+			}
+			return shortTypeNames;
+		}();
 		return s_shortTypeNames;
 	}
 
+	/**
+	 * @brief Получить карту текстовых отображений типов и самих типов
+	 */
+	static const QHash<QString, ScenarioBlockStyle::Type>& typesForNames() {
+		static const QHash<QString, ScenarioBlockStyle::Type> s_typesForNames = [] {
+			QHash<QString, ScenarioBlockStyle::Type> typesForNames;
+			for (int type = 0; type < BLOCK_TYPES_COUNT; ++type) {
+				typesForNames.insert(typeNames().at(type), (ScenarioBlockStyle::Type)type);
+			}
+			return typesForNames;
+		}();
+		return s_typesForNames;
+	}
+
 	/**
 	 * @brief Расширение файла стиля сценария
 	 */
@@ -177,12 +287,22 @@ namespace {
 
 QString ScenarioBlockStyle::typeName(ScenarioBlockStyle::Type _type, bool _beautify)
 {
-	return _beautify ? ::beautifyTypeNames().value(_type) : ::typeNames().value(_type);
+	const QVector<QString>& names = _beautify ? ::beautifyTypeNames() : ::typeNames();
+	return names.value(_type);
 }
 
 ScenarioBlockStyle::Type ScenarioBlockStyle::typeForName(const QString& _typeName, bool _beautify)
 {
-	return _beautify ? ::beautifyTypeNames().key(_typeName) : ::typeNames().key(_typeName);
+	ScenarioBlockStyle::Type type = ScenarioBlockStyle::Undefined;
+	if (_beautify) {
+		const int typeIndex = ::beautifyTypeNames().indexOf(_typeName);
+		if (typeIndex != -1) {
+			type = (ScenarioBlockStyle::Type)typeIndex;
+		}
+	} else {
+		type = ::typesForNames().value(_typeName, ScenarioBlockStyle::Undefined);
+	}
+	return type;
 }
 
 QString ScenarioBlockStyle::shortTypeName(ScenarioBlockStyle::Type _type)
@@ -192,11 +312,52 @@ QString ScenarioBlockStyle::shortTypeName(ScenarioBlockStyle::Type _type)
 
 ScenarioBlockStyle::Type ScenarioBlockStyle::forBlock(const QTextBlock& _block)
 {
-	ScenarioBlockStyle::Type blockType = ScenarioBlockStyle::Undefined;
-	if (_block.blockFormat().hasProperty(ScenarioBlockStyle::PropertyType)) {
-		blockType = (ScenarioBlockStyle::Type)_block.blockFormat().intProperty(ScenarioBlockStyle::PropertyType);
-	}
-	return blockType;
+	//
+	// Если свойство не задано, то intProperty вернёт ноль, что соответствует неопределённому типу
+	//
+	const int blockType = _block.blockFormat().intProperty(ScenarioBlockStyle::PropertyType);
+	return blockType >= 0 && blockType < BLOCK_TYPES_COUNT
+			? (ScenarioBlockStyle::Type)blockType
+			: ScenarioBlockStyle::Undefined;
+}
+
+bool ScenarioBlockStyle::isEmbeddable(ScenarioBlockStyle::Type _type)
+{
+	const BlockTypeInfo& info = ::blockTypeInfo(_type);
+	return info.isEmbeddableHeader || info.isEmbeddableFooter;
+}
+
+bool ScenarioBlockStyle::isEmbeddableHeader(ScenarioBlockStyle::Type _type)
+{
+	return ::blockTypeInfo(_type).isEmbeddableHeader;
+}
+
+bool ScenarioBlockStyle::isEmbeddableFooter(ScenarioBlockStyle::Type _type)
+{
+	return ::blockTypeInfo(_type).isEmbeddableFooter;
+}
+
+ScenarioBlockStyle::Type ScenarioBlockStyle::embeddableFooter(ScenarioBlockStyle::Type _headerType)
+{
+	const BlockTypeInfo& info = ::blockTypeInfo(_headerType);
+	return info.isEmbeddableHeader ? info.embeddablePair : ScenarioBlockStyle::Undefined;
+}
+
+ScenarioBlockStyle::Type ScenarioBlockStyle::embeddableHeader(ScenarioBlockStyle::Type _footerType)
+{
+	const BlockTypeInfo& info = ::blockTypeInfo(_footerType);
+	return info.isEmbeddableFooter ? info.embeddablePair : ScenarioBlockStyle::Undefined;
+}
+
+bool ScenarioBlockStyle::isChronometrable(ScenarioBlockStyle::Type _type)
+{
+	return ::blockTypeInfo(_type).isChronometrable;
+}
+
+bool ScenarioBlockStyle::isVisible(ScenarioBlockStyle::Type _type, bool _outlineMode)
+{
+	const BlockTypeInfo& info = ::blockTypeInfo(_type);
+	return _outlineMode ? info.isVisibleInOutline : info.isVisibleInScenario;
 }
 
 void ScenarioBlockStyle::setIsActive(bool _isActive)
@@ -369,29 +530,17 @@ bool ScenarioBlockStyle::isHeader() const
 
 bool ScenarioBlockStyle::isEmbeddable() const
 {
-	return  m_type == SceneGroupHeader
-			|| m_type == SceneGroupFooter
-			|| m_type == FolderHeader
-			|| m_type == FolderFooter;
+	return isEmbeddable(m_type);
 }
 
 bool ScenarioBlockStyle::isEmbeddableHeader() const
 {
-	return  m_type == SceneGroupHeader
-			|| m_type == FolderHeader;
+	return isEmbeddableHeader(m_type);
 }
 
 ScenarioBlockStyle::Type ScenarioBlockStyle::embeddableFooter() const
 {
-	ScenarioBlockStyle::Type footer = Undefined;
-
-	if (m_type == SceneGroupHeader) {
-		footer = SceneGroupFooter;
-	} else if (m_type == FolderHeader) {
-		footer = FolderFooter;
-	}
-
-	return footer;
+	return embeddableFooter(m_type);
 }
 
 ScenarioBlockStyle::ScenarioBlockStyle(const QXmlStreamAttributes& _blockAttributes)
@@ -662,12 +811,15 @@ void ScenarioTemplate::saveToFile(const QString& _filePath) const
 	}
 }
 
-ScenarioBlockStyle ScenarioTemplate::blockStyle(ScenarioBlockStyle::Type _forType) const
+const ScenarioBlockStyle& ScenarioTemplate::blockStyle(ScenarioBlockStyle::Type _forType) const
 {
-	return m_blockStyles.value(_forType);
+	static const ScenarioBlockStyle EMPTY_STYLE;
+
+	QMap<ScenarioBlockStyle::Type, ScenarioBlockStyle>::const_iterator iter = m_blockStyles.constFind(_forType);
+	return iter != m_blockStyles.constEnd() ? iter.value() : EMPTY_STYLE;
 }
 
-BusinessLogic::ScenarioBlockStyle ScenarioTemplate::blockStyle(const QTextBlock& _forBlock) const
+const BusinessLogic::ScenarioBlockStyle& ScenarioTemplate::blockStyle(const QTextBlock& _forBlock) const
 {
 	return blockStyle(ScenarioBlockStyle::forBlock(_forBlock));
 }
@@ -849,6 +1001,7 @@ void ScenarioTemplate::load(const QString& _fromFile)
 
 QStandardItemModel* ScenarioTemplateFacade::templatesList()
 {
+	QMutexLocker locker(&s_mutex);
 	init();
 
 	return s_instance->m_templatesModel;
@@ -856,28 +1009,32 @@ QStandardItemModel* ScenarioTemplateFacade::templatesList()
 
 bool ScenarioTemplateFacade::containsTemplate(const QString& _templateName)
 {
+	QMutexLocker locker(&s_mutex);
 	init();
 
 	return s_instance->m_templates.contains(_templateName);
 }
 
-ScenarioTemplate ScenarioTemplateFacade::getTemplate(const QString& _templateName)
+const ScenarioTemplate& ScenarioTemplateFacade::getTemplate(const QString& _templateName)
 {
-	init();
+	//
+	// Шаблон принадлежит также библиотеке, поэтому ссылка остаётся действительной
+	//
+	return *getSharedTemplate(_templateName);
+}
 
-	const QString currentTemplate =
-			DataStorageLayer::StorageFacade::settingsStorage()->value(
-				"scenario-editor/current-style",
-				DataStorageLayer::SettingsStorage::ApplicationSettings);
+QSharedPointer<const ScenarioTemplate> ScenarioTemplateFacade::getSharedTemplate(const QString& _templateName)
+{
+	QMutexLocker locker(&s_mutex);
+	init();
 
-	ScenarioTemplate result;
+	QSharedPointer<const ScenarioTemplate> result;
 	if (_templateName.isEmpty()) {
-		if (!currentTemplate.isEmpty()
-			&& s_instance->m_templates.contains(currentTemplate)) {
-			result = s_instance->m_templates.value(currentTemplate);
-		} else {
-			result = s_instance->m_defaultTemplate;
+		if (s_instance->m_currentTemplate.isNull()) {
+			s_instance->m_currentTemplate =
+					s_instance->m_templates.value(s_instance->m_currentTemplateName, s_instance->m_defaultTemplate);
 		}
+		result = s_instance->m_currentTemplate;
 	} else {
 		//
 		// Передаём значением по-умолчанию стандартный шаблон, т.к. иногда, например при смене языка
@@ -889,14 +1046,23 @@ ScenarioTemplate ScenarioTemplateFacade::getTemplate(const QString& _templateNam
 	return result;
 }
 
+int ScenarioTemplateFacade::templatesVersion()
+{
+	QMutexLocker locker(&s_mutex);
+	init();
+
+	return s_instance->m_templatesVersion;
+}
+
 void ScenarioTemplateFacade::saveTemplate(const BusinessLogic::ScenarioTemplate& _template)
 {
+	QMutexLocker locker(&s_mutex);
 	init();
 
 	//
 	// Если такого шаблона ещё не было раньше, то добавляем строку в модель шаблонов
 	//
-	if (!containsTemplate(_template.name())) {
+	if (!s_instance->m_templates.contains(_template.name())) {
 		QStandardItem* stylesRootItem = s_instance->m_templatesModel->invisibleRootItem();
 		QList<QStandardItem*> templateRow;
 		templateRow << new QStandardItem(_template.name());
@@ -917,7 +1083,9 @@ void ScenarioTemplateFacade::saveTemplate(const BusinessLogic::ScenarioTemplate&
 	//
 	// Добавляем/обновляем шаблон в библиотеке
 	//
-	s_instance->m_templates.insert(_template.name(), _template);
+	s_instance->m_templates.insert(_template.name(), QSharedPointer<const ScenarioTemplate>(new ScenarioTemplate(_template)));
+	s_instance->m_currentTemplate.clear();
+	++s_instance->m_templatesVersion;
 
 
 	//
@@ -936,8 +1104,6 @@ void ScenarioTemplateFacade::saveTemplate(const BusinessLogic::ScenarioTemplate&
 
 bool ScenarioTemplateFacade::saveTemplate(const QString& _templateFilePath)
 {
-	init();
-
 	//
 	// Загружаем шаблон из файла
 	//
@@ -957,12 +1123,15 @@ bool ScenarioTemplateFacade::saveTemplate(const QString& _templateFilePath)
 
 void ScenarioTemplateFacade::removeTemplate(const QString& _templateName)
 {
+	QMutexLocker locker(&s_mutex);
 	init();
 
 	//
 	// Удалим шаблон из библиотеки
 	//
 	s_instance->m_templates.remove(_templateName);
+	s_instance->m_currentTemplate.clear();
+	++s_instance->m_templatesVersion;
 	foreach (QStandardItem* templateItem, s_instance->m_templatesModel->findItems(_templateName)) {
 		s_instance->m_templatesModel->removeRow(templateItem->row());
 	}
@@ -983,15 +1152,49 @@ void ScenarioTemplateFacade::removeTemplate(const QString& _templateName)
 
 void ScenarioTemplateFacade::updateTemplatesColors()
 {
+	QMutexLocker locker(&s_mutex);
 	init();
 
-	s_instance->m_defaultTemplate.updateBlocksColors();
+	//
+	// Шаблоны неизменяемы, поэтому заменяем их обновлёнными копиями
+	//
+	auto updateColors = [] (const QSharedPointer<const ScenarioTemplate>& _template) {
+		ScenarioTemplate* updatedTemplate = new ScenarioTemplate(*_template);
+		updatedTemplate->updateBlocksColors();
+		return QSharedPointer<const ScenarioTemplate>(updatedTemplate);
+	};
+
+	s_instance->m_defaultTemplate = updateColors(s_instance->m_defaultTemplate);
 	foreach (const QString& templateName, s_instance->m_templates.keys()) {
-		s_instance->m_templates[templateName].updateBlocksColors();
+		s_instance->m_templates[templateName] = updateColors(s_instance->m_templates.value(templateName));
+	}
+	s_instance->m_currentTemplate.clear();
+	++s_instance->m_templatesVersion;
+}
+
+void ScenarioTemplateFacade::updateCurrentTemplate()
+{
+	const QString currentTemplateName =
+			DataStorageLayer::StorageFacade::settingsStorage()->value(
+				"scenario-editor/current-style",
+				DataStorageLayer::SettingsStorage::ApplicationSettings);
+
+	QMutexLocker locker(&s_mutex);
+	init();
+
+	if (s_instance->m_currentTemplateName != currentTemplateName) {
+		s_instance->m_currentTemplateName = currentTemplateName;
+		s_instance->m_currentTemplate.clear();
+		++s_instance->m_templatesVersion;
 	}
 }
 
-ScenarioTemplateFacade::ScenarioTemplateFacade()
+ScenarioTemplateFacade::ScenarioTemplateFacade() :
+	m_currentTemplateName(
+		DataStorageLayer::StorageFacade::settingsStorage()->value(
+			"scenario-editor/current-style",
+			DataStorageLayer::SettingsStorage::ApplicationSettings)),
+	m_templatesVersion(0)
 {
 	//
 	// Настроим путь к папке с шаблонами
@@ -1039,32 +1242,32 @@ ScenarioTemplateFacade::ScenarioTemplateFacade()
 	QDir templatesDir(templatesFolderPath);
 	foreach (const QFileInfo& templateFile, templatesDir.entryInfoList(QDir::Files)) {
 		if (templateFile.suffix() == SCENARIO_TEMPLATE_FILE_EXTENSION) {
-			ScenarioTemplate templateObj(templateFile.absoluteFilePath());
-			if (!m_templates.contains(templateObj.name())) {
-				m_templates.insert(templateObj.name(), templateObj);
+			QSharedPointer<const ScenarioTemplate> templateObj(new ScenarioTemplate(templateFile.absoluteFilePath()));
+			if (!m_templates.contains(templateObj->name())) {
+				m_templates.insert(templateObj->name(), templateObj);
 			}
 		}
 	}
 	//
 	// ... шаблон по умолчанию
 	//
-	m_defaultTemplate = ScenarioTemplate(defaultTemplatePath);
+	m_defaultTemplate = QSharedPointer<const ScenarioTemplate>(new ScenarioTemplate(defaultTemplatePath));
 
 	//
 	// Настроим модель шаблонов
 	//
 	m_templatesModel = new QStandardItemModel;
 	QStandardItem* rootItem = m_templatesModel->invisibleRootItem();
-	foreach (const ScenarioTemplate& templateObj, m_templates.values()) {
+	foreach (const QSharedPointer<const ScenarioTemplate>& templateObj, m_templates.values()) {
 		QList<QStandardItem*> row;
-		row << new QStandardItem(templateObj.name());
-		row << new QStandardItem(templateObj.description());
+		row << new QStandardItem(templateObj->name());
+		row << new QStandardItem(templateObj->description());
 
 		//
 		// Отключаем возможность редактирования стандартного шаблона
 		//
 		bool isEditable = true;
-		if (templateObj.name() == m_defaultTemplate.name()) {
+		if (templateObj->name() == m_defaultTemplate->name()) {
 			isEditable = false;
 		}
 		row.first()->setData(isEditable, Qt::UserRole);
@@ -1084,3 +1287,4 @@ void ScenarioTemplateFacade::init()
 }
 
 ScenarioTemplateFacade* ScenarioTemplateFacade::s_instance = 0;
+QMutex ScenarioTemplateFacade::s_mutex;
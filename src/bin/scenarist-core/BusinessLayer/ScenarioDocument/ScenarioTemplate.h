@@ -1,7 +1,9 @@
 #ifndef SCENARIOTEMPLATE_H
 #define SCENARIOTEMPLATE_H
 
+#include <QMutex>
 #include <QPageSize>
+#include <QSharedPointer>
 #include <QTextFormat>
 
 class QStandardItemModel;
@@ -60,6 +62,41 @@ namespace BusinessLogic
 		 */
 		static ScenarioBlockStyle::Type forBlock(const QTextBlock& _block);
 
+		/**
+		 * @brief Является ли блок заданного типа частью группы
+		 */
+		static bool isEmbeddable(ScenarioBlockStyle::Type _type);
+
+		/**
+		 * @brief Является ли блок заданного типа заголовком группы
+		 */
+		static bool isEmbeddableHeader(ScenarioBlockStyle::Type _type);
+
+		/**
+		 * @brief Является ли блок заданного типа окончанием группы
+		 */
+		static bool isEmbeddableFooter(ScenarioBlockStyle::Type _type);
+
+		/**
+		 * @brief Блок закрывающий группу с заданным заголовком
+		 */
+		static ScenarioBlockStyle::Type embeddableFooter(ScenarioBlockStyle::Type _headerType);
+
+		/**
+		 * @brief Блок открывающий группу с заданным окончанием
+		 */
+		static ScenarioBlockStyle::Type embeddableHeader(ScenarioBlockStyle::Type _footerType);
+
+		/**
+		 * @brief Учитывается ли блок заданного типа в хронометраже
+		 */
+		static bool isChronometrable(ScenarioBlockStyle::Type _type);
+
+		/**
+		 * @brief Виден ли блок заданного типа в режиме сценария или поэпизодника
+		 */
+		static bool isVisible(ScenarioBlockStyle::Type _type, bool _outlineMode);
+
 		/**
 		 * @brief Дополнительные свойства стилей текстовых блоков
 		 */
@@ -216,7 +253,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Настройки стиля отображения блока
 		 */
-		QTextBlockFormat blockFormat() const { return m_blockFormat; }
+		const QTextBlockFormat& blockFormat() const { return m_blockFormat; }
 
 		/**
 		 * @brief Установить цвет фона блока
@@ -226,7 +263,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Настройки шрифта блока
 		 */
-		QTextCharFormat charFormat() const { return m_charFormat; }
+		const QTextCharFormat& charFormat() const { return m_charFormat; }
 
 		/**
 		 * @brief Установить цвет текста
@@ -430,12 +467,12 @@ namespace BusinessLogic
 		/**
 		 * @brief Получить стиль блока заданного типа
 		 */
-		ScenarioBlockStyle blockStyle(ScenarioBlockStyle::Type _forType) const;
+		const ScenarioBlockStyle& blockStyle(ScenarioBlockStyle::Type _forType) const;
 
 		/**
 		 * @brief Получить стиль заданного блока
 		 */
-		ScenarioBlockStyle blockStyle(const QTextBlock& _forBlock) const;
+		const ScenarioBlockStyle& blockStyle(const QTextBlock& _forBlock) const;
 
 		/**
 		 * @brief Установить наименование
@@ -533,8 +570,25 @@ namespace BusinessLogic
 		 * @brief Получить шаблон в соответствии с заданным именем
 		 *
 		 * Если имя не задано, возвращается стандартный шаблон
+		 * @note Ссылка действительна до изменения библиотеки шаблонов, для хранения шаблона
+		 *		 следует использовать getSharedTemplate
 		 */
-		static ScenarioTemplate getTemplate(const QString& _templateName = QString());
+		static const ScenarioTemplate& getTemplate(const QString& _templateName = QString());
+
+		/**
+		 * @brief Получить разделяемый неизменяемый шаблон в соответствии с заданным именем
+		 *
+		 * Шаблон остаётся действительным и неизменным, даже если в библиотеке он будет обновлён
+		 */
+		static QSharedPointer<const ScenarioTemplate> getSharedTemplate(const QString& _templateName = QString());
+
+		/**
+		 * @brief Версия шаблонов
+		 *
+		 * Увеличивается при любом изменении библиотеки шаблонов и при смене текущего шаблона,
+		 * позволяя дёшево определить необходимость обновления оформления
+		 */
+		static int templatesVersion();
 
 		/**
 		 * @brief Сохранить стиль в библиотеке шаблонов
@@ -554,21 +608,47 @@ namespace BusinessLogic
 		 */
 		static void updateTemplatesColors();
 
+		/**
+		 * @brief Перечитать название текущего шаблона из настроек
+		 * @note Вызывается при смене настроек, в остальное время текущий шаблон берётся из кэша
+		 */
+		static void updateCurrentTemplate();
+
 	private:
 		ScenarioTemplateFacade();
 		static ScenarioTemplateFacade* s_instance;
 		static void init();
 
+		/**
+		 * @brief Защита библиотеки шаблонов, к ней обращаются и фоновые потоки построения и экспорта
+		 */
+		static QMutex s_mutex;
+
 	private:
 		/**
 		 * @brief Шаблон по умолчанию
 		 */
-		ScenarioTemplate m_defaultTemplate;
+		QSharedPointer<const ScenarioTemplate> m_defaultTemplate;
 
 		/**
 		 * @brief Шаблоны сценариев
+		 * @note Шаблоны не изменяются, при обновлении шаблон в библиотеке заменяется новым
+		 */
+		QMap<QString, QSharedPointer<const ScenarioTemplate> > m_templates;
+
+		/**
+		 * @brief Название текущего шаблона из настроек и сам шаблон
+		 * @note Шаблон определяется по названию при первом обращении после изменения библиотеки
+		 */
+		/** @{ */
+		QString m_currentTemplateName;
+		QSharedPointer<const ScenarioTemplate> m_currentTemplate;
+		/** @} */
+
+		/**
+		 * @brief Версия шаблонов
 		 */
-		QMap<QString, ScenarioTemplate> m_templates;
+		int m_templatesVersion;
 
 		/**
 		 * @brief Модель шаблонов
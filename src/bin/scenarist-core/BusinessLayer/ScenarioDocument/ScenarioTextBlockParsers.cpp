@@ -124,19 +124,23 @@ QString SceneHeadingParser::timeName(const QString& _text)
 // ****
 
 QStringList SceneCharactersParser::characters(const QString& _text)
+{
+	return characters(_text, ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::SceneCharacters));
+}
+
+QStringList SceneCharactersParser::characters(const QString& _text, const ScenarioBlockStyle& _style)
 {
 	QString characters = _text.simplified();
 
 	//
 	// Удалим потенциальные приставку и окончание
 	//
-	ScenarioBlockStyle style = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::SceneCharacters);
-	QString stylePrefix = style.prefix();
+	QString stylePrefix = _style.prefix();
 	if (!stylePrefix.isEmpty()
 		&& characters.startsWith(stylePrefix)) {
 		characters.remove(QRegularExpression(QString("^[%1]").arg(stylePrefix)));
 	}
-	QString stylePostfix = style.postfix();
+	QString stylePostfix = _style.postfix();
 	if (!stylePostfix.isEmpty()
 		&& characters.endsWith(stylePostfix)) {
 		characters.remove(QRegularExpression(QString("[%1]$").arg(stylePostfix)));
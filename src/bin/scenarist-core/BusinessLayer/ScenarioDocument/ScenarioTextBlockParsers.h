@@ -7,6 +7,9 @@ class QStringList;
 
 namespace BusinessLogic
 {
+	class ScenarioBlockStyle;
+
+
 	/**
 	 * @brief Парсер текста блока персонаж
 	 */
@@ -98,6 +101,12 @@ namespace BusinessLogic
 		 * @brief Определить список участников
 		 */
 		static QStringList characters(const QString& _text);
+
+		/**
+		 * @brief Определить список участников, используя заданный стиль блока
+		 * @note Не обращается к текущему шаблону, поэтому может использоваться вне потока интерфейса
+		 */
+		static QStringList characters(const QString& _text, const ScenarioBlockStyle& _style);
 	};
 }
 
@@ -17,7 +17,7 @@
 #include <3rd_party/Widgets/QLightBoxWidget/qlightboxprogress.h>
 
 #include <QApplication>
-#include <QCryptographicHash>
+#include <QElapsedTimer>
 #include <QTextBlock>
 
 //
@@ -38,12 +38,37 @@ namespace {
 	const int MAX_UNDO_REDO_STACK_SIZE = 50;
 
 	/**
-	 * @brief Получить хэш текста
+	 * @brief Интервал обновления прогресса применения патчей (мс)
 	 */
-	static QByteArray textMd5Hash(const QString& _text) {
-		QCryptographicHash hash(QCryptographicHash::Md5);
-		hash.addData(_text.toUtf8());
-		return hash.result();
+	const int PROGRESS_UPDATE_INTERVAL = 100;
+
+	/**
+	 * @brief Хэши-ограничители начала и конца документа
+	 */
+	/** @{ */
+	const quint64 DOCUMENT_START_HASH = Q_UINT64_C(0x9e3779b97f4a7c15);
+	const quint64 DOCUMENT_END_HASH = Q_UINT64_C(0xc2b2ae3d27d4eb4f);
+	/** @} */
+
+	/**
+	 * @brief Получить 64-битный хэш xml блока
+	 */
+	static quint64 xmlHash(const QString& _blockXml) {
+		return (quint64(qHash(_blockXml, 0x5bd1e995)) << 32) | qHash(_blockXml, 0x1b873593);
+	}
+
+	/**
+	 * @brief Получить хэш пары соседних блоков
+	 * @note Хэш зависит от порядка блоков, поэтому перестановка блоков меняет составной хэш
+	 */
+	static quint64 blocksPairHash(quint64 _previousBlockHash, quint64 _nextBlockHash) {
+		quint64 hash = _previousBlockHash ^ (_nextBlockHash * Q_UINT64_C(0x9e3779b97f4a7c15) + 1);
+		hash ^= hash >> 30;
+		hash *= Q_UINT64_C(0xbf58476d1ce4e5b9);
+		hash ^= hash >> 27;
+		hash *= Q_UINT64_C(0x94d049bb133111eb);
+		hash ^= hash >> 31;
+		return hash;
 	}
 
 	/**
@@ -68,6 +93,10 @@ ScenarioTextDocument::ScenarioTextDocument(QObject *parent, ScenarioXml* _xmlHan
 	QTextDocument(parent),
 	m_xmlHandler(_xmlHandler),
 	m_isPatchApplyProcessed(false),
+	m_blocksXmlCombinedHash(0),
+	m_isScenarioXmlDirty(false),
+	m_changeFrom(-1),
+	m_changeNewTo(-1),
 	m_reviewModel(new ScenarioReviewModel(this)),
 	m_outlineMode(false)
 {
@@ -76,20 +105,72 @@ ScenarioTextDocument::ScenarioTextDocument(QObject *parent, ScenarioXml* _xmlHan
 
 void ScenarioTextDocument::updateScenarioXml()
 {
-	const QString newScenarioXml = m_xmlHandler->scenarioToXml();
-	const QByteArray newScenarioXmlHash = ::textMd5Hash(newScenarioXml);
+	//
+	// Формируем xml всех блоков документа заново
+	//
+	trackBlocksChange(0, m_blocksXml.size(), blockCount());
+	m_blocksXml.clear();
+	m_blocksXmlHashes.clear();
+	m_blocksPlainLengths.clear();
+	m_blocksXmlCombinedHash = ::blocksPairHash(DOCUMENT_START_HASH, DOCUMENT_END_HASH);
+	replaceBlocksXml(0, 0, blockCount());
+}
+
+void ScenarioTextDocument::updateScenarioXml(int _position, int _charsRemoved, int _charsAdded)
+{
+	Q_UNUSED(_charsRemoved);
 
 	//
-	// Если текущий текст сценария отличается от последнего сохранённого
+	// Определим диапазон изменённых блоков в текущем состоянии документа
 	//
-	if (newScenarioXmlHash != m_scenarioXmlHash) {
-		m_scenarioXml = newScenarioXml;
-		m_scenarioXmlHash = newScenarioXmlHash;
+	const QTextBlock firstChangedBlock = findBlock(_position);
+	QTextBlock lastChangedBlock = findBlock(_position + _charsAdded);
+	if (!lastChangedBlock.isValid()) {
+		lastChangedBlock = lastBlock();
+	}
+
+	//
+	// Блоки после изменённых остаются нетронутыми, поэтому количество заменяемых блоков
+	// определяем по количеству неизменившихся блоков в конце документа
+	//
+	const int changedFrom = firstChangedBlock.blockNumber();
+	const int changedNewTo = lastChangedBlock.blockNumber() + 1;
+	const int changedOldTo = m_blocksXml.size() - (blockCount() - changedNewTo);
+
+	//
+	// Если состояние рассинхронизировалось, то формируем xml заново
+	//
+	if (m_blocksXml.isEmpty()
+		|| !firstChangedBlock.isValid()
+		|| changedOldTo < changedFrom) {
+		updateScenarioXml();
+	}
+	//
+	// В противном случае обновляем только изменённые блоки
+	//
+	else {
+		trackBlocksChange(changedFrom, changedOldTo, changedNewTo);
+		replaceBlocksXml(changedFrom, changedOldTo, changedNewTo);
 	}
 }
 
 QString ScenarioTextDocument::scenarioXml() const
 {
+	if (m_isScenarioXmlDirty) {
+		int xmlLength = 0;
+		foreach (const QString& blockXml, m_blocksXml) {
+			xmlLength += blockXml.length();
+		}
+
+		QString xml;
+		xml.reserve(xmlLength);
+		foreach (const QString& blockXml, m_blocksXml) {
+			xml.append(blockXml);
+		}
+		m_scenarioXml = ScenarioXml::makeMimeFromXml(xml);
+		m_isScenarioXmlDirty = false;
+	}
+
 	return m_scenarioXml;
 }
 
@@ -119,9 +200,8 @@ void ScenarioTextDocument::load(const QString& _scenarioXml)
 	// Загружаем проект
 	//
 	m_xmlHandler->xmlToScenario(0, scenarioXml);
-	m_scenarioXml = scenarioXml;
-	m_scenarioXmlHash = ::textMd5Hash(scenarioXml);
-	m_lastSavedScenarioXml = m_scenarioXml;
+	updateScenarioXml();
+	resetBlocksChange();
 	m_lastSavedScenarioXmlHash = m_scenarioXmlHash;
 
 	//
@@ -136,13 +216,13 @@ void ScenarioTextDocument::load(const QString& _scenarioXml)
 	foreach (DomainObject* obj, DataStorageLayer::StorageFacade::scenarioChangeStorage()->all()->toList()) {
 		ScenarioChange* ch = dynamic_cast<ScenarioChange*>(obj);
 		if (!ch->isDraft()) {
-			m_undoStack.append(ch);
+			m_undoStack.append(StackedChange(ch));
 		}
 	}
 	foreach (DomainObject* obj, DataStorageLayer::StorageFacade::scenarioChangeStorage()->all()->toList()) {
 		ScenarioChange* ch = dynamic_cast<ScenarioChange*>(obj);
 		if (!ch->isDraft()) {
-			m_redoStack.prepend(ch);
+			m_redoStack.prepend(StackedChange(ch));
 		}
 	}
 #endif
@@ -184,7 +264,7 @@ void ScenarioTextDocument::applyPatch(const QString& _patch)
 	//
 	QPair<DiffMatchPatchHelper::ChangeXml, DiffMatchPatchHelper::ChangeXml> xmlsForUpdate;
 	const QString patchUncopressed = DatabaseHelper::uncompress(_patch);
-	xmlsForUpdate = DiffMatchPatchHelper::changedXml(m_scenarioXml, patchUncopressed);
+	xmlsForUpdate = DiffMatchPatchHelper::changedXml(scenarioXml(), patchUncopressed);
 
 	//
 	// Выделяем текст сценария, соответствующий xml для обновления
@@ -220,9 +300,8 @@ void ScenarioTextDocument::applyPatch(const QString& _patch)
 	//
 	// Запомним новый текст
 	//
-	m_scenarioXml = m_xmlHandler->scenarioToXml();
-	m_scenarioXmlHash = ::textMd5Hash(m_scenarioXml);
-	m_lastSavedScenarioXml = m_scenarioXml;
+	updateScenarioXml();
+	resetBlocksChange();
 	m_lastSavedScenarioXmlHash = m_scenarioXmlHash;
 
 
@@ -237,33 +316,48 @@ void ScenarioTextDocument::applyPatches(const QList<QString>& _patches)
 
 
 	//
-	// Применяем патчи
+	// Применяем патчи к плоскому тексту, не преобразуя его в xml после каждого из них
 	//
-	QString newXml = m_scenarioXml;
+	const QString oldPlain = DiffMatchPatchHelper::xmlToPlain(scenarioXml());
+	QString newPlain = oldPlain;
+	QElapsedTimer progressTimer;
+	progressTimer.start();
 	int currentIndex = 0, max = _patches.size();
 	foreach (const QString& patch, _patches) {
 		const QString patchUncopressed = DatabaseHelper::uncompress(patch);
-		newXml = DiffMatchPatchHelper::applyPatchXml(newXml, patchUncopressed);
-		QLightBoxProgress::setProgressValue(++currentIndex * 100 / max);
-		QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+		newPlain = DiffMatchPatchHelper::applyPatch(newPlain, DiffMatchPatchHelper::xmlToPlain(patchUncopressed));
+
+		//
+		// ... прогресс обновляем не после каждого патча, а через равные промежутки времени
+		//
+		++currentIndex;
+		if (progressTimer.elapsed() >= PROGRESS_UPDATE_INTERVAL
+			|| currentIndex == max) {
+			QLightBoxProgress::setProgressValue(currentIndex * 100 / max);
+			QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+			progressTimer.restart();
+		}
 	}
 
 	//
-	// Перезагружаем текст документа
+	// Обновляем в документе только изменившиеся блоки, а если не удалось, то перезагружаем его целиком
 	//
-	QTextCursor cursor(this);
-	cursor.beginEditBlock();
-	cursor.select(QTextCursor::Document);
-	cursor.removeSelectedText();
-	m_xmlHandler->xmlToScenario(0, ScenarioXml::makeMimeFromXml(newXml));
-	cursor.endEditBlock();
+	if (newPlain != oldPlain
+		&& !replaceChangedBlocks(oldPlain, newPlain)) {
+		QTextCursor cursor(this);
+		cursor.beginEditBlock();
+		cursor.select(QTextCursor::Document);
+		cursor.removeSelectedText();
+		m_xmlHandler->xmlToScenario(0, ScenarioXml::makeMimeFromXml(DiffMatchPatchHelper::plainToXml(newPlain)));
+		cursor.endEditBlock();
+
+		updateScenarioXml();
+	}
 
 	//
 	// Запомним новый текст
 	//
-	m_scenarioXml = m_xmlHandler->scenarioToXml();
-	m_scenarioXmlHash = ::textMd5Hash(m_scenarioXml);
-	m_lastSavedScenarioXml = m_scenarioXml;
+	resetBlocksChange();
 	m_lastSavedScenarioXmlHash = m_scenarioXmlHash;
 
 
@@ -280,33 +374,58 @@ Domain::ScenarioChange* ScenarioTextDocument::saveChanges()
 		// Если текущий текст сценария отличается от последнего сохранённого
 		//
 		if (m_scenarioXmlHash != m_lastSavedScenarioXmlHash) {
-			//
-			// Сформируем изменения
-			//
-			const QString undoPatch = DiffMatchPatchHelper::makePatchXml(m_scenarioXml, m_lastSavedScenarioXml);
-			const QString undoPatchCompressed = DatabaseHelper::compress(undoPatch);
-			const QString redoPatch = DiffMatchPatchHelper::makePatchXml(m_lastSavedScenarioXml, m_scenarioXml);
-			const QString redoPatchCompressed = DatabaseHelper::compress(redoPatch);
-
-			//
-			// Сохраним изменения
-			//
-			change = ::saveChange(undoPatchCompressed, redoPatchCompressed);
-
-			//
-			// Запомним новый текст
-			//
-			m_lastSavedScenarioXml = m_scenarioXml;
+			const ScenarioBlocksChange blocksChange = takeBlocksChange();
 			m_lastSavedScenarioXmlHash = m_scenarioXmlHash;
 
-			//
-			// Корректируем стеки последних действий
-			//
-			if (m_undoStack.size() == MAX_UNDO_REDO_STACK_SIZE)  {
-				m_undoStack.takeFirst();
+			if (!blocksChange.isEmpty()) {
+				//
+				// Для совместимости с другими версиями программы сохраняем изменения в виде патчей,
+				// формируя их только по изменённым блокам и соседним с ними для контекста
+				//
+				const int contextFrom = qMax(0, blocksChange.position - 1);
+				const int insertedTo = blocksChange.position + blocksChange.insertedBlocks.size();
+				const int contextTo = qMin(m_blocksXml.size(), insertedTo + 1);
+				QString oldXml;
+				QString newXml;
+				for (int blockNumber = contextFrom; blockNumber < blocksChange.position; ++blockNumber) {
+					oldXml.append(m_blocksXml.at(blockNumber));
+				}
+				foreach (const QString& blockXml, blocksChange.removedBlocks) {
+					oldXml.append(blockXml);
+				}
+				for (int blockNumber = insertedTo; blockNumber < contextTo; ++blockNumber) {
+					oldXml.append(m_blocksXml.at(blockNumber));
+				}
+				for (int blockNumber = contextFrom; blockNumber < contextTo; ++blockNumber) {
+					newXml.append(m_blocksXml.at(blockNumber));
+				}
+				int plainOffset = 0;
+				for (int blockNumber = 0; blockNumber < contextFrom; ++blockNumber) {
+					plainOffset += m_blocksPlainLengths.at(blockNumber);
+				}
+
+				//
+				// Сформируем изменения
+				//
+				const QString undoPatch = DiffMatchPatchHelper::makePatchXml(newXml, oldXml, plainOffset);
+				const QString undoPatchCompressed = DatabaseHelper::compress(undoPatch);
+				const QString redoPatch = DiffMatchPatchHelper::makePatchXml(oldXml, newXml, plainOffset);
+				const QString redoPatchCompressed = DatabaseHelper::compress(redoPatch);
+
+				//
+				// Сохраним изменения
+				//
+				change = ::saveChange(undoPatchCompressed, redoPatchCompressed);
+
+				//
+				// Корректируем стеки последних действий
+				//
+				if (m_undoStack.size() == MAX_UNDO_REDO_STACK_SIZE)  {
+					m_undoStack.takeFirst();
+				}
+				m_undoStack.append(StackedChange(change, blocksChange));
+				m_redoStack.clear();
 			}
-			m_undoStack.append(change);
-			m_redoStack.clear();
 		}
 	}
 
@@ -318,15 +437,18 @@ void ScenarioTextDocument::undoReimpl()
 	saveChanges();
 
 	if (!m_undoStack.isEmpty()) {
-		Domain::ScenarioChange* change = m_undoStack.takeLast();
+		const StackedChange stackedChange = m_undoStack.takeLast();
+		Domain::ScenarioChange* change = stackedChange.change;
 
 #ifdef PATCH_DEBUG
 		qDebug() << "*******************************************************************";
 		qDebug() << change->uuid().toString() << change->user() << characterCount();
 #endif
 
-		m_redoStack.append(change);
-		applyPatch(change->undoPatch());
+		m_redoStack.append(stackedChange);
+		if (!applyBlocksChange(stackedChange.blocksChange.reversed())) {
+			applyPatch(change->undoPatch());
+		}
 
 		//
 		// Сохраним изменения
@@ -339,15 +461,18 @@ void ScenarioTextDocument::undoReimpl()
 void ScenarioTextDocument::redoReimpl()
 {
 	if (!m_redoStack.isEmpty()) {
-		Domain::ScenarioChange* change = m_redoStack.takeLast();
+		const StackedChange stackedChange = m_redoStack.takeLast();
+		Domain::ScenarioChange* change = stackedChange.change;
 
 #ifdef PATCH_DEBUG
 		qDebug() << "*******************************************************************";
 		qDebug() << change->uuid().toString() << change->user() << characterCount();
 #endif
 
-		m_undoStack.append(change);
-		applyPatch(change->redoPatch());
+		m_undoStack.append(stackedChange);
+		if (!applyBlocksChange(stackedChange.blocksChange)) {
+			applyPatch(change->redoPatch());
+		}
 
 		//
 		// Сохраним изменения
@@ -404,18 +529,13 @@ void ScenarioTextDocument::setOutlineMode(bool _outlineMode)
 	if (m_outlineMode != _outlineMode) {
 		m_outlineMode = _outlineMode;
 
-		//
-		// Сформируем список типов блоков для отображения
-		//
-		QList<ScenarioBlockStyle::Type> visibleBlocksTypes = this->visibleBlocksTypes();
-
 		//
 		// Пробегаем документ и настраиваем видимые и невидимые блоки
 		//
 		QTextCursor cursor(this);
 		while (!cursor.atEnd()) {
 			QTextBlock block = cursor.block();
-			block.setVisible(visibleBlocksTypes.contains(ScenarioBlockStyle::forBlock(block)));
+			block.setVisible(ScenarioBlockStyle::isVisible(ScenarioBlockStyle::forBlock(block), m_outlineMode));
 			cursor.movePosition(QTextCursor::EndOfBlock);
 			cursor.movePosition(QTextCursor::NextBlock);
 		}
@@ -454,3 +574,285 @@ QList<ScenarioBlockStyle::Type> ScenarioTextDocument::visibleBlocksTypes() const
 
 	return m_outlineMode ? s_outlineVisibleBlocksTypes : s_scenarioVisibleBlocksTypes;
 }
+
+void ScenarioTextDocument::replaceBlocksXml(int _from, int _oldTo, int _newTo)
+{
+	const quint64 lastCombinedHash = m_blocksXmlCombinedHash;
+
+	//
+	// Исключаем из составного хэша пары, в которые входят заменяемые блоки
+	//
+	for (int blockNumber = _from; blockNumber <= _oldTo; ++blockNumber) {
+		m_blocksXmlCombinedHash -= ::blocksPairHash(blockXmlHash(blockNumber - 1), blockXmlHash(blockNumber));
+	}
+
+	//
+	// Заменяем xml блоков
+	//
+	m_blocksXml.remove(_from, _oldTo - _from);
+	m_blocksXml.insert(_from, _newTo - _from, QString());
+	m_blocksXmlHashes.remove(_from, _oldTo - _from);
+	m_blocksXmlHashes.insert(_from, _newTo - _from, 0);
+	m_blocksPlainLengths.remove(_from, _oldTo - _from);
+	m_blocksPlainLengths.insert(_from, _newTo - _from, 0);
+	QTextBlock block = findBlockByNumber(_from);
+	for (int blockNumber = _from; blockNumber < _newTo && block.isValid(); ++blockNumber) {
+		m_blocksXml[blockNumber] = m_xmlHandler->scenarioBlockToXml(block);
+		m_blocksXmlHashes[blockNumber] = ::xmlHash(m_blocksXml.at(blockNumber));
+		m_blocksPlainLengths[blockNumber] = DiffMatchPatchHelper::plainLength(m_blocksXml.at(blockNumber));
+		block = block.next();
+	}
+
+	//
+	// Добавляем в составной хэш пары с новыми блоками
+	//
+	for (int blockNumber = _from; blockNumber <= _newTo; ++blockNumber) {
+		m_blocksXmlCombinedHash += ::blocksPairHash(blockXmlHash(blockNumber - 1), blockXmlHash(blockNumber));
+	}
+
+	//
+	// Если xml изменился, то обновим хэш, а сам текст сформируем при первом обращении к нему
+	//
+	if (m_blocksXmlCombinedHash != lastCombinedHash
+		|| m_scenarioXmlHash.isEmpty()) {
+		m_scenarioXmlHash = QByteArray::number(m_blocksXmlCombinedHash, 16);
+		m_isScenarioXmlDirty = true;
+	}
+}
+
+quint64 ScenarioTextDocument::blockXmlHash(int _blockNumber) const
+{
+	if (_blockNumber < 0) {
+		return DOCUMENT_START_HASH;
+	}
+
+	if (_blockNumber >= m_blocksXmlHashes.size()) {
+		return DOCUMENT_END_HASH;
+	}
+
+	return m_blocksXmlHashes.at(_blockNumber);
+}
+
+void ScenarioTextDocument::trackBlocksChange(int _from, int _oldTo, int _newTo)
+{
+	//
+	// Изменения, вносимые патчами, не отслеживаем
+	//
+	if (m_isPatchApplyProcessed) {
+		return;
+	}
+
+	//
+	// Первое изменение после сохранения
+	//
+	if (m_changeFrom == -1) {
+		m_changeFrom = _from;
+		m_changeNewTo = _newTo;
+		m_changeRemovedBlocks = m_blocksXml.mid(_from, _oldTo - _from);
+		return;
+	}
+
+	//
+	// Расширяем отслеживаемый диапазон до затронутых блоков, которые ещё не менялись,
+	// их текущий xml совпадает с сохранённым
+	//
+	if (_from < m_changeFrom) {
+		QVector<QString> removedBlocks = m_blocksXml.mid(_from, m_changeFrom - _from);
+		removedBlocks += m_changeRemovedBlocks;
+		m_changeRemovedBlocks = removedBlocks;
+		m_changeFrom = _from;
+	}
+	if (_oldTo > m_changeNewTo) {
+		m_changeRemovedBlocks += m_blocksXml.mid(m_changeNewTo, _oldTo - m_changeNewTo);
+		m_changeNewTo = _oldTo;
+	}
+
+	//
+	// Сдвигаем конец диапазона на количество добавленных, или удалённых блоков
+	//
+	m_changeNewTo += _newTo - _oldTo;
+}
+
+ScenarioBlocksChange ScenarioTextDocument::takeBlocksChange()
+{
+	ScenarioBlocksChange change;
+	if (m_changeFrom != -1) {
+		change.position = m_changeFrom;
+		change.removedBlocks = m_changeRemovedBlocks;
+		change.insertedBlocks = m_blocksXml.mid(m_changeFrom, m_changeNewTo - m_changeFrom);
+		change.trim();
+	}
+
+	resetBlocksChange();
+
+	return change;
+}
+
+void ScenarioTextDocument::resetBlocksChange()
+{
+	m_changeFrom = -1;
+	m_changeNewTo = -1;
+	m_changeRemovedBlocks.clear();
+}
+
+bool ScenarioTextDocument::applyBlocksChange(const ScenarioBlocksChange& _change)
+{
+	//
+	// Изменение можно применить, только если заменяемые блоки есть в документе в том же виде,
+	// а в противном случае применяется патч, т.к. текст мог быть изменён другим пользователем
+	//
+	const int removedTo = _change.position + _change.removedBlocks.size();
+	if (_change.removedBlocks.isEmpty()
+		|| _change.insertedBlocks.isEmpty()
+		|| _change.position < 0
+		|| removedTo > m_blocksXml.size()
+		|| m_blocksXml.size() != blockCount()) {
+		return false;
+	}
+	for (int index = 0; index < _change.removedBlocks.size(); ++index) {
+		if (_change.removedBlocks.at(index).isEmpty()
+			|| m_blocksXml.at(_change.position + index) != _change.removedBlocks.at(index)) {
+			return false;
+		}
+	}
+	QString insertedXml;
+	foreach (const QString& blockXml, _change.insertedBlocks) {
+		if (blockXml.isEmpty()) {
+			return false;
+		}
+		insertedXml.append(blockXml);
+	}
+
+
+	emit beforePatchApply();
+	m_isPatchApplyProcessed = true;
+
+	//
+	// Замещаем текст изменяемых блоков
+	//
+	replaceBlocks(_change.position, removedTo, insertedXml);
+
+	//
+	// Xml блоков обновляется по сигналу об изменении текста, если он не был обновлён,
+	// или текст получился отличным от ожидаемого, то формируем xml заново
+	//
+	bool isXmlActual = m_blocksXml.size() == blockCount()
+					   && _change.position + _change.insertedBlocks.size() <= m_blocksXml.size();
+	for (int index = 0; isXmlActual && index < _change.insertedBlocks.size(); ++index) {
+		isXmlActual = m_blocksXml.at(_change.position + index) == _change.insertedBlocks.at(index);
+	}
+	if (!isXmlActual) {
+		updateScenarioXml();
+	}
+	resetBlocksChange();
+	m_lastSavedScenarioXmlHash = m_scenarioXmlHash;
+
+	m_isPatchApplyProcessed = false;
+	emit afterPatchApply();
+
+	return true;
+}
+
+bool ScenarioTextDocument::replaceChangedBlocks(const QString& _oldPlain, const QString& _newPlain)
+{
+	const int blocksCount = m_blocksXml.size();
+	if (blocksCount == 0
+		|| blocksCount != blockCount()
+		|| blocksCount != m_blocksPlainLengths.size()) {
+		return false;
+	}
+
+	//
+	// Определим совпадающие начало и конец текстов
+	//
+	const int minLength = qMin(_oldPlain.length(), _newPlain.length());
+	int prefixLength = 0;
+	while (prefixLength < minLength
+		   && _oldPlain.at(prefixLength) == _newPlain.at(prefixLength)) {
+		++prefixLength;
+	}
+	int suffixLength = 0;
+	while (suffixLength < minLength - prefixLength
+		   && _oldPlain.at(_oldPlain.length() - suffixLength - 1)
+			  == _newPlain.at(_newPlain.length() - suffixLength - 1)) {
+		++suffixLength;
+	}
+
+	//
+	// Блоки, целиком попадающие в совпадающие начало и конец, не изменились
+	//
+	int from = 0;
+	int fromPlainPos = 0;
+	while (from < blocksCount
+		   && fromPlainPos + m_blocksPlainLengths.at(from) <= prefixLength) {
+		fromPlainPos += m_blocksPlainLengths.at(from);
+		++from;
+	}
+	int to = blocksCount;
+	int toPlainLength = 0;
+	while (to > from
+		   && toPlainLength + m_blocksPlainLengths.at(to - 1) <= suffixLength) {
+		toPlainLength += m_blocksPlainLengths.at(to - 1);
+		--to;
+	}
+
+	//
+	// Заменить можно только существующие блоки и только на непустой текст,
+	// поэтому при необходимости захватываем соседние неизменившиеся блоки
+	//
+	while (from == to
+		   || _newPlain.length() - toPlainLength - fromPlainPos == 0) {
+		if (to < blocksCount) {
+			toPlainLength -= m_blocksPlainLengths.at(to);
+			++to;
+		} else if (from > 0) {
+			--from;
+			fromPlainPos -= m_blocksPlainLengths.at(from);
+		} else {
+			return false;
+		}
+	}
+
+	//
+	// Замещаем изменившиеся блоки
+	//
+	const QString newXml =
+			DiffMatchPatchHelper::plainToXml(
+				_newPlain.mid(fromPlainPos, _newPlain.length() - toPlainLength - fromPlainPos));
+	replaceBlocks(from, to, newXml);
+
+	//
+	// Xml блоков обновляется по сигналу об изменении текста, если он не был обновлён,
+	// или текст получился отличным от ожидаемого, то формируем xml заново
+	//
+	const int newTo = to + blockCount() - blocksCount;
+	bool isXmlActual = m_blocksXml.size() == blockCount() && from <= newTo;
+	if (isXmlActual) {
+		QString replacedXml;
+		for (int blockNumber = from; blockNumber < newTo; ++blockNumber) {
+			replacedXml.append(m_blocksXml.at(blockNumber));
+		}
+		isXmlActual = replacedXml == newXml;
+	}
+	if (!isXmlActual) {
+		updateScenarioXml();
+	}
+
+	return true;
+}
+
+void ScenarioTextDocument::replaceBlocks(int _from, int _to, const QString& _xml)
+{
+	const QTextBlock firstBlock = findBlockByNumber(_from);
+	const QTextBlock lastBlock = findBlockByNumber(_to - 1);
+	const int selectionStartPos = firstBlock.position();
+	const int selectionEndPos = lastBlock.position() + lastBlock.length() - 1;
+
+	QTextCursor cursor(this);
+	cursor.beginEditBlock();
+	cursor.setPosition(selectionStartPos);
+	cursor.setPosition(selectionEndPos, QTextCursor::KeepAnchor);
+	cursor.removeSelectedText();
+	m_xmlHandler->xmlToScenario(selectionStartPos, ScenarioXml::makeMimeFromXml(_xml));
+	cursor.endEditBlock();
+}
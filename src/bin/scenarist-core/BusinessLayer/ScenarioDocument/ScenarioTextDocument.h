@@ -1,10 +1,12 @@
 #ifndef SCENARIOTEXTDOCUMENT_H
 #define SCENARIOTEXTDOCUMENT_H
 
+#include "ScenarioBlocksChange.h"
 #include "ScenarioTemplate.h"
 
 #include <QTextDocument>
 #include <QTextCursor>
+#include <QVector>
 
 namespace Domain {
 	class ScenarioChange;
@@ -39,6 +41,12 @@ namespace BusinessLogic
 		 */
 		void updateScenarioXml();
 
+		/**
+		 * @brief Обновить xml сценария только для блоков, затронутых изменением текста
+		 * @note Параметры соответствуют сигналу contentsChange
+		 */
+		void updateScenarioXml(int _position, int _charsRemoved, int _charsAdded);
+
 		/**
 		 * @brief Получить xml сценария
 		 */
@@ -71,7 +79,8 @@ namespace BusinessLogic
 
 		/**
 		 * @brief Применить множество патчей
-		 * @note Метод для оптимизации, перестраивается весь документ
+		 * @note Патчи применяются последовательно к плоскому тексту сценария,
+		 *		 после чего в документе заменяются только изменившиеся блоки
 		 */
 		void applyPatches(const QList<QString>& _patches);
 
@@ -136,6 +145,71 @@ namespace BusinessLogic
 		 */
 		void reviewChanged();
 
+	private:
+		/**
+		 * @brief Заменить xml блоков в диапазоне [_from, _oldTo) на xml блоков [_from, _newTo) документа
+		 */
+		void replaceBlocksXml(int _from, int _oldTo, int _newTo);
+
+		/**
+		 * @brief Хэш xml блока с заданным номером, для граничных индексов возвращаются хэши-ограничители
+		 */
+		quint64 blockXmlHash(int _blockNumber) const;
+
+		/**
+		 * @brief Учесть в несохранённом изменении замену блоков [_from, _oldTo) на блоки [_from, _newTo)
+		 * @note Вызывается до обновления xml блоков
+		 */
+		void trackBlocksChange(int _from, int _oldTo, int _newTo);
+
+		/**
+		 * @brief Забрать накопленное с момента последнего сохранения изменение
+		 */
+		ScenarioBlocksChange takeBlocksChange();
+
+		/**
+		 * @brief Сбросить накопленное изменение
+		 */
+		void resetBlocksChange();
+
+		/**
+		 * @brief Применить изменение блоков
+		 * @return false, если текущие блоки документа не соответствуют изменению
+		 */
+		bool applyBlocksChange(const ScenarioBlocksChange& _change);
+
+		/**
+		 * @brief Заменить в документе блоки, которые отличаются в новом плоском тексте от старого
+		 * @return false, если определить изменившиеся блоки не удалось
+		 */
+		bool replaceChangedBlocks(const QString& _oldPlain, const QString& _newPlain);
+
+		/**
+		 * @brief Заменить блоки [_from, _to) документа блоками из xml
+		 */
+		void replaceBlocks(int _from, int _to, const QString& _xml);
+
+	private:
+		/**
+		 * @brief Элемент стека отмены/повтора последнего действия
+		 */
+		struct StackedChange {
+			StackedChange(Domain::ScenarioChange* _change = 0,
+				const ScenarioBlocksChange& _blocksChange = ScenarioBlocksChange()) :
+				change(_change), blocksChange(_blocksChange) {}
+
+			/**
+			 * @brief Сохранённое в базе изменение
+			 */
+			Domain::ScenarioChange* change;
+
+			/**
+			 * @brief Изменение блоков для быстрого применения
+			 * @note Если пусто, то применяется патч сохранённого изменения
+			 */
+			ScenarioBlocksChange blocksChange;
+		};
+
 	private:
 		/**
 		 * @brief Обработчик xml
@@ -148,27 +222,57 @@ namespace BusinessLogic
 		bool m_isPatchApplyProcessed;
 
 		/**
-		 * @brief  Xml текст сценария и его MD5-хэш
+		 * @brief Xml каждого из блоков документа и их хэши
+		 * @note Индекс в списке соответствует номеру блока в документе
 		 */
 		/** @{ */
-		QString m_scenarioXml;
-		QByteArray m_scenarioXmlHash;
+		QVector<QString> m_blocksXml;
+		QVector<quint64> m_blocksXmlHashes;
 		/** @} */
 
 		/**
-		 * @brief Xml текст сценария и его MD5-хэш на момент последнего сохранения изменений
+		 * @brief Длины блоков в плоском представлении xml, используемом для патчей
+		 */
+		QVector<int> m_blocksPlainLengths;
+
+		/**
+		 * @brief Составной хэш сценария, сумма хэшей всех пар соседних блоков
+		 * @note Позволяет пересчитывать хэш только для изменённых блоков
+		 */
+		quint64 m_blocksXmlCombinedHash;
+
+		/**
+		 * @brief Xml текст сценария и его хэш
+		 * @note Xml собирается из блоков только по требованию
 		 */
 		/** @{ */
-		QString m_lastSavedScenarioXml;
+		mutable QString m_scenarioXml;
+		mutable bool m_isScenarioXmlDirty;
+		QByteArray m_scenarioXmlHash;
+		/** @} */
+
+		/**
+		 * @brief Хэш сценария на момент последнего сохранения изменений
+		 */
 		QByteArray m_lastSavedScenarioXmlHash;
+
+		/**
+		 * @brief Изменение, накопленное с момента последнего сохранения
+		 * @note Блоки [m_changeFrom, m_changeNewTo) текущего документа заменили сохранённые
+		 *		 блоки m_changeRemovedBlocks, если m_changeFrom равен -1, то изменений нет
+		 */
+		/** @{ */
+		int m_changeFrom;
+		int m_changeNewTo;
+		QVector<QString> m_changeRemovedBlocks;
 		/** @} */
 
 		/**
 		 * @brief Стеки для отмены/повтора последнего действия
 		 */
 		/** @{ */
-		QList<Domain::ScenarioChange*> m_undoStack;
-		QList<Domain::ScenarioChange*> m_redoStack;
+		QList<StackedChange> m_undoStack;
+		QList<StackedChange> m_redoStack;
 		/** @{ */
 
 		/**
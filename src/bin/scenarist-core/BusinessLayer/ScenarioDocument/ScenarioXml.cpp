@@ -158,6 +158,19 @@ ScenarioXml::ScenarioXml(ScenarioDocument* _scenario) :
 }
 
 QString ScenarioXml::scenarioToXml()
+{
+	QString resultXml;
+
+	QTextBlock currentBlock = m_scenario->document()->begin();
+	do {
+		resultXml.append(scenarioBlockToXml(currentBlock));
+		currentBlock = currentBlock.next();
+	} while (currentBlock.isValid());
+
+	return makeMimeFromXml(resultXml);
+}
+
+QString ScenarioXml::scenarioBlockToXml(const QTextBlock& _block)
 {
 	//
 	// Для формирования xml не используем QXmlStreamWriter, т.к. нам нужно хранить по отдельности
@@ -165,160 +178,149 @@ QString ScenarioXml::scenarioToXml()
 	// оставляя место для записи атрибутов. В результате это приводит к появлению в xml
 	// странных последовательностей, наподобии ">>" или ">/>"
 	//
+	const uint blockHash = ::blockHash(_block);
 
-	QString resultXml;
+	//
+	// Если для блока есть кэш, используем его
+	//
+	if (m_xmlCache.contains(blockHash)) {
+		return *m_xmlCache[blockHash];
+	}
 
-	QTextBlock currentBlock = m_scenario->document()->begin();
+	//
+	// В противном случае формируем xml
+	//
 	QString currentBlockXml;
-	do {
-		currentBlockXml.clear();
-		const uint currentBlockHash = ::blockHash(currentBlock);
+	//
+	// Определим тип текущего блока
+	//
+	ScenarioBlockStyle::Type currentType = ScenarioBlockStyle::forBlock(_block);
 
-		//
-		// Если для блока есть кэш, используем его
-		//
-		if (m_xmlCache.contains(currentBlockHash)) {
-			resultXml.append(m_xmlCache[currentBlockHash]);
+	//
+	// Получить текст под курсором
+	//
+	QString textToSave = TextEditHelper::toHtmlEscaped(_block.text());
+
+	//
+	// Определить параметры текущего абзаца
+	//
+	bool needWrite = true; // пишем абзац?
+	QString currentNode = ScenarioBlockStyle::typeName(currentType); // имя текущей ячейки
+	bool canHaveColors = false; // может иметь цвета
+	switch (currentType) {
+		case ScenarioBlockStyle::SceneHeading: {
+			canHaveColors = true;
+			break;
 		}
-		//
-		// В противном случае формируем xml
-		//
-		else {
-			//
-			// Определим тип текущего блока
-			//
-			ScenarioBlockStyle::Type currentType = ScenarioBlockStyle::forBlock(currentBlock);
 
-			//
-			// Получить текст под курсором
-			//
-			QString textToSave = TextEditHelper::toHtmlEscaped(currentBlock.text());
+		case ScenarioBlockStyle::Parenthetical: {
+			needWrite = !textToSave.isEmpty();
+			break;
+		}
 
-			//
-			// Определить параметры текущего абзаца
-			//
-			bool needWrite = true; // пишем абзац?
-			QString currentNode = ScenarioBlockStyle::typeName(currentType); // имя текущей ячейки
-			bool canHaveColors = false; // может иметь цвета
-			switch (currentType) {
-				case ScenarioBlockStyle::SceneHeading: {
-					canHaveColors = true;
-					break;
-				}
+		case ScenarioBlockStyle::SceneGroupHeader: {
+			canHaveColors = true;
+			break;
+		}
 
-				case ScenarioBlockStyle::Parenthetical: {
-					needWrite = !textToSave.isEmpty();
-					break;
-				}
+		case ScenarioBlockStyle::FolderHeader: {
+			canHaveColors = true;
+			break;
+		}
 
-				case ScenarioBlockStyle::SceneGroupHeader: {
-					canHaveColors = true;
-					break;
-				}
+		default: {
+			break;
+		}
+	}
 
-				case ScenarioBlockStyle::FolderHeader: {
-					canHaveColors = true;
-					break;
+	//
+	// Дописать xml
+	//
+	if (needWrite) {
+		//
+		// Если возможно, сохраним uuid, цвета элемента и его заголовок
+		//
+		QString uuidColorsAndTitle;
+		if (canHaveColors) {
+			if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(_block.userData())) {
+				if (!info->uuid().isEmpty()) {
+					uuidColorsAndTitle = QString(" %1=\"%2\"").arg(ATTRIBUTE_UUID, info->uuid());
 				}
-
-				default: {
-					break;
+				if (!info->colors().isEmpty()) {
+					uuidColorsAndTitle += QString(" %1=\"%2\"").arg(ATTRIBUTE_COLOR, info->colors());
+				}
+				if (!info->title().isEmpty()) {
+					uuidColorsAndTitle += QString(" %1=\"%2\"").arg(ATTRIBUTE_TITLE, info->title());
 				}
 			}
+		}
 
-			//
-			// Дописать xml
-			//
-			if (needWrite) {
-				//
-				// Если возможно, сохраним uuid, цвета элемента и его заголовок
-				//
-				QString uuidColorsAndTitle;
-				if (canHaveColors) {
-					if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(currentBlock.userData())) {
-						if (!info->uuid().isEmpty()) {
-							uuidColorsAndTitle = QString(" %1=\"%2\"").arg(ATTRIBUTE_UUID, info->uuid());
-						}
-						if (!info->colors().isEmpty()) {
-							uuidColorsAndTitle += QString(" %1=\"%2\"").arg(ATTRIBUTE_COLOR, info->colors());
-						}
-						if (!info->title().isEmpty()) {
-							uuidColorsAndTitle += QString(" %1=\"%2\"").arg(ATTRIBUTE_TITLE, info->title());
-						}
-					}
-				}
+		//
+		// Открыть ячейку текущего элемента
+		//
+		currentBlockXml.append(QString("<%1%2>\n").arg(currentNode, uuidColorsAndTitle));
 
-				//
-				// Открыть ячейку текущего элемента
-				//
-				currentBlockXml.append(QString("<%1%2>\n").arg(currentNode, uuidColorsAndTitle));
+		//
+		// Пишем текст текущего элемента
+		//
+		currentBlockXml.append(QString("<%1><![CDATA[%2]]></%1>\n").arg(NODE_VALUE, textToSave));
 
-				//
-				// Пишем текст текущего элемента
-				//
-				currentBlockXml.append(QString("<%1><![CDATA[%2]]></%1>\n").arg(NODE_VALUE, textToSave));
+		//
+		// Пишем редакторские комментарии, если они есть в блоке
+		//
+		if (::hasReviewMarks(_block)) {
+			currentBlockXml.append(QString("<%1>\n").arg(NODE_REVIEW_GROUP));
+			foreach (const QTextLayout::FormatRange& range, _block.textFormats()) {
+				bool isReviewMark =
+					range.format.boolProperty(ScenarioBlockStyle::PropertyIsReviewMark);
 
 				//
-				// Пишем редакторские комментарии, если они есть в блоке
+				// Все редакторские правки, и только, если выделен записываемый текст
 				//
-				if (::hasReviewMarks(currentBlock)) {
-					currentBlockXml.append(QString("<%1>\n").arg(NODE_REVIEW_GROUP));
-					foreach (const QTextLayout::FormatRange& range, currentBlock.textFormats()) {
-						bool isReviewMark =
-							range.format.boolProperty(ScenarioBlockStyle::PropertyIsReviewMark);
-
-						//
-						// Все редакторские правки, и только, если выделен записываемый текст
-						//
-						if (isReviewMark) {
-							currentBlockXml.append(QString("<%1").arg(NODE_REVIEW));
-							currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_FROM, QString::number(range.start)));
-							currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_LENGTH, QString::number(range.length)));
-							if (range.format.hasProperty(QTextFormat::ForegroundBrush)) {
-								currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_COLOR, range.format.foreground().color().name()));
-							}
-							if (range.format.hasProperty(QTextFormat::BackgroundBrush)) {
-								currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_BGCOLOR, range.format.background().color().name()));
-							}
-							currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_IS_HIGHLIGHT,
-								range.format.boolProperty(ScenarioBlockStyle::PropertyIsHighlight) ? "true" : "false"));
-							currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_DONE,
-								range.format.boolProperty(ScenarioBlockStyle::PropertyIsDone) ? "true" : "false"));
-							currentBlockXml.append(">\n");
-							//
-							// ... комментарии
-							//
-							const QStringList comments = range.format.property(ScenarioBlockStyle::PropertyComments).toStringList();
-							const QStringList authors = range.format.property(ScenarioBlockStyle::PropertyCommentsAuthors).toStringList();
-							const QStringList dates = range.format.property(ScenarioBlockStyle::PropertyCommentsDates).toStringList();
-							for (int commentIndex = 0; commentIndex < comments.size(); ++commentIndex) {
-								currentBlockXml.append(QString("<%1").arg(NODE_REVIEW_COMMENT));
-								currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_COMMENT,
-									TextEditHelper::toHtmlEscaped(comments.at(commentIndex))));
-								currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_AUTHOR, authors.at(commentIndex)));
-								currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_DATE, dates.at(commentIndex)));
-								currentBlockXml.append("/>\n");
-							}
-							//
-							currentBlockXml.append(QString("</%1>\n").arg(NODE_REVIEW));
-						}
+				if (isReviewMark) {
+					currentBlockXml.append(QString("<%1").arg(NODE_REVIEW));
+					currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_FROM, QString::number(range.start)));
+					currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_LENGTH, QString::number(range.length)));
+					if (range.format.hasProperty(QTextFormat::ForegroundBrush)) {
+						currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_COLOR, range.format.foreground().color().name()));
 					}
-					currentBlockXml.append(QString("</%1>\n").arg(NODE_REVIEW_GROUP));
+					if (range.format.hasProperty(QTextFormat::BackgroundBrush)) {
+						currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_BGCOLOR, range.format.background().color().name()));
+					}
+					currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_IS_HIGHLIGHT,
+						range.format.boolProperty(ScenarioBlockStyle::PropertyIsHighlight) ? "true" : "false"));
+					currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_DONE,
+						range.format.boolProperty(ScenarioBlockStyle::PropertyIsDone) ? "true" : "false"));
+					currentBlockXml.append(">\n");
+					//
+					// ... комментарии
+					//
+					const QStringList comments = range.format.property(ScenarioBlockStyle::PropertyComments).toStringList();
+					const QStringList authors = range.format.property(ScenarioBlockStyle::PropertyCommentsAuthors).toStringList();
+					const QStringList dates = range.format.property(ScenarioBlockStyle::PropertyCommentsDates).toStringList();
+					for (int commentIndex = 0; commentIndex < comments.size(); ++commentIndex) {
+						currentBlockXml.append(QString("<%1").arg(NODE_REVIEW_COMMENT));
+						currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_COMMENT,
+							TextEditHelper::toHtmlEscaped(comments.at(commentIndex))));
+						currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_AUTHOR, authors.at(commentIndex)));
+						currentBlockXml.append(QString(" %1=\"%2\"").arg(ATTRIBUTE_REVIEW_DATE, dates.at(commentIndex)));
+						currentBlockXml.append("/>\n");
+					}
+					//
+					currentBlockXml.append(QString("</%1>\n").arg(NODE_REVIEW));
 				}
-
-				//
-				// Закрываем текущий элемент
-				//
-				currentBlockXml.append(QString("</%1>\n").arg(currentNode));
 			}
-
-			m_xmlCache.insert(currentBlockHash, new QString(currentBlockXml));
-			resultXml.append(currentBlockXml);
+			currentBlockXml.append(QString("</%1>\n").arg(NODE_REVIEW_GROUP));
 		}
-		currentBlock = currentBlock.next();
-	} while (currentBlock.isValid());
 
-	return makeMimeFromXml(resultXml);
+		//
+		// Закрываем текущий элемент
+		//
+		currentBlockXml.append(QString("</%1>\n").arg(currentNode));
+	}
+
+	m_xmlCache.insert(blockHash, new QString(currentBlockXml));
+	return currentBlockXml;
 }
 
 QString ScenarioXml::scenarioToXml(int _startPosition, int _endPosition, bool _correctLastMime)
@@ -840,7 +842,7 @@ void ScenarioXml::xmlToScenarioV0(int _position, const QString& _xml)
 				// Если определён тип блока, то обработать его
 				//
 				if (tokenType != ScenarioBlockStyle::Undefined) {
-					ScenarioBlockStyle currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(tokenType);
+					const ScenarioBlockStyle& currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(tokenType);
 
 					if (!firstBlockHandling) {
 						cursor.insertBlock();
@@ -850,7 +852,7 @@ void ScenarioXml::xmlToScenarioV0(int _position, const QString& _xml)
 					// Если нужно добавим заголовок стиля
 					//
 					if (currentStyle.hasHeader()) {
-						ScenarioBlockStyle headerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(currentStyle.headerType());
+						const ScenarioBlockStyle& headerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(currentStyle.headerType());
 						cursor.setBlockFormat(headerStyle.blockFormat());
 						cursor.setBlockCharFormat(headerStyle.charFormat());
 						cursor.setCharFormat(headerStyle.charFormat());
@@ -884,8 +886,7 @@ void ScenarioXml::xmlToScenarioV0(int _position, const QString& _xml)
 				// Если необходимо, загрузить информацию о сцене
 				//
 				if (tokenType == ScenarioBlockStyle::SceneHeading
-					|| tokenType == ScenarioBlockStyle::SceneGroupHeader
-					|| tokenType == ScenarioBlockStyle::FolderHeader) {
+					|| ScenarioBlockStyle::isEmbeddableHeader(tokenType)) {
 					QString synopsis = reader.attributes().value("synopsis").toString();
 					ScenarioTextBlockInfo* info = new ScenarioTextBlockInfo;
 					bool htmlEscaped = true;
@@ -908,7 +909,7 @@ void ScenarioXml::xmlToScenarioV0(int _position, const QString& _xml)
 					//
 					// Если необходимо так же вставляем префикс и постфикс стиля
 					//
-					ScenarioBlockStyle currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(lastTokenType);
+					const ScenarioBlockStyle& currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(lastTokenType);
 					if (!currentStyle.prefix().isEmpty()
 						&& !textToInsert.startsWith(currentStyle.prefix())) {
 						textToInsert.prepend(currentStyle.prefix());
@@ -988,7 +989,7 @@ void ScenarioXml::xmlToScenarioV1(int _position, const QString& _xml)
 				// Если определён тип блока, то обработать его
 				//
 				if (tokenType != ScenarioBlockStyle::Undefined) {
-					ScenarioBlockStyle currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(tokenType);
+					const ScenarioBlockStyle& currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(tokenType);
 
 					if (firstBlockHandling) {
 						cursor.block().setVisible(true);
@@ -1021,8 +1022,7 @@ void ScenarioXml::xmlToScenarioV1(int _position, const QString& _xml)
 					// Если необходимо, загрузить информацию о сцене
 					//
 					if (tokenType == ScenarioBlockStyle::SceneHeading
-						|| tokenType == ScenarioBlockStyle::SceneGroupHeader
-						|| tokenType == ScenarioBlockStyle::FolderHeader) {
+						|| ScenarioBlockStyle::isEmbeddableHeader(tokenType)) {
 						ScenarioTextBlockInfo* info = new ScenarioTextBlockInfo;
 						if (reader.attributes().hasAttribute(ATTRIBUTE_UUID)) {
 							info->setUuid(reader.attributes().value(ATTRIBUTE_UUID).toString());
@@ -1039,7 +1039,7 @@ void ScenarioXml::xmlToScenarioV1(int _position, const QString& _xml)
 					//
 					// Скрываем блоки, которых не должно быть видно в текщем режиме сценария
 					//
-					if (!m_scenario->document()->visibleBlocksTypes().contains(tokenType)) {
+					if (!ScenarioBlockStyle::isVisible(tokenType, m_scenario->document()->outlineMode())) {
 						cursor.block().setVisible(false);
 					}
 				}
@@ -1122,7 +1122,7 @@ void ScenarioXml::xmlToScenarioV1(int _position, const QString& _xml)
 					//
 					// Если необходимо так же вставляем префикс и постфикс стиля
 					//
-					ScenarioBlockStyle currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(lastTokenType);
+					const ScenarioBlockStyle& currentStyle = ScenarioTemplateFacade::getTemplate().blockStyle(lastTokenType);
 					if (!currentStyle.prefix().isEmpty()
 						&& !textToInsert.startsWith(currentStyle.prefix())) {
 						textToInsert.prepend(currentStyle.prefix());
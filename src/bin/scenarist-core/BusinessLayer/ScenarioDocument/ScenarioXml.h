@@ -47,6 +47,12 @@ namespace BusinessLogic
 		 */
 		QString scenarioToXml();
 
+		/**
+		 * @brief Сформировать xml-описание отдельного блока текста
+		 * @note Используется для пошагового обновления xml сценария, результат кэшируется
+		 */
+		QString scenarioBlockToXml(const QTextBlock& _block);
+
 		/**
 		 * @brief Записать сценарий в xml-строку из заданного диапазона текста
 		 */
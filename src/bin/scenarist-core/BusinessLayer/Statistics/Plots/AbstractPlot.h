@@ -8,10 +8,10 @@
 #include <QStringList>
 #include <QVector>
 
-class QTextDocument;
-
 namespace BusinessLogic
 {
+	class ScenarioSnapshot;
+
 	/**
 	 * @brief Данные графика
 	 */
@@ -80,7 +80,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Сформировать график по заданному сценарию с установленными параметрами
 		 */
-		virtual Plot makePlot(QTextDocument* _scenario,
+		virtual Plot makePlot(const ScenarioSnapshot& _scenario,
 			const StatisticsParameters& _parameters) const = 0;
 	};
 }
@@ -1,33 +1,16 @@
 #include "CharactersActivityPlot.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
-#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
-#include <BusinessLayer/Chronometry/ChronometerFacade.h>
-
-#include <DataLayer/DataStorageLayer/StorageFacade.h>
-#include <DataLayer/DataStorageLayer/CharacterStorage.h>
-
-#include <Domain/Character.h>
-
-#include <3rd_party/Widgets/PagesTextEdit/PageTextEdit.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
-#include <QTextBlock>
-#include <QTextDocument>
 #include <QTextEdit>
 #include <QRegularExpression>
 
 using namespace BusinessLogic;
 
 namespace {
-	/**
-	 * @brief Стиль документа
-	 */
-	static ScenarioTemplate editorStyle() {
-		return ScenarioTemplateFacade::getTemplate();
-	}
-
 	/**
 	 * @brief Цвет для графика по персонажу
 	 *		  Пробуем получить неповторяющие пастельные цвета
@@ -50,25 +33,17 @@ QString CharactersActivityPlot::plotName(const BusinessLogic::StatisticsParamete
 	return QApplication::translate("BusinessLogic::CharactersActivityPlot", "Characters Activity Plot");
 }
 
-Plot CharactersActivityPlot::makePlot(QTextDocument* _scenario, const BusinessLogic::StatisticsParameters& _parameters) const
+Plot CharactersActivityPlot::makePlot(const ScenarioSnapshot& _scenario, const BusinessLogic::StatisticsParameters& _parameters) const
 {
-	PageTextEdit edit;
-	edit.setUsePageMode(true);
-	edit.setPageFormat(::editorStyle().pageSizeId());
-	edit.setPageMargins(::editorStyle().pageMargins());
-	edit.setDocument(_scenario->clone());
-
 	//
 	// Сформируем регулярное выражение для выуживания молчаливых персонажей
 	//
 	QString rxPattern;
-	foreach (DomainObject* characterObject,
-			 DataStorageLayer::StorageFacade::characterStorage()->all()->toList()) {
-		Character* character = dynamic_cast<Character*>(characterObject);
+	foreach (const QString& characterName, _scenario.characters()) {
 		if (rxPattern.isEmpty()) {
-			rxPattern.append(character->name());
+			rxPattern.append(characterName);
 		} else {
-			rxPattern.append("|" + character->name());
+			rxPattern.append("|" + characterName);
 		}
 	}
 	rxPattern.prepend("(^|\\W)(");
@@ -80,27 +55,26 @@ Plot CharactersActivityPlot::makePlot(QTextDocument* _scenario, const BusinessLo
 	//
 	// Бежим по документу и собираем информацию о сценах и персонажах в них
 	//
-	QTextBlock block = _scenario->begin();
 	QList<SceneData*> scenesDataList;
 	SceneData* currentData = 0;
 	QStringList characters;
-	while (block.isValid()) {
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
+	const ScenarioBlockStyle& sceneCharactersStyle =
+			_scenario.scenarioTemplate().blockStyle(ScenarioBlockStyle::SceneCharacters);
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
 			currentData = new SceneData;
 			scenesDataList.append(currentData);
 			//
-			if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
-				currentData->number = info->sceneNumber();
-			}
+			currentData->number = block.sceneNumber;
 		}
 		//
 		if (currentData != 0
-			&& !block.text().isEmpty()) {
+			&& !block.text.isEmpty()) {
 			//
 			// Участники сцены
 			//
-			if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneCharacters) {
-				const QStringList sceneCharacters = SceneCharactersParser::characters(block.text().toUpper());
+			if (block.type == ScenarioBlockStyle::SceneCharacters) {
+				const QStringList sceneCharacters = SceneCharactersParser::characters(block.text.toUpper(), sceneCharactersStyle);
 				foreach (const QString& character, sceneCharacters) {
 					//
 					// Первое появление
@@ -124,8 +98,8 @@ Plot CharactersActivityPlot::makePlot(QTextDocument* _scenario, const BusinessLo
 			//
 			// Персонаж
 			//
-			else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
-				const QString character = CharacterParser::name(block.text().toUpper());
+			else if (block.type == ScenarioBlockStyle::Character) {
+				const QString character = CharacterParser::name(block.text.toUpper());
 				//
 				// Первое появление
 				//
@@ -151,8 +125,8 @@ Plot CharactersActivityPlot::makePlot(QTextDocument* _scenario, const BusinessLo
 			//
 			// Описание действия, выуживаем молчаливых
 			//
-			else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Action) {
-				QRegularExpressionMatch match = rxCharacterFinder.match(block.text());
+			else if (block.type == ScenarioBlockStyle::Action) {
+				QRegularExpressionMatch match = rxCharacterFinder.match(block.text);
 				while (match.hasMatch()) {
 					const QString character = match.captured(2).toUpper();
 					//
@@ -176,14 +150,12 @@ Plot CharactersActivityPlot::makePlot(QTextDocument* _scenario, const BusinessLo
 					//
 					// Ищем дальше
 					//
-					match = rxCharacterFinder.match(block.text(), match.capturedEnd());
+					match = rxCharacterFinder.match(block.text, match.capturedEnd());
 				}
 			}
 
-			currentData->chron += ChronometerFacade::calculate(block);
+			currentData->chron += block.duration;
 		}
-
-		block = block.next();
 	}
 
 
@@ -22,7 +22,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Сформировать график по заданному сценарию с установленными параметрами
 		 */
-		Plot makePlot(QTextDocument* _scenario,
+		Plot makePlot(const ScenarioSnapshot& _scenario,
 			const StatisticsParameters& _parameters) const;
 
 	private:
@@ -5,11 +5,12 @@
 
 #include <QString>
 
-class QTextDocument;
-
 
 namespace BusinessLogic
 {
+	class ScenarioSnapshot;
+
+
 	/**
 	 * @brief Базовый класс для отчёта
 	 */
@@ -26,7 +27,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Сформировать отчёт по заданному сценарию с установленными параметрами
 		 */
-		virtual QString makeReport(QTextDocument* _scenario,
+		virtual QString makeReport(const ScenarioSnapshot& _scenario,
 			const StatisticsParameters& _parameters) const = 0;
 	};
 }
@@ -2,15 +2,9 @@
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
-
-#include <DataLayer/DataStorageLayer/StorageFacade.h>
-#include <DataLayer/DataStorageLayer/CharacterStorage.h>
-
-#include <Domain/Character.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
-#include <QTextBlock>
-#include <QTextDocument>
 #include <QRegularExpression>
 
 using namespace BusinessLogic;
@@ -30,20 +24,18 @@ QString CastReport::reportName(const StatisticsParameters&) const
 	return QApplication::translate("BusinessLogic::CastReport", "Cast Report");
 }
 
-QString CastReport::makeReport(QTextDocument* _scenario,
+QString CastReport::makeReport(const ScenarioSnapshot& _scenario,
 	const BusinessLogic::StatisticsParameters& _parameters) const
 {
 	//
 	// Сформируем регулярное выражение для выуживания молчаливых персонажей
 	//
 	QString rxPattern;
-	foreach (DomainObject* characterObject,
-			 DataStorageLayer::StorageFacade::characterStorage()->all()->toList()) {
-		Character* character = dynamic_cast<Character*>(characterObject);
+	foreach (const QString& characterName, _scenario.characters()) {
 		if (rxPattern.isEmpty()) {
-			rxPattern.append(character->name());
+			rxPattern.append(characterName);
 		} else {
-			rxPattern.append("|" + character->name());
+			rxPattern.append("|" + characterName);
 		}
 	}
 	rxPattern.prepend("(^|\\W)(");
@@ -55,24 +47,25 @@ QString CastReport::makeReport(QTextDocument* _scenario,
 	//
 	// Бежим по документу и собираем информацию о сценах и персонажах в них
 	//
-	QTextBlock block = _scenario->begin();
 	QList<CharacterData*> reportCharactersDataList;
 	QStringList characters;
 	QStringList sceneSpeakingCharacters;
 	QStringList sceneNonspeakingCharacters;
-	while (block.isValid()) {
+	const ScenarioBlockStyle& sceneCharactersStyle =
+			_scenario.scenarioTemplate().blockStyle(ScenarioBlockStyle::SceneCharacters);
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
 		//
 		// Сцена, всё очищаем
 		//
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
 			sceneSpeakingCharacters.clear();
 			sceneNonspeakingCharacters.clear();
 		}
 		//
 		// Список персонажей, всех в молчаливых
 		//
-		else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneCharacters) {
-			const QStringList sceneCharacters = SceneCharactersParser::characters(block.text().toUpper());
+		else if (block.type == ScenarioBlockStyle::SceneCharacters) {
+			const QStringList sceneCharacters = SceneCharactersParser::characters(block.text.toUpper(), sceneCharactersStyle);
 			foreach (const QString& character, sceneCharacters) {
 				if (!characters.contains(character)) {
 					characters.append(character);
@@ -94,8 +87,8 @@ QString CastReport::makeReport(QTextDocument* _scenario,
 		//
 		// Персонаж +1 реплика и в список говорящих
 		//
-		else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
-			const QString character = CharacterParser::name(block.text().toUpper());
+		else if (block.type == ScenarioBlockStyle::Character) {
+			const QString character = CharacterParser::name(block.text.toUpper());
 			if (!characters.contains(character)) {
 				characters.append(character);
 				sceneSpeakingCharacters.append(character);
@@ -138,9 +131,9 @@ QString CastReport::makeReport(QTextDocument* _scenario,
 		//
 		// Описание действия, в молчаливые, если ещё не встречался
 		//
-		else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Action
-				 && !block.text().isEmpty()) {
-			QRegularExpressionMatch match = rxCharacterFinder.match(block.text());
+		else if (block.type == ScenarioBlockStyle::Action
+				 && !block.text.isEmpty()) {
+			QRegularExpressionMatch match = rxCharacterFinder.match(block.text);
 			while (match.hasMatch()) {
 				const QString character = match.captured(2).toUpper();
 				if (!characters.contains(character)) {
@@ -162,11 +155,9 @@ QString CastReport::makeReport(QTextDocument* _scenario,
 				//
 				// Ищем дальше
 				//
-				match = rxCharacterFinder.match(block.text(), match.capturedEnd());
+				match = rxCharacterFinder.match(block.text, match.capturedEnd());
 			}
 		}
-
-		block = block.next();
 	}
 
 	//
@@ -1,26 +1,14 @@
 #include "CharacterReport.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
-#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
-#include <3rd_party/Widgets/PagesTextEdit/PageTextEdit.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
 #include <QPalette>
-#include <QTextBlock>
-#include <QTextDocument>
 
 using namespace BusinessLogic;
 
-namespace {
-	/**
-	 * @brief Стиль документа
-	 */
-	static ScenarioTemplate editorStyle() {
-		return ScenarioTemplateFacade::getTemplate();
-	}
-}
-
 
 QString CharacterReport::reportName(const StatisticsParameters& _parameters) const
 {
@@ -30,7 +18,7 @@ QString CharacterReport::reportName(const StatisticsParameters& _parameters) con
 	return name;
 }
 
-QString CharacterReport::makeReport(QTextDocument* _scenario,
+QString CharacterReport::makeReport(const ScenarioSnapshot& _scenario,
 	const BusinessLogic::StatisticsParameters& _parameters) const
 {
 	if (_parameters.characterNames.isEmpty()) {
@@ -38,39 +26,28 @@ QString CharacterReport::makeReport(QTextDocument* _scenario,
 	}
 
 
-	PageTextEdit edit;
-	edit.setUsePageMode(true);
-	edit.setPageFormat(::editorStyle().pageSizeId());
-	edit.setPageMargins(::editorStyle().pageMargins());
-	edit.setDocument(_scenario->clone());
-
 	//
 	// Бежим по документу и собираем информацию о сценах
 	//
-	QTextBlock block = _scenario->begin();
-	QTextCursor cursor = edit.textCursor();
 	QList<ReportData*> reportScenesDataList;
 	ReportData* currentData = 0;
 	bool saveDialogues = false;
 	QString characterName;
-	while (block.isValid()) {
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
 			currentData = new ReportData;
 			reportScenesDataList.append(currentData);
 			//
-			currentData->scene = block.text().toUpper();
+			currentData->scene = block.text.toUpper();
 			//
-			cursor.setPosition(block.position());
-			currentData->page = edit.cursorPage(cursor);
+			currentData->page = block.page;
 			//
-			if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
-				currentData->number = info->sceneNumber();
-			}
+			currentData->number = block.sceneNumber;
 		}
 		//
 		if (currentData != 0) {
-			if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
-				characterName = CharacterParser::name(block.text().toUpper());
+			if (block.type == ScenarioBlockStyle::Character) {
+				characterName = CharacterParser::name(block.text.toUpper());
 				if (_parameters.characterNames.contains(characterName)) {
 					saveDialogues = true;
 					if (!currentData->dialogues.isEmpty()) {
@@ -79,15 +56,13 @@ QString CharacterReport::makeReport(QTextDocument* _scenario,
 				} else {
 					saveDialogues = false;
 				}
-			} else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Dialogue
-					   || ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Parenthetical) {
+			} else if (block.type == ScenarioBlockStyle::Dialogue
+					   || block.type == ScenarioBlockStyle::Parenthetical) {
 				if (saveDialogues) {
-					currentData->dialogues.append({ characterName, block.text(), block.position() });
+					currentData->dialogues.append({ characterName, block.text, block.position });
 				}
 			}
 		}
-
-		block = block.next();
 	}
 
 
@@ -1,70 +1,44 @@
 #include "LocationReport.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
-#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
 #include <BusinessLayer/Chronometry/ChronometerFacade.h>
-
-#include <3rd_party/Widgets/PagesTextEdit/PageTextEdit.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
-#include <QTextBlock>
-#include <QTextDocument>
 
 using namespace BusinessLogic;
 
-namespace {
-	/**
-	 * @brief Стиль документа
-	 */
-	static ScenarioTemplate editorStyle() {
-		return ScenarioTemplateFacade::getTemplate();
-	}
-}
-
 
 QString LocationReport::reportName(const StatisticsParameters&) const
 {
 	return QApplication::translate("BusinessLogic::LocationReport", "Location Report");
 }
 
-QString LocationReport::makeReport(QTextDocument* _scenario,
+QString LocationReport::makeReport(const ScenarioSnapshot& _scenario,
 	const BusinessLogic::StatisticsParameters& _parameters) const
 {
 
-	PageTextEdit edit;
-	edit.setUsePageMode(true);
-	edit.setPageFormat(::editorStyle().pageSizeId());
-	edit.setPageMargins(::editorStyle().pageMargins());
-	edit.setDocument(_scenario->clone());
-
 	//
 	// Бежим по документу и собираем информацию о сценах
 	//
-	QTextBlock block = _scenario->begin();
-	QTextCursor cursor = edit.textCursor();
 	QList<ReportData*> reportScenesDataList;
 	ReportData* currentData = 0;
-	while (block.isValid()) {
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
 			currentData = new ReportData;
 			reportScenesDataList.append(currentData);
 			//
-			currentData->name = block.text().toUpper();
+			currentData->name = block.text.toUpper();
 			//
-			cursor.setPosition(block.position());
-			currentData->page = edit.cursorPage(cursor);
+			currentData->page = block.page;
 			//
-			if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
-				currentData->number = info->sceneNumber();
-			}
+			currentData->number = block.sceneNumber;
 		}
 		//
 		if (currentData != 0) {
-			currentData->chron += ChronometerFacade::calculate(block);
+			currentData->chron += block.duration;
 		}
-
-		block = block.next();
 	}
 
 	//
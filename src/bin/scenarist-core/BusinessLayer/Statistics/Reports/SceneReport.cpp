@@ -1,60 +1,34 @@
 #include "SceneReport.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
-#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h>
 #include <BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h>
 #include <BusinessLayer/Chronometry/ChronometerFacade.h>
-
-#include <DataLayer/DataStorageLayer/StorageFacade.h>
-#include <DataLayer/DataStorageLayer/CharacterStorage.h>
-
-#include <Domain/Character.h>
-
-#include <3rd_party/Widgets/PagesTextEdit/PageTextEdit.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
-#include <QTextBlock>
-#include <QTextDocument>
 #include <QTextEdit>
 #include <QRegularExpression>
 
 using namespace BusinessLogic;
 
-namespace {
-	/**
-	 * @brief Стиль документа
-	 */
-	static ScenarioTemplate editorStyle() {
-		return ScenarioTemplateFacade::getTemplate();
-	}
-}
-
 
 QString SceneReport::reportName(const StatisticsParameters&) const
 {
 	return QApplication::translate("BusinessLogic::SceneReport", "Scene Report");
 }
 
-QString SceneReport::makeReport(QTextDocument* _scenario,
+QString SceneReport::makeReport(const ScenarioSnapshot& _scenario,
 	const BusinessLogic::StatisticsParameters& _parameters) const
 {
-	PageTextEdit edit;
-	edit.setUsePageMode(true);
-	edit.setPageFormat(::editorStyle().pageSizeId());
-	edit.setPageMargins(::editorStyle().pageMargins());
-	edit.setDocument(_scenario->clone());
-
 	//
 	// Сформируем регулярное выражение для выуживания молчаливых персонажей
 	//
 	QString rxPattern;
-	foreach (DomainObject* characterObject,
-			 DataStorageLayer::StorageFacade::characterStorage()->all()->toList()) {
-		Character* character = dynamic_cast<Character*>(characterObject);
+	foreach (const QString& characterName, _scenario.characters()) {
 		if (rxPattern.isEmpty()) {
-			rxPattern.append(character->name());
+			rxPattern.append(characterName);
 		} else {
-			rxPattern.append("|" + character->name());
+			rxPattern.append("|" + characterName);
 		}
 	}
 	rxPattern.prepend("(^|\\W)(");
@@ -66,33 +40,30 @@ QString SceneReport::makeReport(QTextDocument* _scenario,
 	//
 	// Бежим по документу и собираем информацию о сценах и персонажах в них
 	//
-	QTextBlock block = _scenario->begin();
-	QTextCursor cursor = edit.textCursor();
 	QList<SceneData*> reportScenesDataList;
 	SceneData* currentData = 0;
 	QStringList characters;
-	while (block.isValid()) {
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
+	const ScenarioBlockStyle& sceneCharactersStyle =
+			_scenario.scenarioTemplate().blockStyle(ScenarioBlockStyle::SceneCharacters);
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
 			currentData = new SceneData;
 			reportScenesDataList.append(currentData);
 			//
-			currentData->name = block.text().toUpper();
+			currentData->name = block.text.toUpper();
 			//
-			cursor.setPosition(block.position());
-			currentData->page = edit.cursorPage(cursor);
+			currentData->page = block.page;
 			//
-			if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
-				currentData->number = info->sceneNumber();
-			}
+			currentData->number = block.sceneNumber;
 		}
 		//
 		if (currentData != 0
-			&& !block.text().isEmpty()) {
+			&& !block.text.isEmpty()) {
 			//
 			// Участники сцены
 			//
-			if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneCharacters) {
-				const QStringList sceneCharacters = SceneCharactersParser::characters(block.text().toUpper());
+			if (block.type == ScenarioBlockStyle::SceneCharacters) {
+				const QStringList sceneCharacters = SceneCharactersParser::characters(block.text.toUpper(), sceneCharactersStyle);
 				foreach (const QString& character, sceneCharacters) {
 					//
 					// Первое появление
@@ -116,8 +87,8 @@ QString SceneReport::makeReport(QTextDocument* _scenario,
 			//
 			// Персонаж
 			//
-			else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
-				const QString character = CharacterParser::name(block.text().toUpper());
+			else if (block.type == ScenarioBlockStyle::Character) {
+				const QString character = CharacterParser::name(block.text.toUpper());
 				//
 				// Первое появление
 				//
@@ -143,8 +114,8 @@ QString SceneReport::makeReport(QTextDocument* _scenario,
 			//
 			// Описание действия, выуживаем молчаливых
 			//
-			else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Action) {
-				QRegularExpressionMatch match = rxCharacterFinder.match(block.text());
+			else if (block.type == ScenarioBlockStyle::Action) {
+				QRegularExpressionMatch match = rxCharacterFinder.match(block.text);
 				while (match.hasMatch()) {
 					const QString character = match.captured(2).toUpper();
 					//
@@ -168,14 +139,12 @@ QString SceneReport::makeReport(QTextDocument* _scenario,
 					//
 					// Ищем дальше
 					//
-					match = rxCharacterFinder.match(block.text(), match.capturedEnd());
+					match = rxCharacterFinder.match(block.text, match.capturedEnd());
 				}
 			}
 
-			currentData->chron += ChronometerFacade::calculate(block);
+			currentData->chron += block.duration;
 		}
-
-		block = block.next();
 	}
 
 	//
@@ -24,7 +24,7 @@ namespace BusinessLogic
 		/**
 		 * @brief Подготовить отчёт
 		 */
-		QString makeReport(QTextDocument *_scenario, const StatisticsParameters &_parameters) const;
+		QString makeReport(const ScenarioSnapshot& _scenario, const StatisticsParameters &_parameters) const;
 
 	private:
 		/**
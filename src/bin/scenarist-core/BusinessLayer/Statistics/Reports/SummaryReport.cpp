@@ -5,28 +5,13 @@
 #include <BusinessLayer/Chronometry/ChronometerFacade.h>
 #include <BusinessLayer/Counters/CountersFacade.h>
 #include <BusinessLayer/Counters/Counter.h>
-
-#include <Domain/Character.h>
-
-#include <DataLayer/DataStorageLayer/StorageFacade.h>
-#include <DataLayer/DataStorageLayer/CharacterStorage.h>
-
-#include <3rd_party/Widgets/PagesTextEdit/PageTextEdit.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 
 #include <QApplication>
-#include <QTextBlock>
-#include <QTextDocument>
 
 using namespace BusinessLogic;
 
 namespace {
-	/**
-	 * @brief Стиль документа
-	 */
-	static ScenarioTemplate editorStyle() {
-		return ScenarioTemplateFacade::getTemplate();
-	}
-
 	/**
 	 * @brief Сформировать линию графика
 	 */
@@ -66,7 +51,7 @@ QString SummaryReport::reportName(const BusinessLogic::StatisticsParameters&) co
 	return QApplication::translate("BusinessLogic::SummaryReport", "Summary report");
 }
 
-QString SummaryReport::makeReport(QTextDocument* _scenario, const BusinessLogic::StatisticsParameters& _parameters) const
+QString SummaryReport::makeReport(const ScenarioSnapshot& _scenario, const BusinessLogic::StatisticsParameters& _parameters) const
 {
 	//
 	// Бежим по документу и собираем статистику
@@ -91,34 +76,45 @@ QString SummaryReport::makeReport(QTextDocument* _scenario, const BusinessLogic:
 	QStringList scenes;
 	// - персонаж - кол-во реплик
 	QMap<QString, int> characters;
-	foreach (DomainObject* characterObject, DataStorageLayer::StorageFacade::characterStorage()->all()->toList()) {
-		Character* character = dynamic_cast<Character*>(characterObject);
-		characters.insert(character->name(), 0);
+	foreach (const QString& characterName, _scenario.characters()) {
+		characters.insert(characterName, 0);
 	}
+	// - счётчики всего текста
+	Counter counter;
 	//
 	// ... побежали
 	//
-	QTextBlock block = _scenario->begin();
+	const bool CALCULATE_WORDS = true;
+	const bool CALCULATE_CHARACTERS = true;
 	QString lastCharacter;
-	while (block.isValid()) {
-		if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::SceneHeading) {
-			scenes.append(block.text().toUpper());
-		} else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Character) {
-			lastCharacter = CharacterParser::name(block.text().toUpper());
-		} else if (ScenarioBlockStyle::forBlock(block) == ScenarioBlockStyle::Dialogue) {
+	foreach (const ScenarioSnapshot::Block& block, _scenario.blocks()) {
+		//
+		// Считаем только видимые блоки
+		//
+		const Counter blockCounter =
+				block.isVisible
+				? CountersFacade::calculate(block.text, CALCULATE_WORDS, CALCULATE_CHARACTERS)
+				: Counter();
+		counter.addWords(blockCounter.words());
+		counter.addCharactersWithSpaces(blockCounter.charactersWithSpaces());
+		counter.addCharactersWithoutSpaces(blockCounter.charactersWithoutSpaces());
+		//
+		if (block.type == ScenarioBlockStyle::SceneHeading) {
+			scenes.append(block.text.toUpper());
+		} else if (block.type == ScenarioBlockStyle::Character) {
+			lastCharacter = CharacterParser::name(block.text.toUpper());
+		} else if (block.type == ScenarioBlockStyle::Dialogue) {
 			if (!characters.contains(lastCharacter)) {
 				characters.insert(lastCharacter, 0);
 			}
 			characters[lastCharacter] += 1;
 		}
 		//
-		const QString blockName = ScenarioBlockStyle::typeName(ScenarioBlockStyle::forBlock(block), BEAUTIFY_NAME);
+		const QString blockName = ScenarioBlockStyle::typeName(block.type, BEAUTIFY_NAME);
 		if (blockNames.contains(blockName)) {
 			blockCounters[blockName].first += 1;
-			blockCounters[blockName].second += CountersFacade::calculateFull(block).words();
+			blockCounters[blockName].second += blockCounter.words();
 		}
-
-		block = block.next();
 	}
 
 	//
@@ -130,15 +126,8 @@ QString SummaryReport::makeReport(QTextDocument* _scenario, const BusinessLogic:
 		//
 		// Статистика по текстовой состовляющей
 		//
-		PageTextEdit edit;
-		edit.setUsePageMode(true);
-		edit.setPageFormat(::editorStyle().pageSizeId());
-		edit.setPageMargins(::editorStyle().pageMargins());
-		edit.setDocument(_scenario->clone());
-
-		const qreal chron = ChronometerFacade::calculate(_scenario);
-		const int pageCount = edit.document()->pageCount();
-		const Counter counter = CountersFacade::calculateFull(_scenario);
+		const qreal chron = _scenario.duration();
+		const int pageCount = _scenario.pageCount();
 
 		html.append("<table width=\"100%\">");
 		html.append("<tr>");
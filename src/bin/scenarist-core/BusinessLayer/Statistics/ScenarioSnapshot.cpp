@@ -0,0 +1,97 @@
+#include "ScenarioSnapshot.h"
+
+#include "StatisticsPaginator.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h>
+#include <BusinessLayer/Chronometry/ChronometerFacade.h>
+
+#include <Domain/Character.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/CharacterStorage.h>
+#include <DataLayer/DataStorageLayer/ScenarioDataStorage.h>
+#include <DataLayer/Database/Database.h>
+
+#include <QFileInfo>
+#include <QTextBlock>
+#include <QTextDocument>
+
+using BusinessLogic::ScenarioSnapshot;
+using BusinessLogic::ScenarioTemplate;
+using DataStorageLayer::StorageFacade;
+
+
+ScenarioSnapshot::ScenarioSnapshot(QTextDocument* _scenario) :
+	m_template(ScenarioTemplateFacade::getSharedTemplate()),
+	m_pageCount(StatisticsPaginator::pageCount(_scenario)),
+	m_duration(ChronometerFacade::calculate(_scenario))
+{
+	//
+	// Название сценария, если не задано, берём из имени файла
+	//
+	m_scenarioName = StorageFacade::scenarioDataStorage()->name();
+	if (m_scenarioName.isEmpty()) {
+		QFileInfo fileInfo(DatabaseLayer::Database::currentFile());
+		m_scenarioName = fileInfo.completeBaseName();
+	}
+
+	//
+	// Персонажи
+	//
+	foreach (DomainObject* characterObject, StorageFacade::characterStorage()->all()->toList()) {
+		Character* character = dynamic_cast<Character*>(characterObject);
+		m_characters.append(character->name());
+	}
+
+	//
+	// Блоки текста
+	//
+	const QVector<int> blocksPages = StatisticsPaginator::blocksPages(_scenario);
+	m_blocks.reserve(_scenario->blockCount());
+	QTextBlock block = _scenario->begin();
+	while (block.isValid()) {
+		Block blockInfo;
+		blockInfo.type = ScenarioBlockStyle::forBlock(block);
+		blockInfo.text = block.text();
+		blockInfo.position = block.position();
+		blockInfo.isVisible = block.isVisible();
+		if (ScenarioTextBlockInfo* info = dynamic_cast<ScenarioTextBlockInfo*>(block.userData())) {
+			blockInfo.sceneNumber = info->sceneNumber();
+		}
+		blockInfo.page = blocksPages.value(block.blockNumber(), 1);
+		blockInfo.duration = ChronometerFacade::calculate(block);
+		m_blocks.append(blockInfo);
+
+		block = block.next();
+	}
+}
+
+QString ScenarioSnapshot::scenarioName() const
+{
+	return m_scenarioName;
+}
+
+QStringList ScenarioSnapshot::characters() const
+{
+	return m_characters;
+}
+
+const ScenarioTemplate& ScenarioSnapshot::scenarioTemplate() const
+{
+	return *m_template;
+}
+
+const QVector<ScenarioSnapshot::Block>& ScenarioSnapshot::blocks() const
+{
+	return m_blocks;
+}
+
+int ScenarioSnapshot::pageCount() const
+{
+	return m_pageCount;
+}
+
+qreal ScenarioSnapshot::duration() const
+{
+	return m_duration;
+}
@@ -0,0 +1,111 @@
+#ifndef SCENARIOSNAPSHOT_H
+#define SCENARIOSNAPSHOT_H
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+
+
+namespace BusinessLogic
+{
+	/**
+	 * @brief Неизменяемый снимок сценария для построения отчётов и графиков
+	 *
+	 * Снимается в потоке интерфейса, после чего не обращается ни к документу, ни к настройкам,
+	 * ни к базе данных, поэтому может использоваться одновременно из нескольких фоновых потоков
+	 */
+	class ScenarioSnapshot
+	{
+	public:
+		/**
+		 * @brief Снимок блока текста
+		 */
+		struct Block {
+			Block() :
+				type(ScenarioBlockStyle::Undefined), position(0), isVisible(true), sceneNumber(0),
+				page(1), duration(0) {}
+
+			ScenarioBlockStyle::Type type;
+			QString text;
+			int position;
+			bool isVisible;
+			int sceneNumber;
+			int page;
+			qreal duration;
+		};
+
+	public:
+		/**
+		 * @brief Снять копию сценария
+		 * @note Должен вызываться в потоке интерфейса
+		 */
+		explicit ScenarioSnapshot(QTextDocument* _scenario);
+
+		/**
+		 * @brief Название сценария
+		 */
+		QString scenarioName() const;
+
+		/**
+		 * @brief Имена персонажей сценария
+		 */
+		QStringList characters() const;
+
+		/**
+		 * @brief Шаблон, с которым был снят снимок
+		 */
+		const ScenarioTemplate& scenarioTemplate() const;
+
+		/**
+		 * @brief Блоки текста в порядке следования
+		 */
+		const QVector<Block>& blocks() const;
+
+		/**
+		 * @brief Количество страниц
+		 */
+		int pageCount() const;
+
+		/**
+		 * @brief Хронометраж всего сценария
+		 */
+		qreal duration() const;
+
+	private:
+		/**
+		 * @brief Название сценария
+		 */
+		QString m_scenarioName;
+
+		/**
+		 * @brief Имена персонажей
+		 */
+		QStringList m_characters;
+
+		/**
+		 * @brief Шаблон сценария
+		 */
+		QSharedPointer<const ScenarioTemplate> m_template;
+
+		/**
+		 * @brief Блоки текста
+		 */
+		QVector<Block> m_blocks;
+
+		/**
+		 * @brief Количество страниц
+		 */
+		int m_pageCount;
+
+		/**
+		 * @brief Хронометраж
+		 */
+		qreal m_duration;
+	};
+}
+
+#endif // SCENARIOSNAPSHOT_H
@@ -1,5 +1,7 @@
 #include "StatisticsFacade.h"
 
+#include "ScenarioSnapshot.h"
+
 #include "Reports/AbstractReport.h"
 #include "Reports/SummaryReport.h"
 #include "Reports/SceneReport.h"
@@ -11,16 +13,11 @@
 #include "Plots/StoryStructureAnalisysPlot.h"
 #include "Plots/CharactersActivityPlot.h"
 
-#include <DataLayer/DataStorageLayer/StorageFacade.h>
-#include <DataLayer/DataStorageLayer/ScenarioDataStorage.h>
-#include <DataLayer/Database/Database.h>
-
 #include <QApplication>
 #include <QDateTime>
-#include <QFileInfo>
 
 
-QString BusinessLogic::StatisticsFacade::makeReport(QTextDocument* _scenario, const BusinessLogic::StatisticsParameters& _parameters)
+QString BusinessLogic::StatisticsFacade::makeReport(const BusinessLogic::ScenarioSnapshot& _scenario, const BusinessLogic::StatisticsParameters& _parameters)
 {
 	QString result;
 	switch (_parameters.type) {
@@ -62,15 +59,10 @@ QString BusinessLogic::StatisticsFacade::makeReport(QTextDocument* _scenario, co
 			// Формируем отчёт
 			//
 			result.append("<div style=\"margin-left: 10px; margin-top: 10px; margin-right: 10px; margin-bottom: 10px;\">");
-			QString scenarioName = DataStorageLayer::StorageFacade::scenarioDataStorage()->name();
-			if (scenarioName.isEmpty()) {
-				QFileInfo fileInfo(DatabaseLayer::Database::currentFile());
-				scenarioName = fileInfo.completeBaseName();
-			}
 			result.append(
 				QString("<table width=\"100%\"><tr><td><b>%1</b><br/><b>%2</b></td>"
 						"<td valign=\"top\" align=\"right\"><small>%3 %4</small></td></tr></table>")
-						.arg(scenarioName)
+						.arg(_scenario.scenarioName())
 						.arg(report->reportName(_parameters))
 						.arg(QApplication::translate("BusinessLogic::ReportFacade", "generated"))
 						.arg(QDateTime::currentDateTime().toString("dd.MM.yyyy hh:mm:ss t"))
@@ -90,7 +82,7 @@ QString BusinessLogic::StatisticsFacade::makeReport(QTextDocument* _scenario, co
 }
 
 BusinessLogic::Plot BusinessLogic::StatisticsFacade::makePlot(
-	QTextDocument* _scenario, const BusinessLogic::StatisticsParameters& _parameters)
+	const BusinessLogic::ScenarioSnapshot& _scenario, const BusinessLogic::StatisticsParameters& _parameters)
 {
 	BusinessLogic::Plot result;
 	switch (_parameters.type) {
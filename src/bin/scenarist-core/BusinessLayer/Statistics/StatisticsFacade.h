@@ -3,10 +3,10 @@
 
 #include "Plots/AbstractPlot.h"
 
-class QTextDocument;
 
 namespace BusinessLogic
 {
+	class ScenarioSnapshot;
 	class StatisticsParameters;
 
 
@@ -18,13 +18,15 @@ namespace BusinessLogic
 	public:
 		/**
 		 * @brief Сформировать отчёт
+		 * @note Может выполняться в фоновом потоке, в том числе одновременно с другими отчётами
 		 */
-		static QString makeReport(QTextDocument* _scenario, const StatisticsParameters& _parameters);
+		static QString makeReport(const ScenarioSnapshot& _scenario, const StatisticsParameters& _parameters);
 
 		/**
 		 * @brief Сформировать график
+		 * @note Может выполняться в фоновом потоке, в том числе одновременно с другими графиками
 		 */
-		static Plot makePlot(QTextDocument* _scenario, const StatisticsParameters& _parameters);
+		static Plot makePlot(const ScenarioSnapshot& _scenario, const StatisticsParameters& _parameters);
 	};
 }
 
@@ -0,0 +1,90 @@
+#include "StatisticsPaginator.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+
+#include <3rd_party/Widgets/PagesTextEdit/PageMetrics.h>
+
+#include <QScopedPointer>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextFrame>
+#include <QTextLayout>
+
+using BusinessLogic::StatisticsPaginator;
+using BusinessLogic::ScenarioTemplate;
+using BusinessLogic::ScenarioTemplateFacade;
+
+
+QVector<int> StatisticsPaginator::blocksPages(const QTextDocument* _document)
+{
+	return pagination(_document).blocksPages;
+}
+
+int StatisticsPaginator::pageCount(const QTextDocument* _document)
+{
+	return pagination(_document).pageCount;
+}
+
+const StatisticsPaginator::Pagination& StatisticsPaginator::pagination(const QTextDocument* _document)
+{
+	//
+	// Разбивку документа сбрасываем при изменении текста и удаляем вместе с самим документом
+	//
+	if (!s_paginations.contains(_document)) {
+		QObject::connect(_document, &QTextDocument::contentsChanged, [_document] {
+			s_paginations[_document].revision = -1;
+		});
+		QObject::connect(_document, &QObject::destroyed, [_document] {
+			s_paginations.remove(_document);
+		});
+	}
+
+	Pagination& pagination = s_paginations[_document];
+	const int templatesVersion = ScenarioTemplateFacade::templatesVersion();
+	if (pagination.revision == _document->revision()
+		&& pagination.templatesVersion == templatesVersion) {
+		return pagination;
+	}
+
+	//
+	// Настраиваем копию документа так же, как это делает редактор в постраничном режиме
+	//
+	const ScenarioTemplate& scenarioTemplate = ScenarioTemplateFacade::getTemplate();
+	const PageMetrics pageMetrics(scenarioTemplate.pageSizeId(), scenarioTemplate.pageMargins());
+	QScopedPointer<QTextDocument> document(_document->clone());
+	document->setPageSize(pageMetrics.pxPageSize());
+	document->setDocumentMargin(0);
+	const QMarginsF rootFrameMargins = pageMetrics.pxPageMargins();
+	QTextFrameFormat rootFrameFormat = document->rootFrame()->frameFormat();
+	rootFrameFormat.setLeftMargin(rootFrameMargins.left());
+	rootFrameFormat.setTopMargin(rootFrameMargins.top());
+	rootFrameFormat.setRightMargin(rootFrameMargins.right());
+	rootFrameFormat.setBottomMargin(rootFrameMargins.bottom());
+	document->rootFrame()->setFrameFormat(rootFrameFormat);
+
+	//
+	// Количество страниц запрашиваем первым, т.к. при этом документ раскладывается целиком
+	//
+	pagination.pageCount = document->pageCount();
+
+	//
+	// Определяем страницы блоков по положению их первых строк
+	//
+	const qreal pageHeight = pageMetrics.pxPageSize().height();
+	pagination.blocksPages.clear();
+	pagination.blocksPages.reserve(document->blockCount());
+	for (QTextBlock block = document->begin(); block.isValid(); block = block.next()) {
+		qreal top = block.layout()->position().y();
+		if (block.layout()->lineCount() > 0) {
+			top += block.layout()->lineAt(0).y();
+		}
+		pagination.blocksPages.append(int(top / pageHeight) + 1);
+	}
+
+	pagination.revision = _document->revision();
+	pagination.templatesVersion = templatesVersion;
+
+	return pagination;
+}
+
+QHash<const QTextDocument*, StatisticsPaginator::Pagination> StatisticsPaginator::s_paginations;
@@ -0,0 +1,71 @@
+#ifndef STATISTICSPAGINATOR_H
+#define STATISTICSPAGINATOR_H
+
+#include <QHash>
+#include <QVector>
+
+class QTextDocument;
+
+namespace BusinessLogic
+{
+	/**
+	 * @brief Разбивка сценария на страницы для отчётов и графиков
+	 *
+	 * Документ раскладывается по страницам текущего шаблона без создания редактора,
+	 * результат запоминается и используется повторно, пока не изменится текст или шаблон
+	 */
+	class StatisticsPaginator
+	{
+	public:
+		/**
+		 * @brief Номера страниц, на которых начинаются блоки, в порядке следования блоков
+		 */
+		static QVector<int> blocksPages(const QTextDocument* _document);
+
+		/**
+		 * @brief Количество страниц документа
+		 */
+		static int pageCount(const QTextDocument* _document);
+
+	private:
+		/**
+		 * @brief Разбивка документа на страницы
+		 */
+		struct Pagination {
+			Pagination() : revision(-1), templatesVersion(-1), pageCount(0) {}
+
+			/**
+			 * @brief Ключ, по которому определяется, что разбивка актуальна
+			 * @note После очистки документа ревизии начинаются заново, поэтому при любом
+			 *		 изменении текста ревизия разбивки сбрасывается
+			 */
+			/** @{ */
+			int revision;
+			int templatesVersion;
+			/** @} */
+
+			/**
+			 * @brief Номера страниц блоков, в порядке следования блоков
+			 */
+			QVector<int> blocksPages;
+
+			/**
+			 * @brief Количество страниц
+			 */
+			int pageCount;
+		};
+
+		/**
+		 * @brief Получить актуальную разбивку документа, при необходимости разложив его заново
+		 */
+		static const Pagination& pagination(const QTextDocument* _document);
+
+	private:
+		/**
+		 * @brief Разбивки документов
+		 */
+		static QHash<const QTextDocument*, Pagination> s_paginations;
+	};
+}
+
+#endif // STATISTICSPAGINATOR_H
@@ -1,22 +1,56 @@
 #include "AbstractMapper.h"
 
 #include <DataLayer/Database/Database.h>
-#include <DataLayer/Database/DatabaseHelper.h>
-
-#include <3rd_party/Helpers/QVariantMapWriter.h>
+#include <DataLayer/Database/DatabaseHistoryWriter.h>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QDebug>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QVariant>
-#include <QUuid>
+
+//
+// Для замера времени выполнения запросов мапперами
+//
+//#define MAPPERS_TIMING
+#ifdef MAPPERS_TIMING
+#include <QElapsedTimer>
+#include <typeinfo>
+#endif
 
 
 using namespace DataMappingLayer;
 using namespace DatabaseLayer;
 
+namespace {
+	/**
+	 * @brief Нужно ли сохранять запрос в историю
+	 * @note Оптимизация размера файла проекта: сохраняем всё, кроме изменений сценария и текста самого сценария
+	 */
+	static bool needSaveHistory(const QString& _query) {
+		return !_query.contains(" scenario_changes ")
+				&& !_query.contains(" scenario ");
+	}
+
+#ifdef MAPPERS_TIMING
+	/**
+	 * @brief Количество выполненных запросов и суммарное время их выполнения (нс) для каждого маппера
+	 */
+	QHash<QString, QPair<int, qint64> > g_mappersTiming;
+
+	/**
+	 * @brief Учесть время выполнения запросов маппером
+	 */
+	static void addMapperTiming(const QString& _mapperName, int _queriesCount, qint64 _nsecs) {
+		QPair<int, qint64>& timing = g_mappersTiming[_mapperName];
+		timing.first += _queriesCount;
+		timing.second += _nsecs;
+		qDebug() << _mapperName << "queries:" << timing.first << "total ms:" << timing.second / 1000000.
+				 << "avg us:" << timing.second / 1000. / timing.first;
+	}
+#endif
+}
+
 
 AbstractMapper::AbstractMapper()
 {
@@ -131,10 +165,9 @@ void AbstractMapper::abstractInsert(DomainObject* _subject)
 	//
 	// Сформируем запрос на добавление данных в базу
 	//
-	QSqlQuery q_insert = Database::query();
-	q_insert.prepare(insertQuery);
-	foreach (const QVariant& value, insertValues) {
-		q_insert.addBindValue(value);
+	QSqlQuery q_insert = Database::preparedQuery(insertQuery);
+	for (int index = 0; index < insertValues.size(); ++index) {
+		q_insert.bindValue(index, insertValues.at(index));
 	}
 
 	//
@@ -163,10 +196,9 @@ void AbstractMapper::abstractUpdate(DomainObject* _subject)
 		//
 		// Сформируем запрос на обновление данных в базе
 		//
-		QSqlQuery q_update = Database::query();
-		q_update.prepare(updateQuery);
-		foreach (const QVariant& value, updateValues) {
-			q_update.addBindValue(value);
+		QSqlQuery q_update = Database::preparedQuery(updateQuery);
+		for (int index = 0; index < updateValues.size(); ++index) {
+			q_update.bindValue(index, updateValues.at(index));
 		}
 
 		//
@@ -192,10 +224,9 @@ void AbstractMapper::abstractDelete(DomainObject* _subject)
 	//
 	// Сформируем запрос на удаление данных из базы
 	//
-	QSqlQuery q_delete = Database::query();
-	q_delete.prepare(deleteQuery);
-	foreach (const QVariant& value, deleteValues) {
-		q_delete.addBindValue(value);
+	QSqlQuery q_delete = Database::preparedQuery(deleteQuery);
+	for (int index = 0; index < deleteValues.size(); ++index) {
+		q_delete.bindValue(index, deleteValues.at(index));
 	}
 
 	//
@@ -211,6 +242,69 @@ void AbstractMapper::abstractDelete(DomainObject* _subject)
 	}
 }
 
+void AbstractMapper::abstractInsertMany(const QList<DomainObject*>& _subjects)
+{
+	if (_subjects.isEmpty()) {
+		return;
+	}
+
+	//
+	// Установим идентификаторы новым объектам и соберём данные для их добавления
+	//
+	QString insertQuery;
+	QList<QVariantList> insertRowsValues;
+	foreach (DomainObject* subject, _subjects) {
+		subject->setId(findNextIdentifier());
+		m_loadedObjectsMap.insert(subject->id(), subject);
+
+		QVariantList insertValues;
+		insertQuery = insertStatement(subject, insertValues);
+		insertRowsValues.append(insertValues);
+	}
+
+	//
+	// Добавим данные в базу
+	//
+	Database::transaction();
+	executeBatchSql(insertQuery, insertRowsValues);
+	Database::commit();
+}
+
+void AbstractMapper::abstractUpdateMany(const QList<DomainObject*>& _subjects)
+{
+	//
+	// Соберём данные для обновления объектов с несохранёнными изменениями
+	//
+	QString updateQuery;
+	QList<QVariantList> updateRowsValues;
+	QList<DomainObject*> subjectsForUpdate;
+	foreach (DomainObject* subject, _subjects) {
+		if (!subject->isChangesStored()) {
+			QVariantList updateValues;
+			updateQuery = updateStatement(subject, updateValues);
+			updateRowsValues.append(updateValues);
+			subjectsForUpdate.append(subject);
+		}
+	}
+
+	if (subjectsForUpdate.isEmpty()) {
+		return;
+	}
+
+	//
+	// Обновим данные в базе
+	//
+	Database::transaction();
+	const bool updated = executeBatchSql(updateQuery, updateRowsValues);
+	Database::commit();
+
+	if (updated) {
+		foreach (DomainObject* subject, subjectsForUpdate) {
+			subject->changesStored();
+		}
+	}
+}
+
 DomainObject* AbstractMapper::loadObjectFromDatabase(const Identifier& _id)
 {
 	QSqlQuery query = Database::query();
@@ -261,6 +355,11 @@ DomainObject* AbstractMapper::load(const QSqlRecord& _record )
 
 bool AbstractMapper::executeSql(QSqlQuery& _sqlQuery)
 {
+#ifdef MAPPERS_TIMING
+	QElapsedTimer timer;
+	timer.start();
+#endif
+
 	//
 	// Если запрос завершился с ошибкой, выводим отладочную информацию
 	//
@@ -279,40 +378,85 @@ bool AbstractMapper::executeSql(QSqlQuery& _sqlQuery)
 	else {
 		Database::setLastError(QString::null);
 
-		//
-		// NOTE: Оптимизация размера файла проекта
-		// Сохраняем всё, кроме изменений сценария и текста самого сценария
-		//
-		if (!_sqlQuery.lastQuery().contains(" scenario_changes ")
-			&& !_sqlQuery.lastQuery().contains(" scenario ")) {
+		if (::needSaveHistory(_sqlQuery.lastQuery())) {
+			saveHistory(_sqlQuery.lastQuery(), _sqlQuery.boundValues());
+		}
+	}
 
-			QSqlQuery q_history(_sqlQuery);
-			q_history.prepare("INSERT INTO _database_history (id, query, query_values, datetime) VALUES(?, ?, ?, ?);");
-			//
-			// ... uuid
-			//
-			q_history.addBindValue(QUuid::createUuid().toString());
-			//
-			// ... запрос
-			//
-			q_history.addBindValue(_sqlQuery.lastQuery());
-			//
-			// ... данные в сжатом виде
-			//
-			QString valueString = QVariantMapWriter::mapToDataString(_sqlQuery.boundValues());
-			valueString = DatabaseHelper::compress(valueString);
-			q_history.addBindValue(valueString);
-			//
-			// ... время выполнения
-			//
-			q_history.addBindValue(QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss"));
+#ifdef MAPPERS_TIMING
+	::addMapperTiming(typeid(*this).name(), 1, timer.nsecsElapsed());
+#endif
 
-			//
-			// Сохраняем данные
-			//
-			q_history.exec();
+	return true;
+}
+
+bool AbstractMapper::executeBatchSql(const QString& _statement, const QList<QVariantList>& _rowsValues)
+{
+#ifdef MAPPERS_TIMING
+	QElapsedTimer timer;
+	timer.start();
+#endif
+
+	//
+	// Для пакетного запроса значения привязываются по столбцам
+	//
+	QList<QVariantList> columnsValues;
+	foreach (const QVariantList& rowValues, _rowsValues) {
+		for (int column = 0; column < rowValues.size(); ++column) {
+			if (columnsValues.size() == column) {
+				columnsValues.append(QVariantList());
+			}
+			columnsValues[column].append(rowValues.at(column));
 		}
 	}
 
+	QSqlQuery q_batch = Database::preparedQuery(_statement);
+	for (int column = 0; column < columnsValues.size(); ++column) {
+		q_batch.bindValue(column, columnsValues.at(column));
+	}
+
+	//
+	// Если запрос завершился с ошибкой, выводим отладочную информацию
+	//
+	if (!q_batch.execBatch()) {
+		Database::setLastError(q_batch.lastError().text());
+
+		qDebug() << q_batch.lastError();
+		qDebug() << q_batch.lastQuery();
+		qDebug() << q_batch.boundValues();
+
+		return false;
+	}
+	//
+	// Если всё завершилось успешно сохраняем запрос с данными каждой записи в таблицу истории запросов
+	//
+	else {
+		Database::setLastError(QString::null);
+
+		if (::needSaveHistory(_statement)) {
+			const QMap<QString, QVariant> batchValues = q_batch.boundValues();
+			for (int row = 0; row < _rowsValues.size(); ++row) {
+				QMap<QString, QVariant> rowValues;
+				foreach (const QString& key, batchValues.keys()) {
+					rowValues.insert(key, batchValues.value(key).toList().value(row));
+				}
+				saveHistory(_statement, rowValues);
+			}
+		}
+	}
+
+#ifdef MAPPERS_TIMING
+	::addMapperTiming(typeid(*this).name(), _rowsValues.size(), timer.nsecsElapsed());
+#endif
+
 	return true;
 }
+
+void AbstractMapper::saveHistory(const QString& _query, const QMap<QString, QVariant>& _values)
+{
+	//
+	// Запись в историю откладывается до фиксации транзакции, после чего все записи сохраняются
+	// одной пачкой в фоне
+	//
+	DatabaseHistoryWriter::enqueue(_query, _values);
+}
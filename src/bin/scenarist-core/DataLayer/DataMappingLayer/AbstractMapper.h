@@ -57,6 +57,14 @@ namespace DataMappingLayer
 		void abstractUpdate(DomainObject* _subject);
 		void abstractDelete(DomainObject* _subject);
 
+		/**
+		 * @brief Добавить/обновить список объектов одним пакетным запросом в рамках одной транзакции
+		 */
+		/** @{ */
+		void abstractInsertMany(const QList<DomainObject*>& _subjects);
+		void abstractUpdateMany(const QList<DomainObject*>& _subjects);
+		/** @} */
+
 	protected:
 		AbstractMapper();
 
@@ -81,6 +89,17 @@ namespace DataMappingLayer
 		 */
 		bool executeSql(QSqlQuery& _sqlQuery);
 
+		/**
+		 * @brief Выполнить запрос для каждого из наборов значений
+		 */
+		bool executeBatchSql(const QString& _statement, const QList<QVariantList>& _rowsValues);
+
+		/**
+		 * @brief Сохранить выполненный запрос в таблицу истории запросов
+		 * @note Запись сохраняется в фоне после фиксации текущей транзакции
+		 */
+		void saveHistory(const QString& _query, const QMap<QString, QVariant>& _values);
+
 	private:
 		/**
 		 * @brief Загруженные объекты из базы данных
@@ -3,7 +3,7 @@
 #include <Domain/Character.h>
 #include <Domain/CharacterPhoto.h>
 
-#include <3rd_party/Helpers/ImageHelper.h>
+#include <3rd_party/Helpers/EncodedImage.h>
 
 #include <QBuffer>
 
@@ -45,6 +45,24 @@ void CharacterPhotoMapper::update(CharacterPhoto* _character)
 	abstractUpdate(_character);
 }
 
+void CharacterPhotoMapper::insertMany(const QList<CharacterPhoto*>& _photos)
+{
+	QList<DomainObject*> subjects;
+	foreach (CharacterPhoto* photo, _photos) {
+		subjects.append(photo);
+	}
+	abstractInsertMany(subjects);
+}
+
+void CharacterPhotoMapper::updateMany(const QList<CharacterPhoto*>& _photos)
+{
+	QList<DomainObject*> subjects;
+	foreach (CharacterPhoto* photo, _photos) {
+		subjects.append(photo);
+	}
+	abstractUpdateMany(subjects);
+}
+
 void CharacterPhotoMapper::remove(CharacterPhoto* _character)
 {
 	abstractDelete(_character);
@@ -78,7 +96,7 @@ QString CharacterPhotoMapper::insertStatement(DomainObject* _subject, QVariantLi
 	_insertValues.clear();
 	_insertValues.append(photo->id().value());
 	_insertValues.append(photo->character()->id().value());
-	_insertValues.append(ImageHelper::bytesFromImage(photo->photo()));
+	_insertValues.append(photo->photoData().bytes());
 	_insertValues.append(photo->sortOrder());
 
 	return insertStatement;
@@ -97,7 +115,7 @@ QString CharacterPhotoMapper::updateStatement(DomainObject* _subject, QVariantLi
 	CharacterPhoto* photo = dynamic_cast<CharacterPhoto*>(_subject);
 	_updateValues.clear();
 	_updateValues.append(photo->character()->id().value());
-	_updateValues.append(ImageHelper::bytesFromImage(photo->photo()));
+	_updateValues.append(photo->photoData().bytes());
 	_updateValues.append(photo->sortOrder());
 	_updateValues.append(photo->id().value());
 
@@ -121,7 +139,7 @@ DomainObject* CharacterPhotoMapper::doLoad(const Identifier& _id, const QSqlReco
 	// связывание фотографий с персонажами осуществляется посредством метода findAllForCharacter
 	//
 	Character* character = 0;
-	const QPixmap photo = ImageHelper::imageFromBytes(_record.value("photo").toByteArray());
+	const EncodedImage photo(_record.value("photo").toByteArray());
 	const int sortOrder = _record.value("sort_order").toInt();
 
 	return new CharacterPhoto(_id, character, photo, sortOrder);
@@ -130,8 +148,8 @@ DomainObject* CharacterPhotoMapper::doLoad(const Identifier& _id, const QSqlReco
 void CharacterPhotoMapper::doLoad(DomainObject* _domainObject, const QSqlRecord& _record)
 {
 	if (CharacterPhoto* characterPhoto = dynamic_cast<CharacterPhoto*>(_domainObject)) {
-		const QPixmap photo = ImageHelper::imageFromBytes(_record.value("photo").toByteArray());
-		characterPhoto->setPhoto(photo);
+		const EncodedImage photo(_record.value("photo").toByteArray());
+		characterPhoto->setPhotoData(photo);
 
 		const int sortOrder = _record.value("sort_order").toInt();
 		characterPhoto->setSortOrder(sortOrder);
@@ -22,6 +22,8 @@ namespace DataMappingLayer
 		CharacterPhotosTable* findAllForCharacter(const Identifier& _characterIdentifier);
 		void insert(CharacterPhoto* _character);
 		void update(CharacterPhoto* _character);
+		void insertMany(const QList<CharacterPhoto*>& _photos);
+		void updateMany(const QList<CharacterPhoto*>& _photos);
 		void remove(CharacterPhoto* _character);
 
 	protected:
@@ -2,6 +2,7 @@
 
 #include <DataLayer/Database/Database.h>
 #include <DataLayer/Database/DatabaseHelper.h>
+#include <DataLayer/Database/DatabaseHistoryWriter.h>
 
 #include <3rd_party/Helpers/QVariantMapWriter.h>
 
@@ -12,17 +13,54 @@
 using DataMappingLayer::DatabaseHistoryMapper;
 using DatabaseLayer::Database;
 using DatabaseLayer::DatabaseHelper;
+using DatabaseLayer::DatabaseHistoryWriter;
 
 namespace {
 	const QString ID_KEY = "id";
 	const QString QUERY_KEY = "query";
 	const QString QUERY_VALUES_KEY = "query_values";
+	const QString QUERY_ID_KEY = "query_id";
+	const QString QUERY_VALUES_DATA_KEY = "query_values_data";
 	const QString DATETIME_KEY = "datetime";
+
+	/**
+	 * @brief Получить текст запроса записи истории
+	 * @note Новые записи хранят идентификатор текста запроса из таблицы _database_history_queries,
+	 *		 старые и полученные при синхронизации - сам текст
+	 */
+	static QString historyQuery(const QSqlQuery& _record) {
+		if (_record.value(QUERY_ID_KEY).isNull()) {
+			return _record.value(QUERY_KEY).toString();
+		}
+
+		QSqlQuery q_loader = Database::query();
+		q_loader.prepare("SELECT query FROM _database_history_queries WHERE id = ?");
+		q_loader.addBindValue(_record.value(QUERY_ID_KEY));
+		q_loader.exec();
+		q_loader.next();
+		return q_loader.value(0).toString();
+	}
+
+	/**
+	 * @brief Получить значения параметров запроса записи истории в сжатом текстовом виде
+	 * @note Новые записи хранят значения в двоичном виде, а для синхронизации они
+	 *		 передаются в прежнем формате
+	 */
+	static QString historyQueryValues(const QSqlQuery& _record) {
+		if (_record.value(QUERY_VALUES_DATA_KEY).isNull()) {
+			return _record.value(QUERY_VALUES_KEY).toString();
+		}
+
+		const QByteArray values = qUncompress(_record.value(QUERY_VALUES_DATA_KEY).toByteArray());
+		return DatabaseHelper::compress(QString(values.toBase64()));
+	}
 }
 
 
 QList<QString> DatabaseHistoryMapper::history(const QString& _fromDatetime)
 {
+	DatabaseHistoryWriter::flush();
+
 	QSqlQuery q_loader = Database::query();
 	q_loader.exec(
 		QString("SELECT %1 FROM _database_history WHERE %2 >= '%3'")
@@ -39,17 +77,19 @@ QList<QString> DatabaseHistoryMapper::history(const QString& _fromDatetime)
 
 QMap<QString, QString> DatabaseHistoryMapper::historyRecord(const QString& _uuid)
 {
+	DatabaseHistoryWriter::flush();
+
 	QSqlQuery q_loader = Database::query();
 	q_loader.exec(
-		QString("SELECT %1, %2, %3, %4 FROM _database_history WHERE %1 = '%5'")
-		.arg(ID_KEY, QUERY_KEY, QUERY_VALUES_KEY, DATETIME_KEY, _uuid)
+		QString("SELECT %1, %2, %3, %4, %5, %6 FROM _database_history WHERE %1 = '%7'")
+		.arg(ID_KEY, QUERY_KEY, QUERY_VALUES_KEY, QUERY_ID_KEY, QUERY_VALUES_DATA_KEY, DATETIME_KEY, _uuid)
 		);
 
 	q_loader.next();
 	QMap<QString, QString> historyRecord;
 	historyRecord.insert(ID_KEY, q_loader.value(ID_KEY).toString());
-	historyRecord.insert(QUERY_KEY, q_loader.value(QUERY_KEY).toString());
-	historyRecord.insert(QUERY_VALUES_KEY, q_loader.value(QUERY_VALUES_KEY).toString());
+	historyRecord.insert(QUERY_KEY, ::historyQuery(q_loader));
+	historyRecord.insert(QUERY_VALUES_KEY, ::historyQueryValues(q_loader));
 	historyRecord.insert(DATETIME_KEY, q_loader.value(DATETIME_KEY).toString());
 
 	return historyRecord;
@@ -57,6 +97,8 @@ QMap<QString, QString> DatabaseHistoryMapper::historyRecord(const QString& _uuid
 
 bool DatabaseHistoryMapper::contains(const QString& _uuid) const
 {
+	DatabaseHistoryWriter::flush();
+
 	QSqlQuery q_loader = Database::query();
 	q_loader.exec(
 		QString("SELECT COUNT(%1) AS size FROM _database_history WHERE %1 = '%2'")
@@ -3,7 +3,7 @@
 #include <Domain/Location.h>
 #include <Domain/LocationPhoto.h>
 
-#include <3rd_party/Helpers/ImageHelper.h>
+#include <3rd_party/Helpers/EncodedImage.h>
 
 #include <QBuffer>
 
@@ -45,6 +45,24 @@ void LocationPhotoMapper::update(LocationPhoto* _location)
 	abstractUpdate(_location);
 }
 
+void LocationPhotoMapper::insertMany(const QList<LocationPhoto*>& _photos)
+{
+	QList<DomainObject*> subjects;
+	foreach (LocationPhoto* photo, _photos) {
+		subjects.append(photo);
+	}
+	abstractInsertMany(subjects);
+}
+
+void LocationPhotoMapper::updateMany(const QList<LocationPhoto*>& _photos)
+{
+	QList<DomainObject*> subjects;
+	foreach (LocationPhoto* photo, _photos) {
+		subjects.append(photo);
+	}
+	abstractUpdateMany(subjects);
+}
+
 void LocationPhotoMapper::remove(LocationPhoto* _location)
 {
 	abstractDelete(_location);
@@ -78,7 +96,7 @@ QString LocationPhotoMapper::insertStatement(DomainObject* _subject, QVariantLis
 	_insertValues.clear();
 	_insertValues.append(photo->id().value());
 	_insertValues.append(photo->location()->id().value());
-	_insertValues.append(ImageHelper::bytesFromImage(photo->photo()));
+	_insertValues.append(photo->photoData().bytes());
 	_insertValues.append(photo->sortOrder());
 
 	return insertStatement;
@@ -97,7 +115,7 @@ QString LocationPhotoMapper::updateStatement(DomainObject* _subject, QVariantLis
 	LocationPhoto* photo = dynamic_cast<LocationPhoto*>(_subject);
 	_updateValues.clear();
 	_updateValues.append(photo->location()->id().value());
-	_updateValues.append(ImageHelper::bytesFromImage(photo->photo()));
+	_updateValues.append(photo->photoData().bytes());
 	_updateValues.append(photo->sortOrder());
 	_updateValues.append(photo->id().value());
 
@@ -121,7 +139,7 @@ DomainObject* LocationPhotoMapper::doLoad(const Identifier& _id, const QSqlRecor
 	// связывание фотографий с локациями осуществляется посредством метода findAllForLocation
 	//
 	Location* location = 0;
-	const QPixmap photo = ImageHelper::imageFromBytes(_record.value("photo").toByteArray());
+	const EncodedImage photo(_record.value("photo").toByteArray());
 	const int sortOrder = _record.value("sort_order").toInt();
 
 	return new LocationPhoto(_id, location, photo, sortOrder);
@@ -130,8 +148,8 @@ DomainObject* LocationPhotoMapper::doLoad(const Identifier& _id, const QSqlRecor
 void LocationPhotoMapper::doLoad(DomainObject* _domainObject, const QSqlRecord& _record)
 {
 	if (LocationPhoto* locationPhoto = dynamic_cast<LocationPhoto*>(_domainObject)) {
-		const QPixmap photo = ImageHelper::imageFromBytes(_record.value("photo").toByteArray());
-		locationPhoto->setPhoto(photo);
+		const EncodedImage photo(_record.value("photo").toByteArray());
+		locationPhoto->setPhotoData(photo);
 
 		const int sortOrder = _record.value("sort_order").toInt();
 		locationPhoto->setSortOrder(sortOrder);
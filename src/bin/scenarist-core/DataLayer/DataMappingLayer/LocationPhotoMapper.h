@@ -22,6 +22,8 @@ namespace DataMappingLayer
 		LocationPhotosTable* findAllForLocation(const Identifier& _locationIdentifier);
 		void insert(LocationPhoto* _location);
 		void update(LocationPhoto* _location);
+		void insertMany(const QList<LocationPhoto*>& _photos);
+		void updateMany(const QList<LocationPhoto*>& _photos);
 		void remove(LocationPhoto* _location);
 
 	protected:
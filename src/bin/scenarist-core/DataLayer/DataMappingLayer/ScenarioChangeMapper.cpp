@@ -41,6 +41,15 @@ void ScenarioChangeMapper::update(ScenarioChange* _change)
 	abstractUpdate(_change);
 }
 
+void ScenarioChangeMapper::insertMany(const QList<ScenarioChange*>& _changes)
+{
+	QList<DomainObject*> subjects;
+	foreach (ScenarioChange* change, _changes) {
+		subjects.append(change);
+	}
+	abstractInsertMany(subjects);
+}
+
 bool ScenarioChangeMapper::containsUuid(const QString& _uuid)
 {
 	QSqlQuery checker = DatabaseLayer::Database::query();
@@ -48,6 +57,17 @@ bool ScenarioChangeMapper::containsUuid(const QString& _uuid)
 	checker.addBindValue(_uuid);
 	checker.exec();
 	checker.next();
+	if (checker.value(0).toInt()) {
+		return true;
+	}
+
+	//
+	// Изменение могло быть свёрнуто в снимок при сжатии истории
+	//
+	checker.prepare("SELECT COUNT(uuid) FROM scenario_changes_compacted WHERE uuid = ?");
+	checker.addBindValue(_uuid);
+	checker.exec();
+	checker.next();
 	return checker.value(0).toInt();
 }
 
@@ -22,14 +22,17 @@ namespace DataMappingLayer
 		ScenarioChangesTable* findAll(const QString& _queryFilter = QString::null);
 		void insert(ScenarioChange* _change);
 		void update(ScenarioChange* _change);
+		void insertMany(const QList<ScenarioChange*>& _changes);
 
 		/**
 		 * @brief Существуюет ли изменение с заданным uuid
+		 * @note Учитываются и изменения, свёрнутые в снимок при сжатии истории
 		 */
 		bool containsUuid(const QString& _uuid);
 
 		/**
 		 * @brief Получить список uuid'ов всех локальных изменений
+		 * @note Изменения, свёрнутые в снимок при сжатии истории, сюда не входят, вместо них есть сам снимок
 		 */
 		QList<QString> uuids() const;
 
@@ -30,6 +30,8 @@ void CharacterPhotoStorage::store(Character* _character)
 	//
 	CharacterPhotosTable* newPhotos = _character->photosTable();
 	if (newPhotos->size() > 0) {
+		QList<CharacterPhoto*> photosToInsert;
+		QList<CharacterPhoto*> photosToUpdate;
 		foreach (DomainObject* domainObject, newPhotos->toList()) {
 			CharacterPhoto* newPhoto = dynamic_cast<CharacterPhoto*>(domainObject);
 
@@ -37,16 +39,21 @@ void CharacterPhotoStorage::store(Character* _character)
 			// Новое фото
 			//
 			if (!newPhoto->id().isValid()) {
-				MapperFacade::characterPhotoMapper()->insert(newPhoto);
-				all()->append(newPhoto);
+				photosToInsert.append(newPhoto);
 			}
 			//
 			// Старое фото
 			//
 			else {
-				MapperFacade::characterPhotoMapper()->update(newPhoto);
+				photosToUpdate.append(newPhoto);
 			}
 		}
+
+		MapperFacade::characterPhotoMapper()->insertMany(photosToInsert);
+		MapperFacade::characterPhotoMapper()->updateMany(photosToUpdate);
+		foreach (CharacterPhoto* newPhoto, photosToInsert) {
+			all()->append(newPhoto);
+		}
 	}
 }
 
@@ -29,6 +29,8 @@ void LocationPhotoStorage::store(Location* _location)
 	// Сохранить новые фотографии
 	//
 	LocationPhotosTable* newPhotos = _location->photosTable();
+	QList<LocationPhoto*> photosToInsert;
+	QList<LocationPhoto*> photosToUpdate;
 	foreach (DomainObject* domainObject, newPhotos->toList()) {
 		LocationPhoto* newPhoto = dynamic_cast<LocationPhoto*>(domainObject);
 
@@ -36,16 +38,21 @@ void LocationPhotoStorage::store(Location* _location)
 		// Новое фото
 		//
 		if (!newPhoto->id().isValid()) {
-			MapperFacade::locationPhotoMapper()->insert(newPhoto);
-			all()->append(newPhoto);
+			photosToInsert.append(newPhoto);
 		}
 		//
 		// Старое фото
 		//
 		else {
-			MapperFacade::locationPhotoMapper()->update(newPhoto);
+			photosToUpdate.append(newPhoto);
 		}
 	}
+
+	MapperFacade::locationPhotoMapper()->insertMany(photosToInsert);
+	MapperFacade::locationPhotoMapper()->updateMany(photosToUpdate);
+	foreach (LocationPhoto* newPhoto, photosToInsert) {
+		all()->append(newPhoto);
+	}
 }
 
 void LocationPhotoStorage::remove(Location* _location)
@@ -74,16 +74,16 @@ ScenarioChange* ScenarioChangeStorage::append(const QString& _user, const QStrin
 void ScenarioChangeStorage::store()
 {
 	//
-	// Сохраняем все несохранённые изменения
+	// Сохраняем все несохранённые изменения одним пакетом
 	//
-	DatabaseLayer::Database::transaction();
+	QList<ScenarioChange*> changesToInsert;
 	foreach (DomainObject* domainObject, allToSave()->toList()) {
 		ScenarioChange* change = dynamic_cast<ScenarioChange*>(domainObject);
 		if (!change->id().isValid()) {
-			MapperFacade::scenarioChangeMapper()->insert(change);
+			changesToInsert.append(change);
 		}
 	}
-	DatabaseLayer::Database::commit();
+	MapperFacade::scenarioChangeMapper()->insertMany(changesToInsert);
 
 	//
 	// Очищаем список на сохранение
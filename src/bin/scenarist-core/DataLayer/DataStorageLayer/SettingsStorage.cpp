@@ -473,6 +473,11 @@ SettingsStorage::SettingsStorage()
 	m_defaultValues.insert("application/save-backups", "1");
 	m_defaultValues.insert("application/save-backups-folder",
 		QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) + "/KITScenarist/backups");
+	m_defaultValues.insert("application/database/journal-mode", "DELETE");
+	m_defaultValues.insert("application/database/synchronous", "FULL");
+	m_defaultValues.insert("application/database/page-size", "4096");
+	m_defaultValues.insert("application/database/cache-size", "-16384");
+	m_defaultValues.insert("application/database/mmap-size", "67108864");
 	m_defaultValues.insert("application/modules/research", "1");
 	m_defaultValues.insert("application/modules/cards", "1");
 	m_defaultValues.insert("application/modules/scenario", "1");
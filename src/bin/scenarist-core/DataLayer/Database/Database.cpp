@@ -1,4 +1,6 @@
 #include "Database.h"
+#include "DatabaseHistoryWriter.h"
+#include "ScenarioChangesCompactor.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioXml.h>
 
@@ -11,6 +13,7 @@
 #include <QSqlQuery>
 #include <QSqlRecord>
 #include <QTextCodec>
+#include <QtConcurrentRun>
 #include <QUuid>
 #include <QVariant>
 
@@ -28,6 +31,11 @@ namespace {
 				"application-version";
 #endif
 	}
+
+	/**
+	 * @brief Название соединения для сжатия истории изменений сценария
+	 */
+	const QString COMPACT_CONNECTION_NAME = "compact_database";
 }
 
 
@@ -39,6 +47,8 @@ bool Database::canOpenFile(const QString& _databaseFileName, bool _isLocal)
 	// Проверки специфичные для локальных файлов
 	//
 	if (_isLocal) {
+		waitForCompaction(_databaseFileName);
+
 		QSqlDatabase database = QSqlDatabase::addDatabase(SQL_DRIVER, "tmp_database");
 		database.setDatabaseName(_databaseFileName);
 		database.open();
@@ -92,6 +102,11 @@ void Database::setCurrentFile(const QString& _databaseFileName)
 	//
 	closeCurrentFile();
 
+	//
+	// Файл не открываем, пока его история изменений сжимается
+	//
+	waitForCompaction(_databaseFileName);
+
 	//
 	// Установим текущее имя базы данных
 	//
@@ -108,6 +123,16 @@ void Database::setCurrentFile(const QString& _databaseFileName)
 
 void Database::closeCurrentFile()
 {
+	//
+	// Дописываем историю изменений, пока соединение с файлом ещё открыто
+	//
+	DatabaseHistoryWriter::closeCurrentFile();
+
+	//
+	// Подготовленные запросы держат соединение открытым, поэтому удаляем их первыми
+	//
+	s_preparedQueries.clear();
+
 	if (QSqlDatabase::contains(CONNECTION_NAME)) {
 		QSqlDatabase::removeDatabase(CONNECTION_NAME);
 	}
@@ -123,6 +148,22 @@ QSqlQuery Database::query()
 	return QSqlQuery(instanse());
 }
 
+QSqlQuery Database::preparedQuery(const QString& _statement)
+{
+	if (!s_preparedQueries.contains(_statement)) {
+		QSqlQuery query(instanse());
+		//
+		// Запрос с ошибкой не сохраняем, чтобы ошибка была видна при его выполнении
+		//
+		if (!query.prepare(_statement)) {
+			return query;
+		}
+		s_preparedQueries.insert(_statement, query);
+	}
+
+	return s_preparedQueries.value(_statement);
+}
+
 void Database::transaction()
 {
 	//
@@ -150,6 +191,76 @@ void Database::commit()
 	//
 	if (s_openedTransactions == 0) {
 		instanse().commit();
+
+		//
+		// Историю изменений сохраняем в фоне уже после фиксации, чтобы не удлинять сохранение
+		//
+		DatabaseHistoryWriter::startWriting();
+	}
+}
+
+bool Database::isInTransaction()
+{
+	return s_openedTransactions > 0;
+}
+
+void Database::setPerformanceProfile(const Database::PerformanceProfile& _profile)
+{
+	s_performanceProfile = _profile;
+}
+
+void Database::checkpoint()
+{
+	//
+	// Копия файла должна содержать и историю изменений, которая сохраняется в фоне
+	//
+	DatabaseHistoryWriter::flush();
+
+	if (s_performanceProfile.journalMode.toUpper() == "WAL") {
+		QSqlQuery q_checkpointer = query();
+		q_checkpointer.exec("PRAGMA wal_checkpoint(TRUNCATE)");
+	}
+}
+
+void Database::compactScenarioChanges(const QString& _databaseFileName, int _tailSize)
+{
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase(SQL_DRIVER, COMPACT_CONNECTION_NAME);
+		database.setDatabaseName(_databaseFileName);
+		if (database.open()
+			&& ScenarioChangesCompactor::compact(database, _tailSize, BusinessLogic::ScenarioXml::defaultTextXml())) {
+			//
+			// Возвращаем освободившееся место
+			//
+			QSqlQuery q_vacuumer(database);
+			q_vacuumer.exec("VACUUM");
+		}
+	}
+
+	QSqlDatabase::removeDatabase(COMPACT_CONNECTION_NAME);
+}
+
+void Database::compactScenarioChangesInBackground(const QString& _databaseFileName, int _tailSize,
+	const QFuture<void>& _waitFor)
+{
+	QFuture<void> previousCompactionTask = s_compactionTask;
+	QFuture<void> waitFor = _waitFor;
+	s_compactionFileName = _databaseFileName;
+	s_compactionTask = QtConcurrent::run([previousCompactionTask, waitFor, _databaseFileName, _tailSize] () mutable {
+		previousCompactionTask.waitForFinished();
+		waitFor.waitForFinished();
+		compactScenarioChanges(_databaseFileName, _tailSize);
+	});
+}
+
+void Database::waitForCompaction(const QString& _databaseFileName)
+{
+	//
+	// Предыдущие сжатия завершаются раньше последнего, поэтому достаточно дождаться его
+	//
+	if (_databaseFileName.isEmpty()
+		|| _databaseFileName == s_compactionFileName) {
+		s_compactionTask.waitForFinished();
 	}
 }
 
@@ -165,6 +276,10 @@ QString Database::DATABASE_NAME   = ":memory:";
 QString Database::s_openFileError = QString::null;
 QString Database::s_lastError = QString::null;
 int Database::s_openedTransactions = 0;
+QHash<QString, QSqlQuery> Database::s_preparedQueries;
+Database::PerformanceProfile Database::s_performanceProfile;
+QFuture<void> Database::s_compactionTask;
+QString Database::s_compactionFileName;
 
 QSqlDatabase Database::instanse()
 {
@@ -189,10 +304,15 @@ void Database::open(QSqlDatabase& _database, const QString& _connectionName, con
 
 	Database::States states = checkState(_database);
 
-	if (!states.testFlag(SchemeFlag))
+	applyPerformanceProfile(_database, !states.testFlag(SchemeFlag));
+
+	//
+	// Индексы создаются вместе со схемой, а в существующие файлы добавляются при обновлении
+	//
+	if (!states.testFlag(SchemeFlag)) {
 		createTables(_database);
-	if (!states.testFlag(IndexesFlag))
 		createIndexes(_database);
+	}
 	if (!states.testFlag(EnumsFlag))
 		createEnums(_database);
 	if (states.testFlag(OldVersionFlag))
@@ -222,15 +342,6 @@ Database::States Database::checkState(QSqlDatabase& _database)
 		//
 		states = states | Database::SchemeFlag;
 
-		//
-		// Созданы ли индексы
-		//
-		if (q_checker.exec("SELECT COUNT(*) as size FROM sqlite_master WHERE type = 'index' ") &&
-			q_checker.next() &&
-			q_checker.record().value("size").toInt()) {
-			states = states | Database::IndexesFlag;
-		}
-
 		//
 		// Проверка версии
 		//
@@ -246,6 +357,22 @@ Database::States Database::checkState(QSqlDatabase& _database)
 	return states;
 }
 
+void Database::applyPerformanceProfile(QSqlDatabase& _database, bool _isNewDatabase)
+{
+	QSqlQuery q_tuner(_database);
+
+	//
+	// Размер страницы можно задать только до создания таблиц
+	//
+	if (_isNewDatabase) {
+		q_tuner.exec(QString("PRAGMA page_size = %1").arg(s_performanceProfile.pageSize));
+	}
+	q_tuner.exec(QString("PRAGMA journal_mode = %1").arg(s_performanceProfile.journalMode));
+	q_tuner.exec(QString("PRAGMA synchronous = %1").arg(s_performanceProfile.synchronous));
+	q_tuner.exec(QString("PRAGMA cache_size = %1").arg(s_performanceProfile.cacheSize));
+	q_tuner.exec(QString("PRAGMA mmap_size = %1").arg(s_performanceProfile.mmapSize));
+}
+
 void Database::createTables(QSqlDatabase& _database)
 {
 	QSqlQuery q_creator(_database);
@@ -257,10 +384,20 @@ void Database::createTables(QSqlDatabase& _database)
 				   "id TEXT PRIMARY KEY, " // uuid
 				   "query TEXT NOT NULL, "
 				   "query_values TEXT NOT NULL, "
+				   "query_id INTEGER DEFAULT(NULL), " // текст запроса в _database_history_queries
+				   "query_values_data BLOB DEFAULT(NULL), " // значения в сжатом двоичном виде
 				   "datetime TEXT NOT NULL "
 				   "); "
 				   );
 
+	// Таблица текстов запросов из истории, на которые ссылаются её записи
+	q_creator.exec("CREATE TABLE _database_history_queries "
+				   "( "
+				   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+				   "query TEXT UNIQUE NOT NULL "
+				   "); "
+				   );
+
 	// Таблица системных переменных
 	q_creator.exec("CREATE TABLE system_variables "
 				   "( "
@@ -365,6 +502,15 @@ void Database::createTables(QSqlDatabase& _database)
 				   ")"
 				   );
 
+	//
+	// Uuid'ы изменений сценария, свёрнутых в снимок при сжатии истории
+	//
+	q_creator.exec("CREATE TABLE scenario_changes_compacted "
+				   "("
+				   "uuid TEXT PRIMARY KEY "
+				   ") WITHOUT ROWID"
+				   );
+
 	//
 	// Таблица с данными сценария
 	//
@@ -397,7 +543,25 @@ void Database::createTables(QSqlDatabase& _database)
 
 void Database::createIndexes(QSqlDatabase& _database)
 {
-	Q_UNUSED(_database);
+	QSqlQuery q_creator(_database);
+	_database.transaction();
+
+	// Поиск изменений сценария по uuid при синхронизации
+	q_creator.exec("CREATE INDEX IF NOT EXISTS scenario_changes_uuid_index ON scenario_changes (uuid)");
+
+	// Выборка истории запросов для отправки на сервер
+	q_creator.exec("CREATE INDEX IF NOT EXISTS database_history_datetime_index ON _database_history (datetime)");
+
+	// Фотографии персонажей и локаций
+	q_creator.exec("CREATE INDEX IF NOT EXISTS characters_photo_character_index "
+				   "ON characters_photo (fk_character_id, sort_order)");
+	q_creator.exec("CREATE INDEX IF NOT EXISTS locations_photo_location_index "
+				   "ON locations_photo (fk_location_id, sort_order)");
+
+	// Дерево разработки
+	q_creator.exec("CREATE INDEX IF NOT EXISTS research_parent_index ON research (parent_id, sort_order)");
+
+	_database.commit();
 }
 
 void Database::createEnums(QSqlDatabase& _database)
@@ -574,6 +738,15 @@ void Database::updateDatabase(QSqlDatabase& _database)
 				updateDatabaseTo_0_7_0(_database);
 			}
 		}
+		//
+		// 0.7.x
+		//
+		if (versionMinor <= 7) {
+			if (versionMinor < 7
+				|| versionBuild <= 0) {
+				updateDatabaseTo_0_7_1(_database);
+			}
+		}
 	}
 
 	//
@@ -1124,3 +1297,41 @@ void Database::updateDatabaseTo_0_7_0(QSqlDatabase& _database)
 
 	_database.commit();
 }
+
+void Database::updateDatabaseTo_0_7_1(QSqlDatabase& _database)
+{
+	QSqlQuery q_updater(_database);
+
+	_database.transaction();
+
+	{
+		//
+		// Добавление индекса uuid'ов изменений сценария, свёрнутых при сжатии истории
+		//
+		q_updater.exec("CREATE TABLE scenario_changes_compacted "
+					   "("
+					   "uuid TEXT PRIMARY KEY "
+					   ") WITHOUT ROWID"
+					   );
+
+		//
+		// Тексты запросов истории хранятся отдельно, а в самой истории - их идентификаторы
+		// и значения в двоичном виде, старые записи остаются в текстовых полях
+		//
+		q_updater.exec("CREATE TABLE _database_history_queries "
+					   "( "
+					   "id INTEGER PRIMARY KEY AUTOINCREMENT, "
+					   "query TEXT UNIQUE NOT NULL "
+					   "); "
+					   );
+		q_updater.exec("ALTER TABLE _database_history ADD COLUMN query_id INTEGER DEFAULT(NULL)");
+		q_updater.exec("ALTER TABLE _database_history ADD COLUMN query_values_data BLOB DEFAULT(NULL)");
+	}
+
+	_database.commit();
+
+	//
+	// Индексы для поиска изменений по uuid, выборки истории и фотографий
+	//
+	createIndexes(_database);
+}
@@ -1,7 +1,10 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <QFuture>
+#include <QHash>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 
 
 namespace DatabaseLayer
@@ -49,6 +52,12 @@ namespace DatabaseLayer
 		 */
 		static QSqlQuery query();
 
+		/**
+		 * @brief Получить подготовленный запрос для заданного текста
+		 * @note Запросы подготавливаются один раз и переиспользуются до закрытия текущего файла
+		 */
+		static QSqlQuery preparedQuery(const QString& _statement);
+
 		/**
 		 * @brief Запустить транзакцию, если ещё не запущена
 		 */
@@ -56,9 +65,88 @@ namespace DatabaseLayer
 
 		/**
 		 * @brief Зафиксировать транзакцию, если она была запущена
+		 * @note После фиксации накопленная история запросов сохраняется в фоне собственным соединением
 		 */
 		static void commit();
 
+		/**
+		 * @brief Запущена ли транзакция
+		 */
+		static bool isInTransaction();
+
+		/**
+		 * @brief Параметры SQLite, применяемые при открытии файла проекта
+		 */
+		struct PerformanceProfile {
+			PerformanceProfile() :
+				journalMode("DELETE"), synchronous("FULL"), pageSize(4096), cacheSize(-16384),
+				mmapSize(64 * 1024 * 1024) {}
+
+			/**
+			 * @brief Режим журнала (DELETE, TRUNCATE, WAL и т.п.)
+			 */
+			QString journalMode;
+
+			/**
+			 * @brief Уровень синхронизации с диском (FULL, NORMAL, OFF)
+			 */
+			QString synchronous;
+
+			/**
+			 * @brief Размер страницы в байтах
+			 * @note Применяется только к создаваемым файлам
+			 */
+			int pageSize;
+
+			/**
+			 * @brief Размер кэша страниц: положительное значение - в страницах, отрицательное - в КиБ
+			 */
+			int cacheSize;
+
+			/**
+			 * @brief Размер отображаемой в память части файла в байтах, 0 - не использовать
+			 */
+			qint64 mmapSize;
+		};
+
+		/**
+		 * @brief Установить параметры SQLite
+		 * @note Применяются при следующем открытии файла
+		 */
+		static void setPerformanceProfile(const PerformanceProfile& _profile);
+
+		/**
+		 * @brief Перенести изменения из журнала в сам файл базы данных
+		 * @note Нужно вызывать перед копированием открытого файла: дожидается фоновой записи истории
+		 *		 и, если используется журнал WAL, переносит его в файл
+		 */
+		static void checkpoint();
+
+		/**
+		 * @brief Сжать историю изменений сценария в заданном файле
+		 *
+		 * Изменения старше последних _tailSize сворачиваются в снимок текста, а их uuid'ы переносятся
+		 * в компактный индекс, после чего файл перестраивается для возврата освободившегося места
+		 *
+		 * @note Использует собственное соединение, файл при этом не должен быть открыт в приложении
+		 */
+		static void compactScenarioChanges(const QString& _databaseFileName, int _tailSize);
+
+		/**
+		 * @brief Запустить сжатие истории изменений сценария в заданном файле в фоновом потоке
+		 * @param _waitFor задача, которую нужно дождаться перед сжатием, например резервное
+		 *		  копирование того же файла
+		 * @note Открытие и проверка файла ждут завершения его сжатия, поэтому сжатие
+		 *		 не пересекается с повторным открытием
+		 */
+		static void compactScenarioChangesInBackground(const QString& _databaseFileName, int _tailSize,
+			const QFuture<void>& _waitFor = QFuture<void>());
+
+		/**
+		 * @brief Дождаться завершения фонового сжатия заданного файла, или любого, если файл не задан
+		 */
+		static void waitForCompaction(const QString& _databaseFileName = QString());
+
 		/**
 		 * @brief Состояния базы данных
 		 */
@@ -77,6 +165,11 @@ namespace DatabaseLayer
 		Q_DECLARE_FLAGS(States, State)
 
 	private:
+		/**
+		 * @brief Фоновая запись истории открывает собственное соединение тем же драйвером
+		 */
+		friend class DatabaseHistoryWriter;
+
 		static QString CONNECTION_NAME,
 					   SQL_DRIVER,
 					   DATABASE_NAME;
@@ -96,6 +189,25 @@ namespace DatabaseLayer
 		 */
 		static int s_openedTransactions;
 
+		/**
+		 * @brief Подготовленные запросы текущего соединения, по их тексту
+		 */
+		static QHash<QString, QSqlQuery> s_preparedQueries;
+
+		/**
+		 * @brief Параметры SQLite
+		 */
+		static PerformanceProfile s_performanceProfile;
+
+		/**
+		 * @brief Последнее запущенное фоновое сжатие и сжимаемый им файл
+		 * @note Сжатия выполняются по очереди, т.к. используют одно соединение
+		 */
+		/** @{ */
+		static QFuture<void> s_compactionTask;
+		static QString s_compactionFileName;
+		/** @} */
+
 		/**
 		 * @brief Получить объект текущей базы данных
 		 */
@@ -109,6 +221,7 @@ namespace DatabaseLayer
 				const QString& _databaseName
 				);
 		static Database::States checkState(QSqlDatabase& _database);
+		static void applyPerformanceProfile(QSqlDatabase& _database, bool _isNewDatabase);
 		static void createTables(QSqlDatabase& _database);
 		static void createIndexes(QSqlDatabase& _database);
 		static void createEnums(QSqlDatabase& _database);
@@ -202,6 +315,16 @@ namespace DatabaseLayer
 		 * - в таблицу scenario добавляется поле для хранения схемы
 		 */
 		static void updateDatabaseTo_0_7_0(QSqlDatabase& _database);
+
+		/**
+		 * @brief Обновить базу данных до версии 0.7.1
+		 *
+		 * - добавляется таблица uuid'ов изменений сценария, свёрнутых при сжатии истории
+		 * - добавляется таблица текстов запросов истории, а в саму историю - поля для
+		 *   идентификатора текста запроса и значений в двоичном виде
+		 * - создаются индексы таблиц проекта
+		 */
+		static void updateDatabaseTo_0_7_1(QSqlDatabase& _database);
 	};
 
 	Q_DECLARE_OPERATORS_FOR_FLAGS(Database::States)
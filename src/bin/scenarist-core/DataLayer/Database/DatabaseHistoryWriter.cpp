@@ -0,0 +1,264 @@
+#include "DatabaseHistoryWriter.h"
+
+#include "Database.h"
+#include "DatabaseHelper.h"
+
+#include <3rd_party/Helpers/QVariantMapWriter.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QUuid>
+
+#include <QtConcurrentRun>
+
+using DatabaseLayer::Database;
+using DatabaseLayer::DatabaseHistoryWriter;
+
+namespace {
+	/**
+	 * @brief Название соединения для фоновой записи истории
+	 */
+	const QString WRITER_CONNECTION_NAME = "history_writer_database";
+
+	/**
+	 * @brief Имя базы данных, существующей только в памяти
+	 * @note С такой базой нельзя соединиться повторно, да и синхронизировать её не с чем
+	 */
+	const QString IN_MEMORY_DATABASE_NAME = ":memory:";
+
+	/**
+	 * @brief Время ожидания освобождения базы основным соединением (мс)
+	 */
+	const int BUSY_TIMEOUT = 5000;
+
+	/**
+	 * @brief Запрос на добавление записи в таблицу истории запросов
+	 * @note Поля с текстом запроса и значениями в текстовом виде заполняются только
+	 *		 для записей, полученных при синхронизации
+	 */
+	const QString HISTORY_INSERT_STATEMENT =
+			"INSERT INTO _database_history (id, query, query_values, query_id, query_values_data, datetime) "
+			"VALUES(?, '', '', ?, ?, ?)";
+
+	/**
+	 * @brief Запросы для получения и сохранения текста запроса
+	 */
+	/** @{ */
+	const QString QUERY_SELECT_STATEMENT = "SELECT id FROM _database_history_queries WHERE query = ?";
+	const QString QUERY_INSERT_STATEMENT = "INSERT INTO _database_history_queries (query) VALUES(?)";
+	/** @} */
+}
+
+
+void DatabaseHistoryWriter::enqueue(const QString& _query, const QMap<QString, QVariant>& _values)
+{
+	Record record;
+	record.uuid = QUuid::createUuid().toString();
+	record.query = _query;
+	record.values = _values;
+	record.datetime = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
+
+	{
+		QMutexLocker locker(&s_mutex);
+		s_pendingRecords.append(record);
+	}
+
+	//
+	// Если транзакции нет, то и фиксации ждать не нужно, сохраняем запись сразу
+	//
+	if (!Database::isInTransaction()) {
+		startWriting();
+	}
+}
+
+void DatabaseHistoryWriter::startWriting()
+{
+	const QString databaseFileName = Database::currentFile();
+
+	QMutexLocker locker(&s_mutex);
+	if (s_pendingRecords.isEmpty()) {
+		return;
+	}
+
+	//
+	// Базу в памяти не открыть из другого соединения, историю для неё не ведём
+	//
+	if (databaseFileName == IN_MEMORY_DATABASE_NAME) {
+		s_pendingRecords.clear();
+		return;
+	}
+
+	//
+	// Файл меняется только после flush() при его закрытии, так что все записи в очереди относятся к нему
+	//
+	s_databaseFileName = databaseFileName;
+	s_recordsToWrite.append(s_pendingRecords);
+	s_pendingRecords.clear();
+	startWorker();
+}
+
+void DatabaseHistoryWriter::flush()
+{
+	//
+	// Записи открытой транзакции ждут её фиксации: пока основное соединение держит блокировку,
+	// фоновая запись всё равно не сможет их сохранить
+	//
+	if (!Database::isInTransaction()) {
+		startWriting();
+	}
+
+	//
+	// Фоновая запись может перезапуститься, если во время её завершения в очередь попали новые записи
+	//
+	QMutexLocker locker(&s_mutex);
+	while (s_isWriting) {
+		QFuture<void> writing = s_writing;
+		locker.unlock();
+		writing.waitForFinished();
+		locker.relock();
+	}
+}
+
+void DatabaseHistoryWriter::closeCurrentFile()
+{
+	flush();
+
+	//
+	// Если сохранить записи не удалось, то после закрытия файла сохранить их уже будет некуда
+	//
+	QMutexLocker locker(&s_mutex);
+	if (!s_recordsToWrite.isEmpty()) {
+		qDebug() << "Database history records lost:" << s_recordsToWrite.size();
+		s_recordsToWrite.clear();
+	}
+	s_queriesIds.clear();
+}
+
+//********
+// Скрытая часть
+
+
+QMutex DatabaseHistoryWriter::s_mutex;
+QList<DatabaseHistoryWriter::Record> DatabaseHistoryWriter::s_pendingRecords;
+QList<DatabaseHistoryWriter::Record> DatabaseHistoryWriter::s_recordsToWrite;
+QString DatabaseHistoryWriter::s_databaseFileName;
+bool DatabaseHistoryWriter::s_isWriting = false;
+QFuture<void> DatabaseHistoryWriter::s_writing;
+QHash<QString, qint64> DatabaseHistoryWriter::s_queriesIds;
+
+void DatabaseHistoryWriter::startWorker()
+{
+	if (!s_isWriting && !s_recordsToWrite.isEmpty()) {
+		s_isWriting = true;
+		s_writing = QtConcurrent::run(&DatabaseHistoryWriter::writePending, s_databaseFileName);
+	}
+}
+
+void DatabaseHistoryWriter::writePending(const QString& _databaseFileName)
+{
+	bool isFailed = false;
+	{
+		QSqlDatabase database = QSqlDatabase::addDatabase(Database::SQL_DRIVER, WRITER_CONNECTION_NAME);
+		database.setDatabaseName(_databaseFileName);
+		database.setConnectOptions(QString("QSQLITE_BUSY_TIMEOUT=%1").arg(BUSY_TIMEOUT));
+		const bool isOpened = database.open();
+
+		forever {
+			QList<Record> records;
+			{
+				QMutexLocker locker(&s_mutex);
+				records.swap(s_recordsToWrite);
+				if (records.isEmpty()) {
+					break;
+				}
+			}
+
+			//
+			// Если сохранить не удалось, возвращаем записи в начало очереди
+			//
+			if (!isOpened
+				|| !writeRecords(database, records)) {
+				QMutexLocker locker(&s_mutex);
+				s_recordsToWrite = records + s_recordsToWrite;
+				isFailed = true;
+				break;
+			}
+		}
+	}
+
+	QSqlDatabase::removeDatabase(WRITER_CONNECTION_NAME);
+
+	//
+	// Запись считается завершённой только после удаления соединения, чтобы следующая запись
+	// могла открыть соединение с тем же именем. Если за это время в очередь что-то попало,
+	// сразу запускаем запись заново
+	//
+	QMutexLocker locker(&s_mutex);
+	s_isWriting = false;
+	if (!isFailed) {
+		startWorker();
+	}
+}
+
+bool DatabaseHistoryWriter::writeRecords(QSqlDatabase& _database, const QList<Record>& _records)
+{
+	QSqlQuery q_queryLoader(_database);
+	q_queryLoader.prepare(QUERY_SELECT_STATEMENT);
+	QSqlQuery q_querySaver(_database);
+	q_querySaver.prepare(QUERY_INSERT_STATEMENT);
+	QSqlQuery q_history(_database);
+	q_history.prepare(HISTORY_INSERT_STATEMENT);
+
+	//
+	// NOTE: При откате транзакции идентификаторы добавленных в ней текстов запросов становятся
+	//		 недействительными, поэтому в случае ошибки они сбрасываются
+	//
+	_database.transaction();
+	foreach (const Record& record, _records) {
+		//
+		// ... идентификатор текста запроса
+		//
+		if (!s_queriesIds.contains(record.query)) {
+			q_queryLoader.bindValue(0, record.query);
+			if (q_queryLoader.exec() && q_queryLoader.next()) {
+				s_queriesIds.insert(record.query, q_queryLoader.value(0).toLongLong());
+				q_queryLoader.finish();
+			} else {
+				q_querySaver.bindValue(0, record.query);
+				if (!q_querySaver.exec()) {
+					qDebug() << q_querySaver.lastError();
+					_database.rollback();
+					s_queriesIds.clear();
+					return false;
+				}
+				s_queriesIds.insert(record.query, q_querySaver.lastInsertId().toLongLong());
+			}
+		}
+
+		//
+		// ... сама запись
+		//
+		q_history.bindValue(0, record.uuid);
+		q_history.bindValue(1, s_queriesIds.value(record.query));
+		q_history.bindValue(2, qCompress(QVariantMapWriter::mapToData(record.values), COMPRESSION_LEVEL));
+		q_history.bindValue(3, record.datetime);
+		if (!q_history.exec()) {
+			qDebug() << q_history.lastError();
+			_database.rollback();
+			s_queriesIds.clear();
+			return false;
+		}
+	}
+
+	if (!_database.commit()) {
+		qDebug() << _database.lastError();
+		_database.rollback();
+		s_queriesIds.clear();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,119 @@
+#ifndef DATABASEHISTORYWRITER_H
+#define DATABASEHISTORYWRITER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVariant>
+
+
+namespace DatabaseLayer
+{
+	/**
+	 * @brief Фоновая запись истории запросов в таблицу _database_history
+	 *
+	 * Записи копятся, пока открыта транзакция, а после её фиксации сохраняются в отдельном потоке
+	 * через собственное соединение с файлом, одной транзакцией на пачку. Так запись истории
+	 * не удлиняет сохранение и не конкурирует с ним за блокировку файла. Текст запроса сохраняется
+	 * один раз в таблицу _database_history_queries, а в истории хранится его идентификатор в поле
+	 * query_id. Значения параметров хранятся в сжатом двоичном виде в поле query_values_data
+	 */
+	class DatabaseHistoryWriter
+	{
+	public:
+		/**
+		 * @brief Поставить запрос в очередь на сохранение в историю
+		 * @note Uuid и время изменения фиксируются в момент постановки в очередь,
+		 *		 вне транзакции запись сразу передаётся на сохранение
+		 */
+		static void enqueue(const QString& _query, const QMap<QString, QVariant>& _values);
+
+		/**
+		 * @brief Передать накопленные записи на сохранение в фоне
+		 * @note Вызывается после фиксации транзакции основного соединения
+		 */
+		static void startWriting();
+
+		/**
+		 * @brief Дождаться сохранения всех записей из очереди
+		 * @note Нужно вызывать перед чтением истории и перед копированием файла
+		 */
+		static void flush();
+
+		/**
+		 * @brief Дописать оставшиеся записи и забыть идентификаторы текстов запросов текущего файла
+		 */
+		static void closeCurrentFile();
+
+	private:
+		/**
+		 * @brief Запись истории, ожидающая сохранения
+		 */
+		struct Record {
+			QString uuid;
+			QString query;
+			QMap<QString, QVariant> values;
+			QString datetime;
+		};
+
+		/**
+		 * @brief Запустить фоновую запись, если она ещё не идёт и есть что сохранять
+		 * @note Вызывается под s_mutex
+		 */
+		static void startWorker();
+
+		/**
+		 * @brief Сохранять записи из очереди, пока она не опустеет
+		 * @note Выполняется в фоновом потоке
+		 */
+		static void writePending(const QString& _databaseFileName);
+
+		/**
+		 * @brief Сохранить пачку записей в одной транзакции
+		 */
+		static bool writeRecords(QSqlDatabase& _database, const QList<Record>& _records);
+
+	private:
+		/**
+		 * @brief Защита очереди и состояния фоновой записи
+		 */
+		static QMutex s_mutex;
+
+		/**
+		 * @brief Записи, ожидающие фиксации транзакции
+		 */
+		static QList<Record> s_pendingRecords;
+
+		/**
+		 * @brief Записи, переданные на сохранение в фоне
+		 */
+		static QList<Record> s_recordsToWrite;
+
+		/**
+		 * @brief Файл, в который сохраняются записи
+		 */
+		static QString s_databaseFileName;
+
+		/**
+		 * @brief Выполняется ли фоновая запись
+		 */
+		static bool s_isWriting;
+
+		/**
+		 * @brief Фоновая запись
+		 */
+		static QFuture<void> s_writing;
+
+		/**
+		 * @brief Идентификаторы текстов запросов текущего файла
+		 * @note Используются только фоновой записью, которая выполняется в один поток
+		 */
+		static QHash<QString, qint64> s_queriesIds;
+	};
+}
+
+#endif // DATABASEHISTORYWRITER_H
@@ -0,0 +1,115 @@
+#include "ScenarioChangesCompactor.h"
+#include "DatabaseHelper.h"
+
+#include <3rd_party/Helpers/DiffMatchPatchHelper.h>
+
+#include <QSqlQuery>
+#include <QUuid>
+#include <QVariant>
+
+using DatabaseLayer::DatabaseHelper;
+using DatabaseLayer::ScenarioChangesCompactor;
+
+namespace {
+	/**
+	 * @brief Снимок текста чистовика или черновика на момент последнего свёрнутого изменения
+	 */
+	struct Snapshot {
+		Snapshot() : isFolded(false) {}
+
+		QString text;
+		QString datetime;
+		QString username;
+		bool isFolded;
+	};
+}
+
+
+bool ScenarioChangesCompactor::compact(QSqlDatabase& _database, int _tailSize, const QString& _initialXml)
+{
+	QSqlQuery q_compactor(_database);
+
+	//
+	// Сжимаем историю, только когда за пределами хвоста накопилось достаточно изменений,
+	// чтобы не перестраивать файл при каждом закрытии проекта
+	//
+	if (!q_compactor.exec("SELECT MAX(id) FROM scenario_changes")
+		|| !q_compactor.next()) {
+		return false;
+	}
+	const qint64 lastFoldedId = q_compactor.value(0).toLongLong() - _tailSize;
+
+	q_compactor.prepare("SELECT COUNT(id) FROM scenario_changes WHERE id <= ?");
+	q_compactor.addBindValue(lastFoldedId);
+	if (!q_compactor.exec()
+		|| !q_compactor.next()
+		|| q_compactor.value(0).toInt() < _tailSize) {
+		return false;
+	}
+
+	//
+	// Восстанавливаем тексты чистовика и черновика, накладывая свёрнутые изменения по порядку,
+	// прежние снимки тоже строят свой текст из текста по умолчанию
+	//
+	Snapshot snapshots[2];
+	snapshots[0].text = snapshots[1].text = _initialXml;
+	q_compactor.prepare("SELECT datetime, username, redo_patch, is_draft FROM scenario_changes "
+						"WHERE id <= ? ORDER BY id");
+	q_compactor.addBindValue(lastFoldedId);
+	if (!q_compactor.exec()) {
+		return false;
+	}
+	while (q_compactor.next()) {
+		Snapshot& snapshot = snapshots[q_compactor.value("is_draft").toInt() ? 1 : 0];
+		snapshot.text =
+				DiffMatchPatchHelper::applyPatchXml(
+					snapshot.text, DatabaseHelper::uncompress(q_compactor.value("redo_patch").toString()));
+		snapshot.datetime = q_compactor.value("datetime").toString();
+		snapshot.username = q_compactor.value("username").toString();
+		snapshot.isFolded = true;
+	}
+
+	_database.transaction();
+
+	//
+	// Переносим uuid'ы свёрнутых изменений в индекс и удаляем сами изменения
+	//
+	bool isOk = true;
+	q_compactor.prepare("INSERT OR IGNORE INTO scenario_changes_compacted (uuid) "
+						"SELECT uuid FROM scenario_changes WHERE id <= ?");
+	q_compactor.addBindValue(lastFoldedId);
+	isOk = isOk && q_compactor.exec();
+	q_compactor.prepare("DELETE FROM scenario_changes WHERE id <= ?");
+	q_compactor.addBindValue(lastFoldedId);
+	isOk = isOk && q_compactor.exec();
+
+	//
+	// Снимки занимают последние идентификаторы свёрнутых изменений, чтобы оставаться перед хвостом
+	//
+	qint64 snapshotId = lastFoldedId - (snapshots[0].isFolded && snapshots[1].isFolded ? 1 : 0);
+	for (int isDraft = 0; isDraft < 2; ++isDraft) {
+		const Snapshot& snapshot = snapshots[isDraft];
+		if (!snapshot.isFolded) {
+			continue;
+		}
+
+		q_compactor.prepare("INSERT INTO scenario_changes "
+							"(id, uuid, datetime, username, undo_patch, redo_patch, is_draft) "
+							"VALUES(?, ?, ?, ?, ?, ?, ?)");
+		q_compactor.addBindValue(snapshotId++);
+		q_compactor.addBindValue(QUuid::createUuid().toString());
+		q_compactor.addBindValue(snapshot.datetime);
+		q_compactor.addBindValue(snapshot.username);
+		q_compactor.addBindValue(DatabaseHelper::compress(DiffMatchPatchHelper::makePatchXml(snapshot.text, _initialXml)));
+		q_compactor.addBindValue(DatabaseHelper::compress(DiffMatchPatchHelper::makePatchXml(_initialXml, snapshot.text)));
+		q_compactor.addBindValue(isDraft);
+		isOk = isOk && q_compactor.exec();
+	}
+
+	if (!isOk) {
+		_database.rollback();
+		return false;
+	}
+
+	return _database.commit();
+}
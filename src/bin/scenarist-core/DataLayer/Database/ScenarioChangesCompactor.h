@@ -0,0 +1,31 @@
+#ifndef SCENARIOCHANGESCOMPACTOR_H
+#define SCENARIOCHANGESCOMPACTOR_H
+
+#include <QSqlDatabase>
+#include <QString>
+
+
+namespace DatabaseLayer
+{
+	/**
+	 * @brief Сжатие истории изменений сценария
+	 *
+	 * Изменения старше последних _tailSize сворачиваются в снимок - по одному изменению для чистовика
+	 * и черновика, которые строят из текста по умолчанию тот текст, что получался после свёрнутых
+	 * изменений. Снимок встаёт на место свёрнутых изменений перед хвостом, поэтому история,
+	 * отправляемая в облако при переносе туда проекта, остаётся полной. Uuid'ы свёрнутых изменений
+	 * сохраняются в таблице scenario_changes_compacted, чтобы синхронизация не загружала их повторно
+	 */
+	class ScenarioChangesCompactor
+	{
+	public:
+		/**
+		 * @brief Сжать историю изменений в заданной базе данных
+		 * @param _initialXml текст сценария, к которому применялось первое изменение
+		 * @return Были ли свёрнуты изменения
+		 */
+		static bool compact(QSqlDatabase& _database, int _tailSize, const QString& _initialXml);
+	};
+}
+
+#endif // SCENARIOCHANGESCOMPACTOR_H
@@ -70,6 +70,16 @@ CharacterPhotosTable* Character::photosTable() const
 
 QList<QPixmap> Character::photos() const
 {
+	//
+	// Распаковываем все фотографии разом, чтобы делать это параллельно
+	//
+	QList<EncodedImage> photosData;
+	foreach (DomainObject* domainObject, m_photos->toList()) {
+		CharacterPhoto* photo = dynamic_cast<CharacterPhoto*>(domainObject);
+		photosData.append(photo->photoData());
+	}
+	EncodedImage::prepare(photosData);
+
 	QList<QPixmap> photos;
 	foreach (DomainObject* domainObject, m_photos->toList()) {
 		CharacterPhoto* photo = dynamic_cast<CharacterPhoto*>(domainObject);
@@ -93,10 +103,29 @@ void Character::setPhotosTable(CharacterPhotosTable* _photos)
 
 void Character::setPhotos(const QList<QPixmap>& _photos)
 {
+	QList<CharacterPhoto*> oldPhotos;
+	foreach (DomainObject* domainObject, m_photos->toList()) {
+		oldPhotos.append(dynamic_cast<CharacterPhoto*>(domainObject));
+	}
 	m_photos->clear();
 
 	for (int index = 0; index < _photos.count(); ++index) {
-		CharacterPhoto* newPhoto = new CharacterPhoto(Identifier(), this, _photos.value(index), index);
+		//
+		// Неизменённые фотографии оставляем прежними, чтобы не сохранять их заново
+		//
+		CharacterPhoto* newPhoto = 0;
+		foreach (CharacterPhoto* oldPhoto, oldPhotos) {
+			if (oldPhoto->photoData().isSourceOf(_photos.value(index))) {
+				newPhoto = oldPhoto;
+				newPhoto->setSortOrder(index);
+				oldPhotos.removeOne(oldPhoto);
+				break;
+			}
+		}
+
+		if (newPhoto == 0) {
+			newPhoto = new CharacterPhoto(Identifier(), this, EncodedImage(_photos.value(index)), index);
+		}
 		m_photos->append(newPhoto);
 	}
 
@@ -2,15 +2,13 @@
 
 #include "Character.h"
 
-#include <3rd_party/Helpers/ImageHelper.h>
-
 using namespace Domain;
 
 
 CharacterPhoto::CharacterPhoto(
 		const Identifier& _id,
 		Character* _character,
-		const QPixmap& _photo,
+		const EncodedImage& _photo,
 		int _sortOrder
 		) :
 	DomainObject(_id),
@@ -41,12 +39,27 @@ void CharacterPhoto::setCharacter(Character* _character, bool _onLoad)
 
 QPixmap CharacterPhoto::photo() const
 {
-	return m_photo;
+	return m_photo.image();
 }
 
 void CharacterPhoto::setPhoto(const QPixmap& _photo)
 {
-	if (!ImageHelper::isImagesEqual(m_photo, _photo)) {
+	//
+	// Если это та же фотография, что была распакована, то сжимать её для сравнения не нужно
+	//
+	if (!m_photo.isSourceOf(_photo)) {
+		setPhotoData(EncodedImage(_photo));
+	}
+}
+
+EncodedImage CharacterPhoto::photoData() const
+{
+	return m_photo;
+}
+
+void CharacterPhoto::setPhotoData(const EncodedImage& _photo)
+{
+	if (m_photo != _photo) {
 		m_photo = _photo;
 
 		changesNotStored();
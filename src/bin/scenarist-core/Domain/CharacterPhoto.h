@@ -3,6 +3,8 @@
 
 #include "DomainObject.h"
 
+#include <3rd_party/Helpers/EncodedImage.h>
+
 #include <QPixmap>
 
 
@@ -19,7 +21,7 @@ namespace Domain
 		CharacterPhoto(
 				const Identifier& _id,
 				Character* _character,
-				const QPixmap& _photo,
+				const EncodedImage& _photo,
 				int _sortOrder
 				);
 
@@ -29,6 +31,12 @@ namespace Domain
 		QPixmap photo() const;
 		void setPhoto(const QPixmap& _photo);
 
+		/**
+		 * @brief Фотография в сжатом виде, в котором она хранится в базе данных
+		 */
+		EncodedImage photoData() const;
+		void setPhotoData(const EncodedImage& _photo);
+
 		int sortOrder() const;
 		void setSortOrder(int _sortOrder);
 
@@ -40,8 +48,9 @@ namespace Domain
 
 		/**
 		 * @brief Собственно фотография
+		 * @note Распаковывается только при обращении к ней
 		 */
-		QPixmap m_photo;
+		EncodedImage m_photo;
 
 		/**
 		 * @brief Порядок следования фотографии
@@ -54,6 +54,16 @@ LocationPhotosTable* Location::photosTable() const
 
 QList<QPixmap> Location::photos() const
 {
+	//
+	// Распаковываем все фотографии разом, чтобы делать это параллельно
+	//
+	QList<EncodedImage> photosData;
+	foreach (DomainObject* domainObject, m_photos->toList()) {
+		LocationPhoto* photo = dynamic_cast<LocationPhoto*>(domainObject);
+		photosData.append(photo->photoData());
+	}
+	EncodedImage::prepare(photosData);
+
 	QList<QPixmap> photos;
 	foreach (DomainObject* domainObject, m_photos->toList()) {
 		LocationPhoto* photo = dynamic_cast<LocationPhoto*>(domainObject);
@@ -77,10 +87,29 @@ void Location::setPhotosTable(LocationPhotosTable* _photos)
 
 void Location::setPhotos(const QList<QPixmap>& _photos)
 {
+	QList<LocationPhoto*> oldPhotos;
+	foreach (DomainObject* domainObject, m_photos->toList()) {
+		oldPhotos.append(dynamic_cast<LocationPhoto*>(domainObject));
+	}
 	m_photos->clear();
 
 	for (int index = 0; index < _photos.count(); ++index) {
-		LocationPhoto* newPhoto = new LocationPhoto(Identifier(), this, _photos.value(index), index);
+		//
+		// Неизменённые фотографии оставляем прежними, чтобы не сохранять их заново
+		//
+		LocationPhoto* newPhoto = 0;
+		foreach (LocationPhoto* oldPhoto, oldPhotos) {
+			if (oldPhoto->photoData().isSourceOf(_photos.value(index))) {
+				newPhoto = oldPhoto;
+				newPhoto->setSortOrder(index);
+				oldPhotos.removeOne(oldPhoto);
+				break;
+			}
+		}
+
+		if (newPhoto == 0) {
+			newPhoto = new LocationPhoto(Identifier(), this, EncodedImage(_photos.value(index)), index);
+		}
 		m_photos->append(newPhoto);
 	}
 
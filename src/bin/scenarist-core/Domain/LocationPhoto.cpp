@@ -2,15 +2,13 @@
 
 #include "Location.h"
 
-#include <3rd_party/Helpers/ImageHelper.h>
-
 using namespace Domain;
 
 
 LocationPhoto::LocationPhoto(
 		const Identifier& _id,
 		Location* _location,
-		const QPixmap& _photo,
+		const EncodedImage& _photo,
 		int _sortOrder
 		) :
 	DomainObject(_id),
@@ -41,12 +39,27 @@ void LocationPhoto::setLocation(Location* _location, bool _onLoad)
 
 QPixmap LocationPhoto::photo() const
 {
-	return m_photo;
+	return m_photo.image();
 }
 
 void LocationPhoto::setPhoto(const QPixmap& _photo)
 {
-	if (!ImageHelper::isImagesEqual(m_photo, _photo)) {
+	//
+	// Если это та же фотография, что была распакована, то сжимать её для сравнения не нужно
+	//
+	if (!m_photo.isSourceOf(_photo)) {
+		setPhotoData(EncodedImage(_photo));
+	}
+}
+
+EncodedImage LocationPhoto::photoData() const
+{
+	return m_photo;
+}
+
+void LocationPhoto::setPhotoData(const EncodedImage& _photo)
+{
+	if (m_photo != _photo) {
 		m_photo = _photo;
 
 		changesNotStored();
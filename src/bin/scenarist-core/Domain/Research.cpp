@@ -1,12 +1,10 @@
 #include "Research.h"
 
-#include <3rd_party/Helpers/ImageHelper.h>
-
 using namespace Domain;
 
 
 Research::Research(const Identifier& _id, Research* _parent, Research::Type _type, int _sortOrder,
-	const QString& _name, const QString& _description, const QString& _url, const QPixmap& _image) :
+	const QString& _name, const QString& _description, const QString& _url, const EncodedImage& _image) :
 	DomainObject(_id),
 	m_parent(_parent),
 	m_type(_type),
@@ -90,12 +88,27 @@ void Research::setUrl(const QString& _url)
 
 QPixmap Research::image() const
 {
-	return m_image;
+	return m_image.image();
 }
 
 void Research::setImage(const QPixmap& _image)
 {
-	if (!ImageHelper::isImagesEqual(m_image, _image)) {
+	//
+	// Если это то же изображение, что было распаковано, то сжимать его для сравнения не нужно
+	//
+	if (!m_image.isSourceOf(_image)) {
+		setImageData(EncodedImage(_image));
+	}
+}
+
+EncodedImage Research::imageData() const
+{
+	return m_image;
+}
+
+void Research::setImageData(const EncodedImage& _image)
+{
+	if (m_image != _image) {
 		m_image = _image;
 
 		changesNotStored();
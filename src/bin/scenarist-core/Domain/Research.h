@@ -3,6 +3,8 @@
 
 #include "DomainObject.h"
 
+#include <3rd_party/Helpers/EncodedImage.h>
+
 #include <QPixmap>
 #include <QString>
 
@@ -34,7 +36,7 @@ namespace Domain
 	public:
 		Research(const Identifier& _id, Research* _parent, Type _type, int _sortOrder,
 			const QString& _name, const QString& _description = QString::null,
-			const QString& _url = QString::null, const QPixmap& _image = QPixmap());
+			const QString& _url = QString::null, const EncodedImage& _image = EncodedImage());
 
 		/**
 		 * @brief Получить родителя
@@ -96,6 +98,16 @@ namespace Domain
 		 */
 		void setImage(const QPixmap& _image);
 
+		/**
+		 * @brief Получить изображение в сжатом виде, в котором оно хранится в базе данных
+		 */
+		EncodedImage imageData() const;
+
+		/**
+		 * @brief Установить изображение в сжатом виде
+		 */
+		void setImageData(const EncodedImage& _image);
+
 		/**
 		 * @brief Получить позицию сортировки
 		 */
@@ -136,8 +148,9 @@ namespace Domain
 
 		/**
 		 * @brief Изображение
+		 * @note Распаковывается только при обращении к нему
 		 */
-		QPixmap m_image;
+		EncodedImage m_image;
 
 		/**
 		 * @brief Порядок сортировки
@@ -30,7 +30,7 @@ void ParentheticalHandler::handleEnter(QKeyEvent*)
 	// ... текст после курсора
 	QString cursorForwardText = currentBlock.text().mid(cursor.positionInBlock());
 	// ... префикс и постфикс стиля
-	ScenarioBlockStyle style = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::Parenthetical);
+	const ScenarioBlockStyle& style = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::Parenthetical);
 	QString stylePrefix = style.prefix();
 	QString stylePostfix = style.postfix();
 
@@ -124,7 +124,7 @@ void ParentheticalHandler::handleTab(QKeyEvent*)
 	// ... текст после курсора
 	QString cursorForwardText = currentBlock.text().mid(cursor.positionInBlock());
 	// ... префикс и постфикс стиля
-	ScenarioBlockStyle style = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::Parenthetical);
+	const ScenarioBlockStyle& style = ScenarioTemplateFacade::getTemplate().blockStyle(ScenarioBlockStyle::Parenthetical);
 	QString stylePrefix = style.prefix();
 	QString stylePostfix = style.postfix();
 
@@ -90,6 +90,7 @@ void ScenarioTextEdit::setScenarioDocument(ScenarioTextDocument* _document)
 	removeEditorConnections();
 
 	m_document = _document;
+	m_blocksGeometry.clear();
 	setDocument(m_document);
 	setHighlighterDocument(m_document);
 
@@ -222,8 +223,8 @@ void ScenarioTextEdit::changeScenarioBlockType(ScenarioBlockStyle::Type _blockTy
 			//
 			// Определим стили
 			//
-			ScenarioBlockStyle oldStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
-			ScenarioBlockStyle newStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
+			const ScenarioBlockStyle& oldStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
+			const ScenarioBlockStyle& newStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
 
 			//
 			// Если необходимо сменить группирующий стиль на аналогичный
@@ -264,7 +265,7 @@ void ScenarioTextEdit::applyScenarioTypeToBlockText(ScenarioBlockStyle::Type _bl
 	QTextCursor cursor = textCursor();
 	cursor.beginEditBlock();
 
-	ScenarioBlockStyle newBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
+	const ScenarioBlockStyle& newBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
 
 	//
 	// Обновим стили
@@ -770,9 +771,22 @@ void ScenarioTextEdit::paintEvent(QPaintEvent* _event)
 
 			QPainter painter(viewport());
 
-			QTextBlock block = document()->begin();
 			const QRectF viewportGeometry = viewport()->geometry();
 			const int leftDelta = -horizontalScrollBar()->value();
+			const int topDelta = -verticalScrollBar()->value();
+
+			//
+			// Начинаем с первого видимого блока, определяя его через позиционирование в верхней
+			// точке области прорисовки, и на всякий случай захватываем предыдущий блок,
+			// который может быть виден частично
+			//
+			QTextBlock block = cursorForPosition(QPoint(0, 0)).block();
+			if (block.isValid() && block.previous().isValid()) {
+				block = block.previous();
+			}
+			if (!block.isValid()) {
+				block = document()->begin();
+			}
 
 			QTextCursor cursor(document());
 			while (block.isValid()) {
@@ -783,16 +797,28 @@ void ScenarioTextEdit::paintEvent(QPaintEvent* _event)
 
 				if (block.isVisible()) {
 					cursor.setPosition(block.position());
-					QRect cursorR = cursorRect(cursor);
+
+					//
+					// Геометрию блока берём из кэша, если есть, или рассчитываем и сохраняем в кэш
+					//
+					if (!m_blocksGeometry.contains(block.blockNumber())) {
+						m_blocksGeometry.insert(block.blockNumber(),
+							cursorRect(cursor).translated(-leftDelta, -topDelta));
+					}
+					const QRect cursorR = m_blocksGeometry.value(block.blockNumber()).translated(leftDelta, topDelta);
+
+					//
+					// Если блок ниже нижней границы, то дальше рисовать нечего
+					//
+					if (cursorR.top() >= viewportGeometry.bottom()) {
+						break;
+					}
 
 					//
 					// Курсор на экране
 					//
 					// ... ниже верхней границы
-					if ((cursorR.top() > 0 || cursorR.bottom() > 0)
-						// ... и выше нижней
-						&& cursorR.top() < viewportGeometry.bottom()) {
-
+					if (cursorR.top() > 0 || cursorR.bottom() > 0) {
 						//
 						// Прорисовка символа пустой строки
 						//
@@ -1104,10 +1130,15 @@ void ScenarioTextEdit::aboutLoadEditorState()
 
 }
 
+void ScenarioTextEdit::aboutResetBlocksGeometry()
+{
+	m_blocksGeometry.clear();
+}
+
 void ScenarioTextEdit::cleanScenarioTypeFromBlock()
 {
 	QTextCursor cursor = textCursor();
-	ScenarioBlockStyle oldBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
+	const ScenarioBlockStyle& oldBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
 
 	//
 	// Удалить завершающий блок группы сцен
@@ -1221,7 +1252,7 @@ void ScenarioTextEdit::applyScenarioTypeToBlock(ScenarioBlockStyle::Type _blockT
 	QTextCursor cursor = textCursor();
 	cursor.beginEditBlock();
 
-	ScenarioBlockStyle newBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
+	const ScenarioBlockStyle& newBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
 
 	//
 	// Обновим стили
@@ -1298,7 +1329,7 @@ void ScenarioTextEdit::applyScenarioTypeToBlock(ScenarioBlockStyle::Type _blockT
 	// Вставим заголовок, если необходимо
 	//
 	if (newBlockStyle.hasHeader()) {
-		ScenarioBlockStyle headerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockStyle.headerType());
+		const ScenarioBlockStyle& headerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockStyle.headerType());
 
 		cursor.movePosition(QTextCursor::StartOfBlock);
 		cursor.insertBlock();
@@ -1314,7 +1345,7 @@ void ScenarioTextEdit::applyScenarioTypeToBlock(ScenarioBlockStyle::Type _blockT
 	// Для заголовка группы нужно создать завершение, захватив всё содержимое сцены
 	//
 	if (newBlockStyle.isEmbeddableHeader()) {
-		ScenarioBlockStyle footerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockStyle.embeddableFooter());
+		const ScenarioBlockStyle& footerStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockStyle.embeddableFooter());
 
 		//
 		// Запомним позицию курсора
@@ -1364,9 +1395,9 @@ void ScenarioTextEdit::applyScenarioTypeToBlock(ScenarioBlockStyle::Type _blockT
 
 void ScenarioTextEdit::applyScenarioGroupTypeToGroupBlock(ScenarioBlockStyle::Type _blockType)
 {
-	ScenarioBlockStyle oldBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
-	ScenarioBlockStyle newBlockHeaderStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
-	ScenarioBlockStyle newBlockFooterStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockHeaderStyle.embeddableFooter());
+	const ScenarioBlockStyle& oldBlockStyle = ScenarioTemplateFacade::getTemplate().blockStyle(scenarioBlockType());
+	const ScenarioBlockStyle& newBlockHeaderStyle = ScenarioTemplateFacade::getTemplate().blockStyle(_blockType);
+	const ScenarioBlockStyle& newBlockFooterStyle = ScenarioTemplateFacade::getTemplate().blockStyle(newBlockHeaderStyle.embeddableFooter());
 
 	//
 	// Сменим стиль заголовочного блока
@@ -1598,6 +1629,9 @@ void ScenarioTextEdit::initEditorConnections()
 		connect(m_document, SIGNAL(beforePatchApply()), this, SLOT(aboutSaveEditorState()));
 		connect(m_document, SIGNAL(afterPatchApply()), this, SLOT(aboutLoadEditorState()));
 		connect(m_document, SIGNAL(reviewChanged()), this, SIGNAL(reviewChanged()));
+		connect(m_document->documentLayout(), SIGNAL(update(QRectF)), this, SLOT(aboutResetBlocksGeometry()));
+		connect(m_document->documentLayout(), SIGNAL(documentSizeChanged(QSizeF)),
+				this, SLOT(aboutResetBlocksGeometry()));
 	}
 }
 
@@ -1609,6 +1643,9 @@ void ScenarioTextEdit::removeEditorConnections()
 		disconnect(m_document, SIGNAL(beforePatchApply()), this, SLOT(aboutSaveEditorState()));
 		disconnect(m_document, SIGNAL(afterPatchApply()), this, SLOT(aboutLoadEditorState()));
 		disconnect(m_document, SIGNAL(reviewChanged()), this, SIGNAL(reviewChanged()));
+		disconnect(m_document->documentLayout(), SIGNAL(update(QRectF)), this, SLOT(aboutResetBlocksGeometry()));
+		disconnect(m_document->documentLayout(), SIGNAL(documentSizeChanged(QSizeF)),
+				   this, SLOT(aboutResetBlocksGeometry()));
 	}
 }
 
@@ -233,6 +233,11 @@ namespace UserInterface
 		 */
 		void aboutLoadEditorState();
 
+		/**
+		 * @brief Сбросить кэш геометрии блоков при изменении компоновки документа
+		 */
+		void aboutResetBlocksGeometry();
+
 	private:
 		/**
 		 * @brief Очистить текущий блок от установленного в нём типа
@@ -334,6 +339,12 @@ namespace UserInterface
 		 */
 		QMap<QString, int> m_additionalCursorsCorrected;
 
+		/**
+		 * @brief Кэш геометрии начала блоков в координатах документа
+		 * @note Используется для прорисовки декораций, ключ - номер блока
+		 */
+		QHash<int, QRect> m_blocksGeometry;
+
 		/**
 		 * @brief Управляющий шорткатами
 		 */
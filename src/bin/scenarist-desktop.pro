@@ -137,6 +137,8 @@ SOURCES += \
     scenarist-core/BusinessLayer/Chronometry/ChronometerFacade.cpp \
     scenarist-core/BusinessLayer/Chronometry/ConfigurableChronometer.cpp \
     scenarist-core/DataLayer/Database/Database.cpp \
+    scenarist-core/DataLayer/Database/DatabaseHistoryWriter.cpp \
+    scenarist-core/DataLayer/Database/ScenarioChangesCompactor.cpp \
     scenarist-core/DataLayer/DataMappingLayer/AbstractMapper.cpp \
     scenarist-core/DataLayer/DataMappingLayer/CharacterMapper.cpp \
     scenarist-core/DataLayer/DataMappingLayer/LocationMapper.cpp \
@@ -171,6 +173,7 @@ SOURCES += \
     scenarist-core/BusinessLayer/Export/PdfExporter.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioXml.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextDocument.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioBlocksChange.cpp \
     scenarist-desktop/UserInterfaceLayer/StartUp/StartUpView.cpp \
     scenarist-desktop/UserInterfaceLayer/StartUp/RecentFilesDelegate.cpp \
     scenarist-desktop/UserInterfaceLayer/StartUp/RecentFileWidget.cpp \
@@ -202,6 +205,7 @@ SOURCES += \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioFastFormatWidget.cpp \
     scenarist-core/3rd_party/Widgets/PagesTextEdit/PageMetrics.cpp \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioNavigator/ScenarioNavigatorProxyStyle.cpp \
+    scenarist-desktop/ManagementLayer/Export/BatchExporter.cpp \
     scenarist-desktop/ManagementLayer/Export/ExportManager.cpp \
     scenarist-desktop/UserInterfaceLayer/Export/ExportDialog.cpp \
     scenarist-core/Domain/CharacterState.cpp \
@@ -219,6 +223,7 @@ SOURCES += \
     scenarist-core/3rd_party/Widgets/AcceptebleLineEdit/AcceptebleLineEdit.cpp \
     scenarist-core/3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.cpp \
     scenarist-core/3rd_party/Helpers/BackupHelper.cpp \
+    scenarist-core/3rd_party/Helpers/EncodedImage.cpp \
     scenarist-core/3rd_party/Widgets/HierarchicalHeaderView/HierarchicalHeaderView.cpp \
     scenarist-core/3rd_party/Widgets/HierarchicalHeaderView/HierarchicalTableModel.cpp \
     scenarist-core/3rd_party/Widgets/FlatButton/FlatButton.cpp \
@@ -244,6 +249,9 @@ SOURCES += \
     scenarist-core/3rd_party/Widgets/QLightBoxWidget/qlightboxmessage.cpp \
     scenarist-core/3rd_party/Widgets/ToolTipLabel/ToolTipLabel.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioReviewModel.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.cpp \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewPanel.cpp \
     scenarist-core/3rd_party/Widgets/ColoredToolButton/ColoredToolButton.cpp \
     scenarist-core/3rd_party/Widgets/ColoredToolButton/GoogleColorsPane.cpp \
@@ -282,6 +290,8 @@ SOURCES += \
     scenarist-core/3rd_party/Widgets/QCutomPlot/qcustomplot.cpp \
     scenarist-core/BusinessLayer/Statistics/Plots/StoryStructureAnalisysPlot.cpp \
     scenarist-core/BusinessLayer/Statistics/StatisticsFacade.cpp \
+    scenarist-core/BusinessLayer/Statistics/StatisticsPaginator.cpp \
+    scenarist-core/BusinessLayer/Statistics/ScenarioSnapshot.cpp \
     scenarist-core/3rd_party/Widgets/QCutomPlot/qcustomplotextended.cpp \
     scenarist-core/BusinessLayer/Statistics/Plots/CharactersActivityPlot.cpp \
     scenarist-core/3rd_party/Widgets/PagesTextEdit/PageTextEdit.cpp \
@@ -415,6 +425,7 @@ HEADERS += \
     scenarist-core/BusinessLayer/Export/PdfExporter.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioXml.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextDocument.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioBlocksChange.h \
     scenarist-desktop/UserInterfaceLayer/StartUp/StartUpView.h \
     scenarist-desktop/UserInterfaceLayer/StartUp/RecentFilesDelegate.h \
     scenarist-desktop/UserInterfaceLayer/StartUp/RecentFileWidget.h \
@@ -447,6 +458,7 @@ HEADERS += \
     scenarist-core/3rd_party/Widgets/PagesTextEdit/PageMetrics.h \
     scenarist-core/3rd_party/Helpers/TextEditHelper.h \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioNavigator/ScenarioNavigatorProxyStyle.h \
+    scenarist-desktop/ManagementLayer/Export/BatchExporter.h \
     scenarist-desktop/ManagementLayer/Export/ExportManager.h \
     scenarist-desktop/UserInterfaceLayer/Export/ExportDialog.h \
     scenarist-core/Domain/CharacterState.h \
@@ -465,6 +477,7 @@ HEADERS += \
     scenarist-core/3rd_party/Widgets/AcceptebleLineEdit/AcceptebleLineEdit.h \
     scenarist-core/3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.h \
     scenarist-core/3rd_party/Helpers/BackupHelper.h \
+    scenarist-core/3rd_party/Helpers/EncodedImage.h \
     scenarist-core/3rd_party/Widgets/HierarchicalHeaderView/HierarchicalHeaderView.h \
     scenarist-core/3rd_party/Widgets/HierarchicalHeaderView/HierarchicalTableModel.h \
     scenarist-core/3rd_party/Widgets/FlatButton/FlatButton.h \
@@ -495,6 +508,9 @@ HEADERS += \
     scenarist-core/3rd_party/Widgets/QLightBoxWidget/qlightboxmessage.h \
     scenarist-core/3rd_party/Widgets/ToolTipLabel/ToolTipLabel.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioReviewModel.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.h \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewPanel.h \
     scenarist-core/3rd_party/Widgets/ColoredToolButton/ColoredToolButton.h \
     scenarist-core/3rd_party/Widgets/ColoredToolButton/ColorsPane.h \
@@ -505,6 +521,8 @@ HEADERS += \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewView.h \
     scenarist-desktop/UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewItemDelegate.h \
     scenarist-core/DataLayer/Database/DatabaseHelper.h \
+    scenarist-core/DataLayer/Database/DatabaseHistoryWriter.h \
+    scenarist-core/DataLayer/Database/ScenarioChangesCompactor.h \
     scenarist-core/3rd_party/Widgets/Ctk/ctkCollapsibleButton.h \
     scenarist-desktop/UserInterfaceLayer/Statistics/StatisticsView.h \
     scenarist-desktop/ManagementLayer/Statistics/StatisticsManager.h \
@@ -545,6 +563,8 @@ HEADERS += \
     scenarist-core/BusinessLayer/Statistics/StatisticsParameters.h \
     scenarist-core/BusinessLayer/Statistics/Plots/StoryStructureAnalisysPlot.h \
     scenarist-core/BusinessLayer/Statistics/StatisticsFacade.h \
+    scenarist-core/BusinessLayer/Statistics/StatisticsPaginator.h \
+    scenarist-core/BusinessLayer/Statistics/ScenarioSnapshot.h \
     scenarist-core/3rd_party/Widgets/QCutomPlot/qcustomplotextended.h \
     scenarist-core/BusinessLayer/Statistics/Plots/CharactersActivityPlot.h \
     scenarist-core/3rd_party/Widgets/PagesTextEdit/PageTextEdit.h \
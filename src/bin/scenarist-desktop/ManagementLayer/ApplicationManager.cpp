@@ -83,6 +83,11 @@ namespace {
 	 */
 	const QString PROJECT_FILE_EXTENSION = ".kitsp"; // kit scenarist project
 
+	/**
+	 * @brief Количество последних изменений сценария, патчи которых остаются при сжатии истории
+	 */
+	const int SCENARIO_CHANGES_TAIL_SIZE = 1000;
+
 	/**
 	 * @brief Суффикс "изменено" для заголовка окна добавляемый в маке
 	 */
@@ -356,12 +361,14 @@ void ApplicationManager::aboutSaveAs()
 			// ... если файл существовал, удалим его для удаления данных в нём
 			//
 			if (QFile::exists(saveAsProjectFileName)) {
+				DatabaseLayer::Database::waitForCompaction(saveAsProjectFileName);
 				QFile::remove(saveAsProjectFileName);
 			}
 
 			//
 			// ... скопируем текущую базу в указанный файл
 			//
+			DatabaseLayer::Database::checkpoint();
 			if (QFile::copy(ProjectsManager::currentProject().path(), saveAsProjectFileName)) {
 				//
 				// ... отключаем индикатор соединения, если мы работали с облаком
@@ -436,7 +443,14 @@ void ApplicationManager::aboutSave()
 			//
 			// Если необходимо создадим резервную копию закрываемого файла
 			//
-			QtConcurrent::run(&m_backupHelper, &BackupHelper::saveBackup, ProjectsManager::currentProject().path());
+			DatabaseLayer::Database::checkpoint();
+			QFuture<void> previousBackupTask = m_backupTask;
+			BackupHelper* backupHelper = &m_backupHelper;
+			const QString projectPath = ProjectsManager::currentProject().path();
+			m_backupTask = QtConcurrent::run([previousBackupTask, backupHelper, projectPath] () mutable {
+				previousBackupTask.waitForFinished();
+				backupHelper->saveBackup(projectPath);
+			});
 		}
 		//
 		// А если ошибка сохранения, то делаем дополнительные проверки и работаем с пользователем
@@ -869,9 +883,10 @@ void ApplicationManager::aboutExit()
 		progress.showProgress(tr("Exit from Application"), tr("Closing Databse Connections and Remove Temporatry Files."));
 
 		//
-		// Закроем текущий проект
+		// Закроем текущий проект и дождёмся сжатия его истории, чтобы не прервать перестройку файла
 		//
 		closeCurrentProject();
+		DatabaseLayer::Database::waitForCompaction();
 
 		//
 		// Сохраняем состояния виджетов
@@ -1038,7 +1053,11 @@ void ApplicationManager::currentTabIndexChanged()
 					case CHARACTERS_TAB_INDEX: result = m_charactersManager->view(); break;
 					case LOCATIONS_TAB_INDEX: result = m_locationsManager->view(); break;
 					case STATISTICS_TAB_INDEX: result = m_statisticsManager->view(); break;
-					case SETTINGS_TAB_INDEX: result = m_settingsManager->view(); break;
+					case SETTINGS_TAB_INDEX: {
+						m_settingsManager->updateBackupsInfo();
+						result = m_settingsManager->view();
+						break;
+					}
 				}
 				return result;
 			};
@@ -1236,6 +1255,18 @@ void ApplicationManager::closeCurrentProject()
 		//
 		DatabaseLayer::Database::closeCurrentFile();
 
+		//
+		// Сжимаем историю изменений локальных проектов, для проектов из облака
+		// вся история нужна для синхронизации с соавторами
+		//
+		// NOTE: Сжатие выполняется в фоне после резервного копирования того же файла,
+		//		 а повторное открытие файла дожидается окончания сжатия
+		//
+		if (!m_projectsManager->currentProject().isRemote()) {
+			DatabaseLayer::Database::compactScenarioChangesInBackground(
+				ProjectsManager::currentProject().path(), SCENARIO_CHANGES_TAIL_SIZE, m_backupTask);
+		}
+
 		//
 		// Информируем управляющего проектами, что текущий проект закрыт
 		//
@@ -1630,6 +1661,37 @@ void ApplicationManager::reloadApplicationSettings()
 	m_backupHelper.setIsActive(saveBackups);
 	m_backupHelper.setBackupDir(saveBackupsFolder);
 
+	//
+	// Параметры базы данных, вступают в силу при следующем открытии проекта
+	//
+	{
+		DatabaseLayer::Database::PerformanceProfile profile;
+		profile.journalMode =
+				DataStorageLayer::StorageFacade::settingsStorage()->value(
+					"application/database/journal-mode",
+					DataStorageLayer::SettingsStorage::ApplicationSettings);
+		profile.synchronous =
+				DataStorageLayer::StorageFacade::settingsStorage()->value(
+					"application/database/synchronous",
+					DataStorageLayer::SettingsStorage::ApplicationSettings);
+		profile.pageSize =
+				DataStorageLayer::StorageFacade::settingsStorage()->value(
+					"application/database/page-size",
+					DataStorageLayer::SettingsStorage::ApplicationSettings)
+				.toInt();
+		profile.cacheSize =
+				DataStorageLayer::StorageFacade::settingsStorage()->value(
+					"application/database/cache-size",
+					DataStorageLayer::SettingsStorage::ApplicationSettings)
+				.toInt();
+		profile.mmapSize =
+				DataStorageLayer::StorageFacade::settingsStorage()->value(
+					"application/database/mmap-size",
+					DataStorageLayer::SettingsStorage::ApplicationSettings)
+				.toLongLong();
+		DatabaseLayer::Database::setPerformanceProfile(profile);
+	}
+
 	//
 	// Разделение экрана на две панели
 	//
@@ -3,6 +3,7 @@
 
 #include <3rd_party/Helpers/BackupHelper.h>
 
+#include <QFuture>
 #include <QObject>
 #include <QTimer>
 
@@ -351,6 +352,12 @@ namespace ManagementLayer
 		 * @brief Помощник резервного копирования
 		 */
 		BackupHelper m_backupHelper;
+
+		/**
+		 * @brief Последнее запущенное резервное копирование
+		 * @note Копирования выполняются по очереди, а перед сжатием файла проекта нужно дождаться их завершения
+		 */
+		QFuture<void> m_backupTask;
 	};
 }
 
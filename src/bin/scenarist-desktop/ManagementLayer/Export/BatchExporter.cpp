@@ -0,0 +1,341 @@
+#include "BatchExporter.h"
+
+#include <BusinessLayer/ScenarioDocument/ScenarioDocument.h>
+#include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/Export/DocxExporter.h>
+#include <BusinessLayer/Export/PdfExporter.h>
+#include <BusinessLayer/Export/FdxExporter.h>
+
+#include <DataLayer/Database/Database.h>
+
+#include <DataLayer/DataStorageLayer/StorageFacade.h>
+#include <DataLayer/DataStorageLayer/ScenarioStorage.h>
+#include <DataLayer/DataStorageLayer/ScenarioDataStorage.h>
+#include <DataLayer/DataStorageLayer/SettingsStorage.h>
+
+#include <Domain/Scenario.h>
+
+#include <3rd_party/Helpers/FileHelper.h>
+
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QFuture>
+#include <QTextDocument>
+#include <QTextStream>
+
+#include <QtConcurrentRun>
+
+#ifdef Q_OS_UNIX
+#include <sys/resource.h>
+#endif
+
+using ManagementLayer::BatchExporter;
+using DataStorageLayer::StorageFacade;
+using DataStorageLayer::SettingsStorage;
+
+namespace {
+	/**
+	 * @brief Параметр командной строки со списком форматов экспорта
+	 */
+	const QString EXPORT_OPTION = "export";
+
+	/**
+	 * @brief Параметр командной строки с папкой для экспортированных файлов
+	 */
+	const QString OUTPUT_DIR_OPTION = "output-dir";
+
+	/**
+	 * @brief Поддерживаемые форматы экспорта
+	 */
+	const QStringList SUPPORTED_FORMATS = QStringList() << "pdf" << "docx" << "fdx";
+
+	/**
+	 * @brief Поток для вывода отчёта
+	 */
+	static QTextStream& output() {
+		static QTextStream s_output(stdout);
+		return s_output;
+	}
+
+	/**
+	 * @brief Поток для вывода ошибок
+	 */
+	static QTextStream& errorOutput() {
+		static QTextStream s_errorOutput(stderr);
+		return s_errorOutput;
+	}
+
+	/**
+	 * @brief Пиковый объём памяти процесса (КиБ)
+	 * @return -1, если на этой платформе он не определяется
+	 */
+	static qint64 peakMemoryKib() {
+#ifdef Q_OS_UNIX
+		rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) != 0) {
+			return -1;
+		}
+#ifdef Q_OS_MAC
+		return usage.ru_maxrss / 1024;
+#else
+		return usage.ru_maxrss;
+#endif
+#else
+		return -1;
+#endif
+	}
+
+	/**
+	 * @brief Создать экспортера для заданного формата
+	 * @note Вызывающий получает владение над новым экспортером
+	 */
+	static BusinessLogic::AbstractExporter* createExporter(const QString& _format) {
+		BusinessLogic::AbstractExporter* exporter = 0;
+		if (_format == "docx") {
+			exporter = new BusinessLogic::DocxExporter;
+		} else if (_format == "pdf") {
+			exporter = new BusinessLogic::PdfExporter;
+		} else if (_format == "fdx") {
+			exporter = new BusinessLogic::FdxExporter;
+		}
+		return exporter;
+	}
+
+	/**
+	 * @brief Получить параметр экспорта проекта, сохранённый диалогом экспорта
+	 */
+	static QString projectSetting(const QString& _projectPath, const QString& _key,
+		const QString& _defaultValue = QString::null) {
+		return
+				StorageFacade::settingsStorage()->value(
+					QString("projects/%1/export/%2").arg(_projectPath, _key),
+					SettingsStorage::ApplicationSettings,
+					_defaultValue);
+	}
+
+	/**
+	 * @brief Экспортировать сформированный документ в один формат
+	 * @return Время экспорта (мс)
+	 * @note Выполняется в фоновом потоке
+	 */
+	static qint64 exportFormat(BusinessLogic::AbstractExporter* _exporter, BusinessLogic::ScenarioDocument* _scenario,
+		QTextDocument* _preparedDocument, const BusinessLogic::ExportParameters& _exportParameters) {
+		QElapsedTimer timer;
+		timer.start();
+		_exporter->exportTo(_scenario, _preparedDocument, _exportParameters);
+		return timer.elapsed();
+	}
+}
+
+
+bool BatchExporter::isRequested(const QStringList& _arguments)
+{
+	foreach (const QString& argument, _arguments) {
+		if (argument == "--" + EXPORT_OPTION
+			|| argument.startsWith("--" + EXPORT_OPTION + "=")) {
+			return true;
+		}
+	}
+	return false;
+}
+
+int BatchExporter::exec(const QStringList& _arguments)
+{
+	QCommandLineParser parser;
+	parser.addHelpOption();
+	parser.addOption(QCommandLineOption(EXPORT_OPTION,
+		"Export projects to the comma separated list of formats: pdf, docx, fdx.", "formats"));
+	parser.addOption(QCommandLineOption(OUTPUT_DIR_OPTION,
+		"Folder for the exported files. By default they are placed next to the projects.", "dir"));
+	parser.addPositionalArgument("projects", "Project files to export.", "<project.kitsp>...");
+	if (!parser.parse(_arguments)) {
+		errorOutput() << parser.errorText() << endl;
+		return 1;
+	}
+	if (parser.isSet("help")) {
+		parser.showHelp();
+	}
+
+	//
+	// Разбираем список форматов
+	//
+	QStringList formats;
+	foreach (const QString& format, parser.value(EXPORT_OPTION).toLower().split(",", QString::SkipEmptyParts)) {
+		const QString trimmedFormat = format.trimmed();
+		if (!SUPPORTED_FORMATS.contains(trimmedFormat)) {
+			errorOutput() << "Unknown export format: " << trimmedFormat << endl;
+			return 1;
+		}
+		if (!formats.contains(trimmedFormat)) {
+			formats.append(trimmedFormat);
+		}
+	}
+	if (formats.isEmpty()
+		|| parser.positionalArguments().isEmpty()) {
+		errorOutput() << parser.helpText() << endl;
+		return 1;
+	}
+
+	const QString outputDir = parser.value(OUTPUT_DIR_OPTION);
+	if (!outputDir.isEmpty()
+		&& !QDir::root().mkpath(outputDir)) {
+		errorOutput() << "Can't create output folder: " << outputDir << endl;
+		return 1;
+	}
+
+	//
+	// Экспортеры в фоновых потоках читают стиль экспорта, поэтому загружаем его заранее,
+	// чтобы там были только обращения на чтение к кэшу настроек и библиотеке стилей
+	//
+	BusinessLogic::ScenarioTemplateFacade::getTemplate(
+		StorageFacade::settingsStorage()->value("export/style", SettingsStorage::ApplicationSettings));
+
+	QElapsedTimer timer;
+	timer.start();
+	bool isSuccess = true;
+	foreach (const QString& projectPath, parser.positionalArguments()) {
+		isSuccess = exportProject(projectPath, formats, outputDir) && isSuccess;
+	}
+	output() << "total: " << timer.elapsed() << " ms" << endl;
+	const qint64 peakMemory = ::peakMemoryKib();
+	if (peakMemory >= 0) {
+		output() << "peak memory: " << peakMemory << " KiB" << endl;
+	}
+
+	return isSuccess ? 0 : 1;
+}
+
+
+//********
+// Скрытая часть
+
+
+bool BatchExporter::exportProject(const QString& _projectPath, const QStringList& _formats,
+	const QString& _outputDir)
+{
+	//
+	// Путь приводится к тому же виду, что и при открытии проекта, чтобы найти его настройки
+	//
+	const QString projectPath = QDir::toNativeSeparators(QFileInfo(_projectPath).absoluteFilePath());
+	if (!QFileInfo(projectPath).isFile()) {
+		errorOutput() << projectPath << ": file not found" << endl;
+		return false;
+	}
+	if (!DatabaseLayer::Database::canOpenFile(projectPath, true)) {
+		errorOutput() << projectPath << ": " << DatabaseLayer::Database::openFileError() << endl;
+		return false;
+	}
+
+	output() << projectPath << endl;
+	QElapsedTimer timer;
+	timer.start();
+
+	//
+	// Загружаем проект
+	//
+	DatabaseLayer::Database::setCurrentFile(projectPath);
+	BusinessLogic::ScenarioDocument scenario;
+	scenario.load(StorageFacade::scenarioStorage()->current());
+
+	//
+	// Настраиваем параметры экспорта так же, как их сохранил диалог экспорта
+	//
+	BusinessLogic::ExportParameters exportParameters;
+	exportParameters.checkPageBreaks = projectSetting(projectPath, "check-page-breaks").toInt();
+	exportParameters.style = StorageFacade::settingsStorage()->value("export/style", SettingsStorage::ApplicationSettings);
+	exportParameters.printPagesNumbers = projectSetting(projectPath, "page-numbering").toInt();
+	exportParameters.printScenesNumbers = projectSetting(projectPath, "scenes-numbering").toInt();
+	exportParameters.scenesPrefix = projectSetting(projectPath, "scenes-prefix");
+	exportParameters.saveReviewMarks = projectSetting(projectPath, "save-review-marks", "1").toInt();
+	exportParameters.printTilte = projectSetting(projectPath, "print-title").toInt();
+	exportParameters.scenarioName = StorageFacade::scenarioDataStorage()->name();
+	exportParameters.scenarioAdditionalInfo = StorageFacade::scenarioDataStorage()->additionalInfo();
+	exportParameters.scenarioGenre = StorageFacade::scenarioDataStorage()->genre();
+	exportParameters.scenarioAuthor = StorageFacade::scenarioDataStorage()->author();
+	exportParameters.scenarioContacts = StorageFacade::scenarioDataStorage()->contacts();
+	exportParameters.scenarioYear = StorageFacade::scenarioDataStorage()->year();
+
+	QString exportFileName = exportParameters.scenarioName;
+	if (exportFileName.isEmpty()) {
+		exportFileName = QFileInfo(projectPath).completeBaseName();
+	}
+	exportFileName = FileHelper::systemSavebleFileName(exportFileName);
+	const QDir exportDir(_outputDir.isEmpty() ? QFileInfo(projectPath).absolutePath() : _outputDir);
+
+	output() << "  load: " << timer.restart() << " ms" << endl;
+
+	//
+	// Создаём экспортеров и один раз формируем документ для тех из них, кому он нужен
+	//
+	QList<BusinessLogic::AbstractExporter*> exporters;
+	bool needPreparedDocument = false;
+	foreach (const QString& format, _formats) {
+		exporters.append(::createExporter(format));
+		needPreparedDocument = needPreparedDocument || exporters.last()->needPreparedDocument();
+	}
+	QTextDocument* preparedDocument = 0;
+	if (needPreparedDocument) {
+		preparedDocument = BusinessLogic::AbstractExporter::prepareDocument(&scenario, exportParameters);
+		output() << "  prepare: " << timer.restart() << " ms" << endl;
+	}
+
+	//
+	// Выводим документ во все форматы параллельно. Экспортеры изменяют сформированный документ
+	// при выводе, поэтому каждый получает свою копию. Копии снимаются в этом потоке, а сценарий
+	// до завершения экспорта здесь больше не трогается
+	//
+	QList<QTextDocument*> documentsCopies;
+	QStringList exportFilesPaths;
+	QList<QFuture<qint64> > exports;
+	for (int formatIndex = 0; formatIndex < _formats.size(); ++formatIndex) {
+		BusinessLogic::AbstractExporter* exporter = exporters.at(formatIndex);
+		QTextDocument* documentCopy = 0;
+		if (exporter->needPreparedDocument()) {
+			documentCopy = preparedDocument->clone();
+			documentsCopies.append(documentCopy);
+		}
+
+		BusinessLogic::ExportParameters formatExportParameters = exportParameters;
+		formatExportParameters.filePath = exportDir.absoluteFilePath(exportFileName + "." + _formats.at(formatIndex));
+
+		//
+		// Старый файл удаляем, чтобы по нему нельзя было принять неудачный экспорт за удачный
+		//
+		exportFilesPaths.append(formatExportParameters.filePath);
+		QFile::remove(formatExportParameters.filePath);
+		exports.append(QtConcurrent::run(&::exportFormat, exporter, &scenario, documentCopy, formatExportParameters));
+	}
+
+	//
+	// Экспортеры не сообщают об ошибках, поэтому считаем экспорт удачным, если файл был создан и не пуст
+	//
+	bool isSuccess = true;
+	for (int formatIndex = 0; formatIndex < _formats.size(); ++formatIndex) {
+		const qint64 exportTime = exports[formatIndex].result();
+		const QFileInfo exportFileInfo(exportFilesPaths.at(formatIndex));
+		if (!exportFileInfo.isFile()
+			|| exportFileInfo.size() == 0) {
+			errorOutput() << projectPath << ": " << _formats.at(formatIndex) << " export failed" << endl;
+			isSuccess = false;
+			continue;
+		}
+		output() << "  " << _formats.at(formatIndex) << ": " << exportTime << " ms" << endl;
+	}
+	output() << "  export: " << timer.elapsed() << " ms" << endl;
+
+	//
+	// Освобождаем память и закрываем проект
+	//
+	qDeleteAll(documentsCopies);
+	delete preparedDocument;
+	preparedDocument = 0;
+	qDeleteAll(exporters);
+
+	StorageFacade::clearStorages();
+	DatabaseLayer::Database::closeCurrentFile();
+
+	return isSuccess;
+}
@@ -0,0 +1,42 @@
+#ifndef BATCHEXPORTER_H
+#define BATCHEXPORTER_H
+
+#include <QStringList>
+
+
+namespace ManagementLayer
+{
+	/**
+	 * @brief Пакетный экспорт проектов из командной строки, без интерфейса
+	 *
+	 * Scenarist --export pdf,docx,fdx [--output-dir <папка>] <проект.kitsp> ...
+	 *
+	 * Каждый проект загружается один раз, документ для экспорта формируется один раз,
+	 * а в разные форматы он выводится параллельно в пуле потоков. Время каждого этапа
+	 * и пиковый объём памяти процесса выводятся в стандартный поток вывода
+	 */
+	class BatchExporter
+	{
+	public:
+		/**
+		 * @brief Запрошен ли пакетный экспорт в аргументах командной строки
+		 */
+		static bool isRequested(const QStringList& _arguments);
+
+		/**
+		 * @brief Выполнить пакетный экспорт
+		 * @return Код завершения приложения
+		 */
+		static int exec(const QStringList& _arguments);
+
+	private:
+		/**
+		 * @brief Экспортировать проект в заданные форматы
+		 * @return false, если проект не удалось открыть или экспортировать хотя бы в один формат
+		 */
+		static bool exportProject(const QString& _projectPath, const QStringList& _formats,
+			const QString& _outputDir);
+	};
+}
+
+#endif // BATCHEXPORTER_H
@@ -77,6 +77,16 @@ void ImportManager::importScenario(BusinessLogic::ScenarioDocument* _scenario, i
 				importScenarioXml = BusinessLogic::DocumentImporter().importScenario(importParameters);
 			}
 
+			//
+			// Если файл не удалось прочитать, оставляем сценарий как есть
+			//
+			if (importScenarioXml.isEmpty()) {
+				progress.finish();
+				QLightBoxMessage::critical(m_importDialog, tr("Import error"),
+					tr("Can't read the file. It may be damaged."));
+				return;
+			}
+
 			//
 			// Загрузим импортируемый текст в сценарий
 			//
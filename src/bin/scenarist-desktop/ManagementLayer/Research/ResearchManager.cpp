@@ -272,6 +272,15 @@ void ResearchManager::editResearch(const QModelIndex& _index)
 					//
 					QList<QPixmap> images;
 					if (researchItem->hasChildren()) {
+						//
+						// ... распаковываем изображения разом, чтобы делать это параллельно
+						//
+						QList<EncodedImage> imagesData;
+						for (int childIndex = 0; childIndex < researchItem->childCount(); ++childIndex) {
+							imagesData.append(researchItem->childAt(childIndex)->research()->imageData());
+						}
+						EncodedImage::prepare(imagesData);
+
 						for (int childIndex = 0; childIndex < researchItem->childCount(); ++childIndex) {
 							images.append(researchItem->childAt(childIndex)->research()->image());
 						}
@@ -437,6 +437,7 @@ void ScenarioManager::aboutNavigatorSettingsUpdated()
 
 void ScenarioManager::aboutChronometrySettingsUpdated()
 {
+	BusinessLogic::ChronometerFacade::updateChronometer();
 	aboutRefreshDuration(m_textEditManager->cursorPosition());
 	m_textEditManager->reloadTextEditSettings();
 }
@@ -982,6 +983,9 @@ void ScenarioManager::initConnections()
 	connect(m_draftNavigatorManager, &ScenarioNavigatorManager::undoRequest, this, &ScenarioManager::aboutUndo);
 	connect(m_draftNavigatorManager, &ScenarioNavigatorManager::redoRequest, this, &ScenarioManager::aboutRedo);
 
+	connect(m_scenario, &ScenarioDocument::structureRebuildProgress, m_navigatorManager, &ScenarioNavigatorManager::setStructureRebuildProgress);
+	connect(m_scenarioDraft, &ScenarioDocument::structureRebuildProgress, m_draftNavigatorManager, &ScenarioNavigatorManager::setStructureRebuildProgress);
+
 	connect(m_sceneDescriptionManager, &ScenarioSceneDescriptionManager::titleChanged, this, &ScenarioManager::aboutUpdateCurrentSceneTitle);
 	connect(m_sceneDescriptionManager, &ScenarioSceneDescriptionManager::descriptionChanged, this, &ScenarioManager::aboutUpdateCurrentSceneDescription);
 
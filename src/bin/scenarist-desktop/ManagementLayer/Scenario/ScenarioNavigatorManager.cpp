@@ -113,6 +113,11 @@ void ScenarioNavigatorManager::setCommentOnly(bool _isCommentOnly)
 	m_navigator->setCommentOnly(_isCommentOnly);
 }
 
+void ScenarioNavigatorManager::setStructureRebuildProgress(int _progress)
+{
+	m_navigator->setStructureRebuildProgress(_progress);
+}
+
 void ScenarioNavigatorManager::aboutAddItem(const QModelIndex& _index)
 {
 	m_addItemDialog->clear();
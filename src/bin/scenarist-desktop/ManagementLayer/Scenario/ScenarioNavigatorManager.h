@@ -65,6 +65,11 @@ namespace ManagementLayer
 		 */
 		void setCommentOnly(bool _isCommentOnly);
 
+		/**
+		 * @brief Показать прогресс фонового построения структуры, в процентах
+		 */
+		void setStructureRebuildProgress(int _progress);
+
 	signals:
 		/**
 		 * @brief Запрос на добавление элемента
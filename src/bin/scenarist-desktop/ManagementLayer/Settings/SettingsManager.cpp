@@ -10,6 +10,7 @@
 
 #include <UserInterfaceLayer/Settings/SettingsView.h>
 
+#include <3rd_party/Helpers/BackupHelper.h>
 #include <3rd_party/Widgets/HierarchicalHeaderView/HierarchicalHeaderView.h>
 #include <3rd_party/Widgets/HierarchicalHeaderView/HierarchicalTableModel.h>
 #include <3rd_party/Widgets/SpellCheckTextEdit/SpellChecker.h>
@@ -124,6 +125,32 @@ void SettingsManager::setUseTwoPanelMode(bool _use)
 	m_view->setApplicationTwoPanelMode(_use);
 }
 
+void SettingsManager::updateBackupsInfo()
+{
+	const QString backupsFolder =
+			DataStorageLayer::StorageFacade::settingsStorage()->value(
+				"application/save-backups-folder",
+				DataStorageLayer::SettingsStorage::ApplicationSettings);
+	const qreal MEGABYTE = 1024 * 1024;
+	QString info =
+			tr("Backups use %1 MB of disk space.")
+			.arg(QString::number(BackupHelper::backupsSize(backupsFolder) / MEGABYTE, 'f', 1));
+
+	const BackupHelper::Statistics statistics = BackupHelper::lastStatistics();
+	if (statistics.datetime.isValid()) {
+		const qreal seconds = qMax(statistics.msecs, (qint64)1) / 1000.;
+		info.prepend(
+			tr("Last backup at %1: %2 MB of %3 MB written in %4 s (%5 MB/s). ")
+			.arg(statistics.datetime.toString("hh:mm:ss"))
+			.arg(QString::number(statistics.bytesWritten / MEGABYTE, 'f', 1))
+			.arg(QString::number(statistics.fileSize / MEGABYTE, 'f', 1))
+			.arg(QString::number(seconds, 'f', 1))
+			.arg(QString::number(statistics.fileSize / MEGABYTE / seconds, 'f', 1)));
+	}
+
+	m_view->setApplicationBackupsInfo(info);
+}
+
 void SettingsManager::aboutResetSettings()
 {
 	QLightBoxProgress progress(m_view);
@@ -135,12 +162,18 @@ void SettingsManager::aboutResetSettings()
 	//
 	DataStorageLayer::StorageFacade::settingsStorage()->resetValues(
 		DataStorageLayer::SettingsStorage::ApplicationSettings);
+	ScenarioTemplateFacade::updateCurrentTemplate();
 
 	//
 	// Перезагружаем интерфейс
 	//
 	initView();
 
+	//
+	// Хронометраж запоминает свои параметры, поэтому уведомляем о их смене
+	//
+	emit chronometrySettingsUpdated();
+
 	progress.close();
 }
 
@@ -411,6 +444,7 @@ void SettingsManager::scenarioEditFolderBackgroundColorDarkChanged(const QColor&
 void SettingsManager::scenarioEditCurrentTemplateChanged(const QString& _value)
 {
 	storeValue("scenario-editor/current-style", _value);
+	ScenarioTemplateFacade::updateCurrentTemplate();
 }
 
 void SettingsManager::scenarioEditAutoJumpToNextBlockChanged(bool _value)
@@ -739,6 +773,7 @@ void SettingsManager::initView()
 					"application/save-backups-folder",
 					DataStorageLayer::SettingsStorage::ApplicationSettings)
 				);
+	updateBackupsInfo();
 	m_view->setApplicationTwoPanelMode(
 				DataStorageLayer::StorageFacade::settingsStorage()->value(
 					"application/two-panel-mode",
@@ -27,6 +27,11 @@ namespace ManagementLayer
 		 */
 		void setUseTwoPanelMode(bool _use);
 
+		/**
+		 * @brief Обновить информацию о резервных копиях
+		 */
+		void updateBackupsInfo();
+
 	signals:
 		/**
 		 * @brief Обновления настроек
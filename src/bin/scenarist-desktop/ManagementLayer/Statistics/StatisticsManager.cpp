@@ -1,6 +1,7 @@
 #include "StatisticsManager.h"
 
 #include <BusinessLayer/ScenarioDocument/ScenarioTemplate.h>
+#include <BusinessLayer/Statistics/ScenarioSnapshot.h>
 #include <BusinessLayer/Statistics/StatisticsFacade.h>
 #include <BusinessLayer/Statistics/Reports/AbstractReport.h>
 
@@ -14,6 +15,7 @@
 #include <QEventLoop>
 #include <QStringListModel>
 #include <QTextDocument>
+#include <QtConcurrentRun>
 
 using BusinessLogic::ScenarioBlockStyle;
 using ManagementLayer::StatisticsManager;
@@ -84,41 +86,43 @@ void StatisticsManager::aboutMakeReport(const BusinessLogic::StatisticsParameter
 		emit needNewExportedScenario();
 	}
 
+	//
+	// Снимаем копию сценария, а сами отчёт и график формируем в фоне, не блокируя редактор
+	//
+	const BusinessLogic::ScenarioSnapshot scenario(m_exportedScenario);
 	switch (_parameters.type) {
 		case BusinessLogic::StatisticsParameters::Report: {
-			//
-			// Формируем отчёт
-			//
-			const QString reportHtml = BusinessLogic::StatisticsFacade::makeReport(m_exportedScenario, _parameters);
-
-			//
-			// Устанавливаем отчёт в форму
-			//
-			m_view->setReport(reportHtml);
-
+			m_reportWatcher.setFuture(
+				QtConcurrent::run(&BusinessLogic::StatisticsFacade::makeReport, scenario, _parameters));
 			break;
 		}
 
 		case BusinessLogic::StatisticsParameters::Plot: {
-			//
-			// Формируем данные
-			//
-			BusinessLogic::Plot plot = BusinessLogic::StatisticsFacade::makePlot(m_exportedScenario, _parameters);
-
-			//
-			// Рисуем график по данным
-			//
-			m_view->setPlot(plot);
-
+			m_plotWatcher.setFuture(
+				QtConcurrent::run(&BusinessLogic::StatisticsFacade::makePlot, scenario, _parameters));
 			break;
 		}
 	}
+}
 
+void StatisticsManager::aboutReportMade()
+{
+	//
+	// Устанавливаем отчёт в форму
+	//
+	m_view->setReport(m_reportWatcher.result());
 
+	hideProgressIfFinished();
+}
+
+void StatisticsManager::aboutPlotMade()
+{
 	//
-	// Закрываем уведомление
+	// Рисуем график по данным
 	//
-	m_view->hideProgress();
+	m_view->setPlot(m_plotWatcher.result());
+
+	hideProgressIfFinished();
 }
 
 void StatisticsManager::initView()
@@ -130,5 +134,19 @@ void StatisticsManager::initConnections()
 {
     connect(m_view, &StatisticsView::makeReport, this, &StatisticsManager::aboutMakeReport);
     connect(m_view, &StatisticsView::linkActivated, this, &StatisticsManager::linkActivated);
+
+    connect(&m_reportWatcher, &QFutureWatcherBase::finished, this, &StatisticsManager::aboutReportMade);
+    connect(&m_plotWatcher, &QFutureWatcherBase::finished, this, &StatisticsManager::aboutPlotMade);
+}
+
+void StatisticsManager::hideProgressIfFinished()
+{
+	if (!m_reportWatcher.isRunning()
+		&& !m_plotWatcher.isRunning()) {
+		//
+		// Закрываем уведомление
+		//
+		m_view->hideProgress();
+	}
 }
 
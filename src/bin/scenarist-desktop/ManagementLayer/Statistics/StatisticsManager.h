@@ -1,6 +1,9 @@
 #ifndef STATISTICSMANAGER_H
 #define STATISTICSMANAGER_H
 
+#include <BusinessLayer/Statistics/Plots/AbstractPlot.h>
+
+#include <QFutureWatcher>
 #include <QObject>
 
 class QTextDocument;
@@ -61,6 +64,16 @@ namespace ManagementLayer
 		 */
 		void aboutMakeReport(const BusinessLogic::StatisticsParameters& _parameters);
 
+		/**
+		 * @brief Отчёт сформирован в фоне
+		 */
+		void aboutReportMade();
+
+		/**
+		 * @brief График сформирован в фоне
+		 */
+		void aboutPlotMade();
+
 	private:
 		/**
 		 * @brief Настроить представление
@@ -72,6 +85,11 @@ namespace ManagementLayer
 		 */
 		void initConnections();
 
+		/**
+		 * @brief Скрыть уведомление о формировании, если больше ничего не формируется
+		 */
+		void hideProgressIfFinished();
+
 	private:
 		/**
 		 * @brief Представление для страницы со статистикой
@@ -87,6 +105,15 @@ namespace ManagementLayer
 		 * @brief Флаг обозначающий необходимость обновить текст сценария перед построением отчёта
 		 */
 		bool m_needUpdateScenario;
+
+		/**
+		 * @brief Наблюдатели за формированием отчёта и графика в фоне
+		 * @note Результаты предыдущих запусков, ещё не завершившихся к моменту нового, отбрасываются
+		 */
+		/** @{ */
+		QFutureWatcher<QString> m_reportWatcher;
+		QFutureWatcher<BusinessLogic::Plot> m_plotWatcher;
+		/** @} */
 	};
 }
 
@@ -17,8 +17,6 @@
 #include <3rd_party/Widgets/QLightBoxWidget/qlightboxprogress.h>
 #include <3rd_party/Helpers/PasswordStorage.h>
 
-#include <WebLoader.h>
-
 #include <QEventLoop>
 #include <QHash>
 #include <QNetworkConfigurationManager>
@@ -33,22 +31,37 @@ using DataStorageLayer::StorageFacade;
 using DataStorageLayer::SettingsStorage;
 
 namespace {
+	/**
+	 * @brief Получить ссылку для запроса к API
+	 * @note Адрес сервера можно заменить переменной окружения SCENARIST_API_URL,
+	 *		 например, чтобы проверить синхронизацию на локальном сервере
+	 */
+	static QUrl apiUrl(const QString& _path) {
+		QString baseUrl = QString::fromUtf8(qgetenv("SCENARIST_API_URL"));
+		if (baseUrl.isEmpty()) {
+			baseUrl = "https://kitscenarist.ru/api/";
+		} else if (!baseUrl.endsWith("/")) {
+			baseUrl.append("/");
+		}
+		return QUrl(baseUrl + _path);
+	}
+
 	/**
 	 * @brief Ссылки для запросов
 	 */
 	/** @{ */
-	const QUrl URL_LOGIN = QUrl("https://kitscenarist.ru/api/account/login/");
-	const QUrl URL_LOGOUT = QUrl("https://kitscenarist.ru/api/account/logout/");
-	const QUrl URL_PROJECTS = QUrl("https://kitscenarist.ru/api/projects/");
-
-	const QUrl URL_SCENARIO_CHANGE_LIST = QUrl("https://kitscenarist.ru/api/projects/scenario/change/list/");
-	const QUrl URL_SCENARIO_CHANGE_LOAD = QUrl("https://kitscenarist.ru/api/projects/scenario/change/");
-	const QUrl URL_SCENARIO_CHANGE_SAVE = QUrl("https://kitscenarist.ru/api/projects/scenario/change/save/");
-	const QUrl URL_SCENARIO_CURSORS = QUrl("https://kitscenarist.ru/api/projects/scenario/cursor/");
-
-	const QUrl URL_SCENARIO_DATA_LIST = QUrl("https://kitscenarist.ru/api/projects/data/list/");
-	const QUrl URL_SCENARIO_DATA_LOAD = QUrl("https://kitscenarist.ru/api/projects/data/");
-	const QUrl URL_SCENARIO_DATA_SAVE = QUrl("https://kitscenarist.ru/api/projects/data/save/");
+	const QUrl URL_LOGIN = apiUrl("account/login/");
+	const QUrl URL_LOGOUT = apiUrl("account/logout/");
+	const QUrl URL_PROJECTS = apiUrl("projects/");
+
+	const QUrl URL_SCENARIO_CHANGE_LIST = apiUrl("projects/scenario/change/list/");
+	const QUrl URL_SCENARIO_CHANGE_LOAD = apiUrl("projects/scenario/change/");
+	const QUrl URL_SCENARIO_CHANGE_SAVE = apiUrl("projects/scenario/change/save/");
+	const QUrl URL_SCENARIO_CURSORS = apiUrl("projects/scenario/cursor/");
+
+	const QUrl URL_SCENARIO_DATA_LIST = apiUrl("projects/data/list/");
+	const QUrl URL_SCENARIO_DATA_LOAD = apiUrl("projects/data/");
+	const QUrl URL_SCENARIO_DATA_SAVE = apiUrl("projects/data/save/");
 	/** @} */
 
 	/**
@@ -98,15 +111,278 @@ namespace {
 	 * @brief Код ошибки означающий работу в автономном режиме
 	 */
 	const int OFFLINE_ERROR_CODE = 0;
+
+	/**
+	 * @brief За сколько последних минут загружать изменения соавторов во время работы
+	 */
+	const int LAST_MINUTES = 2;
+
+	/**
+	 * @brief Время, в течение которого накапливаются фоновые запросы перед отправкой (мс)
+	 */
+	const int WORK_REQUESTS_DELAY = 300;
+
+	/**
+	 * @brief Интервал проверки соединения, удваивающийся с каждой неудачной проверкой (мс)
+	 */
+	/** @{ */
+	const int CHECK_CONNECTION_INTERVAL_MIN = 5000;
+	const int CHECK_CONNECTION_INTERVAL_MAX = 60000;
+	/** @} */
+
+	/**
+	 * @brief Типы фоновых запросов
+	 */
+	enum WorkRequestType {
+		ScenarioChangesUploadRequest,
+		ScenarioChangesListRequest,
+		ScenarioChangesLoadRequest,
+		ScenarioDataUploadRequest,
+		ScenarioDataListRequest,
+		ScenarioDataLoadRequest,
+		CursorsRequest
+	};
+
+	/**
+	 * @brief Является ли запрос отправкой изменений
+	 */
+	static bool isUploadRequest(int _type) {
+		return _type == ScenarioChangesUploadRequest
+				|| _type == ScenarioDataUploadRequest;
+	}
+
+	/**
+	 * @brief Пара из имени и значения атрибута запроса
+	 */
+	static QPair<QString, QVariant> attribute(const QString& _name, const QVariant& _value) {
+		return qMakePair(_name, _value);
+	}
+
+	/**
+	 * @brief Считать из ответа сервера список uuid'ов изменений
+	 * @return false, если сервер сообщил об ошибке
+	 */
+	static bool readChangesUuids(const QByteArray& _response, QList<QString>& _changesUuids) {
+		QXmlStreamReader changesReader(_response);
+		while (!changesReader.atEnd()) {
+			changesReader.readNext();
+			if (changesReader.name().toString() == "status") {
+				const bool success = changesReader.attributes().value("result").toString() == "true";
+				if (success) {
+					changesReader.readNextStartElement();
+					changesReader.readNextStartElement(); // changes
+					while (!changesReader.atEnd()) {
+						changesReader.readNextStartElement();
+						if (changesReader.name() == "change") {
+							const QString changeUuid = changesReader.attributes().value("id").toString();
+							if (!changeUuid.isEmpty()) {
+								_changesUuids.append(changeUuid);
+							}
+						}
+					}
+				} else {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Считать из ответа сервера данные изменений
+	 * @return false, если сервер сообщил об ошибке
+	 */
+	static bool readChanges(const QByteArray& _response, QList<QHash<QString, QString> >& _changes) {
+		QXmlStreamReader changesReader(_response);
+		while (!changesReader.atEnd()) {
+			changesReader.readNext();
+			if (changesReader.name().toString() == "status") {
+				const bool success = changesReader.attributes().value("result").toString() == "true";
+				if (success) {
+					changesReader.readNextStartElement();
+					while (!changesReader.atEnd()
+						   && changesReader.readNextStartElement()) {
+						//
+						// Изменения
+						//
+						while (changesReader.name() == "changes"
+							   && changesReader.readNextStartElement()) {
+							//
+							// Считываем каждое изменение
+							//
+							while (changesReader.name() == "change"
+								   && changesReader.readNextStartElement()) {
+								//
+								// Данные изменения
+								//
+								QHash<QString, QString> change;
+								while (changesReader.name() != "change") {
+									const QString key = changesReader.name().toString();
+									const QString value = changesReader.readElementText();
+									if (!value.isEmpty()) {
+										change.insert(key, value);
+									}
+
+									//
+									// ... переходим к следующему элементу
+									//
+									changesReader.readNextStartElement();
+								}
+
+								if (!change.isEmpty()) {
+									_changes.append(change);
+								}
+							}
+						}
+					}
+				} else {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Считать из ответа сервера позиции курсоров соавторов
+	 * @return false, если сервер сообщил об ошибке
+	 */
+	static bool readCursors(const QByteArray& _response, QMap<QString, int>& _cleanCursors,
+		QMap<QString, int>& _draftCursors) {
+		QXmlStreamReader cursorsReader(_response);
+		while (!cursorsReader.atEnd()) {
+			cursorsReader.readNext();
+			if (cursorsReader.name().toString() == "status") {
+				const bool success = cursorsReader.attributes().value("result").toString() == "true";
+				if (success) {
+					cursorsReader.readNextStartElement();
+					while (!cursorsReader.atEnd()
+						   && cursorsReader.readNextStartElement()) {
+						//
+						// Курсоры
+						//
+						while (cursorsReader.name() == "cursors"
+							   && cursorsReader.readNextStartElement()) {
+							//
+							// Считываем каждый курсор
+							//
+							while (cursorsReader.name() == "cursor") {
+								const QString username = cursorsReader.attributes().value("username").toString();
+								const int cursorPosition = cursorsReader.attributes().value("position").toInt();
+								const bool isDraft = cursorsReader.attributes().value("is_draft").toInt();
+
+								QMap<QString, int>& cursors = isDraft ? _draftCursors : _cleanCursors;
+								cursors.insert(username, cursorPosition);
+
+								//
+								// ... переход к следующему курсору
+								//
+								cursorsReader.readNextStartElement();
+								cursorsReader.readNextStartElement();
+							}
+						}
+					}
+				} else {
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Сформировать xml с изменениями сценария для отправки
+	 */
+	static QString scenarioChangesXml(const QList<QString>& _changesUuids) {
+		QString changesXml;
+		QXmlStreamWriter xmlWriter(&changesXml);
+		xmlWriter.writeStartDocument();
+		xmlWriter.writeStartElement("changes");
+		foreach (const QString& changeUuid, _changesUuids) {
+			const Domain::ScenarioChange change = StorageFacade::scenarioChangeStorage()->change(changeUuid);
+
+			xmlWriter.writeStartElement("change");
+
+			xmlWriter.writeTextElement(SCENARIO_CHANGE_ID, change.uuid().toString());
+
+			xmlWriter.writeTextElement(SCENARIO_CHANGE_DATETIME, change.datetime().toString("yyyy-MM-dd hh:mm:ss"));
+
+			xmlWriter.writeStartElement(SCENARIO_CHANGE_UNDO_PATCH);
+			xmlWriter.writeCDATA(change.undoPatch());
+			xmlWriter.writeEndElement();
+
+			xmlWriter.writeStartElement(SCENARIO_CHANGE_REDO_PATCH);
+			xmlWriter.writeCDATA(change.redoPatch());
+			xmlWriter.writeEndElement();
+
+			xmlWriter.writeTextElement(SCENARIO_CHANGE_IS_DRAFT, change.isDraft() ? "1" : "0");
+
+			xmlWriter.writeEndElement(); // change
+		}
+		xmlWriter.writeEndElement(); // changes
+		xmlWriter.writeEndDocument();
+		return changesXml;
+	}
+
+	/**
+	 * @brief Сформировать xml с изменениями данных для отправки
+	 */
+	static QString scenarioDataXml(const QList<QString>& _dataUuids) {
+		QString dataChangesXml;
+		QXmlStreamWriter xmlWriter(&dataChangesXml);
+		xmlWriter.writeStartDocument();
+		xmlWriter.writeStartElement("changes");
+		int order = 0;
+		foreach (const QString& dataUuid, _dataUuids) {
+			const QMap<QString, QString> historyRecord =
+					StorageFacade::databaseHistoryStorage()->historyRecord(dataUuid);
+
+			//
+			// NOTE: Вынесено на уровень AbstractMapper::executeSql
+			// Нас интересуют изменения из всех таблиц, кроме сценария и истории изменений сценария,
+			// они синхронизируются самостоятельно
+			//
+
+			xmlWriter.writeStartElement("change");
+			//
+			xmlWriter.writeTextElement(DBH_ID_KEY, historyRecord.value(DBH_ID_KEY));
+			//
+			xmlWriter.writeStartElement(DBH_QUERY_KEY);
+			xmlWriter.writeCDATA(historyRecord.value(DBH_QUERY_KEY));
+			xmlWriter.writeEndElement();
+			//
+			xmlWriter.writeStartElement(DBH_QUERY_VALUES_KEY);
+			xmlWriter.writeCDATA(historyRecord.value(DBH_QUERY_VALUES_KEY));
+			xmlWriter.writeEndElement();
+			//
+			xmlWriter.writeTextElement(DBH_DATETIME_KEY, historyRecord.value(DBH_DATETIME_KEY));
+			//
+			xmlWriter.writeTextElement(DBH_ORDER_KEY, QString::number(order++));
+			//
+			xmlWriter.writeEndElement(); // change
+		}
+		xmlWriter.writeEndElement(); // changes
+		xmlWriter.writeEndDocument();
+		return dataChangesXml;
+	}
 }
 
 
 SynchronizationManager::SynchronizationManager(QObject* _parent, QWidget* _parentView) :
 	QObject(_parent),
 	m_view(_parentView),
-	m_loader(new WebLoader(this)),
-	m_isInternetConnectionActive(true)
+	m_client(new WebClient(this)),
+	m_needLoadScenarioChanges(false),
+	m_needLoadScenarioData(false),
+	m_needUpdateCursors(false),
+	m_cursorPosition(0),
+	m_isCursorInDraft(false),
+	m_isInternetConnectionActive(true),
+	m_checkConnectionInterval(CHECK_CONNECTION_INTERVAL_MIN)
 {
+	m_workRequestsTimer.setSingleShot(true);
+	m_workRequestsTimer.setInterval(WORK_REQUESTS_DELAY);
+
 	initConnections();
 }
 
@@ -143,11 +419,10 @@ void SynchronizationManager::aboutLogin(const QString& _userName, const QString&
 	//
 	// Авторизуемся
 	//
-	m_loader->setRequestMethod(WebLoader::Post);
-	m_loader->clearRequestAttributes();
-	m_loader->addRequestAttribute(KEY_USER_NAME, _userName);
-	m_loader->addRequestAttribute(KEY_PASSWORD, _password);
-	QByteArray response = loadSyncWrapper(URL_LOGIN);
+	WebClient::Attributes attributes;
+	attributes.append(::attribute(KEY_USER_NAME, _userName));
+	attributes.append(::attribute(KEY_PASSWORD, _password));
+	QByteArray response = loadSyncWrapper(URL_LOGIN, attributes);
 
 	//
 	// Считываем результат авторизации
@@ -224,10 +499,9 @@ void SynchronizationManager::aboutLogout()
 	// Закрываем авторизацию
 	//
 	if (!m_sessionKey.isEmpty()) {
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		loadSyncWrapper(URL_LOGOUT);
+		WebClient::Attributes attributes;
+		attributes.append(::attribute(KEY_SESSION_KEY, m_sessionKey));
+		loadSyncWrapper(URL_LOGOUT, attributes);
 	}
 
 	//
@@ -267,10 +541,9 @@ void SynchronizationManager::aboutLoadProjects()
 		//
 		// Получаем список проектов
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		QByteArray response = loadSyncWrapper(URL_PROJECTS);
+		WebClient::Attributes attributes;
+		attributes.append(::attribute(KEY_SESSION_KEY, m_sessionKey));
+		QByteArray response = loadSyncWrapper(URL_PROJECTS, attributes);
 
 		//
 		// Считываем результат
@@ -334,38 +607,14 @@ void SynchronizationManager::aboutFullSyncScenario()
 		//
 		// Получить список патчей проекта
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_LIST);
+		QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_LIST, projectAttributes());
 
 		//
 		// ... считываем изменения (uuid)
 		//
 		QList<QString> remoteChanges;
-		QXmlStreamReader changesReader(response);
-		while (!changesReader.atEnd()) {
-			changesReader.readNext();
-			if (changesReader.name().toString() == "status") {
-				const bool success = changesReader.attributes().value("result").toString() == "true";
-				if (success) {
-					changesReader.readNextStartElement();
-					changesReader.readNextStartElement(); // changes
-					while (!changesReader.atEnd()) {
-						changesReader.readNextStartElement();
-						if (changesReader.name() == "change") {
-							const QString changeUuid = changesReader.attributes().value("id").toString();
-							if (!changeUuid.isEmpty()) {
-								remoteChanges.append(changeUuid);
-							}
-						}
-					}
-				} else {
-					handleError(response);
-					break;
-				}
-			}
+		if (!::readChangesUuids(response, remoteChanges)) {
+			handleError(response);
 		}
 
 
@@ -403,9 +652,12 @@ void SynchronizationManager::aboutFullSyncScenario()
 			QStringList changesForDownload;
 			foreach (const QString& changeUuid, remoteChanges) {
 				//
-				// ... сохранять нужно, если такого изменения нет в локальной БД
+				// ... сохранять нужно, если такого изменения нет в локальной БД,
+				//	   в том числе среди свёрнутых в снимок при сжатии истории
 				//
-				const bool needDownload = !localChanges.contains(changeUuid);
+				const bool needDownload =
+						!localChanges.contains(changeUuid)
+						&& !StorageFacade::scenarioChangeStorage()->contains(changeUuid);
 
 				if (needDownload) {
 					changesForDownload.append(changeUuid);
@@ -460,9 +712,8 @@ void SynchronizationManager::aboutFullSyncScenario()
 void SynchronizationManager::aboutWorkSyncScenario()
 {
 	if (isCanSync()) {
-
 		//
-		// Отправляем новые изменения
+		// Отправляем новые изменения, не дожидаясь ответа
 		//
 		{
 			//
@@ -472,169 +723,44 @@ void SynchronizationManager::aboutWorkSyncScenario()
 			m_lastChangesSyncDatetime = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
 
 			//
-			// Отправляем
+			// Отправляем, а если отправить не удастся, то время последней синхронизации
+			// будет восстановлено при обработке ошибки
 			//
-			QList<QString> newChanges =
+			const QList<QString> newChanges =
 					StorageFacade::scenarioChangeStorage()->newUuids(prevChangesSyncDatetime);
-			const bool changesUploaded = uploadScenarioChanges(newChanges);
-
-			//
-			// Не обновляем время последней синхронизации, если изменения не были отправлены
-			//
-			if (changesUploaded == false) {
-				m_lastChangesSyncDatetime = prevChangesSyncDatetime;
+			if (!newChanges.isEmpty()) {
+				WebClient::Attributes attributes = projectAttributes();
+				attributes.append(::attribute(KEY_CHANGES, ::scenarioChangesXml(newChanges)));
+				postWorkRequest(ScenarioChangesUploadRequest, URL_SCENARIO_CHANGE_SAVE, attributes,
+					prevChangesSyncDatetime);
 			}
 		}
 
 		//
-		// Загружаем и применяем изменения от других пользователей за последние LAST_MINUTES минут
+		// Изменения от других пользователей загрузим вместе с остальными фоновыми запросами
 		//
-		{
-			const int LAST_MINUTES = 2;
+		m_needLoadScenarioChanges = true;
+		if (!m_workRequestsTimer.isActive()) {
+			m_workRequestsTimer.start();
+		}
+	}
+}
 
-			m_loader->setRequestMethod(WebLoader::Post);
-			m_loader->clearRequestAttributes();
-			m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-			m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-			m_loader->addRequestAttribute(KEY_FROM_LAST_MINUTES, LAST_MINUTES);
-			QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_LIST);
+void SynchronizationManager::aboutUpdateCursors(int _cursorPosition, bool _isDraft)
+{
+	if (isCanSync()) {
+		//
+		// Запоминаем позицию, отправлена будет последняя из накопившихся
+		//
+		m_cursorPosition = _cursorPosition;
+		m_isCursorInDraft = _isDraft;
 
-			//
-			// ... считываем uuid'ы новых изменений
-			//
-			QList<QString> remoteChanges;
-			QXmlStreamReader changesReader(response);
-			while (!changesReader.atEnd()) {
-				changesReader.readNext();
-				if (changesReader.name().toString() == "status") {
-					const bool success = changesReader.attributes().value("result").toString() == "true";
-					if (success) {
-						changesReader.readNextStartElement();
-						changesReader.readNextStartElement(); // changes
-						while (!changesReader.atEnd()) {
-							changesReader.readNextStartElement();
-							if (changesReader.name() == "change") {
-								const QString changeUuid = changesReader.attributes().value("id").toString();
-								if (!changeUuid.isEmpty()) {
-									remoteChanges.append(changeUuid);
-								}
-							}
-						}
-					} else {
-						handleError(response);
-						break;
-					}
-				}
-			}
-
-			//
-			// ... скачиваем все изменения, которых ещё нет
-			//
-			QStringList changesForDownload;
-			foreach (const QString& changeUuid, remoteChanges) {
-				//
-				// ... сохранять нужно, если такого изменения нет
-				//
-				const bool needDownload =
-						!DataStorageLayer::StorageFacade::scenarioChangeStorage()->contains(changeUuid);
-
-				if (needDownload) {
-					changesForDownload.append(changeUuid);
-				}
-			}
-			//
-			// ... скачиваем
-			//
-			const QList<QHash<QString, QString> > changes = downloadScenarioChanges(changesForDownload.join(";"));
-			QHash<QString, QString> change;
-			foreach (change, changes) {
-				if (!change.isEmpty()) {
-					//
-					// ... сохраняем
-					//
-					StorageFacade::scenarioChangeStorage()->append(
-						change.value(SCENARIO_CHANGE_ID), change.value(SCENARIO_CHANGE_DATETIME),
-						change.value(SCENARIO_CHANGE_USERNAME), change.value(SCENARIO_CHANGE_UNDO_PATCH),
-						change.value(SCENARIO_CHANGE_REDO_PATCH), change.value(SCENARIO_CHANGE_IS_DRAFT).toInt());
-
-					//
-					// ... применяем
-					//
-					emit applyPatchRequested(change.value(SCENARIO_CHANGE_REDO_PATCH),
-											 change.value(SCENARIO_CHANGE_IS_DRAFT).toInt());
-				}
-			}
-		}
-	}
-}
-
-void SynchronizationManager::aboutUpdateCursors(int _cursorPosition, bool _isDraft)
-{
-	if (isCanSync()) {
-		//
-		// Загрузим позиции курсоров
-		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		m_loader->addRequestAttribute(KEY_CURSOR_POSITION, _cursorPosition);
-		m_loader->addRequestAttribute(KEY_SCENARIO_IS_DRAFT, _isDraft ? "1" : "0");
-		QByteArray response = loadSyncWrapper(URL_SCENARIO_CURSORS);
-
-
-		//
-		// ... считываем данные о курсорах
-		//
-		QMap<QString, int> cleanCursors;
-		QMap<QString, int> draftCursors;
-		QXmlStreamReader cursorsReader(response);
-		while (!cursorsReader.atEnd()) {
-			cursorsReader.readNext();
-			if (cursorsReader.name().toString() == "status") {
-				const bool success = cursorsReader.attributes().value("result").toString() == "true";
-				if (success) {
-					cursorsReader.readNextStartElement();
-					while (!cursorsReader.atEnd()
-						   && cursorsReader.readNextStartElement()) {
-						//
-						// Курсоры
-						//
-						while (cursorsReader.name() == "cursors"
-							   && cursorsReader.readNextStartElement()) {
-							//
-							// Считываем каждый курсор
-							//
-							while (cursorsReader.name() == "cursor") {
-								const QString username = cursorsReader.attributes().value("username").toString();
-								const int cursorPosition = cursorsReader.attributes().value("position").toInt();
-								const bool isDraft = cursorsReader.attributes().value("is_draft").toInt();
-
-								QMap<QString, int>& cursors = isDraft ? draftCursors : cleanCursors;
-								cursors.insert(username, cursorPosition);
-
-								//
-								// ... переход к следующему курсору
-								//
-								cursorsReader.readNextStartElement();
-								cursorsReader.readNextStartElement();
-							}
-						}
-					}
-				} else {
-					handleError(response);
-					break;
-				}
-			}
-		}
-
-		//
-		// Уведомляем об обновлении курсоров
-		//
-		emit cursorsUpdated(cleanCursors);
-		emit cursorsUpdated(draftCursors, IS_DRAFT);
-	}
-}
+		m_needUpdateCursors = true;
+		if (!m_workRequestsTimer.isActive()) {
+			m_workRequestsTimer.start();
+		}
+	}
+}
 
 void SynchronizationManager::aboutFullSyncData()
 {
@@ -648,37 +774,13 @@ void SynchronizationManager::aboutFullSyncData()
 		//
 		// Получить список всех изменений данных на сервере
 		//
-		WebLoader loader;
-		loader.setRequestMethod(WebLoader::Post);
-		loader.addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		loader.addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		QByteArray response = loader.loadSync(URL_SCENARIO_DATA_LIST);
+		QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_LIST, projectAttributes());
 		//
 		// ... считываем изменения (uuid)
 		//
 		QList<QString> remoteChanges;
-		QXmlStreamReader changesReader(response);
-		while (!changesReader.atEnd()) {
-			changesReader.readNext();
-			if (changesReader.name().toString() == "status") {
-				const bool success = changesReader.attributes().value("result").toString() == "true";
-				if (success) {
-					changesReader.readNextStartElement();
-					changesReader.readNextStartElement(); // changes
-					while (!changesReader.atEnd()) {
-						changesReader.readNextStartElement();
-						if (changesReader.name() == "change") {
-							const QString changeUuid = changesReader.attributes().value("id").toString();
-							if (!changeUuid.isEmpty()) {
-								remoteChanges.append(changeUuid);
-							}
-						}
-					}
-				} else {
-					handleError(response);
-					break;
-				}
-			}
+		if (!::readChangesUuids(response, remoteChanges)) {
+			handleError(response);
 		}
 
 		//
@@ -735,7 +837,7 @@ void SynchronizationManager::aboutWorkSyncData()
 {
 	if (isCanSync()) {
 		//
-		// Отправляем новые изменения
+		// Отправляем новые изменения, не дожидаясь ответа
 		//
 		{
 			//
@@ -745,85 +847,30 @@ void SynchronizationManager::aboutWorkSyncData()
 			m_lastDataSyncDatetime = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
 
 			//
-			// Отправляем
+			// Отправляем, а если отправить не удастся, то время последней синхронизации
+			// будет восстановлено при обработке ошибки
 			//
-			QList<QString> newChanges =
+			const QList<QString> newChanges =
 					StorageFacade::databaseHistoryStorage()->history(prevDataSyncDatetime);
-			const bool dataUploaded = uploadScenarioData(newChanges);
-
-			//
-			// Не обновляем время последней синхронизации, если данные не были отправлены
-			//
-			if (dataUploaded == false) {
-				m_lastDataSyncDatetime = prevDataSyncDatetime;
+			if (!newChanges.isEmpty()) {
+				WebClient::Attributes attributes = projectAttributes();
+				attributes.append(::attribute(KEY_CHANGES, ::scenarioDataXml(newChanges)));
+				postWorkRequest(ScenarioDataUploadRequest, URL_SCENARIO_DATA_SAVE, attributes,
+					prevDataSyncDatetime);
 			}
 		}
 
 		//
-		// Загружаем и применяем изменения от других пользователей за последние LAST_MINUTES минут
+		// Изменения от других пользователей загрузим вместе с остальными фоновыми запросами
 		//
-		{
-			const int LAST_MINUTES = 2;
-
-			m_loader->setRequestMethod(WebLoader::Post);
-			m_loader->clearRequestAttributes();
-			m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-			m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-			m_loader->addRequestAttribute(KEY_FROM_LAST_MINUTES, LAST_MINUTES);
-			QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_LIST);
-
-			//
-			// ... считываем uuid'ы новых изменений
-			//
-			QList<QString> remoteChanges;
-			QXmlStreamReader changesReader(response);
-			while (!changesReader.atEnd()) {
-				changesReader.readNext();
-				if (changesReader.name().toString() == "status") {
-					const bool success = changesReader.attributes().value("result").toString() == "true";
-					if (success) {
-						changesReader.readNextStartElement();
-						changesReader.readNextStartElement(); // changes
-						while (!changesReader.atEnd()) {
-							changesReader.readNextStartElement();
-							if (changesReader.name() == "change") {
-								const QString changeUuid = changesReader.attributes().value("id").toString();
-								if (!changeUuid.isEmpty()) {
-									remoteChanges.append(changeUuid);
-								}
-							}
-						}
-					} else {
-						handleError(response);
-						break;
-					}
-				}
-			}
-
-			//
-			// ... скачиваем все изменения, которых ещё нет
-			//
-			QStringList changesForDownload;
-			foreach (const QString& changeUuid, remoteChanges) {
-				//
-				// ... сохранять нужно, если такого изменения нет
-				//
-				const bool needDownload =
-						!DataStorageLayer::StorageFacade::databaseHistoryStorage()->contains(changeUuid);
-
-				if (needDownload) {
-					changesForDownload.append(changeUuid);
-				}
-			}
-			//
-			// ... скачиваем и сохраняем
-			//
-			downloadAndSaveScenarioData(changesForDownload.join(";"));
+		m_needLoadScenarioData = true;
+		if (!m_workRequestsTimer.isActive()) {
+			m_workRequestsTimer.start();
 		}
 	}
 }
 
-QByteArray SynchronizationManager::loadSyncWrapper(const QUrl& _url)
+QByteArray SynchronizationManager::loadSyncWrapper(const QUrl& _url, const WebClient::Attributes& _attributes)
 {
 	QByteArray response;
 
@@ -831,26 +878,30 @@ QByteArray SynchronizationManager::loadSyncWrapper(const QUrl& _url)
 	// Если соединение активно, делаем запрос
 	//
 	if (m_isInternetConnectionActive) {
-		response = m_loader->loadSync(_url);
+		response = m_client->postSync(_url, _attributes);
 
 		//
 		// Если пропало соединение с интернетом, уведомляем об этом и запускаем процесс проверки связи
 		//
 		if (response.isEmpty()) {
-			m_isInternetConnectionActive = false;
-
-			emit syncClosedWithError(OFFLINE_ERROR_CODE, tr("Can't estabilish network connection."));
-			emit cursorsUpdated(QMap<QString, int>());
-			emit cursorsUpdated(QMap<QString, int>(), IS_DRAFT);
-
-			checkInternetConnection();
+			handleNetworkError();
+		} else {
+			m_checkConnectionInterval = CHECK_CONNECTION_INTERVAL_MIN;
 		}
 	}
 
 	return response;
 }
 
-void SynchronizationManager::handleError(const QByteArray& _response)
+WebClient::Attributes SynchronizationManager::projectAttributes() const
+{
+	WebClient::Attributes attributes;
+	attributes.append(::attribute(KEY_SESSION_KEY, m_sessionKey));
+	attributes.append(::attribute(KEY_PROJECT, ProjectsManager::currentProject().id()));
+	return attributes;
+}
+
+void SynchronizationManager::handleError(const QByteArray& _response, const QString& _defaultErrorMessage)
 {
 	//
 	// Считываем ошибку
@@ -866,6 +917,9 @@ void SynchronizationManager::handleError(const QByteArray& _response)
 			break;
 		}
 	}
+	if (errorMessage.isEmpty()) {
+		errorMessage = _defaultErrorMessage;
+	}
 
 	//
 	// Закрываем сессию, если
@@ -892,6 +946,29 @@ void SynchronizationManager::handleError(const QByteArray& _response)
 	emit syncClosedWithError(errorCode, errorMessage);
 }
 
+void SynchronizationManager::handleNetworkError()
+{
+	//
+	// Об ошибке уведомляем один раз, даже если не удалось выполнить сразу несколько запросов
+	//
+	if (!m_isInternetConnectionActive) {
+		return;
+	}
+
+	m_isInternetConnectionActive = false;
+
+	emit syncClosedWithError(OFFLINE_ERROR_CODE, tr("Can't estabilish network connection."));
+	emit cursorsUpdated(QMap<QString, int>());
+	emit cursorsUpdated(QMap<QString, int>(), IS_DRAFT);
+
+	//
+	// Соединение проверяем не сразу, а каждый раз выжидая всё дольше,
+	// чтобы не нагружать недоступный сервер повторными попытками синхронизации
+	//
+	QTimer::singleShot(m_checkConnectionInterval, this, SLOT(checkInternetConnection()));
+	m_checkConnectionInterval = qMin(m_checkConnectionInterval * 2, CHECK_CONNECTION_INTERVAL_MAX);
+}
+
 bool SynchronizationManager::isCanSync() const
 {
 	return
@@ -907,46 +984,12 @@ bool SynchronizationManager::uploadScenarioChanges(const QList<QString>& _change
 
 	if (isCanSync()
 		&& !_changesUuids.isEmpty()) {
-		//
-		// Сформировать xml для отправки
-		//
-		QString changesXml;
-		QXmlStreamWriter xmlWriter(&changesXml);
-		xmlWriter.writeStartDocument();
-		xmlWriter.writeStartElement("changes");
-		foreach (const QString& changeUuid, _changesUuids) {
-			const ScenarioChange change = StorageFacade::scenarioChangeStorage()->change(changeUuid);
-
-			xmlWriter.writeStartElement("change");
-
-			xmlWriter.writeTextElement(SCENARIO_CHANGE_ID, change.uuid().toString());
-
-			xmlWriter.writeTextElement(SCENARIO_CHANGE_DATETIME, change.datetime().toString("yyyy-MM-dd hh:mm:ss"));
-
-			xmlWriter.writeStartElement(SCENARIO_CHANGE_UNDO_PATCH);
-			xmlWriter.writeCDATA(change.undoPatch());
-			xmlWriter.writeEndElement();
-
-			xmlWriter.writeStartElement(SCENARIO_CHANGE_REDO_PATCH);
-			xmlWriter.writeCDATA(change.redoPatch());
-			xmlWriter.writeEndElement();
-
-			xmlWriter.writeTextElement(SCENARIO_CHANGE_IS_DRAFT, change.isDraft() ? "1" : "0");
-
-			xmlWriter.writeEndElement(); // change
-		}
-		xmlWriter.writeEndElement(); // changes
-		xmlWriter.writeEndDocument();
-
 		//
 		// Отправить данные
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		m_loader->addRequestAttribute(KEY_CHANGES, changesXml);
-		const QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_SAVE);
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_CHANGES, ::scenarioChangesXml(_changesUuids)));
+		const QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_SAVE, attributes);
 
 		//
 		// Изменения отправлены, если сервер это подтвердил
@@ -966,64 +1009,15 @@ QList<QHash<QString, QString> > SynchronizationManager::downloadScenarioChanges(
 		//
 		// ... загружаем изменения
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		m_loader->addRequestAttribute(KEY_CHANGES_IDS, _changesUuids);
-		QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_LOAD);
-
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_CHANGES_IDS, _changesUuids));
+		QByteArray response = loadSyncWrapper(URL_SCENARIO_CHANGE_LOAD, attributes);
 
 		//
 		// ... считываем данные об изменениях
 		//
-		QXmlStreamReader changesReader(response);
-		while (!changesReader.atEnd()) {
-			changesReader.readNext();
-			if (changesReader.name().toString() == "status") {
-				const bool success = changesReader.attributes().value("result").toString() == "true";
-				if (success) {
-					changesReader.readNextStartElement();
-					while (!changesReader.atEnd()
-						   && changesReader.readNextStartElement()) {
-						//
-						// Изменения
-						//
-						while (changesReader.name() == "changes"
-							   && changesReader.readNextStartElement()) {
-							//
-							// Считываем каждое изменение
-							//
-							while (changesReader.name() == "change"
-								   && changesReader.readNextStartElement()) {
-								//
-								// Данные изменения
-								//
-								QHash<QString, QString> change;
-								while (changesReader.name() != "change") {
-									const QString key = changesReader.name().toString();
-									const QString value = changesReader.readElementText();
-									if (!value.isEmpty()) {
-										change.insert(key, value);
-									}
-
-									//
-									// ... переходим к следующему элементу
-									//
-									changesReader.readNextStartElement();
-								}
-
-								if (!change.isEmpty()) {
-									changes.append(change);
-								}
-							}
-						}
-					}
-				} else {
-					handleError(response);
-					break;
-				}
-			}
+		if (!::readChanges(response, changes)) {
+			handleError(response);
 		}
 	}
 
@@ -1036,57 +1030,12 @@ bool SynchronizationManager::uploadScenarioData(const QList<QString>& _dataUuids
 
 	if (isCanSync()
 		&& !_dataUuids.isEmpty()) {
-		//
-		// Сформировать xml для отправки
-		//
-		QString dataChangesXml;
-		QXmlStreamWriter xmlWriter(&dataChangesXml);
-		xmlWriter.writeStartDocument();
-		xmlWriter.writeStartElement("changes");
-		int order = 0;
-		foreach (const QString& dataUuid, _dataUuids) {
-			const QMap<QString, QString> historyRecord =
-					StorageFacade::databaseHistoryStorage()->historyRecord(dataUuid);
-
-			//
-			// NOTE: Вынесено на уровень AbstractMapper::executeSql
-			// Нас интересуют изменения из всех таблиц, кроме сценария и истории изменений сценария,
-			// они синхронизируются самостоятельно
-			//
-
-			xmlWriter.writeStartElement("change");
-			//
-			xmlWriter.writeTextElement(DBH_ID_KEY, historyRecord.value(DBH_ID_KEY));
-			//
-			xmlWriter.writeStartElement(DBH_QUERY_KEY);
-			xmlWriter.writeCDATA(historyRecord.value(DBH_QUERY_KEY));
-			xmlWriter.writeEndElement();
-			//
-			xmlWriter.writeStartElement(DBH_QUERY_VALUES_KEY);
-			xmlWriter.writeCDATA(historyRecord.value(DBH_QUERY_VALUES_KEY));
-			xmlWriter.writeEndElement();
-			//
-			xmlWriter.writeTextElement(DBH_DATETIME_KEY, historyRecord.value(DBH_DATETIME_KEY));
-			//
-			xmlWriter.writeTextElement(DBH_ORDER_KEY, QString::number(order++));
-			//
-			xmlWriter.writeEndElement(); // change
-		}
-		xmlWriter.writeEndElement(); // changes
-		xmlWriter.writeEndDocument();
-
 		//
 		// Отправить данные
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		m_loader->addRequestAttribute(KEY_CHANGES, dataChangesXml);
-		//
-		// NOTE: При отправке большого объёма данных возможно зависание
-		//
-		const QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_SAVE);
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_CHANGES, ::scenarioDataXml(_dataUuids)));
+		const QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_SAVE, attributes);
 
 		//
 		// Данные отправлены, если сервер это подтвердил
@@ -1105,85 +1054,278 @@ void SynchronizationManager::downloadAndSaveScenarioData(const QString& _dataUui
 		//
 		// ... загружаем изменения
 		//
-		m_loader->setRequestMethod(WebLoader::Post);
-		m_loader->clearRequestAttributes();
-		m_loader->addRequestAttribute(KEY_SESSION_KEY, m_sessionKey);
-		m_loader->addRequestAttribute(KEY_PROJECT, ProjectsManager::currentProject().id());
-		m_loader->addRequestAttribute(KEY_CHANGES_IDS, _dataUuids);
-		QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_LOAD);
-
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_CHANGES_IDS, _dataUuids));
+		QByteArray response = loadSyncWrapper(URL_SCENARIO_DATA_LOAD, attributes);
 
 		//
 		// ... считываем данные об изменениях
 		//
 		QList<QHash<QString, QString> > changes;
-		QXmlStreamReader changesReader(response);
-		while (!changesReader.atEnd()) {
-			changesReader.readNext();
-			if (changesReader.name().toString() == "status") {
-				const bool success = changesReader.attributes().value("result").toString() == "true";
-				if (success) {
-					changesReader.readNextStartElement();
-					while (!changesReader.atEnd()
-						   && changesReader.readNextStartElement()) {
+		if (!::readChanges(response, changes)) {
+			handleError(response);
+		}
+
+		//
+		// ... и сохраняем их
+		//
+		saveScenarioData(changes);
+	}
+}
+
+void SynchronizationManager::saveScenarioData(const QList<QHash<QString, QString> >& _changes)
+{
+	if (_changes.isEmpty()) {
+		return;
+	}
+
+	//
+	// Применяем изменения
+	//
+	QHash<QString, QString> changeValues;
+	DatabaseLayer::Database::transaction();
+	foreach (changeValues, _changes) {
+		DataStorageLayer::StorageFacade::databaseHistoryStorage()->storeAndApplyHistoryRecord(
+			changeValues.value(DBH_ID_KEY), changeValues.value(DBH_QUERY_KEY),
+			changeValues.value(DBH_QUERY_VALUES_KEY), changeValues.value(DBH_DATETIME_KEY));
+	}
+	DatabaseLayer::Database::commit();
+
+
+	//
+	// Обновляем данные
+	//
+	DataStorageLayer::StorageFacade::refreshStorages();
+}
+
+void SynchronizationManager::postWorkRequest(int _type, const QUrl& _url, const WebClient::Attributes& _attributes,
+	const QString& _prevSyncDatetime)
+{
+	WorkRequest request;
+	request.type = _type;
+	request.projectId = ProjectsManager::currentProject().id();
+	request.prevSyncDatetime = _prevSyncDatetime;
+	m_workRequests.insert(m_client->post(_url, _attributes), request);
+}
+
+bool SynchronizationManager::takeFailedWorkRequest(int _requestId)
+{
+	if (!m_workRequests.contains(_requestId)) {
+		return false;
+	}
+
+	const WorkRequest request = m_workRequests.take(_requestId);
+
+	//
+	// Если не удалось отправить изменения, то возвращаем время последней синхронизации,
+	// чтобы отправить их повторно вместе со следующими
+	//
+	if (request.projectId == ProjectsManager::currentProject().id()) {
+		if (request.type == ScenarioChangesUploadRequest) {
+			m_lastChangesSyncDatetime = qMin(m_lastChangesSyncDatetime, request.prevSyncDatetime);
+		} else if (request.type == ScenarioDataUploadRequest) {
+			m_lastDataSyncDatetime = qMin(m_lastDataSyncDatetime, request.prevSyncDatetime);
+		}
+	}
+
+	return true;
+}
+
+void SynchronizationManager::sendWorkRequests()
+{
+	if (!isCanSync()) {
+		return;
+	}
+
+	//
+	// Пока не пришли ответы на предыдущие запросы загрузки, новые не отправляем,
+	// они будут отправлены после получения ответов
+	//
+	foreach (const WorkRequest& request, m_workRequests) {
+		if (!::isUploadRequest(request.type)) {
+			return;
+		}
+	}
+
+	//
+	// Все накопившиеся запросы отправляются разом и выполняются параллельно
+	//
+	if (m_needLoadScenarioChanges) {
+		m_needLoadScenarioChanges = false;
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_FROM_LAST_MINUTES, LAST_MINUTES));
+		postWorkRequest(ScenarioChangesListRequest, URL_SCENARIO_CHANGE_LIST, attributes);
+	}
+	if (m_needLoadScenarioData) {
+		m_needLoadScenarioData = false;
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_FROM_LAST_MINUTES, LAST_MINUTES));
+		postWorkRequest(ScenarioDataListRequest, URL_SCENARIO_DATA_LIST, attributes);
+	}
+	if (m_needUpdateCursors) {
+		m_needUpdateCursors = false;
+		WebClient::Attributes attributes = projectAttributes();
+		attributes.append(::attribute(KEY_CURSOR_POSITION, m_cursorPosition));
+		attributes.append(::attribute(KEY_SCENARIO_IS_DRAFT, m_isCursorInDraft ? "1" : "0"));
+		postWorkRequest(CursorsRequest, URL_SCENARIO_CURSORS, attributes);
+	}
+}
+
+void SynchronizationManager::aboutWorkRequestFinished(int _requestId, const QByteArray& _response)
+{
+	if (!m_workRequests.contains(_requestId)) {
+		return;
+	}
+
+	//
+	// Изменения отправлены, только если сервер это подтвердил
+	//
+	if (_response.isEmpty()
+		&& ::isUploadRequest(m_workRequests.value(_requestId).type)) {
+		aboutWorkRequestFailed(_requestId);
+		return;
+	}
+
+	const WorkRequest request = m_workRequests.take(_requestId);
+	m_checkConnectionInterval = CHECK_CONNECTION_INTERVAL_MIN;
+
+	//
+	// Ответы по проекту, который уже закрыт, не обрабатываем
+	//
+	if (isCanSync()
+		&& request.projectId == ProjectsManager::currentProject().id()) {
+		switch (request.type) {
+			//
+			// Загружаем изменения, которых ещё нет
+			//
+			case ScenarioChangesListRequest:
+			case ScenarioDataListRequest: {
+				QList<QString> remoteChanges;
+				if (!::readChangesUuids(_response, remoteChanges)) {
+					handleError(_response);
+					break;
+				}
+
+				const bool isScenarioChanges = request.type == ScenarioChangesListRequest;
+				QStringList changesForDownload;
+				foreach (const QString& changeUuid, remoteChanges) {
+					//
+					// ... загружать нужно, если такого изменения нет
+					//
+					const bool needDownload =
+							isScenarioChanges
+							? !StorageFacade::scenarioChangeStorage()->contains(changeUuid)
+							: !StorageFacade::databaseHistoryStorage()->contains(changeUuid);
+
+					if (needDownload) {
+						changesForDownload.append(changeUuid);
+					}
+				}
+
+				if (!changesForDownload.isEmpty()) {
+					WebClient::Attributes attributes = projectAttributes();
+					attributes.append(::attribute(KEY_CHANGES_IDS, changesForDownload.join(";")));
+					if (isScenarioChanges) {
+						postWorkRequest(ScenarioChangesLoadRequest, URL_SCENARIO_CHANGE_LOAD, attributes);
+					} else {
+						postWorkRequest(ScenarioDataLoadRequest, URL_SCENARIO_DATA_LOAD, attributes);
+					}
+				}
+				break;
+			}
+
+			//
+			// Сохраняем и применяем изменения сценария
+			//
+			case ScenarioChangesLoadRequest: {
+				QList<QHash<QString, QString> > changes;
+				if (!::readChanges(_response, changes)) {
+					handleError(_response);
+					break;
+				}
+
+				QHash<QString, QString> change;
+				foreach (change, changes) {
+					if (!change.isEmpty()
+						&& !StorageFacade::scenarioChangeStorage()->contains(change.value(SCENARIO_CHANGE_ID))) {
 						//
-						// Изменения
+						// ... сохраняем
 						//
-						while (changesReader.name() == "changes"
-							   && changesReader.readNextStartElement()) {
-							//
-							// Считываем каждое изменение
-							//
-							while (changesReader.name() == "change"
-								   && changesReader.readNextStartElement()) {
-								//
-								// Данные изменения
-								//
-								QHash<QString, QString> change;
-								while (changesReader.name() != "change") {
-									const QString key = changesReader.name().toString();
-									const QString value = changesReader.readElementText();
-									if (!value.isEmpty()) {
-										change.insert(key, value);
-									}
+						StorageFacade::scenarioChangeStorage()->append(
+							change.value(SCENARIO_CHANGE_ID), change.value(SCENARIO_CHANGE_DATETIME),
+							change.value(SCENARIO_CHANGE_USERNAME), change.value(SCENARIO_CHANGE_UNDO_PATCH),
+							change.value(SCENARIO_CHANGE_REDO_PATCH), change.value(SCENARIO_CHANGE_IS_DRAFT).toInt());
 
-									//
-									// ... переходим к следующему элементу
-									//
-									changesReader.readNextStartElement();
-								}
-
-								if (!change.isEmpty()) {
-									changes.append(change);
-								}
-							}
-						}
+						//
+						// ... применяем
+						//
+						emit applyPatchRequested(change.value(SCENARIO_CHANGE_REDO_PATCH),
+												 change.value(SCENARIO_CHANGE_IS_DRAFT).toInt());
 					}
-				} else {
-					handleError(response);
+				}
+				break;
+			}
+
+			//
+			// Сохраняем изменения данных
+			//
+			case ScenarioDataLoadRequest: {
+				QList<QHash<QString, QString> > changes;
+				if (!::readChanges(_response, changes)) {
+					handleError(_response);
 					break;
 				}
+
+				saveScenarioData(changes);
+				break;
 			}
-		}
 
+			//
+			// Уведомляем об обновлении курсоров
+			//
+			case CursorsRequest: {
+				QMap<QString, int> cleanCursors;
+				QMap<QString, int> draftCursors;
+				if (!::readCursors(_response, cleanCursors, draftCursors)) {
+					handleError(_response);
+					break;
+				}
 
-		//
-		// Применяем изменения
-		//
-		QHash<QString, QString> changeValues;
-		DatabaseLayer::Database::transaction();
-		foreach (changeValues, changes) {
-			DataStorageLayer::StorageFacade::databaseHistoryStorage()->storeAndApplyHistoryRecord(
-				changeValues.value(DBH_ID_KEY), changeValues.value(DBH_QUERY_KEY),
-				changeValues.value(DBH_QUERY_VALUES_KEY), changeValues.value(DBH_DATETIME_KEY));
+				emit cursorsUpdated(cleanCursors);
+				emit cursorsUpdated(draftCursors, IS_DRAFT);
+				break;
+			}
+
+			default: {
+				break;
+			}
 		}
-		DatabaseLayer::Database::commit();
+	}
+
+	//
+	// Если пока ждали ответ накопились новые запросы, отправляем их
+	//
+	if ((m_needLoadScenarioChanges || m_needLoadScenarioData || m_needUpdateCursors)
+		&& !m_workRequestsTimer.isActive()) {
+		m_workRequestsTimer.start();
+	}
+}
 
+void SynchronizationManager::aboutWorkRequestFailed(int _requestId)
+{
+	if (takeFailedWorkRequest(_requestId)) {
+		handleNetworkError();
+	}
+}
 
-		//
-		// Обновляем данные
-		//
-		DataStorageLayer::StorageFacade::refreshStorages();
+void SynchronizationManager::aboutWorkRequestServerError(int _requestId, const QString& _error,
+	const QByteArray& _response)
+{
+	//
+	// Сервер доступен, поэтому в автономный режим не переходим, а сообщаем об ошибке от сервера
+	//
+	if (takeFailedWorkRequest(_requestId)) {
+		handleError(_response, _error);
 	}
 }
 
@@ -1195,13 +1337,20 @@ void SynchronizationManager::checkInternetConnection()
 		emit syncRestarted();
 	} else {
 		s_networkConfigurationManager.updateConfigurations();
-		QTimer::singleShot(5000, this, SLOT(checkInternetConnection()));
+		QTimer::singleShot(m_checkConnectionInterval, this, SLOT(checkInternetConnection()));
+		m_checkConnectionInterval = qMin(m_checkConnectionInterval * 2, CHECK_CONNECTION_INTERVAL_MAX);
 	}
 }
 
 void SynchronizationManager::initConnections()
 {
 	connect(this, SIGNAL(loginAccepted()), this, SLOT(aboutLoadProjects()));
+
+	connect(&m_workRequestsTimer, SIGNAL(timeout()), this, SLOT(sendWorkRequests()));
+	connect(m_client, SIGNAL(finished(int,QByteArray)), this, SLOT(aboutWorkRequestFinished(int,QByteArray)));
+	connect(m_client, SIGNAL(failed(int,QString)), this, SLOT(aboutWorkRequestFailed(int)));
+	connect(m_client, SIGNAL(serverError(int,QString,QByteArray)),
+		this, SLOT(aboutWorkRequestServerError(int,QString,QByteArray)));
 }
 
 void SynchronizationManager::sleepALittle()
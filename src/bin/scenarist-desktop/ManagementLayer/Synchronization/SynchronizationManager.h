@@ -3,15 +3,15 @@
 
 #include <QObject>
 #include <QHash>
+#include <QTimer>
+
+#include <WebClient.h>
 
 namespace Domain {
 	class Scenario;
 	class ScenarioChange;
 }
 
-class QTimer;
-class WebLoader;
-
 
 namespace ManagementLayer
 {
@@ -53,11 +53,13 @@ namespace ManagementLayer
 
 		/**
 		 * @brief Синхронизация сценария во время работы над ним
+		 * @note Новые изменения отправляются сразу, а изменения соавторов загружаются в фоне
 		 */
 		void aboutWorkSyncScenario();
 
 		/**
 		 * @brief Загрузить информацию о курсорах соавторов и отправить информацию о своём
+		 * @note Выполняется в фоне, частые перемещения курсора объединяются в один запрос
 		 */
 		void aboutUpdateCursors(int _cursorPosition, bool _isDraft);
 
@@ -68,6 +70,7 @@ namespace ManagementLayer
 
 		/**
 		 * @brief Синхронизация данных во время работы
+		 * @note Новые изменения отправляются сразу, а изменения соавторов загружаются в фоне
 		 */
 		void aboutWorkSyncData();
 
@@ -112,14 +115,25 @@ namespace ManagementLayer
 
 	private:
 		/**
-		 * @brief Обёртка для вызова функции m_loader->loadSync, отлавливающая отсутствие интернета
+		 * @brief Обёртка для вызова функции m_client->postSync, отлавливающая отсутствие интернета
+		 */
+		QByteArray loadSyncWrapper(const QUrl& _url, const WebClient::Attributes& _attributes);
+
+		/**
+		 * @brief Атрибуты запроса, общие для всех запросов по текущему проекту
 		 */
-		QByteArray loadSyncWrapper(const QUrl& _url);
+		WebClient::Attributes projectAttributes() const;
 
 		/**
 		 * @brief Обработать ошибку работы с API
+		 * @param _defaultErrorMessage - текст ошибки, если в ответе его нет
+		 */
+		void handleError(const QByteArray& _response, const QString& _defaultErrorMessage = QString());
+
+		/**
+		 * @brief Обработать пропажу соединения с интернетом
 		 */
-		void handleError(const QByteArray& _response);
+		void handleNetworkError();
 
 		/**
 		 * @brief Возможно ли использовать методы синхронизации
@@ -148,7 +162,45 @@ namespace ManagementLayer
 		 */
 		void downloadAndSaveScenarioData(const QString& _dataUuids);
 
+		/**
+		 * @brief Сохранить в БД изменения данных, скачанные с сервера
+		 */
+		void saveScenarioData(const QList<QHash<QString, QString> >& _changes);
+
+		/**
+		 * @brief Отправить фоновый запрос синхронизации во время работы
+		 */
+		void postWorkRequest(int _type, const QUrl& _url, const WebClient::Attributes& _attributes,
+			const QString& _prevSyncDatetime = QString::null);
+
+		/**
+		 * @brief Забыть невыполненный фоновый запрос, вернув время синхронизации неотправленных изменений
+		 * @return false, если такой запрос не отправлялся
+		 */
+		bool takeFailedWorkRequest(int _requestId);
+
 	private slots:
+		/**
+		 * @brief Отправить накопившиеся фоновые запросы загрузки изменений соавторов и курсоров
+		 * @note Все запросы отправляются разом и выполняются параллельно
+		 */
+		void sendWorkRequests();
+
+		/**
+		 * @brief Получен ответ на фоновый запрос
+		 */
+		void aboutWorkRequestFinished(int _requestId, const QByteArray& _response);
+
+		/**
+		 * @brief Фоновый запрос выполнить не удалось из-за проблем со связью
+		 */
+		void aboutWorkRequestFailed(int _requestId);
+
+		/**
+		 * @brief Сервер ответил на фоновый запрос ошибкой
+		 */
+		void aboutWorkRequestServerError(int _requestId, const QString& _error, const QByteArray& _response);
+
 		/**
 		 * @brief Проверить соединение с интернетом
 		 */
@@ -173,9 +225,62 @@ namespace ManagementLayer
 		QWidget* m_view;
 
 		/**
-		 * @brief Загрузчик данных
+		 * @brief Клиент для запросов к серверу
 		 */
-		WebLoader* m_loader;
+		WebClient* m_client;
+
+		/**
+		 * @brief Фоновый запрос, ожидающий ответа
+		 */
+		struct WorkRequest {
+			/**
+			 * @brief Тип запроса
+			 */
+			int type;
+
+			/**
+			 * @brief Проект, к которому относится запрос
+			 */
+			int projectId;
+
+			/**
+			 * @brief Время предыдущей синхронизации, восстанавливаемое, если отправить изменения не удалось
+			 */
+			QString prevSyncDatetime;
+		};
+
+		/**
+		 * @brief Фоновые запросы, ожидающие ответа, по идентификаторам
+		 */
+		QHash<int, WorkRequest> m_workRequests;
+
+		/**
+		 * @brief Таймер, объединяющий частые фоновые запросы в одну отправку
+		 */
+		QTimer m_workRequestsTimer;
+
+		/**
+		 * @brief Нужно ли загрузить изменения сценария от соавторов
+		 */
+		bool m_needLoadScenarioChanges;
+
+		/**
+		 * @brief Нужно ли загрузить изменения данных от соавторов
+		 */
+		bool m_needLoadScenarioData;
+
+		/**
+		 * @brief Нужно ли обновить курсоры
+		 */
+		bool m_needUpdateCursors;
+
+		/**
+		 * @brief Последняя позиция курсора, которую нужно отправить
+		 */
+		/** @{ */
+		int m_cursorPosition;
+		bool m_isCursorInDraft;
+		/** @} */
 
 		/**
 		 * @brief Ключ сессии
@@ -196,6 +301,11 @@ namespace ManagementLayer
 		 * @brief Активно ли соединение с интернетом
 		 */
 		bool m_isInternetConnectionActive;
+
+		/**
+		 * @brief Интервал проверки соединения с интернетом, растёт, пока соединения нет (мс)
+		 */
+		int m_checkConnectionInterval;
 	};
 }
 
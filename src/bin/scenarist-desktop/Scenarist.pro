@@ -89,6 +89,8 @@ SOURCES += main.cpp \
     BusinessLayer/Chronometry/ChronometerFacade.cpp \
     BusinessLayer/Chronometry/ConfigurableChronometer.cpp \
     DataLayer/Database/Database.cpp \
+    DataLayer/Database/DatabaseHistoryWriter.cpp \
+    DataLayer/Database/ScenarioChangesCompactor.cpp \
     DataLayer/DataMappingLayer/AbstractMapper.cpp \
     DataLayer/DataMappingLayer/CharacterMapper.cpp \
     DataLayer/DataMappingLayer/LocationMapper.cpp \
@@ -139,6 +141,7 @@ SOURCES += main.cpp \
     BusinessLayer/Export/PdfExporter.cpp \
     BusinessLayer/ScenarioDocument/ScenarioXml.cpp \
     BusinessLayer/ScenarioDocument/ScenarioTextDocument.cpp \
+    BusinessLayer/ScenarioDocument/ScenarioBlocksChange.cpp \
     UserInterfaceLayer/StartUp/StartUpView.cpp \
     UserInterfaceLayer/StartUp/RecentFilesDelegate.cpp \
     UserInterfaceLayer/StartUp/RecentFileWidget.cpp \
@@ -176,6 +179,7 @@ SOURCES += main.cpp \
     3rd_party/Widgets/PagesTextEdit/PageMetrics.cpp \
     UserInterfaceLayer/Scenario/ScenarioNavigator/ScenarioNavigatorProxyStyle.cpp \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/Handlers/SceneCharactersHandler.cpp \
+    ManagementLayer/Export/BatchExporter.cpp \
     ManagementLayer/Export/ExportManager.cpp \
     UserInterfaceLayer/Export/ExportDialog.cpp \
     Domain/CharacterState.cpp \
@@ -194,6 +198,7 @@ SOURCES += main.cpp \
     3rd_party/Widgets/AcceptebleLineEdit/AcceptebleLineEdit.cpp \
     3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.cpp \
     3rd_party/Helpers/BackupHelper.cpp \
+    3rd_party/Helpers/EncodedImage.cpp \
     3rd_party/Widgets/HierarchicalHeaderView/HierarchicalHeaderView.cpp \
     3rd_party/Widgets/HierarchicalHeaderView/HierarchicalTableModel.cpp \
     3rd_party/Widgets/FlatButton/FlatButton.cpp \
@@ -221,6 +226,9 @@ SOURCES += main.cpp \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/Handlers/NoprintableTextHandler.cpp \
     3rd_party/Widgets/ToolTipLabel/ToolTipLabel.cpp \
     BusinessLayer/ScenarioDocument/ScenarioReviewModel.cpp \
+    BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.cpp \
+    BusinessLayer/ScenarioDocument/ScenarioStructureParser.cpp \
+    BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.cpp \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewPanel.cpp \
     3rd_party/Widgets/ColoredToolButton/ColoredToolButton.cpp \
     3rd_party/Widgets/ColoredToolButton/GoogleColorsPane.cpp \
@@ -332,6 +340,7 @@ HEADERS += \
     BusinessLayer/Export/PdfExporter.h \
     BusinessLayer/ScenarioDocument/ScenarioXml.h \
     BusinessLayer/ScenarioDocument/ScenarioTextDocument.h \
+    BusinessLayer/ScenarioDocument/ScenarioBlocksChange.h \
     UserInterfaceLayer/StartUp/StartUpView.h \
     UserInterfaceLayer/StartUp/RecentFilesDelegate.h \
     UserInterfaceLayer/StartUp/RecentFileWidget.h \
@@ -370,6 +379,7 @@ HEADERS += \
     3rd_party/Helpers/TextEditHelper.h \
     UserInterfaceLayer/Scenario/ScenarioNavigator/ScenarioNavigatorProxyStyle.h \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/Handlers/SceneCharactersHandler.h \
+    ManagementLayer/Export/BatchExporter.h \
     ManagementLayer/Export/ExportManager.h \
     UserInterfaceLayer/Export/ExportDialog.h \
     Domain/CharacterState.h \
@@ -389,6 +399,7 @@ HEADERS += \
     3rd_party/Widgets/AcceptebleLineEdit/AcceptebleLineEdit.h \
     3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.h \
     3rd_party/Helpers/BackupHelper.h \
+    3rd_party/Helpers/EncodedImage.h \
     3rd_party/Widgets/HierarchicalHeaderView/HierarchicalHeaderView.h \
     3rd_party/Widgets/HierarchicalHeaderView/HierarchicalTableModel.h \
     3rd_party/Widgets/FlatButton/FlatButton.h \
@@ -421,6 +432,9 @@ HEADERS += \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/Handlers/NoprintableTextHandler.h \
     3rd_party/Widgets/ToolTipLabel/ToolTipLabel.h \
     BusinessLayer/ScenarioDocument/ScenarioReviewModel.h \
+    BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.h \
+    BusinessLayer/ScenarioDocument/ScenarioStructureParser.h \
+    BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.h \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewPanel.h \
     3rd_party/Widgets/ColoredToolButton/ColoredToolButton.h \
     3rd_party/Widgets/ColoredToolButton/ColorsPane.h \
@@ -431,6 +445,8 @@ HEADERS += \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewView.h \
     UserInterfaceLayer/Scenario/ScenarioTextEdit/ScenarioReviewItemDelegate.h \
     DataLayer/Database/DatabaseHelper.h \
+    DataLayer/Database/DatabaseHistoryWriter.h \
+    DataLayer/Database/ScenarioChangesCompactor.h \
     3rd_party/Widgets/Ctk/ctkCollapsibleButton.h \
     UserInterfaceLayer/Statistics/StatisticsView.h \
     ManagementLayer/Statistics/StatisticsManager.h \
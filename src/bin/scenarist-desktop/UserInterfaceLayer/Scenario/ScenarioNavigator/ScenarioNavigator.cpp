@@ -14,6 +14,7 @@
 #include <QKeyEvent>
 #include <QLabel>
 #include <QMenu>
+#include <QProgressBar>
 #include <QTreeView>
 #include <QVBoxLayout>
 #include <QWidgetAction>
@@ -33,6 +34,7 @@ ScenarioNavigator::ScenarioNavigator(QWidget *parent) :
 	m_middleTitle(new QLabel(this)),
 	m_showDraft(new FlatButton(this)),
 	m_showNote(new FlatButton(this)),
+	m_structureRebuildProgress(new QProgressBar(this)),
 	m_navigationTree(new QTreeView(this)),
 	m_navigationTreeDelegate(new ScenarioNavigatorItemDelegate(this))
 {
@@ -46,6 +48,12 @@ void ScenarioNavigator::setScenesCount(int _scenesCount)
 	m_scenesCount->setText(QString::number(_scenesCount));
 }
 
+void ScenarioNavigator::setStructureRebuildProgress(int _progress)
+{
+	m_structureRebuildProgress->setValue(_progress);
+	m_structureRebuildProgress->setVisible(_progress < 100);
+}
+
 void ScenarioNavigator::setModel(QAbstractItemModel* _model)
 {
 	m_navigationTree->setModel(_model);
@@ -353,6 +361,12 @@ void ScenarioNavigator::initView()
 	m_showNote->setToolTip(tr("Show/hide scene note"));
 	m_showNote->setCheckable(true);
 
+	m_structureRebuildProgress->setRange(0, 100);
+	m_structureRebuildProgress->setTextVisible(false);
+	m_structureRebuildProgress->setFixedHeight(4);
+	m_structureRebuildProgress->setToolTip(tr("Updating scenario structure"));
+	m_structureRebuildProgress->hide();
+
 	m_navigationTree->setItemDelegate(m_navigationTreeDelegate);
 	m_navigationTree->setDragDropMode(QAbstractItemView::DragDrop);
 	m_navigationTree->setDragEnabled(true);
@@ -380,6 +394,7 @@ void ScenarioNavigator::initView()
 	layout->setContentsMargins(QMargins());
 	layout->setSpacing(0);
 	layout->addLayout(topLayout);
+	layout->addWidget(m_structureRebuildProgress);
 	layout->addWidget(m_navigationTree);
 
 	setLayout(layout);
@@ -7,6 +7,7 @@
 class FlatButton;
 class QAbstractItemModel;
 class QLabel;
+class QProgressBar;
 class QTreeView;
 
 namespace UserInterface
@@ -29,6 +30,12 @@ namespace UserInterface
 		 */
 		void setScenesCount(int _scenesCount);
 
+		/**
+		 * @brief Установить прогресс фонового построения структуры, в процентах
+		 * @note Индикатор скрывается по достижении 100
+		 */
+		void setStructureRebuildProgress(int _progress);
+
 		/**
 		 * @brief Установить модель навигации
 		 */
@@ -222,6 +229,11 @@ namespace UserInterface
 		 */
 		FlatButton* m_showNote;
 
+		/**
+		 * @brief Индикатор фонового построения структуры
+		 */
+		QProgressBar* m_structureRebuildProgress;
+
 		/**
 		 * @brief Дерево навигации
 		 */
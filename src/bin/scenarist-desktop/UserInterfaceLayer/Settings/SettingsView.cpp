@@ -167,6 +167,11 @@ void SettingsView::setApplicationSaveBackupsFolder(const QString& _folder)
 	ui->saveBackupsFolder->setText(_folder);
 }
 
+void SettingsView::setApplicationBackupsInfo(const QString& _info)
+{
+	ui->backupsInfo->setText(_info);
+}
+
 void SettingsView::setApplicationTwoPanelMode(bool _use)
 {
 	ui->applicationTwoPanelMode->setChecked(_use);
@@ -53,6 +53,7 @@ namespace UserInterface
 		void setApplicationAutosaveInterval(int);
 		void setApplicationSaveBackups(bool _save);
 		void setApplicationSaveBackupsFolder(const QString& _folder);
+		void setApplicationBackupsInfo(const QString& _info);
 		void setApplicationTwoPanelMode(bool _use);
 		void setApplicationModuleResearch(bool _use);
 		void setApplicationModuleCards(bool _use);
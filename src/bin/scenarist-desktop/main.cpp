@@ -7,6 +7,7 @@
 #endif
 
 #include <ManagementLayer/ApplicationManager.h>
+#include <ManagementLayer/Export/BatchExporter.h>
 
 
 int main(int argc, char *argv[])
@@ -22,6 +23,13 @@ int main(int argc, char *argv[])
 	QBreakpadInstance.setDumpPath(crashReportsFolderPath);
 #endif
 
+	//
+	// Пакетный экспорт выполняется без интерфейса, после чего приложение сразу завершается
+	//
+	if (ManagementLayer::BatchExporter::isRequested(application.arguments())) {
+		return ManagementLayer::BatchExporter::exec(application.arguments());
+	}
+
 	//
 	// Получим имя файла, который пользователь возможно хочет открыть
 	//
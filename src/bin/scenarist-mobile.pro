@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT += core core-private gui gui-private sql xml widgets widgets-private network
+QT += core core-private gui gui-private sql xml widgets widgets-private network concurrent
 android: QT += androidextras
 
 TARGET = Scenarist
@@ -76,6 +76,7 @@ SOURCES += \
     scenarist-core/3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.cpp \
     scenarist-core/3rd_party/Delegates/KeySequenceDelegate/KeySequenceDelegate.cpp \
     scenarist-core/3rd_party/Helpers/BackupHelper.cpp \
+    scenarist-core/3rd_party/Helpers/EncodedImage.cpp \
     scenarist-core/3rd_party/Helpers/DiffMatchPatch.cpp \
     scenarist-core/3rd_party/Widgets/AcceptebleLineEdit/AcceptebleLineEdit.cpp \
     scenarist-core/3rd_party/Widgets/ColoredToolButton/ColoredToolButton.cpp \
@@ -119,13 +120,19 @@ SOURCES += \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioDocument.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModel.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItem.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioReviewModel.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTemplate.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextDocument.cpp \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioBlocksChange.cpp \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioXml.cpp \
     scenarist-core/DataLayer/Database/Database.cpp \
+    scenarist-core/DataLayer/Database/DatabaseHistoryWriter.cpp \
+    scenarist-core/DataLayer/Database/ScenarioChangesCompactor.cpp \
     scenarist-core/DataLayer/DataMappingLayer/AbstractMapper.cpp \
     scenarist-core/DataLayer/DataMappingLayer/CharacterMapper.cpp \
     scenarist-core/DataLayer/DataMappingLayer/CharacterPhotoMapper.cpp \
@@ -232,6 +239,7 @@ HEADERS += \
     scenarist-core/3rd_party/Delegates/ComboBoxItemDelegate/ComboBoxItemDelegate.h \
     scenarist-core/3rd_party/Delegates/KeySequenceDelegate/KeySequenceDelegate.h \
     scenarist-core/3rd_party/Helpers/BackupHelper.h \
+    scenarist-core/3rd_party/Helpers/EncodedImage.h \
     scenarist-core/3rd_party/Helpers/DiffMatchPatch.h \
     scenarist-core/3rd_party/Helpers/DiffMatchPatchHelper.h \
     scenarist-core/3rd_party/Helpers/ImageHelper.h \
@@ -288,14 +296,20 @@ HEADERS += \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioDocument.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModel.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItem.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioModelItemsIndex.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioReviewModel.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureBuilder.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTemplate.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextBlockInfo.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextBlockParsers.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioTextDocument.h \
+    scenarist-core/BusinessLayer/ScenarioDocument/ScenarioBlocksChange.h \
     scenarist-core/BusinessLayer/ScenarioDocument/ScenarioXml.h \
     scenarist-core/DataLayer/Database/Database.h \
     scenarist-core/DataLayer/Database/DatabaseHelper.h \
+    scenarist-core/DataLayer/Database/DatabaseHistoryWriter.h \
+    scenarist-core/DataLayer/Database/ScenarioChangesCompactor.h \
     scenarist-core/DataLayer/DataMappingLayer/AbstractMapper.h \
     scenarist-core/DataLayer/DataMappingLayer/CharacterMapper.h \
     scenarist-core/DataLayer/DataMappingLayer/CharacterPhotoMapper.h \
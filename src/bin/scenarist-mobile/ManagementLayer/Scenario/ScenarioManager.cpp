@@ -389,6 +389,7 @@ void ScenarioManager::aboutNavigatorSettingsUpdated()
 
 void ScenarioManager::aboutChronometrySettingsUpdated()
 {
+	BusinessLogic::ChronometerFacade::updateChronometer();
 	m_scenario->refresh();
 	m_scenarioDraft->refresh();
 //	aboutUpdateDuration(m_textEditManager->cursorPosition());
@@ -131,12 +131,18 @@ void SettingsManager::aboutResetSettings()
 	//
 	DataStorageLayer::StorageFacade::settingsStorage()->resetValues(
 		DataStorageLayer::SettingsStorage::ApplicationSettings);
+	ScenarioTemplateFacade::updateCurrentTemplate();
 
 	//
 	// Перезагружаем интерфейс
 	//
 	initView();
 
+	//
+	// Хронометраж запоминает свои параметры, поэтому уведомляем о их смене
+	//
+	emit chronometrySettingsUpdated();
+
 	progress.close();
 }
 
@@ -288,6 +294,7 @@ void SettingsManager::scenarioEditFolderBackgroundColorDarkChanged(const QColor&
 void SettingsManager::scenarioEditCurrentTemplateChanged(const QString& _value)
 {
 	storeValue("scenario-editor/current-style", _value);
+	ScenarioTemplateFacade::updateCurrentTemplate();
 }
 
 void SettingsManager::scenarioEditAutoJumpToNextBlockChanged(bool _value)
@@ -23,6 +23,7 @@
 
 #include "qtzip/QtZipReader"
 
+#include <QScopedPointer>
 #include <QTextDocument>
 #include <QXmlStreamAttributes>
 
@@ -128,17 +129,27 @@ void DocxReader::readData(QIODevice* device)
 			QString::fromLatin1("word/document.xml")
 		};
 		for (int i = 0; i < 3; ++i) {
-			QByteArray data = zip.fileData(files[i]);
-			if (data.isEmpty()) {
+			QScopedPointer<QIODevice> file(zip.openFile(files[i]));
+			if (!file || file->size() == 0) {
 				continue;
 			}
-			m_xml.addData(data);
+			m_xml.setDevice(file.data());
 			readContent();
-			if (m_xml.hasError()) {
+			// Read the rest of the entry, so that its checksum is verified
+			if (!m_xml.hasError()) {
+				file->readAll();
+			}
+			const bool isCorrupted = QtZipReader::isCorrupted(file.data());
+			const bool hasError = isCorrupted || m_xml.hasError();
+			if (isCorrupted) {
+				m_error = file->errorString();
+			} else if (hasError) {
 				m_error = m_xml.errorString();
-				break;
 			}
 			m_xml.clear();
+			if (hasError) {
+				break;
+			}
 		}
 	} else {
 		m_error = tr("Unable to open archive.");
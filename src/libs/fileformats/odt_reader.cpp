@@ -21,6 +21,7 @@
 
 #include "qtzip/QtZipReader"
 
+#include <QScopedPointer>
 #include <QTextDocument>
 
 namespace {
@@ -61,17 +62,27 @@ void OdtReader::readData(QIODevice* device)
 	if (zip.isReadable()) {
 		const QString files[] = { QString::fromLatin1("styles.xml"), QString::fromLatin1("content.xml") };
 		for (int i = 0; i < 2; ++i) {
-			QByteArray data = zip.fileData(files[i]);
-			if (data.isEmpty()) {
+			QScopedPointer<QIODevice> file(zip.openFile(files[i]));
+			if (!file || file->size() == 0) {
 				continue;
 			}
-			m_xml.addData(data);
+			m_xml.setDevice(file.data());
 			readDocument();
-			if (m_xml.hasError()) {
+			// Read the rest of the entry, so that its checksum is verified
+			if (!m_xml.hasError()) {
+				file->readAll();
+			}
+			const bool isCorrupted = QtZipReader::isCorrupted(file.data());
+			const bool hasError = isCorrupted || m_xml.hasError();
+			if (isCorrupted) {
+				m_error = file->errorString();
+			} else if (hasError) {
 				m_error = m_xml.errorString();
-				break;
 			}
 			m_xml.clear();
+			if (hasError) {
+				break;
+			}
 		}
 	} else {
 		m_error = tr("Unable to open archive.");
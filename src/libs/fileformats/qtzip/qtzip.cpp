@@ -461,6 +461,8 @@ bool QtZipReader::FileInfo::isValid() const
 	return isDir || isFile || isSymLink;
 }
 
+class QtZipEntryWriter;
+
 class QtZipPrivate
 {
 public:
@@ -545,6 +547,8 @@ public:
 	}
 
 	void scanFiles();
+	int findFile(const QString &fileName);
+	qint64 dataOffset(const FileHeader &header) const;
 
 	QtZipReader::Status status;
 };
@@ -556,17 +560,97 @@ public:
 		: QtZipPrivate(device, ownDev),
 		status(QtZipWriter::NoError),
 		permissions(QFile::ReadOwner | QFile::WriteOwner),
-		compressionPolicy(QtZipWriter::AlwaysCompress)
+		compressionPolicy(QtZipWriter::AlwaysCompress),
+		currentEntry(0)
 	{
 	}
 
 	QtZipWriter::Status status;
 	QFile::Permissions permissions;
 	QtZipWriter::CompressionPolicy compressionPolicy;
+	QtZipEntryWriter *currentEntry;
 
 	enum EntryType { Directory, File, Symlink };
 
+	FileHeader createHeader(EntryType type, const QString &fileName) const;
 	void addEntry(EntryType type, const QString &fileName, const QByteArray &contents);
+	QIODevice *openEntry(const QString &fileName);
+	void finishEntry(int headerIndex, qint64 localHeaderOffset, uint crc, qint64 compressedSize, qint64 uncompressedSize);
+	void closeEntry();
+};
+
+// size of the buffers used to deflate and inflate entries by parts
+static const int ZIP_STREAM_BUFFER_SIZE = 16 * 1024;
+
+/*
+	Device writing the contents of one entry right into the archive, compressing them by parts.
+	The sizes and the crc of the entry are written to its local header when the device is closed.
+*/
+class QtZipEntryWriter : public QIODevice
+{
+public:
+	QtZipEntryWriter(QtZipWriterPrivate *zip, int headerIndex, qint64 localHeaderOffset, bool compress);
+	~QtZipEntryWriter();
+
+	bool isSequential() const;
+	void close();
+
+protected:
+	qint64 readData(char *data, qint64 maxlen);
+	qint64 writeData(const char *data, qint64 len);
+
+private:
+	bool deflateData(const char *data, qint64 len, int flush);
+
+	QtZipWriterPrivate *zip;
+	int headerIndex;
+	qint64 localHeaderOffset;
+	bool compress;
+	bool finished;
+	z_stream stream;
+	uint crc;
+	qint64 compressedSize;
+	qint64 uncompressedSize;
+};
+
+/*
+	Device reading the contents of one entry from the archive, uncompressing them by parts.
+	The crc of the entry is checked when all of its contents are read.
+*/
+class QtZipEntryReader : public QIODevice
+{
+public:
+	QtZipEntryReader(QIODevice *archive, qint64 dataOffset, qint64 compressedSize, qint64 uncompressedSize,
+		uint expectedCrc, bool compressed);
+	~QtZipEntryReader();
+
+	bool isSequential() const;
+	qint64 size() const;
+	qint64 bytesAvailable() const;
+	void close();
+
+	bool isCorrupted() const;
+
+protected:
+	qint64 readData(char *data, qint64 maxlen);
+	qint64 writeData(const char *data, qint64 len);
+
+private:
+	qint64 readArchive(char *data, qint64 maxlen);
+	qint64 setCorrupted(const char *error);
+
+	QIODevice *archive;
+	qint64 position;
+	qint64 compressedLeft;
+	qint64 uncompressedSize;
+	qint64 uncompressedRead;
+	uint expectedCrc;
+	uint crc;
+	bool compressed;
+	bool streamEnded;
+	bool corrupted;
+	z_stream stream;
+	QByteArray buffer;
 };
 
 LocalFileHeader CentralFileHeader::toLocalHeader() const
@@ -674,6 +758,25 @@ void QtZipReaderPrivate::scanFiles()
 	}
 }
 
+int QtZipReaderPrivate::findFile(const QString &fileName)
+{
+	scanFiles();
+	for (int i = 0; i < fileHeaders.size(); ++i) {
+		if (QString::fromLocal8Bit(fileHeaders.at(i).file_name) == fileName)
+			return i;
+	}
+	return -1;
+}
+
+qint64 QtZipReaderPrivate::dataOffset(const FileHeader &header) const
+{
+	const qint64 start = readUInt(header.h.offset_local_header);
+	device->seek(start);
+	LocalFileHeader lh;
+	device->read((char *)&lh, sizeof(LocalFileHeader));
+	return start + sizeof(LocalFileHeader) + readUShort(lh.file_name_length) + readUShort(lh.extra_field_length);
+}
+
 void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const QByteArray &contents/*, QFile::Permissions permissions, QtZip::Method m*/)
 {
 #ifndef NDEBUG
@@ -699,13 +802,8 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
 			compression = QtZipWriter::AlwaysCompress;
 	}
 
-	FileHeader header;
-	memset(&header.h, 0, sizeof(CentralFileHeader));
-	writeUInt(header.h.signature, 0x02014b50);
-
-	writeUShort(header.h.version_needed, ZIP_VERSION);
+	FileHeader header = createHeader(type, fileName);
 	writeUInt(header.h.uncompressed_size, contents.length());
-	writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
 	QByteArray data = contents;
 	if (compression == QtZipWriter::AlwaysCompress) {
 		writeUShort(header.h.compression_method, CompressionMethodDeflated);
@@ -738,6 +836,25 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
 	crc_32 = ::crc32(crc_32, (const uchar *)contents.constData(), contents.length());
 	writeUInt(header.h.crc_32, crc_32);
 
+	fileHeaders.append(header);
+
+	LocalFileHeader h = header.h.toLocalHeader();
+	device->write((const char *)&h, sizeof(LocalFileHeader));
+	device->write(header.file_name);
+	device->write(data);
+	start_of_directory = device->pos();
+	dirtyFileTree = true;
+}
+
+FileHeader QtZipWriterPrivate::createHeader(EntryType type, const QString &fileName) const
+{
+	FileHeader header;
+	memset(&header.h, 0, sizeof(CentralFileHeader));
+	writeUInt(header.h.signature, 0x02014b50);
+
+	writeUShort(header.h.version_needed, ZIP_VERSION);
+	writeMSDosDate(header.h.last_mod_file, QDateTime::currentDateTime());
+
 	// if bit 11 is set, the filename and comment fields must be encoded using UTF-8
 	ushort general_purpose_bits = Utf8Names; // always use utf-8
 	writeUShort(header.h.general_purpose_bits, general_purpose_bits);
@@ -767,17 +884,285 @@ void QtZipWriterPrivate::addEntry(EntryType type, const QString &fileName, const
 	writeUInt(header.h.external_file_attributes, mode << 16);
 	writeUInt(header.h.offset_local_header, start_of_directory);
 
+	return header;
+}
+
+QIODevice *QtZipWriterPrivate::openEntry(const QString &fileName)
+{
+	closeEntry();
+
+	if (! (device->isOpen() || device->open(QIODevice::WriteOnly))) {
+		status = QtZipWriter::FileOpenError;
+		return 0;
+	}
+	device->seek(start_of_directory);
+
+	// the size is not known beforehand, so AutoCompress means compression here
+	const bool compress = compressionPolicy != QtZipWriter::NeverCompress;
 
+	// crc and sizes are filled in when the entry is finished
+	FileHeader header = createHeader(File, fileName);
+	writeUShort(header.h.compression_method, compress ? CompressionMethodDeflated : CompressionMethodStored);
 	fileHeaders.append(header);
 
 	LocalFileHeader h = header.h.toLocalHeader();
 	device->write((const char *)&h, sizeof(LocalFileHeader));
 	device->write(header.file_name);
-	device->write(data);
-	start_of_directory = device->pos();
+
+	currentEntry = new QtZipEntryWriter(this, fileHeaders.size() - 1, start_of_directory, compress);
+	return currentEntry;
+}
+
+void QtZipWriterPrivate::finishEntry(int headerIndex, qint64 localHeaderOffset, uint crc, qint64 compressedSize, qint64 uncompressedSize)
+{
+	FileHeader &header = fileHeaders[headerIndex];
+	writeUInt(header.h.crc_32, crc);
+	writeUInt(header.h.compressed_size, compressedSize);
+	writeUInt(header.h.uncompressed_size, uncompressedSize);
+
+	// update the local header, crc and sizes follow each other in it
+	const qint64 end = device->pos();
+	LocalFileHeader h = header.h.toLocalHeader();
+	device->seek(localHeaderOffset + (h.crc_32 - (uchar *)&h));
+	device->write((const char *)h.crc_32, sizeof(h.crc_32) + sizeof(h.compressed_size) + sizeof(h.uncompressed_size));
+	device->seek(end);
+
+	start_of_directory = end;
 	dirtyFileTree = true;
 }
 
+void QtZipWriterPrivate::closeEntry()
+{
+	if (currentEntry != 0) {
+		currentEntry->close();
+		delete currentEntry;
+		currentEntry = 0;
+	}
+}
+
+//////////////////////////////  Entry devices
+
+QtZipEntryWriter::QtZipEntryWriter(QtZipWriterPrivate *zip, int headerIndex, qint64 localHeaderOffset, bool compress)
+	: zip(zip), headerIndex(headerIndex), localHeaderOffset(localHeaderOffset), compress(compress),
+	finished(false), crc(::crc32(0, 0, 0)), compressedSize(0), uncompressedSize(0)
+{
+	memset(&stream, 0, sizeof(z_stream));
+	if (compress)
+		deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+	open(QIODevice::WriteOnly);
+}
+
+QtZipEntryWriter::~QtZipEntryWriter()
+{
+	close();
+}
+
+bool QtZipEntryWriter::isSequential() const
+{
+	return true;
+}
+
+void QtZipEntryWriter::close()
+{
+	if (!finished) {
+		finished = true;
+		if (compress) {
+			if (!deflateData(0, 0, Z_FINISH))
+				zip->status = QtZipWriter::FileWriteError;
+			deflateEnd(&stream);
+		}
+		zip->finishEntry(headerIndex, localHeaderOffset, crc, compressedSize, uncompressedSize);
+	}
+	QIODevice::close();
+}
+
+qint64 QtZipEntryWriter::readData(char *data, qint64 maxlen)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(maxlen);
+	return -1;
+}
+
+qint64 QtZipEntryWriter::writeData(const char *data, qint64 len)
+{
+	if (finished)
+		return -1;
+
+	crc = ::crc32(crc, (const uchar *)data, len);
+	uncompressedSize += len;
+	if (compress) {
+		if (!deflateData(data, len, Z_NO_FLUSH)) {
+			zip->status = QtZipWriter::FileWriteError;
+			return -1;
+		}
+	} else {
+		if (zip->device->write(data, len) != len) {
+			zip->status = QtZipWriter::FileWriteError;
+			return -1;
+		}
+		compressedSize += len;
+	}
+	return len;
+}
+
+bool QtZipEntryWriter::deflateData(const char *data, qint64 len, int flush)
+{
+	char buffer[ZIP_STREAM_BUFFER_SIZE];
+	stream.next_in = (Bytef *)data;
+	stream.avail_in = (uInt)len;
+	do {
+		stream.next_out = (Bytef *)buffer;
+		stream.avail_out = sizeof(buffer);
+		if (::deflate(&stream, flush) == Z_STREAM_ERROR)
+			return false;
+		const qint64 size = sizeof(buffer) - stream.avail_out;
+		if (zip->device->write(buffer, size) != size)
+			return false;
+		compressedSize += size;
+	} while (stream.avail_out == 0);
+	return true;
+}
+
+QtZipEntryReader::QtZipEntryReader(QIODevice *archive, qint64 dataOffset, qint64 compressedSize, qint64 uncompressedSize,
+	uint expectedCrc, bool compressed)
+	: archive(archive), position(dataOffset), compressedLeft(compressedSize), uncompressedSize(uncompressedSize),
+	uncompressedRead(0), expectedCrc(expectedCrc), crc(::crc32(0, 0, 0)), compressed(compressed), streamEnded(false),
+	corrupted(false)
+{
+	memset(&stream, 0, sizeof(z_stream));
+	if (compressed) {
+		inflateInit2(&stream, -MAX_WBITS);
+		buffer.resize(ZIP_STREAM_BUFFER_SIZE);
+	}
+	open(QIODevice::ReadOnly);
+}
+
+QtZipEntryReader::~QtZipEntryReader()
+{
+	close();
+}
+
+bool QtZipEntryReader::isSequential() const
+{
+	return true;
+}
+
+qint64 QtZipEntryReader::size() const
+{
+	return uncompressedSize;
+}
+
+qint64 QtZipEntryReader::bytesAvailable() const
+{
+	return uncompressedSize - uncompressedRead + QIODevice::bytesAvailable();
+}
+
+void QtZipEntryReader::close()
+{
+	if (compressed && isOpen())
+		inflateEnd(&stream);
+	QIODevice::close();
+}
+
+bool QtZipEntryReader::isCorrupted() const
+{
+	return corrupted;
+}
+
+qint64 QtZipEntryReader::readArchive(char *data, qint64 maxlen)
+{
+	// the archive device may be used by other entries in between, so always seek to our position
+	const qint64 len = qMin(maxlen, compressedLeft);
+	if (len <= 0)
+		return 0;
+	// the archive ends before the entry does
+	if (!archive->seek(position))
+		return setCorrupted("Unexpected end of archive");
+	const qint64 read = archive->read(data, len);
+	if (read <= 0)
+		return setCorrupted("Unexpected end of archive");
+	position += read;
+	compressedLeft -= read;
+	return read;
+}
+
+qint64 QtZipEntryReader::setCorrupted(const char *error)
+{
+	qWarning("QtZip: %s, the entry is corrupted", error);
+	setErrorString(QLatin1String(error));
+	corrupted = true;
+	return -1;
+}
+
+qint64 QtZipEntryReader::readData(char *data, qint64 maxlen)
+{
+	if (corrupted)
+		return -1;
+	if (uncompressedRead >= uncompressedSize && (!compressed || streamEnded))
+		return 0;
+
+	qint64 read = 0;
+	if (!compressed) {
+		read = readArchive(data, qMin(maxlen, uncompressedSize - uncompressedRead));
+		if (read < 0)
+			return -1;
+		// the stored data ran out before the entry size
+		if (read == 0)
+			return setCorrupted("Unexpected end of stored data");
+	} else {
+		stream.next_out = (Bytef *)data;
+		stream.avail_out = (uInt)qMin(maxlen, qint64(ZIP_STREAM_BUFFER_SIZE));
+		while (stream.avail_out > 0 && !streamEnded) {
+			if (stream.avail_in == 0) {
+				const qint64 compressedRead = readArchive(buffer.data(), buffer.size());
+				if (compressedRead < 0)
+					return -1;
+				if (compressedRead == 0)
+					break;
+				stream.next_in = (Bytef *)buffer.data();
+				stream.avail_in = (uInt)compressedRead;
+			}
+			const int res = ::inflate(&stream, Z_NO_FLUSH);
+			if (res == Z_STREAM_END) {
+				streamEnded = true;
+			} else if (res != Z_OK) {
+				qWarning("QtZip: Z_DATA_ERROR: Input data is corrupted");
+				setErrorString(QLatin1String("Input data is corrupted"));
+				corrupted = true;
+				return -1;
+			}
+		}
+		read = (char *)stream.next_out - data;
+
+		// the compressed data ran out before the deflate stream ended
+		if (read == 0 && !streamEnded && stream.avail_in == 0 && compressedLeft == 0)
+			return setCorrupted("Unexpected end of compressed data");
+	}
+
+	if (read > 0) {
+		crc = ::crc32(crc, (const uchar *)data, read);
+		uncompressedRead += read;
+		if (uncompressedRead == uncompressedSize && crc != expectedCrc) {
+			qWarning("QtZip: crc mismatch, the entry is corrupted");
+			setErrorString(QLatin1String("CRC mismatch, the entry is corrupted"));
+			corrupted = true;
+			return -1;
+		}
+	}
+
+	// the deflate stream ended before all of the entry was uncompressed
+	if (compressed && streamEnded && uncompressedRead < uncompressedSize)
+		return setCorrupted("Unexpected end of compressed data");
+	return read;
+}
+
+qint64 QtZipEntryReader::writeData(const char *data, qint64 len)
+{
+	Q_UNUSED(data);
+	Q_UNUSED(len);
+	return -1;
+}
+
 //////////////////////////////  Reader
 
 /*!
@@ -977,13 +1362,8 @@ QtZipReader::FileInfo QtZipReader::entryInfoAt(int index) const
 */
 QByteArray QtZipReader::fileData(const QString &fileName) const
 {
-	d->scanFiles();
-	int i;
-	for (i = 0; i < d->fileHeaders.size(); ++i) {
-		if (QString::fromLocal8Bit(d->fileHeaders.at(i).file_name) == fileName)
-			break;
-	}
-	if (i == d->fileHeaders.size())
+	const int i = d->findFile(fileName);
+	if (i == -1)
 		return QByteArray();
 
 	FileHeader header = d->fileHeaders.at(i);
@@ -1055,6 +1435,56 @@ QByteArray QtZipReader::fileData(const QString &fileName) const
 	return QByteArray();
 }
 
+/*!
+	Opens the file \a fileName in the zip archive for reading. The contents are
+	uncompressed by parts while they are read, so the whole file is never held
+	in memory. Returns 0 if there is no such file or it can't be extracted.
+
+	The caller takes ownership of the returned device. The archive device must
+	stay open while the returned device is used.
+
+	If the compressed data or its checksum turn out to be broken, reading from
+	the returned device fails with -1 and its errorString() describes the
+	problem. Check isCorrupted() after reading to tell this from the end of file.
+*/
+QIODevice *QtZipReader::openFile(const QString &fileName) const
+{
+	const int i = d->findFile(fileName);
+	if (i == -1)
+		return 0;
+
+	const FileHeader header = d->fileHeaders.at(i);
+	ushort version_needed = readUShort(header.h.version_needed);
+	if (version_needed > ZIP_VERSION) {
+		qWarning("QtZip: .ZIP specification version %d implementationis needed to extract the data.", version_needed);
+		return 0;
+	}
+	ushort general_purpose_bits = readUShort(header.h.general_purpose_bits);
+	if ((general_purpose_bits & Encrypted) != 0) {
+		qWarning("QtZip: Unsupported encryption method is needed to extract the data.");
+		return 0;
+	}
+	int compression_method = readUShort(header.h.compression_method);
+	if (compression_method != CompressionMethodStored && compression_method != CompressionMethodDeflated) {
+		qWarning("QtZip: Unsupported compression method %d is needed to extract the data.", compression_method);
+		return 0;
+	}
+
+	return new QtZipEntryReader(d->device, d->dataOffset(header), readUInt(header.h.compressed_size),
+		readUInt(header.h.uncompressed_size), readUInt(header.h.crc_32),
+		compression_method == CompressionMethodDeflated);
+}
+
+/*!
+	Returns \c true if \a file was opened with openFile() and reading from it
+	failed because the entry is corrupted; otherwise returns \c false.
+*/
+bool QtZipReader::isCorrupted(QIODevice *file)
+{
+	const QtZipEntryReader *entry = dynamic_cast<const QtZipEntryReader*>(file);
+	return entry != 0 && entry->isCorrupted();
+}
+
 /*!
 	Extracts the full contents of the zip file into \a destinationDir on
 	the local filesystem.
@@ -1326,6 +1756,7 @@ QFile::Permissions QtZipWriter::creationPermissions() const
 */
 void QtZipWriter::addFile(const QString &fileName, const QByteArray &data)
 {
+	d->closeEntry();
 	d->addEntry(QtZipWriterPrivate::File, QDir::fromNativeSeparators(fileName), data);
 }
 
@@ -1353,6 +1784,24 @@ void QtZipWriter::addFile(const QString &fileName, QIODevice *device)
 		device->close();
 }
 
+/*!
+	Add a file to the archive and return a device to write its contents to.
+	The contents are compressed by parts while they are written, so they never
+	have to be held in memory as a whole. The file is stored in the archive
+	using the \a fileName which includes the full path in the archive.
+
+	The file is finished when the returned device is closed, or when the next
+	file is added, or when the archive is closed. The device stays owned by the
+	writer and is deleted at that point. Returns 0 if the archive can't be written.
+
+	As the size of the file is not known beforehand, the AutoCompress policy
+	compresses it. Use NeverCompress to store the contents as is, which is faster.
+*/
+QIODevice *QtZipWriter::openFile(const QString &fileName)
+{
+	return d->openEntry(QDir::fromNativeSeparators(fileName));
+}
+
 /*!
 	Create a new directory in the archive with the specified \a dirName and
 	the \a permissions;
@@ -1363,6 +1812,7 @@ void QtZipWriter::addDirectory(const QString &dirName)
 	// separator is mandatory
 	if (!name.endsWith(QLatin1Char('/')))
 		name.append(QLatin1Char('/'));
+	d->closeEntry();
 	d->addEntry(QtZipWriterPrivate::Directory, name, QByteArray());
 }
 
@@ -1373,6 +1823,7 @@ void QtZipWriter::addDirectory(const QString &dirName)
 */
 void QtZipWriter::addSymLink(const QString &fileName, const QString &destination)
 {
+	d->closeEntry();
 	d->addEntry(QtZipWriterPrivate::Symlink, QDir::fromNativeSeparators(fileName), QFile::encodeName(destination));
 }
 
@@ -1381,6 +1832,8 @@ void QtZipWriter::addSymLink(const QString &fileName, const QString &destination
 */
 void QtZipWriter::close()
 {
+	d->closeEntry();
+
 	if (!(d->device->openMode() & QIODevice::WriteOnly)) {
 		d->device->close();
 		return;
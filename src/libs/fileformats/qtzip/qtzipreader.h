@@ -87,6 +87,8 @@ public:
 
 	FileInfo entryInfoAt(int index) const;
 	QByteArray fileData(const QString &fileName) const;
+	QIODevice *openFile(const QString &fileName) const;
+	static bool isCorrupted(QIODevice *file);
 	bool extractAll(const QString &destinationDir) const;
 
 	enum Status {
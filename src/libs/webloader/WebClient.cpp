@@ -0,0 +1,178 @@
+#include "WebClient.h"
+#include "WebClientWorker.h"
+
+#include <QtCore/QEventLoop>
+#include <QtCore/QStringList>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+
+WebClient::WebClient(QObject* _parent) :
+	QObject(_parent),
+	m_thread(new QThread(this)),
+	m_worker(new WebClientWorker),
+	m_lastRequestId(0)
+{
+	//
+	// Исполнитель живёт в потоке клиента и удаляется при его завершении
+	//
+	m_worker->moveToThread(m_thread);
+	connect(m_thread, SIGNAL(finished()), m_worker, SLOT(deleteLater()));
+
+	//
+	// Результаты запросов приходят в поток, которому принадлежит клиент
+	//
+	connect(m_worker, SIGNAL(finished(int,QByteArray)), this, SLOT(aboutRequestFinished(int,QByteArray)));
+	connect(m_worker, SIGNAL(failed(int,QString)), this, SLOT(aboutRequestFailed(int,QString)));
+	connect(m_worker, SIGNAL(serverError(int,QString,QByteArray)),
+		this, SLOT(aboutServerError(int,QString,QByteArray)));
+
+	m_thread->start();
+}
+
+WebClient::~WebClient()
+{
+	m_thread->quit();
+	m_thread->wait();
+}
+
+void WebClient::setRequestTimeout(int _msecs)
+{
+	QMetaObject::invokeMethod(m_worker, "setRequestTimeout", Qt::QueuedConnection, Q_ARG(int, _msecs));
+}
+
+int WebClient::post(const QUrl& _url, const Attributes& _attributes)
+{
+	const int requestId = ++m_lastRequestId;
+	send(requestId, _url, _attributes, true);
+	return requestId;
+}
+
+QByteArray WebClient::postSync(const QUrl& _url, const Attributes& _attributes)
+{
+	const int requestId = ++m_lastRequestId;
+	m_syncRequestsIds.insert(requestId);
+
+	//
+	// Ждём только своего запроса, результаты остальных откладываем до окончания ожидания,
+	// чтобы их обработчики не вклинивались в середину действия, которое ждёт ответа.
+	// Время ожидания ограничено исполнителем, который сам прерывает зависшие запросы
+	//
+	QByteArray response;
+	QEventLoop loop;
+	connect(this, &WebClient::finished, &loop, [&] (int _finishedRequestId, const QByteArray& _response) {
+		if (_finishedRequestId == requestId) {
+			response = _response;
+			loop.quit();
+		}
+	});
+	connect(this, &WebClient::failed, &loop, [&] (int _failedRequestId) {
+		if (_failedRequestId == requestId) {
+			loop.quit();
+		}
+	});
+	connect(this, &WebClient::serverError, &loop, [&] (int _failedRequestId) {
+		if (_failedRequestId == requestId) {
+			loop.quit();
+		}
+	});
+
+	//
+	// Повторные попытки с задержками заняли бы до полутора минут, всё это время
+	// вызывающий поток ничего бы не обрабатывал, поэтому запрос отправляется один раз
+	//
+	send(requestId, _url, _attributes, false);
+	loop.exec();
+
+	m_syncRequestsIds.remove(requestId);
+	if (!m_deferredResults.isEmpty()) {
+		QTimer::singleShot(0, this, SLOT(emitDeferredResults()));
+	}
+
+	return response;
+}
+
+void WebClient::aboutRequestFinished(int _requestId, const QByteArray& _response)
+{
+	Result result;
+	result.type = Result::Finished;
+	result.requestId = _requestId;
+	result.response = _response;
+	deliver(result);
+}
+
+void WebClient::aboutRequestFailed(int _requestId, const QString& _error)
+{
+	Result result;
+	result.type = Result::Failed;
+	result.requestId = _requestId;
+	result.error = _error;
+	deliver(result);
+}
+
+void WebClient::aboutServerError(int _requestId, const QString& _error, const QByteArray& _response)
+{
+	Result result;
+	result.type = Result::ServerError;
+	result.requestId = _requestId;
+	result.error = _error;
+	result.response = _response;
+	deliver(result);
+}
+
+void WebClient::emitDeferredResults()
+{
+	//
+	// Обработчик результата может снова начать синхронный запрос, тогда остальные
+	// результаты будут доставлены уже после его окончания
+	//
+	while (m_syncRequestsIds.isEmpty()
+		   && !m_deferredResults.isEmpty()) {
+		emitResult(m_deferredResults.takeFirst());
+	}
+}
+
+void WebClient::send(int _requestId, const QUrl& _url, const Attributes& _attributes, bool _canRetry)
+{
+	QStringList names;
+	QVariantList values;
+	for (int index = 0; index < _attributes.size(); ++index) {
+		names.append(_attributes.at(index).first);
+		values.append(_attributes.at(index).second);
+	}
+
+	QMetaObject::invokeMethod(m_worker, "post", Qt::QueuedConnection,
+		Q_ARG(int, _requestId), Q_ARG(QUrl, _url), Q_ARG(QStringList, names), Q_ARG(QVariantList, values),
+		Q_ARG(bool, _canRetry));
+}
+
+void WebClient::deliver(const Result& _result)
+{
+	if (!m_syncRequestsIds.isEmpty()
+		&& !m_syncRequestsIds.contains(_result.requestId)) {
+		m_deferredResults.append(_result);
+		return;
+	}
+
+	emitResult(_result);
+}
+
+void WebClient::emitResult(const Result& _result)
+{
+	switch (_result.type) {
+		case Result::Finished: {
+			emit finished(_result.requestId, _result.response);
+			break;
+		}
+
+		case Result::Failed: {
+			emit failed(_result.requestId, _result.error);
+			break;
+		}
+
+		case Result::ServerError: {
+			emit serverError(_result.requestId, _result.error, _result.response);
+			break;
+		}
+	}
+}
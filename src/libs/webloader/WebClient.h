@@ -0,0 +1,170 @@
+#ifndef WEBCLIENT_H
+#define WEBCLIENT_H
+
+#include "WebLoaderGlobal.h"
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QPair>
+#include <QtCore/QSet>
+#include <QtCore/QUrl>
+#include <QtCore/QVariant>
+
+class QThread;
+class WebClientWorker;
+
+
+/*!
+  \class WebClient
+
+  \brief Асинхронный клиент для работы с http-протоколом
+
+  Все запросы выполняются одним сетевым менеджером в отдельном потоке, поэтому открытые
+  соединения с сервером переиспользуются, а несколько запросов отправляются параллельно,
+  не дожидаясь ответов на предыдущие. Запросы, прерванные из-за проблем с сетью,
+  повторяются с увеличивающейся задержкой
+  */
+class WEBLOADER_EXPORT WebClient : public QObject
+{
+	Q_OBJECT
+
+public:
+	/*!
+	  \typedef Атрибуты запроса - пары из имени и значения
+	  */
+	typedef QList<QPair<QString, QVariant> > Attributes;
+
+public:
+	/*!
+	  \fn Конструктор
+	  */
+	explicit WebClient(QObject* _parent = 0);
+	/*!
+	  \fn Деструктор
+	  \note Неотправленные запросы отменяются
+	  */
+	~WebClient();
+
+	/*!
+	  \fn Установить максимальное время ожидания ответа на одну попытку запроса
+	  \param msecs - время ожидания (мс)
+	  */
+	void setRequestTimeout(int _msecs);
+
+	/*!
+	  \fn Отправка POST-запроса (асинхронное выполнение)
+	  \param url        - ссылка для запроса
+	  \param attributes - атрибуты запроса
+	  \return Идентификатор запроса, с которым будет испущен сигнал о его завершении
+	  */
+	int post(const QUrl& _url, const Attributes& _attributes);
+
+	/*!
+	  \fn Отправка POST-запроса (синхронное выполнение)
+	  \param url        - ссылка для запроса
+	  \param attributes - атрибуты запроса
+	  \return Ответ сервера, или пустой массив, если запрос выполнить не удалось
+	  \note Запрос не повторяется, чтобы вызывающий не ждал дольше одного таймаута. Результаты
+			асинхронных запросов, пришедшие во время ожидания, доставляются после его окончания
+	  */
+	QByteArray postSync(const QUrl& _url, const Attributes& _attributes);
+
+signals:
+	/*!
+	  \fn Получен ответ на запрос
+	  \param requestId - идентификатор запроса
+	  \param response  - ответ сервера
+	  */
+	void finished(int _requestId, const QByteArray& _response);
+
+	/*!
+	  \fn Запрос не удалось выполнить из-за проблем со связью и повторные попытки исчерпаны
+	  \param requestId - идентификатор запроса
+	  \param error     - текст ошибки
+	  */
+	void failed(int _requestId, const QString& _error);
+
+	/*!
+	  \fn Сервер ответил на запрос ошибкой
+	  \param requestId - идентификатор запроса
+	  \param error     - текст ошибки
+	  \param response  - ответ сервера
+	  */
+	void serverError(int _requestId, const QString& _error, const QByteArray& _response);
+
+private slots:
+	/*!
+	  \fn Результаты запроса от исполнителя
+	  */
+	/** @{ */
+	void aboutRequestFinished(int _requestId, const QByteArray& _response);
+	void aboutRequestFailed(int _requestId, const QString& _error);
+	void aboutServerError(int _requestId, const QString& _error, const QByteArray& _response);
+	/** @} */
+
+	/*!
+	  \fn Доставить результаты, отложенные во время синхронного запроса
+	  */
+	void emitDeferredResults();
+
+private:
+	/*!
+	  \brief Результат запроса
+	  */
+	struct Result {
+		enum Type {
+			Finished,
+			Failed,
+			ServerError
+		};
+
+		Type type;
+		int requestId;
+		QString error;
+		QByteArray response;
+	};
+
+	/*!
+	  \fn Передать запрос на выполнение в поток клиента
+	  \param canRetry - повторять ли запрос, прерванный из-за проблем со связью
+	  */
+	void send(int _requestId, const QUrl& _url, const Attributes& _attributes, bool _canRetry);
+
+	/*!
+	  \fn Доставить результат сразу, или отложить, если его никто не ждёт во время синхронного запроса
+	  */
+	void deliver(const Result& _result);
+
+	/*!
+	  \fn Испустить сигнал с результатом запроса
+	  */
+	void emitResult(const Result& _result);
+
+private:
+	/*!
+	  \brief Поток, в котором выполняются запросы
+	  */
+	QThread* m_thread;
+
+	/*!
+	  \brief Исполнитель запросов, живущий в потоке клиента
+	  */
+	WebClientWorker* m_worker;
+
+	/*!
+	  \brief Идентификатор последнего запроса
+	  */
+	int m_lastRequestId;
+
+	/*!
+	  \brief Идентификаторы синхронных запросов, ответа на которые ждёт клиент
+	  */
+	QSet<int> m_syncRequestsIds;
+
+	/*!
+	  \brief Результаты асинхронных запросов, пришедшие во время ожидания синхронного
+	  */
+	QList<Result> m_deferredResults;
+};
+
+#endif // WEBCLIENT_H
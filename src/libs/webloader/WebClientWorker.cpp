@@ -0,0 +1,170 @@
+#include "WebClientWorker.h"
+#include "WebRequest.h"
+
+#include <QtCore/QTimer>
+#include <QtNetwork/QNetworkAccessManager>
+#include <QtNetwork/QNetworkReply>
+#include <QtNetwork/QNetworkRequest>
+
+namespace {
+	/**
+	 * @brief Максимальное время ожидания ответа от сервера (мс)
+	 */
+	const int REQUEST_TIMEOUT = 20000;
+
+	/**
+	 * @brief Количество попыток выполнения запроса, столько же раз можно перейти по перенаправлению
+	 */
+	const int MAX_ATTEMPTS = 4;
+
+	/**
+	 * @brief Задержка перед первой повторной попыткой, каждая следующая вдвое больше (мс)
+	 */
+	const int RETRY_DELAY = 1000;
+
+	/**
+	 * @brief Можно ли повторить запрос, прерванный с заданной ошибкой
+	 * @note Повторяются только запросы, прерванные из-за проблем со связью,
+	 *		 ответ сервера с ошибкой повторная отправка не исправит
+	 */
+	static bool isTransientError(QNetworkReply::NetworkError _error) {
+		switch (_error) {
+			case QNetworkReply::ConnectionRefusedError:
+			case QNetworkReply::RemoteHostClosedError:
+			case QNetworkReply::HostNotFoundError:
+			case QNetworkReply::TimeoutError:
+			case QNetworkReply::OperationCanceledError:
+			case QNetworkReply::TemporaryNetworkFailureError:
+			case QNetworkReply::NetworkSessionFailedError:
+			case QNetworkReply::ProxyConnectionClosedError:
+			case QNetworkReply::ProxyTimeoutError:
+			case QNetworkReply::UnknownNetworkError: {
+				return true;
+			}
+
+			default: {
+				return false;
+			}
+		}
+	}
+}
+
+
+WebClientWorker::WebClientWorker(QObject* _parent) :
+	QObject(_parent),
+	m_requestTimeout(REQUEST_TIMEOUT),
+	m_networkManager(0)
+{
+}
+
+void WebClientWorker::setRequestTimeout(int _msecs)
+{
+	m_requestTimeout = _msecs;
+}
+
+void WebClientWorker::post(int _requestId, const QUrl& _url, const QStringList& _names, const QVariantList& _values,
+	bool _canRetry)
+{
+	Request request;
+	request.url = _url;
+	request.names = _names;
+	request.values = _values;
+	request.canRetry = _canRetry;
+	m_requests.insert(_requestId, request);
+
+	sendRequest(_requestId);
+}
+
+void WebClientWorker::replyFinished(QNetworkReply* _reply)
+{
+	_reply->deleteLater();
+	if (!m_replies.contains(_reply)) {
+		return;
+	}
+
+	const int requestId = m_replies.take(_reply);
+	Request& request = m_requests[requestId];
+
+	//
+	// Переходим по перенаправлению, всегда методом GET, но не больше заданного числа раз,
+	// чтобы не зациклиться на сервере, который перенаправляет запрос сам на себя
+	//
+	const QVariant redirectUrl = _reply->header(QNetworkRequest::LocationHeader);
+	if (_reply->error() == QNetworkReply::NoError
+		&& !redirectUrl.isNull()) {
+		if (request.redirectsCount < MAX_ATTEMPTS) {
+			++request.redirectsCount;
+			request.url = _reply->url().resolved(redirectUrl.toUrl());
+			request.isRedirect = true;
+			sendRequest(requestId);
+		} else {
+			m_requests.remove(requestId);
+			emit failed(requestId, tr("Too many redirects"));
+		}
+	}
+	//
+	// Если ответ получен, отдаём его
+	//
+	else if (_reply->error() == QNetworkReply::NoError) {
+		m_requests.remove(requestId);
+		emit finished(requestId, _reply->readAll());
+	}
+	//
+	// Если сервер ответил ошибкой, повторять запрос бесполезно, отдаём ответ с ошибкой
+	//
+	else if (_reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400) {
+		m_requests.remove(requestId);
+		emit serverError(requestId, _reply->errorString(), _reply->readAll());
+	}
+	//
+	// Если пропала связь, то повторяем запрос через некоторое время, каждый раз ожидая дольше
+	//
+	else if (::isTransientError(_reply->error())
+			 && request.canRetry
+			 && request.attempt < MAX_ATTEMPTS) {
+		QTimer::singleShot(RETRY_DELAY << (request.attempt - 1), this, [=] { sendRequest(requestId); });
+		++request.attempt;
+	}
+	//
+	// В остальных случаях сообщаем об ошибке
+	//
+	else {
+		m_requests.remove(requestId);
+		emit failed(requestId, _reply->errorString());
+	}
+}
+
+void WebClientWorker::sendRequest(int _requestId)
+{
+	//
+	// Один сетевой менеджер на все запросы держит соединения с сервером открытыми
+	// и отправляет до нескольких запросов к одному серверу параллельно
+	//
+	if (m_networkManager == 0) {
+		m_networkManager = new QNetworkAccessManager(this);
+		connect(m_networkManager, SIGNAL(finished(QNetworkReply*)), this, SLOT(replyFinished(QNetworkReply*)));
+	}
+
+	const Request& request = m_requests[_requestId];
+
+	WebRequest webRequest;
+	webRequest.setUrlToLoad(request.url);
+	for (int index = 0; index < request.names.size(); ++index) {
+		webRequest.addAttribute(request.names.at(index), request.values.value(index));
+	}
+
+	QNetworkReply* reply = 0;
+	if (request.isRedirect) {
+		reply = m_networkManager->get(webRequest.networkRequest());
+	} else {
+		const QNetworkRequest networkRequest = webRequest.networkRequest(true);
+		reply = m_networkManager->post(networkRequest, webRequest.multiPartData());
+	}
+	connect(reply, SIGNAL(sslErrors(QList<QSslError>)), reply, SLOT(ignoreSslErrors()));
+	m_replies.insert(reply, _requestId);
+
+	//
+	// Зависший запрос прерываем, после чего он будет повторён как прерванный из-за проблем со связью
+	//
+	QTimer::singleShot(m_requestTimeout, reply, SLOT(abort()));
+}
@@ -0,0 +1,113 @@
+#ifndef WEBCLIENTWORKER_H
+#define WEBCLIENTWORKER_H
+
+#include <QtCore/QHash>
+#include <QtCore/QObject>
+#include <QtCore/QStringList>
+#include <QtCore/QUrl>
+#include <QtCore/QVariant>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+
+/*!
+  \class WebClientWorker
+
+  \brief Исполнитель запросов WebClient, работающий в его потоке
+  */
+class WebClientWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	/*!
+	  \fn Конструктор
+	  */
+	explicit WebClientWorker(QObject* _parent = 0);
+
+public slots:
+	/*!
+	  \fn Установить максимальное время ожидания ответа на одну попытку запроса (мс)
+	  */
+	void setRequestTimeout(int _msecs);
+
+	/*!
+	  \fn Отправить POST-запрос
+	  \param requestId - идентификатор запроса
+	  \param url       - ссылка для запроса
+	  \param names     - имена атрибутов запроса
+	  \param values    - значения атрибутов запроса
+	  \param canRetry  - повторять ли запрос, прерванный из-за проблем со связью
+	  */
+	void post(int _requestId, const QUrl& _url, const QStringList& _names, const QVariantList& _values,
+		bool _canRetry);
+
+signals:
+	/*!
+	  \fn Получен ответ на запрос
+	  */
+	void finished(int _requestId, const QByteArray& _response);
+
+	/*!
+	  \fn Запрос не удалось выполнить из-за проблем со связью
+	  */
+	void failed(int _requestId, const QString& _error);
+
+	/*!
+	  \fn Сервер ответил на запрос ошибкой
+	  */
+	void serverError(int _requestId, const QString& _error, const QByteArray& _response);
+
+private slots:
+	/*!
+	  \fn Окончание выполнения запроса
+	  \param reply - ответ сервера
+	  */
+	void replyFinished(QNetworkReply* _reply);
+
+private:
+	/*!
+	  \fn Выполнить очередную попытку отправки запроса
+	  */
+	void sendRequest(int _requestId);
+
+private:
+	/*!
+	  \brief Запрос, ожидающий ответа
+	  */
+	struct Request {
+		Request() : isRedirect(false), canRetry(true), attempt(1), redirectsCount(0) {}
+
+		QUrl url;
+		QStringList names;
+		QVariantList values;
+		bool isRedirect;
+		bool canRetry;
+		int attempt;
+		int redirectsCount;
+	};
+
+	/*!
+	  \brief Максимальное время ожидания ответа на одну попытку запроса (мс)
+	  */
+	int m_requestTimeout;
+
+	/*!
+	  \brief Сетевой менеджер, общий для всех запросов
+	  \note Создаётся при первом запросе, чтобы принадлежать потоку клиента
+	  */
+	QNetworkAccessManager* m_networkManager;
+
+	/*!
+	  \brief Запросы, ожидающие ответа, по идентификаторам
+	  */
+	QHash<int, Request> m_requests;
+
+	/*!
+	  \brief Идентификаторы запросов по ответам сервера
+	  */
+	QHash<QNetworkReply*, int> m_replies;
+};
+
+#endif // WEBCLIENTWORKER_H
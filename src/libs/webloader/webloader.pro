@@ -12,6 +12,8 @@ QMAKE_MAC_SDK = macosx10.12
 TARGET = webloader
 TEMPLATE = lib
 
+CONFIG += c++11
+
 DEFINES += WEBLOADER_LIBRARY
 
 #
@@ -32,12 +34,16 @@ UI_DIR = $$DESTDIR/.ui
 SOURCES += \
     WebRequest.cpp \
     WebLoader.cpp \
+    WebClient.cpp \
+    WebClientWorker.cpp \
     HttpMultiPart.cpp \
     QFreeDesktopMime/freedesktopmime.cpp
 
 HEADERS += \
     WebRequest.h \
     WebLoader.h \
+    WebClient.h \
+    WebClientWorker.h \
     HttpMultiPart.h \
     QFreeDesktopMime/freedesktopmime.h \
     WebLoaderGlobal.h \
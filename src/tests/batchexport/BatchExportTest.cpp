@@ -0,0 +1,175 @@
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Время ожидания завершения экспорта (мс)
+	 */
+	const int EXPORT_TIMEOUT = 2 * 60 * 1000;
+
+	/**
+	 * @brief Имя файла проекта, по нему же называются экспортированные файлы
+	 */
+	const QString PROJECT_NAME = "project";
+}
+
+
+/**
+ * @brief Проверка сообщений и кода завершения пакетного экспорта
+ */
+class BatchExportTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сформировать пустой проект, схему в нём создаст само приложение
+	 */
+	void initTestCase();
+
+	/**
+	 * @brief Подготовить пустую папку для экспортированных файлов
+	 */
+	void init();
+
+	/**
+	 * @brief Удачный экспорт в несколько форматов завершается с нулевым кодом
+	 */
+	void exportSucceeded();
+
+	/**
+	 * @brief Неудачный формат выводится в поток ошибок, остальные форматы экспортируются,
+	 *		  а приложение завершается с ненулевым кодом
+	 */
+	void formatFailed();
+
+	/**
+	 * @brief Отсутствующий проект выводится в поток ошибок, а приложение завершается с ненулевым кодом
+	 */
+	void projectNotFound();
+
+private:
+	/**
+	 * @brief Запустить приложение в режиме пакетного экспорта
+	 * @return Удалось ли запустить приложение и дождаться его нормального завершения
+	 */
+	bool runExport(const QString& _formats, const QString& _projectFileName);
+
+	/**
+	 * @brief Путь к экспортированному файлу заданного формата
+	 */
+	QString exportedFileName(const QString& _format) const;
+
+private:
+	/**
+	 * @brief Папка для проекта
+	 */
+	QTemporaryDir m_dir;
+
+	/**
+	 * @brief Папка для экспортированных файлов, своя у каждой проверки
+	 */
+	QScopedPointer<QTemporaryDir> m_outputDir;
+
+	/**
+	 * @brief Файл проекта
+	 */
+	QString m_projectFileName;
+
+	/**
+	 * @brief Код завершения, стандартный вывод и поток ошибок последнего запуска
+	 */
+	/** @{ */
+	int m_exitCode;
+	QString m_output;
+	QString m_errorOutput;
+	/** @} */
+};
+
+void BatchExportTest::initTestCase()
+{
+	QVERIFY(m_dir.isValid());
+	m_projectFileName = m_dir.filePath(PROJECT_NAME + ".kitsp");
+
+	QFile projectFile(m_projectFileName);
+	QVERIFY(projectFile.open(QIODevice::WriteOnly));
+}
+
+void BatchExportTest::init()
+{
+	m_outputDir.reset(new QTemporaryDir);
+	QVERIFY(m_outputDir->isValid());
+	m_exitCode = -1;
+	m_output.clear();
+	m_errorOutput.clear();
+}
+
+void BatchExportTest::exportSucceeded()
+{
+	QVERIFY2(runExport("docx,fdx", m_projectFileName), "Can't run Scenarist, set SCENARIST_BINARY to its path");
+	QCOMPARE(m_exitCode, 0);
+	QVERIFY2(!m_errorOutput.contains("export failed"), qPrintable(m_errorOutput));
+	QVERIFY(QFileInfo(exportedFileName("docx")).size() > 0);
+	QVERIFY(QFileInfo(exportedFileName("fdx")).size() > 0);
+}
+
+void BatchExportTest::formatFailed()
+{
+	//
+	// На месте файла DOCX лежит папка, поэтому записать его не получится
+	//
+	QVERIFY(QDir(m_outputDir->path()).mkdir(PROJECT_NAME + ".docx"));
+
+	QVERIFY2(runExport("docx,fdx", m_projectFileName), "Can't run Scenarist, set SCENARIST_BINARY to its path");
+	QVERIFY(m_exitCode != 0);
+	QVERIFY2(m_errorOutput.contains("docx export failed"), qPrintable(m_errorOutput));
+	QVERIFY(!m_errorOutput.contains("fdx export failed"));
+	QVERIFY(!m_output.contains("docx:"));
+	QVERIFY(QFileInfo(exportedFileName("fdx")).size() > 0);
+}
+
+void BatchExportTest::projectNotFound()
+{
+	QVERIFY2(runExport("fdx", m_dir.filePath("missing.kitsp")), "Can't run Scenarist, set SCENARIST_BINARY to its path");
+	QVERIFY(m_exitCode != 0);
+	QVERIFY2(m_errorOutput.contains("file not found"), qPrintable(m_errorOutput));
+}
+
+bool BatchExportTest::runExport(const QString& _formats, const QString& _projectFileName)
+{
+	QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+	QString binary = environment.value("SCENARIST_BINARY");
+	if (binary.isEmpty()) {
+		binary = QDir(QCoreApplication::applicationDirPath()).filePath("../../bin/scenarist-desktop/Scenarist");
+	}
+	if (!environment.contains("QT_QPA_PLATFORM")) {
+		environment.insert("QT_QPA_PLATFORM", "offscreen");
+	}
+
+	QProcess scenarist;
+	scenarist.setProcessEnvironment(environment);
+	scenarist.start(binary,
+		QStringList() << "--export" << _formats << "--output-dir" << m_outputDir->path() << _projectFileName);
+	if (!scenarist.waitForFinished(EXPORT_TIMEOUT)
+		|| scenarist.exitStatus() != QProcess::NormalExit) {
+		scenarist.kill();
+		return false;
+	}
+
+	m_exitCode = scenarist.exitCode();
+	m_output = QString::fromUtf8(scenarist.readAllStandardOutput());
+	m_errorOutput = QString::fromUtf8(scenarist.readAllStandardError());
+	return true;
+}
+
+QString BatchExportTest::exportedFileName(const QString& _format) const
+{
+	return QDir(m_outputDir->path()).filePath(PROJECT_NAME + "." + _format);
+}
+
+QTEST_GUILESS_MAIN(BatchExportTest)
+
+#include "BatchExportTest.moc"
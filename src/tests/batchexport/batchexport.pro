@@ -0,0 +1,35 @@
+#-------------------------------------------------
+#
+# Проверка пакетного экспорта: неудачный формат выводится в поток ошибок,
+# а приложение завершается с ненулевым кодом
+#
+# Запускает собранное приложение, путь к нему можно задать переменной окружения SCENARIST_BINARY
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+TARGET = batchexport-test
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/tests/batchexport
+} else {
+    DESTDIR = $$PWD/../../../build/Release/tests/batchexport
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+SOURCES += \
+    BatchExportTest.cpp
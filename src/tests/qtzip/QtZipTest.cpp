@@ -0,0 +1,251 @@
+#include <qtzip/QtZipReader>
+#include <qtzip/QtZipWriter>
+
+#include <QBuffer>
+#include <QScopedPointer>
+#include <QtEndian>
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Имя записи в проверяемых архивах
+	 */
+	const QString ENTRY_NAME = "word/document.xml";
+
+	/**
+	 * @brief Размер порции, которой читается запись
+	 */
+	const int READ_CHUNK_SIZE = 1024;
+
+	/**
+	 * @brief Положение полей в локальном заголовке и в заголовке центрального каталога
+	 */
+	/** @{ */
+	const int LOCAL_HEADER_SIZE = 30;
+	const int LOCAL_CRC_OFFSET = 14;
+	const int LOCAL_COMPRESSED_SIZE_OFFSET = 18;
+	const int LOCAL_UNCOMPRESSED_SIZE_OFFSET = 22;
+	const int CENTRAL_CRC_OFFSET = 16;
+	const int CENTRAL_UNCOMPRESSED_SIZE_OFFSET = 24;
+	/** @} */
+
+	/**
+	 * @brief Содержимое записи: достаточно большое, чтобы читаться в несколько приёмов
+	 */
+	QByteArray entryData() {
+		QByteArray data;
+		for (int line = 0; line < 5000; ++line) {
+			data.append(QString("<w:p><w:r><w:t>Line %1 of the scenario</w:t></w:r></w:p>\n").arg(line).toUtf8());
+		}
+		return data;
+	}
+
+	/**
+	 * @brief Собрать архив с одной записью
+	 */
+	QByteArray makeArchive(const QByteArray& _data, bool _isCompressed) {
+		QBuffer buffer;
+		buffer.open(QIODevice::WriteOnly);
+		QtZipWriter writer(&buffer);
+		writer.setCompressionPolicy(_isCompressed ? QtZipWriter::AlwaysCompress : QtZipWriter::NeverCompress);
+		writer.addFile(ENTRY_NAME, _data);
+		writer.close();
+		return buffer.data();
+	}
+
+	/**
+	 * @brief Записать число в заголовок архива
+	 */
+	void writeUInt(QByteArray& _archive, int _position, quint32 _value) {
+		qToLittleEndian(_value, reinterpret_cast<uchar*>(_archive.data() + _position));
+	}
+
+	/**
+	 * @brief Прочитать число из заголовка архива
+	 */
+	quint32 readUInt(const QByteArray& _archive, int _position) {
+		return qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(_archive.constData() + _position));
+	}
+
+	/**
+	 * @brief Положение заголовка записи в центральном каталоге
+	 */
+	int centralHeaderPosition(const QByteArray& _archive) {
+		return _archive.lastIndexOf(QByteArray("PK\x01\x02", 4));
+	}
+
+	/**
+	 * @brief Положение данных записи, идущей первой в архиве
+	 */
+	int entryDataPosition(const QByteArray& _archive) {
+		return LOCAL_HEADER_SIZE
+				+ qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(_archive.constData() + 26))
+				+ qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(_archive.constData() + 28));
+	}
+
+	/**
+	 * @brief Прочитать запись целиком порциями
+	 * @param _isFailed - сюда записывается, завершилось ли чтение ошибкой
+	 */
+	QByteArray readEntry(QIODevice* _entry, bool* _isFailed) {
+		QByteArray data;
+		*_isFailed = false;
+		char chunk[READ_CHUNK_SIZE];
+		forever {
+			const qint64 read = _entry->read(chunk, READ_CHUNK_SIZE);
+			if (read < 0) {
+				*_isFailed = true;
+				break;
+			}
+			if (read == 0) {
+				break;
+			}
+			data.append(chunk, read);
+		}
+		return data;
+	}
+}
+
+
+/**
+ * @brief Проверка того, что повреждённые и обрезанные записи архива не читаются как целые
+ */
+class QtZipTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Целая запись читается полностью и без ошибки
+	 */
+	void readIntactEntry_data();
+	void readIntactEntry();
+
+	/**
+	 * @brief При несовпадении контрольной суммы чтение завершается ошибкой
+	 */
+	void corruptedCrc_data();
+	void corruptedCrc();
+
+	/**
+	 * @brief Если архив заканчивается раньше данных записи, чтение завершается ошибкой,
+	 *		  а не обычным концом данных
+	 */
+	void truncatedArchive_data();
+	void truncatedArchive();
+
+	/**
+	 * @brief Если сжатые данные заканчиваются раньше заявленного размера записи,
+	 *		  чтение завершается ошибкой
+	 */
+	void truncatedDeflateStream();
+};
+
+void QtZipTest::readIntactEntry_data()
+{
+	QTest::addColumn<bool>("isCompressed");
+	QTest::newRow("stored") << false;
+	QTest::newRow("deflated") << true;
+}
+
+void QtZipTest::readIntactEntry()
+{
+	QFETCH(bool, isCompressed);
+
+	QByteArray archive = makeArchive(entryData(), isCompressed);
+	QBuffer archiveBuffer(&archive);
+	archiveBuffer.open(QIODevice::ReadOnly);
+	QtZipReader reader(&archiveBuffer);
+	QScopedPointer<QIODevice> entry(reader.openFile(ENTRY_NAME));
+	QVERIFY(!entry.isNull());
+
+	bool isFailed = false;
+	QCOMPARE(readEntry(entry.data(), &isFailed), entryData());
+	QVERIFY(!isFailed);
+	QVERIFY(!QtZipReader::isCorrupted(entry.data()));
+}
+
+void QtZipTest::corruptedCrc_data()
+{
+	readIntactEntry_data();
+}
+
+void QtZipTest::corruptedCrc()
+{
+	QFETCH(bool, isCompressed);
+
+	QByteArray archive = makeArchive(entryData(), isCompressed);
+	const int centralHeader = centralHeaderPosition(archive);
+	QVERIFY(centralHeader > 0);
+	const quint32 wrongCrc = ~readUInt(archive, LOCAL_CRC_OFFSET);
+	writeUInt(archive, LOCAL_CRC_OFFSET, wrongCrc);
+	writeUInt(archive, centralHeader + CENTRAL_CRC_OFFSET, wrongCrc);
+
+	QBuffer archiveBuffer(&archive);
+	archiveBuffer.open(QIODevice::ReadOnly);
+	QtZipReader reader(&archiveBuffer);
+	QScopedPointer<QIODevice> entry(reader.openFile(ENTRY_NAME));
+	QVERIFY(!entry.isNull());
+
+	bool isFailed = false;
+	readEntry(entry.data(), &isFailed);
+	QVERIFY(isFailed);
+	QVERIFY(QtZipReader::isCorrupted(entry.data()));
+}
+
+void QtZipTest::truncatedArchive_data()
+{
+	readIntactEntry_data();
+}
+
+void QtZipTest::truncatedArchive()
+{
+	QFETCH(bool, isCompressed);
+
+	QByteArray archive = makeArchive(entryData(), isCompressed);
+	QBuffer archiveBuffer(&archive);
+	archiveBuffer.open(QIODevice::ReadOnly);
+	QtZipReader reader(&archiveBuffer);
+	QScopedPointer<QIODevice> entry(reader.openFile(ENTRY_NAME));
+	QVERIFY(!entry.isNull());
+
+	//
+	// Центральный каталог уже прочитан, обрезаем архив посреди данных записи
+	//
+	const int compressedSize = readUInt(archive, LOCAL_COMPRESSED_SIZE_OFFSET);
+	archive.truncate(entryDataPosition(archive) + compressedSize / 2);
+
+	bool isFailed = false;
+	const QByteArray data = readEntry(entry.data(), &isFailed);
+	QVERIFY(isFailed);
+	QVERIFY(QtZipReader::isCorrupted(entry.data()));
+	QVERIFY(data.size() < entryData().size());
+}
+
+void QtZipTest::truncatedDeflateStream()
+{
+	//
+	// Заявляем размер больше, чем в действительности содержит сжатый поток
+	//
+	QByteArray archive = makeArchive(entryData(), true);
+	const int centralHeader = centralHeaderPosition(archive);
+	QVERIFY(centralHeader > 0);
+	const quint32 claimedSize = entryData().size() + READ_CHUNK_SIZE;
+	writeUInt(archive, LOCAL_UNCOMPRESSED_SIZE_OFFSET, claimedSize);
+	writeUInt(archive, centralHeader + CENTRAL_UNCOMPRESSED_SIZE_OFFSET, claimedSize);
+
+	QBuffer archiveBuffer(&archive);
+	archiveBuffer.open(QIODevice::ReadOnly);
+	QtZipReader reader(&archiveBuffer);
+	QScopedPointer<QIODevice> entry(reader.openFile(ENTRY_NAME));
+	QVERIFY(!entry.isNull());
+
+	bool isFailed = false;
+	readEntry(entry.data(), &isFailed);
+	QVERIFY(isFailed);
+	QVERIFY(QtZipReader::isCorrupted(entry.data()));
+}
+
+QTEST_GUILESS_MAIN(QtZipTest)
+
+#include "QtZipTest.moc"
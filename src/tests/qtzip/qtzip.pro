@@ -0,0 +1,48 @@
+#-------------------------------------------------
+#
+# Проверка чтения повреждённых и обрезанных записей zip-архива
+#
+#-------------------------------------------------
+
+QT       += core testlib
+QT       -= gui
+
+TARGET = qtzip-test
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/tests/qtzip
+} else {
+    DESTDIR = $$PWD/../../../build/Release/tests/qtzip
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+#
+# Архиватор собирается вместе с проверкой из исходников библиотеки fileformats
+#
+DEFINES += FILEFORMATS_LIBRARY
+
+INCLUDEPATH += $$PWD/../../libs/fileformats
+
+unix {
+    LIBS += -lz
+}
+
+SOURCES += \
+    QtZipTest.cpp \
+    ../../libs/fileformats/qtzip/qtzip.cpp
+
+HEADERS += \
+    ../../libs/fileformats/qtzip/qtzipreader.h \
+    ../../libs/fileformats/qtzip/qtzipwriter.h
@@ -0,0 +1,182 @@
+#include <BusinessLayer/ScenarioDocument/ScenarioStructureParser.h>
+#include <BusinessLayer/Counters/CountersFacade.h>
+
+#include <QtTest>
+
+using BusinessLogic::Counter;
+using BusinessLogic::CountersFacade;
+using BusinessLogic::ScenarioBlockStyle;
+using BusinessLogic::ScenarioModelItem;
+using BusinessLogic::ScenarioStructureParser;
+
+
+//
+// Разбор использует из фасада счётчиков только подсчёт для текста, поэтому не тянем
+// за ним хранилище настроек, а считаем слова здесь же
+//
+Counter CountersFacade::calculate(const QString& _text, bool _calculateWords, bool _calculateCharacters)
+{
+	Q_UNUSED(_calculateCharacters);
+
+	Counter counter;
+	if (_calculateWords) {
+		counter.addWords(_text.split(' ', QString::SkipEmptyParts).size());
+	}
+	return counter;
+}
+
+
+namespace {
+	/**
+	 * @brief Построитель снимка документа из последовательности блоков
+	 */
+	class Blocks
+	{
+	public:
+		Blocks() : m_position(0) {}
+
+		Blocks& add(ScenarioBlockStyle::Type _type, const QString& _text) {
+			ScenarioStructureParser::BlockInfo block;
+			block.type = _type;
+			block.text = _text;
+			block.position = m_position;
+			m_blocks.append(block);
+			m_position += _text.length() + 1;
+			return *this;
+		}
+
+		QVector<ScenarioStructureParser::BlockInfo> blocks() const {
+			return m_blocks;
+		}
+
+	private:
+		QVector<ScenarioStructureParser::BlockInfo> m_blocks;
+		int m_position;
+	};
+
+	/**
+	 * @brief Разобрать снимок без хронометража и прописных стилей
+	 */
+	QList<ScenarioStructureParser::ItemInfo> parse(const Blocks& _blocks) {
+		return ScenarioStructureParser::parse(_blocks.blocks(), QSet<ScenarioBlockStyle::Type>(), false, true, false);
+	}
+}
+
+
+/**
+ * @brief Проверка разбора текста сценария на элементы структуры
+ */
+class StructureBuilderTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Сцены вкладываются в открытую группу, а её окончание сохраняется в группе
+	 */
+	void scenesInGroup();
+
+	/**
+	 * @brief Текст после окончания группы верхнего уровня не теряется, а образует новый элемент
+	 */
+	void topLevelTextAfterGroupFooter();
+
+	/**
+	 * @brief Текст после окончания вложенной группы образует элемент внутри охватывающей папки,
+	 *		  а окончание папки сразу после него закрывает папку
+	 */
+	void nestedTextAfterGroupFooter();
+
+	/**
+	 * @brief По окончании разбора прогресс равен 100, а отменённый разбор возвращает пустой результат
+	 */
+	void progressAndCancel();
+};
+
+void StructureBuilderTest::scenesInGroup()
+{
+	const QList<ScenarioStructureParser::ItemInfo> items = ::parse(
+		Blocks()
+			.add(ScenarioBlockStyle::SceneGroupHeader, "ACT ONE")
+			.add(ScenarioBlockStyle::SceneHeading, "INT. ROOM - DAY")
+			.add(ScenarioBlockStyle::Action, "He walks in.")
+			.add(ScenarioBlockStyle::SceneGroupFooter, "END OF ACT ONE"));
+
+	QCOMPARE(items.size(), 2);
+	QCOMPARE(items.at(0).type, ScenarioModelItem::SceneGroup);
+	QCOMPARE(items.at(0).footer, QString("END OF ACT ONE"));
+	QCOMPARE(items.at(1).type, ScenarioModelItem::Scene);
+	QCOMPARE(items.at(1).parentIndex, 0);
+	QCOMPARE(items.at(1).text, QString("He walks in."));
+}
+
+void StructureBuilderTest::topLevelTextAfterGroupFooter()
+{
+	const QList<ScenarioStructureParser::ItemInfo> items = ::parse(
+		Blocks()
+			.add(ScenarioBlockStyle::SceneGroupHeader, "ACT ONE")
+			.add(ScenarioBlockStyle::SceneHeading, "INT. ROOM - DAY")
+			.add(ScenarioBlockStyle::SceneGroupFooter, "END OF ACT ONE")
+			.add(ScenarioBlockStyle::Action, "Somebody stays in the hall.")
+			.add(ScenarioBlockStyle::Action, "And waits."));
+
+	QCOMPARE(items.size(), 3);
+	const ScenarioStructureParser::ItemInfo& afterFooter = items.at(2);
+	QCOMPARE(afterFooter.type, ScenarioModelItem::Undefined);
+	QCOMPARE(afterFooter.parentIndex, -1);
+	QCOMPARE(afterFooter.header, QString("Somebody stays in the hall."));
+	QCOMPARE(afterFooter.text, QString("And waits."));
+	QCOMPARE(afterFooter.counter.words(), 7);
+
+	//
+	// Текст группы и её сцены не изменился
+	//
+	QVERIFY(items.at(0).text.isEmpty());
+	QVERIFY(items.at(1).text.isEmpty());
+}
+
+void StructureBuilderTest::nestedTextAfterGroupFooter()
+{
+	const QList<ScenarioStructureParser::ItemInfo> items = ::parse(
+		Blocks()
+			.add(ScenarioBlockStyle::FolderHeader, "PART ONE")
+			.add(ScenarioBlockStyle::SceneGroupHeader, "ACT ONE")
+			.add(ScenarioBlockStyle::SceneHeading, "INT. ROOM - DAY")
+			.add(ScenarioBlockStyle::SceneGroupFooter, "END OF ACT ONE")
+			.add(ScenarioBlockStyle::Action, "Meanwhile in the hall.")
+			.add(ScenarioBlockStyle::FolderFooter, "END OF PART ONE")
+			.add(ScenarioBlockStyle::SceneHeading, "EXT. STREET - NIGHT"));
+
+	QCOMPARE(items.size(), 5);
+	QCOMPARE(items.at(0).type, ScenarioModelItem::Folder);
+	QCOMPARE(items.at(0).footer, QString("END OF PART ONE"));
+	QCOMPARE(items.at(1).footer, QString("END OF ACT ONE"));
+	QCOMPARE(items.at(3).type, ScenarioModelItem::Undefined);
+	QCOMPARE(items.at(3).parentIndex, 0);
+	QCOMPARE(items.at(3).header, QString("Meanwhile in the hall."));
+	QCOMPARE(items.at(4).type, ScenarioModelItem::Scene);
+	QCOMPARE(items.at(4).parentIndex, -1);
+}
+
+void StructureBuilderTest::progressAndCancel()
+{
+	Blocks blocks;
+	for (int scene = 0; scene < 10; ++scene) {
+		blocks.add(ScenarioBlockStyle::SceneHeading, QString("INT. ROOM %1 - DAY").arg(scene));
+		blocks.add(ScenarioBlockStyle::Action, "He walks in.");
+	}
+
+	QAtomicInt isCanceled(0);
+	QAtomicInt progress(0);
+	QCOMPARE(ScenarioStructureParser::parse(blocks.blocks(), QSet<ScenarioBlockStyle::Type>(), false, true, false,
+		&isCanceled, &progress).size(), 10);
+	QCOMPARE(progress.loadAcquire(), 100);
+
+	isCanceled.storeRelease(1);
+	QVERIFY(ScenarioStructureParser::parse(blocks.blocks(), QSet<ScenarioBlockStyle::Type>(), false, true, false,
+		&isCanceled, &progress).isEmpty());
+}
+
+QTEST_MAIN(StructureBuilderTest)
+
+#include "StructureBuilderTest.moc"
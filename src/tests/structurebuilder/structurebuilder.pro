@@ -0,0 +1,37 @@
+#-------------------------------------------------
+#
+# Проверка разбора текста сценария на элементы структуры при фоновом построении
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+TARGET = structurebuilder-test
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/tests/structurebuilder
+} else {
+    DESTDIR = $$PWD/../../../build/Release/tests/structurebuilder
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+INCLUDEPATH += $$PWD/../../bin/scenarist-core
+
+SOURCES += \
+    StructureBuilderTest.cpp \
+    ../../bin/scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.cpp
+
+HEADERS += \
+    ../../bin/scenarist-core/BusinessLayer/ScenarioDocument/ScenarioStructureParser.h
@@ -0,0 +1,18 @@
+#-------------------------------------------------
+#
+# Проверки отдельных частей приложения
+#
+# Собираются отдельно от приложения:
+#   qmake tests.pro && make
+# и запускаются из папки сборки, например:
+#   ./webclient-test
+#
+#-------------------------------------------------
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    batchexport \
+    qtzip \
+    structurebuilder \
+    webclient
@@ -0,0 +1,298 @@
+#include <WebClient.h>
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QtTest>
+
+namespace {
+	/**
+	 * @brief Время ожидания результата, заведомо большее суммы задержек между попытками (мс)
+	 */
+	const int RESULT_TIMEOUT = 20000;
+
+	/**
+	 * @brief Время ожидания ответа на одну попытку запроса в тестах таймаута (мс)
+	 */
+	const int SHORT_REQUEST_TIMEOUT = 300;
+
+	/**
+	 * @brief Количество попыток выполнения асинхронного запроса, как в клиенте
+	 */
+	const int MAX_ATTEMPTS = 4;
+}
+
+
+/**
+ * @brief Простейший http-сервер, отвечающий путём запроса и умеющий изображать проблемы со связью
+ */
+class TestHttpServer : public QTcpServer
+{
+	Q_OBJECT
+
+public:
+	TestHttpServer() :
+		dropRequestsCount(0),
+		isSilent(false),
+		statusCode(200),
+		requestsCount(0)
+	{
+		connect(this, &QTcpServer::newConnection, this, &TestHttpServer::aboutNewConnection);
+		listen(QHostAddress::LocalHost);
+	}
+
+	/**
+	 * @brief Адрес для запроса по заданному пути
+	 */
+	QUrl url(const QString& _path) const {
+		return QUrl(QString("http://127.0.0.1:%1%2").arg(serverPort()).arg(_path));
+	}
+
+	/**
+	 * @brief Сколько первых запросов оборвать, закрыв соединение без ответа
+	 */
+	int dropRequestsCount;
+
+	/**
+	 * @brief Не отвечать на запросы вовсе
+	 */
+	bool isSilent;
+
+	/**
+	 * @brief Код ответа
+	 */
+	int statusCode;
+
+	/**
+	 * @brief Задержки ответов по путям запросов (мс)
+	 */
+	QHash<QString, int> delays;
+
+	/**
+	 * @brief Количество полученных запросов
+	 */
+	int requestsCount;
+
+private:
+	/**
+	 * @brief Читаем запросы из нового соединения
+	 */
+	void aboutNewConnection() {
+		while (QTcpSocket* socket = nextPendingConnection()) {
+			connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+			connect(socket, &QTcpSocket::readyRead, this, [=] {
+				m_buffers[socket].append(socket->readAll());
+				handleRequest(socket);
+			});
+		}
+	}
+
+	/**
+	 * @brief Ответить на запрос, если он получен полностью
+	 */
+	void handleRequest(QTcpSocket* _socket) {
+		QByteArray& buffer = m_buffers[_socket];
+		const int headersEnd = buffer.indexOf("\r\n\r\n");
+		if (headersEnd == -1) {
+			return;
+		}
+
+		int contentLength = 0;
+		foreach (const QByteArray& header, buffer.left(headersEnd).split('\n')) {
+			if (header.toLower().startsWith("content-length:")) {
+				contentLength = header.mid(header.indexOf(':') + 1).trimmed().toInt();
+			}
+		}
+		if (buffer.size() < headersEnd + 4 + contentLength) {
+			return;
+		}
+
+		const QString path = QString::fromLatin1(buffer.left(buffer.indexOf("\r\n")).split(' ').value(1));
+		m_buffers.remove(_socket);
+		++requestsCount;
+
+		if (isSilent) {
+			return;
+		}
+		if (requestsCount <= dropRequestsCount) {
+			_socket->abort();
+			return;
+		}
+
+		const QByteArray response =
+				QString("HTTP/1.1 %1 Status\r\nContent-Type: text/plain\r\nContent-Length: %2\r\n"
+						"Connection: close\r\n\r\n%3")
+				.arg(statusCode).arg(path.toLatin1().size()).arg(path).toLatin1();
+		QPointer<QTcpSocket> socket(_socket);
+		QTimer::singleShot(delays.value(path), this, [=] {
+			if (!socket.isNull()) {
+				socket->write(response);
+				socket->disconnectFromHost();
+			}
+		});
+	}
+
+private:
+	/**
+	 * @brief Накопленные данные запросов по соединениям
+	 */
+	QHash<QTcpSocket*, QByteArray> m_buffers;
+};
+
+
+/**
+ * @brief Проверка повторов, таймаутов и доставки результатов по идентификаторам запросов в WebClient
+ */
+class WebClientTest : public QObject
+{
+	Q_OBJECT
+
+private slots:
+	/**
+	 * @brief Ответы на параллельные запросы приходят с идентификаторами своих запросов
+	 */
+	void routeResponsesById();
+
+	/**
+	 * @brief Запрос, оборванный из-за проблем со связью, повторяется
+	 */
+	void retryDroppedRequest();
+
+	/**
+	 * @brief Зависший асинхронный запрос прерывается и повторяется заданное число раз
+	 */
+	void failAfterTimeouts();
+
+	/**
+	 * @brief Зависший синхронный запрос прерывается без повторов
+	 */
+	void postSyncTimeout();
+
+	/**
+	 * @brief Ошибка сервера не повторяется и приходит отдельным сигналом
+	 */
+	void serverError();
+
+	/**
+	 * @brief Результаты асинхронных запросов не доставляются, пока ждём синхронный
+	 */
+	void deferResultsDuringPostSync();
+};
+
+void WebClientTest::routeResponsesById()
+{
+	TestHttpServer server;
+	server.delays.insert("/first", 300);
+
+	WebClient client;
+	QSignalSpy finishedSpy(&client, SIGNAL(finished(int,QByteArray)));
+	const int firstId = client.post(server.url("/first"), WebClient::Attributes());
+	const int secondId = client.post(server.url("/second"), WebClient::Attributes());
+	QVERIFY(firstId != secondId);
+
+	QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 2, RESULT_TIMEOUT);
+	QHash<int, QByteArray> responses;
+	foreach (const QList<QVariant>& arguments, finishedSpy) {
+		responses.insert(arguments.at(0).toInt(), arguments.at(1).toByteArray());
+	}
+	QCOMPARE(responses.value(firstId), QByteArray("/first"));
+	QCOMPARE(responses.value(secondId), QByteArray("/second"));
+
+	//
+	// Второй ответ пришёл раньше первого
+	//
+	QCOMPARE(finishedSpy.first().at(0).toInt(), secondId);
+}
+
+void WebClientTest::retryDroppedRequest()
+{
+	TestHttpServer server;
+	server.dropRequestsCount = 2;
+
+	WebClient client;
+	QSignalSpy finishedSpy(&client, SIGNAL(finished(int,QByteArray)));
+	QSignalSpy failedSpy(&client, SIGNAL(failed(int,QString)));
+	const int requestId = client.post(server.url("/retry"), WebClient::Attributes());
+
+	QTRY_COMPARE_WITH_TIMEOUT(finishedSpy.count(), 1, RESULT_TIMEOUT);
+	QCOMPARE(finishedSpy.first().at(0).toInt(), requestId);
+	QCOMPARE(finishedSpy.first().at(1).toByteArray(), QByteArray("/retry"));
+	QCOMPARE(failedSpy.count(), 0);
+	QCOMPARE(server.requestsCount, 3);
+}
+
+void WebClientTest::failAfterTimeouts()
+{
+	TestHttpServer server;
+	server.isSilent = true;
+
+	WebClient client;
+	client.setRequestTimeout(SHORT_REQUEST_TIMEOUT);
+	QSignalSpy failedSpy(&client, SIGNAL(failed(int,QString)));
+	const int requestId = client.post(server.url("/silent"), WebClient::Attributes());
+
+	QTRY_COMPARE_WITH_TIMEOUT(failedSpy.count(), 1, RESULT_TIMEOUT);
+	QCOMPARE(failedSpy.first().at(0).toInt(), requestId);
+	QCOMPARE(server.requestsCount, MAX_ATTEMPTS);
+}
+
+void WebClientTest::postSyncTimeout()
+{
+	TestHttpServer server;
+	server.isSilent = true;
+
+	WebClient client;
+	client.setRequestTimeout(SHORT_REQUEST_TIMEOUT);
+
+	QElapsedTimer timer;
+	timer.start();
+	const QByteArray response = client.postSync(server.url("/silent"), WebClient::Attributes());
+	QVERIFY(response.isEmpty());
+	QVERIFY(timer.elapsed() < RESULT_TIMEOUT / 4);
+	QCOMPARE(server.requestsCount, 1);
+}
+
+void WebClientTest::serverError()
+{
+	TestHttpServer server;
+	server.statusCode = 500;
+
+	WebClient client;
+	QSignalSpy serverErrorSpy(&client, SIGNAL(serverError(int,QString,QByteArray)));
+	QSignalSpy failedSpy(&client, SIGNAL(failed(int,QString)));
+	const int requestId = client.post(server.url("/error"), WebClient::Attributes());
+
+	QTRY_COMPARE_WITH_TIMEOUT(serverErrorSpy.count(), 1, RESULT_TIMEOUT);
+	QCOMPARE(serverErrorSpy.first().at(0).toInt(), requestId);
+	QCOMPARE(serverErrorSpy.first().at(2).toByteArray(), QByteArray("/error"));
+	QCOMPARE(failedSpy.count(), 0);
+	QCOMPARE(server.requestsCount, 1);
+}
+
+void WebClientTest::deferResultsDuringPostSync()
+{
+	TestHttpServer server;
+	server.delays.insert("/slow", 500);
+
+	WebClient client;
+	QList<int> finishedIds;
+	connect(&client, &WebClient::finished, [&] (int _requestId) { finishedIds.append(_requestId); });
+
+	const int asyncId = client.post(server.url("/fast"), WebClient::Attributes());
+	const QByteArray response = client.postSync(server.url("/slow"), WebClient::Attributes());
+	QCOMPARE(response, QByteArray("/slow"));
+
+	//
+	// Быстрый ответ пришёл во время ожидания, но доставлен только после него
+	//
+	QCOMPARE(finishedIds.size(), 1);
+	QVERIFY(!finishedIds.contains(asyncId));
+	QTRY_VERIFY_WITH_TIMEOUT(finishedIds.contains(asyncId), RESULT_TIMEOUT);
+}
+
+QTEST_GUILESS_MAIN(WebClientTest)
+
+#include "WebClientTest.moc"
@@ -0,0 +1,53 @@
+#-------------------------------------------------
+#
+# Проверка повторов, таймаутов и доставки ответов по идентификаторам запросов в WebClient
+# на локальном http-сервере
+#
+#-------------------------------------------------
+
+QT       += core network xml testlib
+QT       -= gui
+
+TARGET = webclient-test
+TEMPLATE = app
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+#
+# Конфигурируем расположение файлов сборки
+#
+CONFIG(debug, debug|release) {
+    DESTDIR = $$PWD/../../../build/Debug/tests/webclient
+} else {
+    DESTDIR = $$PWD/../../../build/Release/tests/webclient
+}
+
+OBJECTS_DIR = $$DESTDIR/.obj
+MOC_DIR = $$DESTDIR/.moc
+RCC_DIR = $$DESTDIR/.qrc
+UI_DIR = $$DESTDIR/.ui
+#
+
+#
+# Клиент собирается вместе с проверкой из исходников библиотеки WebLoader
+#
+DEFINES += WEBLOADER_LIBRARY
+
+INCLUDEPATH += $$PWD/../../libs/webloader
+
+SOURCES += \
+    WebClientTest.cpp \
+    ../../libs/webloader/WebClient.cpp \
+    ../../libs/webloader/WebClientWorker.cpp \
+    ../../libs/webloader/WebRequest.cpp \
+    ../../libs/webloader/HttpMultiPart.cpp \
+    ../../libs/webloader/QFreeDesktopMime/freedesktopmime.cpp
+
+HEADERS += \
+    ../../libs/webloader/WebClient.h \
+    ../../libs/webloader/WebClientWorker.h \
+    ../../libs/webloader/QFreeDesktopMime/freedesktopmime.h
+
+RESOURCES += \
+    ../../libs/webloader/resources.qrc